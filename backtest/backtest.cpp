@@ -0,0 +1,144 @@
+#include "backtest.hpp"
+
+#include "infra/book_stage.hpp"
+#include "protocols/kalshi/kalshi_ws_adapter.hpp"
+#include "strategy/kalshi_mm.hpp"
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <unordered_set>
+
+std::vector<RecordedEvent> load_recorded_feed(const std::string &path) {
+  std::vector<RecordedEvent> out;
+  std::ifstream in(path);
+  if (!in.is_open()) {
+    std::cerr << "backtest: cannot open " << path << std::endl;
+    return out;
+  }
+
+  KalshiWsAdapter adapter;
+  std::int64_t ts = 0;
+  std::string line;
+  while (std::getline(in, line)) {
+    std::string_view frame = line;
+    const auto tab = frame.find('\t');
+    std::int64_t stamped = 0;
+    if (tab != std::string_view::npos &&
+        std::from_chars(frame.data(), frame.data() + tab, stamped).ec ==
+            std::errc{}) {
+      ts = stamped;
+      frame.remove_prefix(tab + 1);
+    } else {
+      ts += 1'000'000;
+    }
+
+    auto ev = adapter.parse(frame);
+    if (!ev || ev->type == FeedEvent::Type::Fill)
+      continue;
+    out.push_back(RecordedEvent{ts, std::move(*ev)});
+  }
+  return out;
+}
+
+std::vector<std::string> feed_tickers(const std::vector<RecordedEvent> &feed) {
+  std::vector<std::string> out;
+  std::unordered_set<std::string> seen;
+  for (const auto &rec : feed) {
+    if (seen.insert(rec.ev.ticker).second)
+      out.push_back(rec.ev.ticker);
+  }
+  return out;
+}
+
+BacktestConfig backtest_config_from_json(const nlohmann::json &j) {
+  BacktestConfig cfg;
+  if (j.contains("as_params")) {
+    const auto &aj = j["as_params"];
+    cfg.as_params.gamma = aj.value("gamma", cfg.as_params.gamma);
+    cfg.as_params.k = aj.value("k", cfg.as_params.k);
+    cfg.as_params.sigma = aj.value("sigma", cfg.as_params.sigma);
+    cfg.as_params.horizon = aj.value("horizon", cfg.as_params.horizon);
+  }
+  if (j.contains("backtest")) {
+    const auto &bj = j["backtest"];
+    cfg.quote_size = bj.value("quote_size", cfg.quote_size);
+    cfg.sim.order_latency_ns =
+        bj.value("order_latency_us", cfg.sim.order_latency_ns / 1000) * 1000;
+    cfg.sim.cancel_latency_ns =
+        bj.value("cancel_latency_us", cfg.sim.cancel_latency_ns / 1000) * 1000;
+    cfg.sim.fill_from_queue =
+        bj.value("fill_from_queue", cfg.sim.fill_from_queue);
+  }
+  return cfg;
+}
+
+BacktestResult run_backtest(const std::vector<RecordedEvent> &feed,
+                            std::vector<std::string> tickers,
+                            const BacktestConfig &cfg) {
+  const auto started = std::chrono::steady_clock::now();
+
+  ASParams as_params = cfg.as_params;
+  KalshiMM mm(tickers, as_params);
+  // Same book stage the live engine runs ahead of its strategies.
+  BookStage stage(tickers);
+  mm.attach_books(stage.books());
+  SimExchange sim(cfg.sim);
+  BacktestResult res;
+
+  struct Working {
+    Quote quote{0, 0};
+    std::uint64_t bid_id = 0;
+    std::uint64_t ask_id = 0;
+  };
+  std::unordered_map<std::string, Working> working;
+  std::int64_t now = 0;
+
+  mm.set_quote_handler(
+      [&](const std::string &ticker, const Quote &yes, const Quote &) {
+        ++res.quotes;
+        Working &w = working[ticker];
+        if (w.quote.bid == yes.bid && w.quote.ask == yes.ask &&
+            (yes.bid == 0 || sim.is_open(ticker, w.bid_id)) &&
+            (yes.ask == 0 || sim.is_open(ticker, w.ask_id)))
+          return;
+        sim.cancel(ticker, w.bid_id, now);
+        sim.cancel(ticker, w.ask_id, now);
+        w.quote = yes;
+        w.bid_id = w.ask_id = 0;
+        if (yes.bid > 0)
+          w.bid_id =
+              sim.submit(ticker, Side::YES, yes.bid, cfg.quote_size, now);
+        if (yes.ask > 0)
+          w.ask_id =
+              sim.submit(ticker, Side::NO, 100 - yes.ask, cfg.quote_size, now);
+      });
+
+  std::vector<FeedEvent> fills;
+  for (const auto &rec : feed) {
+    now = rec.ts_ns;
+    fills.clear();
+    sim.on_market_data(rec.ev, now, fills);
+    mm.handle_feed_event(rec.ev, stage.apply(rec.ev));
+    for (auto &f : fills) {
+      const FillEvent &fe = std::get<FillEvent>(f.payload);
+      res.contracts_filled += fe.count;
+      res.max_abs_position =
+          std::max(res.max_abs_position, std::abs(fe.post_position));
+      mm.handle_feed_event(f, stage.apply(f));
+    }
+    ++res.events;
+  }
+
+  res.orders = sim.orders_submitted();
+  res.fills = sim.fills_generated();
+  mm.positions().for_each_ledger([&](const TickerPositionLedger &ledger) {
+    res.pnl.emplace(ledger.ticker(), ledger.snapshot());
+  });
+  res.wall_seconds = std::chrono::duration<double>(
+                         std::chrono::steady_clock::now() - started)
+                         .count();
+  return res;
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include "backtest/sim_exchange.hpp"
+#include "strategy/avellaneda_stoikov.hpp"
+#include "strategy/positions/ticker_position_ledger.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <nlohmann/json.hpp>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+struct RecordedEvent {
+  std::int64_t ts_ns;
+  FeedEvent ev;
+};
+
+// Reads raw feed frames, one per line, optionally prefixed by a receive
+// timestamp in nanoseconds and a tab. Unstamped frames are spaced 1ms after
+// the previous one. Only book snapshots and deltas are kept.
+std::vector<RecordedEvent> load_recorded_feed(const std::string &path);
+
+// Market tickers in the order they first appear.
+std::vector<std::string> feed_tickers(const std::vector<RecordedEvent> &feed);
+
+struct BacktestConfig {
+  ASParams as_params{0.1, 1.5, 2.0, 60.0};
+  SimConfig sim;
+  int quote_size = 1;
+};
+
+// Reads the optional "as_params" and "backtest" sections of a runner file.
+BacktestConfig backtest_config_from_json(const nlohmann::json &j);
+
+struct BacktestResult {
+  std::unordered_map<std::string, TickerSnapshotPnL> pnl;
+  std::size_t events = 0;
+  std::size_t quotes = 0;
+  std::size_t orders = 0;
+  std::size_t fills = 0;
+  long long contracts_filled = 0;
+  int max_abs_position = 0; // largest |yes - no| seen in any market
+  double wall_seconds = 0;
+};
+
+// Replays a recorded feed through KalshiMM with its YES quote working on a
+// SimExchange: the bid as a YES bid, the ask as a NO bid at 100 - ask.
+// Quotes are replaced only when their price changes or the order is gone.
+BacktestResult run_backtest(const std::vector<RecordedEvent> &feed,
+                            std::vector<std::string> tickers,
+                            const BacktestConfig &cfg);
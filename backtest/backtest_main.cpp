@@ -0,0 +1,46 @@
+#include "backtest/backtest.hpp"
+#include <fstream>
+#include <iostream>
+#include <nlohmann/json.hpp>
+
+int main(int argc, char **argv) {
+  if (argc < 2 || argc > 3) {
+    std::cerr << "usage: ./kalshi_backtest path/to/feed.jsonl [runner.json]"
+              << std::endl;
+    return 1;
+  }
+
+  BacktestConfig cfg;
+  if (argc == 3) {
+    std::ifstream runner_file(argv[2]);
+    if (!runner_file.is_open()) {
+      std::cerr << "error opening file: " << argv[2] << std::endl;
+      return 1;
+    }
+    nlohmann::json j;
+    runner_file >> j;
+    cfg = backtest_config_from_json(j);
+  }
+
+  const auto feed = load_recorded_feed(argv[1]);
+  if (feed.empty()) {
+    std::cerr << "no book events in " << argv[1] << std::endl;
+    return 1;
+  }
+
+  const BacktestResult res = run_backtest(feed, feed_tickers(feed), cfg);
+
+  const double span_s =
+      (feed.back().ts_ns - feed.front().ts_ns) / 1'000'000'000.0;
+  std::cout << res.events << " events (" << span_s << "s of market) in "
+            << res.wall_seconds << "s; " << res.quotes << " quotes, "
+            << res.orders << " orders, " << res.fills << " fills\n";
+  for (const auto &[ticker, s] : res.pnl) {
+    std::cout << ticker << " yes=" << s.yes_pos << " no=" << s.no_pos
+              << " cash=" << s.cash_cents
+              << " realized=" << s.realized_pnl_cents
+              << " unrealized=" << s.unrealized_pnl_cents
+              << " equity=" << s.equity_cents << '\n';
+  }
+  return 0;
+}
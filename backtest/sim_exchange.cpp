@@ -0,0 +1,257 @@
+#include "sim_exchange.hpp"
+
+#include <algorithm>
+
+namespace {
+
+Side other(Side s) { return s == Side::YES ? Side::NO : Side::YES; }
+
+int level_size(const OrderBook::Levels &levels, int price) {
+  auto it = levels.find(price);
+  return it == levels.end() ? 0 : it->second;
+}
+
+std::size_t ladder(Side s) { return s == Side::YES ? 1 : 0; }
+
+// Orders in the sequence the venue would fill them: best price first, then
+// by place in the queue, then by age.
+bool ahead_of(const SimOrder &a, const SimOrder &b) {
+  if (a.price != b.price)
+    return a.price > b.price;
+  if (a.queue_ahead != b.queue_ahead)
+    return a.queue_ahead < b.queue_ahead;
+  return a.id < b.id;
+}
+
+} // namespace
+
+SimExchange::SimExchange(SimConfig c) : cfg(c) {}
+
+std::uint64_t SimExchange::submit(const std::string &ticker, Side side,
+                                  int price, int count, std::int64_t now_ns) {
+  SimOrder o;
+  o.id = next_id++;
+  o.side = side;
+  o.price = price;
+  o.remaining = count;
+  o.active_at_ns = now_ns + cfg.order_latency_ns;
+  markets[ticker].orders.push_back(o);
+  ++submitted;
+  return o.id;
+}
+
+void SimExchange::cancel(const std::string &ticker, std::uint64_t id,
+                         std::int64_t now_ns) {
+  auto it = markets.find(ticker);
+  if (it == markets.end())
+    return;
+  for (auto &o : it->second.orders) {
+    if (o.id == id) {
+      o.cancel_at_ns =
+          std::min(o.cancel_at_ns, now_ns + cfg.cancel_latency_ns);
+      return;
+    }
+  }
+}
+
+bool SimExchange::is_open(const std::string &ticker, std::uint64_t id) const {
+  auto it = markets.find(ticker);
+  if (it == markets.end())
+    return false;
+  for (const auto &o : it->second.orders) {
+    if (o.id == id)
+      return o.cancel_at_ns == std::numeric_limits<std::int64_t>::max();
+  }
+  return false;
+}
+
+const std::vector<SimOrder> &
+SimExchange::orders(const std::string &ticker) const {
+  static const std::vector<SimOrder> none;
+  auto it = markets.find(ticker);
+  return it == markets.end() ? none : it->second.orders;
+}
+
+void SimExchange::advance(std::int64_t now_ns, std::vector<FeedEvent> &fills) {
+  for (auto &[ticker, mkt] : markets) {
+    bool changed = false;
+    for (auto &o : mkt.orders) {
+      if (o.cancel_at_ns <= now_ns) {
+        o.remaining = 0;
+        changed = true;
+      } else if (!o.active && o.active_at_ns <= now_ns) {
+        activate(ticker, mkt, o, now_ns, fills);
+        changed = true;
+      }
+    }
+    if (changed)
+      erase_done(mkt);
+  }
+}
+
+void SimExchange::activate(const std::string &ticker, Market &mkt,
+                           SimOrder &o, std::int64_t now_ns,
+                           std::vector<FeedEvent> &fills) {
+  o.active = true;
+  KalshiOrderBook *kb = book_manager.get_book(ticker);
+  if (!kb || !kb->has_snapshot)
+    return;
+
+  // Marketable on arrival: take what crosses, rest the remainder at the
+  // back of the queue.
+  const int take = take_crossing(mkt, kb->book, o.side, o.price, o.remaining);
+  if (take > 0)
+    fill(ticker, mkt, o, take, /*is_taker=*/true, now_ns, fills);
+  o.queue_ahead = level_size(kb->book.bids(o.side), o.price);
+}
+
+void SimExchange::on_market_data(const FeedEvent &ev, std::int64_t now_ns,
+                                 std::vector<FeedEvent> &fills) {
+  advance(now_ns, fills);
+
+  if (const auto *snap = std::get_if<SnapshotEvent>(&ev.payload)) {
+    if (book_manager.set_ticker_snapshot(ev.ticker, ev.cid, *snap) !=
+        KalshiOrderBook::ApplyResult::Applied)
+      return;
+    auto it = markets.find(ev.ticker);
+    if (it == markets.end())
+      return;
+    const OrderBook &book = book_manager.get_book(ev.ticker)->book;
+    for (Side side : {Side::NO, Side::YES}) {
+      for (int px = 0; px <= 100; ++px) {
+        clamp_taken(it->second, book, side, px);
+      }
+    }
+    for (auto &o : it->second.orders) {
+      if (o.active)
+        o.queue_ahead =
+            std::min(o.queue_ahead, level_size(book.bids(o.side), o.price));
+    }
+    match_crossed(ev.ticker, it->second, now_ns, fills);
+    return;
+  }
+
+  const auto *d = std::get_if<DeltaEvent>(&ev.payload);
+  if (!d || book_manager.update_ticker_delta(ev.ticker, ev.cid, *d) !=
+                KalshiOrderBook::ApplyResult::Applied)
+    return;
+  auto it = markets.find(ev.ticker);
+  if (it == markets.end())
+    return;
+  Market &mkt = it->second;
+  clamp_taken(mkt, book_manager.get_book(ev.ticker)->book, d->side,
+              d->price_cents);
+
+  if (d->delta_contracts < 0) {
+    // The removed size works down the queue once: past the contracts ahead
+    // of our first order, through that order, and on to the next.
+    const int removed = -d->delta_contracts;
+    std::vector<SimOrder *> level;
+    for (auto &o : mkt.orders) {
+      if (o.active && o.side == d->side && o.price == d->price_cents &&
+          o.remaining > 0)
+        level.push_back(&o);
+    }
+    std::sort(level.begin(), level.end(),
+              [](const SimOrder *a, const SimOrder *b) {
+                return ahead_of(*a, *b);
+              });
+    int ours = 0; // filled from this delta so far
+    for (SimOrder *o : level) {
+      const int past_us = removed - o->queue_ahead - ours;
+      o->queue_ahead = std::max(0, o->queue_ahead - removed);
+      if (cfg.fill_from_queue && past_us > 0) {
+        const int qty = std::min(o->remaining, past_us);
+        fill(ev.ticker, mkt, *o, qty, /*is_taker=*/false, now_ns, fills);
+        ours += qty;
+      }
+    }
+  }
+  match_crossed(ev.ticker, mkt, now_ns, fills);
+}
+
+void SimExchange::match_crossed(const std::string &ticker, Market &mkt,
+                                std::int64_t now_ns,
+                                std::vector<FeedEvent> &fills) {
+  const OrderBook &book = book_manager.get_book(ticker)->book;
+  std::vector<SimOrder *> resting;
+  for (auto &o : mkt.orders) {
+    if (o.active && o.remaining > 0)
+      resting.push_back(&o);
+  }
+  std::sort(resting.begin(), resting.end(),
+            [](const SimOrder *a, const SimOrder *b) {
+              return ahead_of(*a, *b);
+            });
+  for (SimOrder *o : resting) {
+    const int qty = take_crossing(mkt, book, o->side, o->price, o->remaining);
+    if (qty > 0)
+      fill(ticker, mkt, *o, qty, /*is_taker=*/false, now_ns, fills);
+  }
+  erase_done(mkt);
+}
+
+int SimExchange::take_crossing(Market &mkt, const OrderBook &book, Side side,
+                               int price, int want) {
+  const Side resting = other(side);
+  auto &taken = mkt.taken[ladder(resting)];
+  int total = 0;
+  for (const auto &[px, vol] : book.bids(resting)) {
+    if (px + price < 100 || total == want)
+      break;
+    if (px < 0 || px > 100)
+      continue;
+    const int qty = std::min(want - total, vol - taken[px]);
+    if (qty > 0) {
+      taken[px] += qty;
+      total += qty;
+    }
+  }
+  return total;
+}
+
+void SimExchange::clamp_taken(Market &mkt, const OrderBook &book, Side side,
+                              int price) {
+  if (price < 0 || price > 100)
+    return;
+  int &t = mkt.taken[ladder(side)][price];
+  if (t > 0)
+    t = std::min(t, level_size(book.bids(side), price));
+}
+
+void SimExchange::fill(const std::string &ticker, Market &mkt, SimOrder &o,
+                       int qty, bool is_taker, std::int64_t now_ns,
+                       std::vector<FeedEvent> &fills) {
+  o.remaining -= qty;
+  mkt.net_position += o.side == Side::YES ? qty : -qty;
+  ++fill_count;
+
+  FillEvent f{};
+  f.trade_id = "sim-" + std::to_string(fill_count);
+  f.order_id = std::to_string(o.id);
+  f.market_ticker = ticker;
+  f.is_taker = is_taker;
+  f.side = o.side;
+  f.purchased_side = o.side;
+  f.action = Action::BUY;
+  f.yes_price = o.side == Side::YES ? o.price : 100 - o.price;
+  f.count = qty;
+  f.ts = now_ns / 1'000'000'000;
+  f.post_position = mkt.net_position;
+
+  FeedEvent ev;
+  ev.exchange = Exchange::KALSHI;
+  ev.type = FeedEvent::Type::Fill;
+  ev.cid = 0;
+  ev.ticker = ticker;
+  ev.payload = std::move(f);
+  fills.push_back(std::move(ev));
+}
+
+void SimExchange::erase_done(Market &mkt) {
+  mkt.orders.erase(std::remove_if(mkt.orders.begin(), mkt.orders.end(),
+                                  [](const SimOrder &o) {
+                                    return o.remaining <= 0;
+                                  }),
+                   mkt.orders.end());
+}
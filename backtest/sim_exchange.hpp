@@ -0,0 +1,96 @@
+#pragma once
+
+#include "protocols/feed_adapter.hpp"
+#include "protocols/kalshi/kalshi_order_book_manager.hpp"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+struct SimConfig {
+  // Time from submit/cancel until the venue acts on it.
+  std::int64_t order_latency_ns = 2'000'000;
+  std::int64_t cancel_latency_ns = 2'000'000;
+  // Size removed from our level is assumed to come off the front of the
+  // queue: it first works through the contracts ahead of us, then fills us.
+  // When false we only fill once the other side crosses our price.
+  bool fill_from_queue = true;
+};
+
+struct SimOrder {
+  std::uint64_t id = 0;
+  Side side = Side::YES; // ladder the bid rests on
+  int price = 0;
+  int remaining = 0;
+  int queue_ahead = 0; // contracts in front of us at `price`
+  std::int64_t active_at_ns = 0;
+  std::int64_t cancel_at_ns = std::numeric_limits<std::int64_t>::max();
+  bool active = false;
+};
+
+// In-process stand-in for the Kalshi matching engine, driven by recorded
+// book messages. Our orders never enter the recorded book; instead each one
+// carries an estimate of the size queued ahead of it, and fills are inferred
+// from what the recorded book does at and through our price.
+//
+// Kalshi books are bids on both sides, so every order is a buy: selling YES
+// at p is a NO bid at 100 - p.
+class SimExchange {
+public:
+  explicit SimExchange(SimConfig cfg = {});
+
+  std::uint64_t submit(const std::string &ticker, Side side, int price,
+                       int count, std::int64_t now_ns);
+  void cancel(const std::string &ticker, std::uint64_t id,
+              std::int64_t now_ns);
+  bool is_open(const std::string &ticker, std::uint64_t id) const;
+
+  // Applies order and cancel latency up to `now_ns`.
+  void advance(std::int64_t now_ns, std::vector<FeedEvent> &fills);
+
+  // Advances to `now_ns`, applies a snapshot or delta and appends any fills
+  // it causes. Other event types are ignored.
+  void on_market_data(const FeedEvent &ev, std::int64_t now_ns,
+                      std::vector<FeedEvent> &fills);
+
+  const std::vector<SimOrder> &orders(const std::string &ticker) const;
+  const KalshiOrderBookManager &books() const { return book_manager; }
+
+  std::size_t orders_submitted() const { return submitted; }
+  std::size_t fills_generated() const { return fill_count; }
+
+private:
+  struct Market {
+    std::vector<SimOrder> orders;
+    int net_position = 0; // yes - no, as reported in post_position
+    // Recorded contracts our orders have already traded against, per
+    // ladder and price. The recording never removes them, so this keeps
+    // the same liquidity from filling us twice.
+    std::array<std::array<int, 101>, 2> taken{};
+  };
+
+  void activate(const std::string &ticker, Market &mkt, SimOrder &o,
+                std::int64_t now_ns, std::vector<FeedEvent> &fills);
+  void match_crossed(const std::string &ticker, Market &mkt,
+                     std::int64_t now_ns, std::vector<FeedEvent> &fills);
+  // Uses up to `want` contracts of what crosses a bid at `price` on
+  // `side`, best price first. Returns how many.
+  int take_crossing(Market &mkt, const OrderBook &book, Side side, int price,
+                    int want);
+  // What is left of `taken` after the recorded level at `price` changed.
+  void clamp_taken(Market &mkt, const OrderBook &book, Side side, int price);
+  void fill(const std::string &ticker, Market &mkt, SimOrder &o, int qty,
+            bool is_taker, std::int64_t now_ns,
+            std::vector<FeedEvent> &fills);
+  void erase_done(Market &mkt);
+
+  SimConfig cfg;
+  KalshiOrderBookManager book_manager;
+  std::unordered_map<std::string, Market> markets;
+  std::uint64_t next_id = 1;
+  std::size_t submitted = 0;
+  std::size_t fill_count = 0;
+};
@@ -0,0 +1,84 @@
+#include "sweep.hpp"
+
+namespace {
+
+std::vector<double> axis(const nlohmann::json &aj, const char *key,
+                         double base) {
+  if (!aj.contains(key))
+    return {base};
+  const auto &v = aj[key];
+  if (!v.is_array())
+    return {v.get<double>()};
+  std::vector<double> out = v.get<std::vector<double>>();
+  if (out.empty())
+    out.push_back(base);
+  return out;
+}
+
+} // namespace
+
+std::vector<ASParams> SweepGrid::expand() const {
+  std::vector<ASParams> out;
+  out.reserve(gamma.size() * k.size() * sigma.size() * horizon.size());
+  for (double g : gamma)
+    for (double kk : k)
+      for (double s : sigma)
+        for (double h : horizon)
+          out.push_back(ASParams{g, kk, s, h});
+  return out;
+}
+
+SweepGrid sweep_grid_from_json(const nlohmann::json &j, const ASParams &base) {
+  const nlohmann::json aj =
+      j.contains("as_params") ? j["as_params"] : nlohmann::json::object();
+  SweepGrid grid;
+  grid.gamma = axis(aj, "gamma", base.gamma);
+  grid.k = axis(aj, "k", base.k);
+  grid.sigma = axis(aj, "sigma", base.sigma);
+  grid.horizon = axis(aj, "horizon", base.horizon);
+  return grid;
+}
+
+std::vector<SweepResult> run_sweep(const std::vector<RecordedEvent> &feed,
+                                   const std::vector<std::string> &tickers,
+                                   const std::vector<ASParams> &grid,
+                                   const BacktestConfig &base,
+                                   ThreadPool &pool) {
+  // Each task writes only its own slot, so no locking is needed.
+  std::vector<SweepResult> results(grid.size());
+  for (std::size_t i = 0; i < grid.size(); ++i) {
+    pool.submit([&, i] {
+      BacktestConfig cfg = base;
+      cfg.as_params = grid[i];
+      results[i].params = grid[i];
+      results[i].result = run_backtest(feed, tickers, cfg);
+    });
+  }
+  pool.wait_idle();
+  return results;
+}
+
+void write_sweep_csv(std::ostream &out,
+                     const std::vector<SweepResult> &results) {
+  out << "gamma,k,sigma,horizon,equity_cents,realized_pnl_cents,"
+         "unrealized_pnl_cents,cash_cents,yes_pos,no_pos,max_abs_position,"
+         "quotes,orders,fills,contracts_filled,wall_seconds\n";
+  for (const auto &r : results) {
+    TickerSnapshotPnL total;
+    for (const auto &[_, s] : r.result.pnl) {
+      total.equity_cents += s.equity_cents;
+      total.realized_pnl_cents += s.realized_pnl_cents;
+      total.unrealized_pnl_cents += s.unrealized_pnl_cents;
+      total.cash_cents += s.cash_cents;
+      total.yes_pos += s.yes_pos;
+      total.no_pos += s.no_pos;
+    }
+    out << r.params.gamma << ',' << r.params.k << ',' << r.params.sigma << ','
+        << r.params.horizon << ',' << total.equity_cents << ','
+        << total.realized_pnl_cents << ',' << total.unrealized_pnl_cents << ','
+        << total.cash_cents << ',' << total.yes_pos << ',' << total.no_pos
+        << ',' << r.result.max_abs_position << ',' << r.result.quotes << ','
+        << r.result.orders << ',' << r.result.fills << ','
+        << r.result.contracts_filled << ',' << r.result.wall_seconds << '\n';
+  }
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include "backtest/backtest.hpp"
+#include "infra/thread_pool.hpp"
+#include <ostream>
+#include <vector>
+
+// Values to try for each ASParams field; the sweep runs their product.
+struct SweepGrid {
+  std::vector<double> gamma;
+  std::vector<double> k;
+  std::vector<double> sigma;
+  std::vector<double> horizon;
+
+  std::vector<ASParams> expand() const;
+};
+
+// Reads "as_params" as {"gamma": [..], "k": [..], ...}; a missing or scalar
+// field sweeps only `base`'s value.
+SweepGrid sweep_grid_from_json(const nlohmann::json &j, const ASParams &base);
+
+struct SweepResult {
+  ASParams params;
+  BacktestResult result;
+};
+
+// Runs one independent backtest per parameter set on `pool`. The feed is
+// shared read-only by every run; results come back in `grid` order.
+std::vector<SweepResult> run_sweep(const std::vector<RecordedEvent> &feed,
+                                   const std::vector<std::string> &tickers,
+                                   const std::vector<ASParams> &grid,
+                                   const BacktestConfig &base,
+                                   ThreadPool &pool);
+
+// One CSV row per configuration, PnL summed over markets.
+void write_sweep_csv(std::ostream &out,
+                     const std::vector<SweepResult> &results);
@@ -0,0 +1,53 @@
+#include "backtest/sweep.hpp"
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <nlohmann/json.hpp>
+#include <string>
+
+int main(int argc, char **argv) {
+  if (argc < 3 || argc > 4) {
+    std::cerr << "usage: ./kalshi_sweep path/to/feed.jsonl path/to/sweep.json "
+                 "[threads]"
+              << std::endl;
+    return 1;
+  }
+
+  std::ifstream sweep_file(argv[2]);
+  if (!sweep_file.is_open()) {
+    std::cerr << "error opening file: " << argv[2] << std::endl;
+    return 1;
+  }
+  nlohmann::json j;
+  sweep_file >> j;
+
+  // "backtest" settings are shared; "as_params" holds the grid.
+  nlohmann::json shared = j;
+  shared.erase("as_params");
+  const BacktestConfig base = backtest_config_from_json(shared);
+  const std::vector<ASParams> grid =
+      sweep_grid_from_json(j, base.as_params).expand();
+
+  const auto loaded_at = std::chrono::steady_clock::now();
+  const auto feed = load_recorded_feed(argv[1]);
+  if (feed.empty()) {
+    std::cerr << "no book events in " << argv[1] << std::endl;
+    return 1;
+  }
+  const auto tickers = feed_tickers(feed);
+
+  ThreadPool pool(argc == 4 ? std::stoul(argv[3])
+                            : std::thread::hardware_concurrency());
+  const auto started = std::chrono::steady_clock::now();
+  const auto results = run_sweep(feed, tickers, grid, base, pool);
+  const auto finished = std::chrono::steady_clock::now();
+
+  write_sweep_csv(std::cout, results);
+  std::cerr << feed.size() << " events loaded in "
+            << std::chrono::duration<double>(started - loaded_at).count()
+            << "s; " << grid.size() << " configurations on " << pool.size()
+            << " threads in "
+            << std::chrono::duration<double>(finished - started).count()
+            << "s" << std::endl;
+  return 0;
+}
@@ -0,0 +1,176 @@
+// Request-signing throughput: RSA-PSS/SHA-256 signatures/sec over a
+// Kalshi-shaped message, for the old fresh-context-per-call path, the
+// cached PssSigner, and KalshiAuth's signing pool at several sizes.
+
+#include "protocols/kalshi/kalshi_auth.hpp"
+#include "utils/rsa_pss.hpp"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <future>
+#include <iostream>
+#include <openssl/rsa.h>
+#include <sstream>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+const std::string kMessage =
+    "1700000000000POST/trade-api/v2/portfolio/orders";
+
+double elapsed_s(Clock::time_point start) {
+  return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+// What signPssSha256 used to do on every call: a new context, padding and
+// salt set up again, base64 through a BIO chain.
+bool sign_fresh_context(EVP_PKEY *pkey, const std::string &message,
+                        std::string &out) {
+  EVP_MD_CTX *ctx = EVP_MD_CTX_new();
+  EVP_PKEY_CTX *pctx = nullptr;
+  bool ok =
+      EVP_DigestSignInit(ctx, &pctx, EVP_sha256(), nullptr, pkey) == 1 &&
+      EVP_PKEY_CTX_set_rsa_padding(pctx, RSA_PKCS1_PSS_PADDING) > 0 &&
+      EVP_PKEY_CTX_set_rsa_mgf1_md(pctx, EVP_sha256()) > 0 &&
+      EVP_PKEY_CTX_set_rsa_pss_saltlen(pctx, RSA_PSS_SALTLEN_DIGEST) > 0 &&
+      EVP_DigestSignUpdate(ctx, message.data(), message.size()) == 1;
+  std::size_t len = 0;
+  ok = ok && EVP_DigestSignFinal(ctx, nullptr, &len) == 1;
+  std::vector<unsigned char> sig(len);
+  ok = ok && EVP_DigestSignFinal(ctx, sig.data(), &len) == 1;
+  EVP_MD_CTX_free(ctx);
+  if (!ok)
+    return false;
+  sig.resize(len);
+
+  BIO *b64 = BIO_new(BIO_f_base64());
+  BIO *mem = BIO_new(BIO_s_mem());
+  BIO_set_flags(b64, BIO_FLAGS_BASE64_NO_NL);
+  b64 = BIO_push(b64, mem);
+  BIO_write(b64, sig.data(), static_cast<int>(sig.size()));
+  (void)BIO_flush(b64);
+  BUF_MEM *buf = nullptr;
+  BIO_get_mem_ptr(b64, &buf);
+  out.assign(buf->data, buf->length);
+  BIO_free_all(b64);
+  return true;
+}
+
+template <typename F> double rate(int n, F &&sign_one) {
+  const auto start = Clock::now();
+  for (int i = 0; i < n; ++i) {
+    if (!sign_one()) {
+      std::cerr << "signing failed" << std::endl;
+      std::exit(1);
+    }
+  }
+  return n / elapsed_s(start);
+}
+
+double pool_rate(std::size_t threads, int n) {
+  KalshiAuth &auth = KalshiAuth::instance();
+  auth.set_signing_threads(threads);
+  std::vector<std::future<SignedRequest>> pending;
+  pending.reserve(n);
+  const auto start = Clock::now();
+  for (int i = 0; i < n; ++i) {
+    pending.push_back(
+        auth.sign_request_async("POST", "/trade-api/v2/portfolio/orders"));
+  }
+  for (auto &f : pending)
+    f.get();
+  const double r = n / elapsed_s(start);
+  auth.set_signing_threads(0);
+  return r;
+}
+
+// KalshiAuth only loads keys from disk.
+std::string write_temp_key(EVP_PKEY *pkey) {
+  char path[] = "/tmp/kalshi_signing_bench_XXXXXX";
+  const int fd = mkstemp(path);
+  if (fd < 0)
+    return "";
+  FILE *f = fdopen(fd, "w");
+  PEM_write_PrivateKey(f, pkey, nullptr, nullptr, 0, nullptr, nullptr);
+  std::fclose(f);
+  return path;
+}
+
+std::vector<std::size_t> parse_threads(const std::string &s) {
+  std::vector<std::size_t> out;
+  std::stringstream in(s);
+  std::string item;
+  while (std::getline(in, item, ','))
+    out.push_back(std::stoul(item));
+  return out;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  int n = 2000;
+  unsigned bits = 2048;
+  std::vector<std::size_t> threads{1, 2, 4};
+  for (int i = 1; i < argc; ++i) {
+    const std::string arg = argv[i];
+    if (arg == "--signatures" && i + 1 < argc) {
+      n = std::stoi(argv[++i]);
+    } else if (arg == "--bits" && i + 1 < argc) {
+      bits = static_cast<unsigned>(std::stoul(argv[++i]));
+    } else if (arg == "--threads" && i + 1 < argc) {
+      threads = parse_threads(argv[++i]);
+    } else {
+      std::cerr << "usage: ./kalshi_signing_bench [--signatures N] "
+                   "[--bits 2048] [--threads 1,2,4]"
+                << std::endl;
+      return 1;
+    }
+  }
+
+  EVP_PKEY *pkey = EVP_RSA_gen(bits);
+  if (!pkey) {
+    std::cerr << "RSA key generation failed" << std::endl;
+    return 1;
+  }
+
+  std::string sig;
+  std::printf("RSA-%u, %d signatures per row\n", bits, n);
+  std::printf("%-28s %12s\n", "path", "sigs/sec");
+
+  std::printf("%-28s %12.0f\n", "fresh context per call", rate(n, [&] {
+                return sign_fresh_context(pkey, kMessage, sig);
+              }));
+
+  PssSigner signer(pkey);
+  std::printf("%-28s %12.0f\n", "cached PssSigner", rate(n, [&] {
+                return signer.sign(kMessage, sig);
+              }));
+
+  const std::string key_path = write_temp_key(pkey);
+  if (key_path.empty()) {
+    std::cerr << "could not write temporary key" << std::endl;
+    EVP_PKEY_free(pkey);
+    return 1;
+  }
+  KalshiAuth::instance().configure_from_file(key_path, "bench");
+  std::remove(key_path.c_str());
+
+  std::string ts;
+  std::printf("%-28s %12.0f\n", "KalshiAuth::sign_request", rate(n, [&] {
+                KalshiAuth::instance().sign_request(
+                    "POST", "/trade-api/v2/portfolio/orders", ts, sig);
+                return true;
+              }));
+  for (std::size_t t : threads) {
+    char label[32];
+    std::snprintf(label, sizeof(label), "signing pool, %zu threads", t);
+    std::printf("%-28s %12.0f\n", label, pool_rate(t, n));
+  }
+
+  EVP_PKEY_free(pkey);
+  return 0;
+}
@@ -0,0 +1,367 @@
+// End-to-end tick-to-quote latency: a local ixwebsocket server replays
+// Kalshi-shaped book frames at fixed rates into WsClient -> Engine ->
+// KalshiMM, and every quote is timed against the send timestamp of the
+// frame that produced it.
+
+#include "infra/engine.hpp"
+#include "infra/ws_client.hpp"
+#include "protocols/kalshi/kalshi_ws_adapter.hpp"
+#include "strategy/kalshi_mm.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <ixwebsocket/IXWebSocketServer.h>
+#include <memory>
+#include <nlohmann/json.hpp>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+const std::string kTicker = "BENCH-26-LAT";
+
+std::int64_t now_ns() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             Clock::now().time_since_epoch())
+      .count();
+}
+
+// One paced replay. Frames and their send timestamps are indexed by
+// seq - base_seq.
+struct Run {
+  std::int64_t base_seq = 0;
+  std::vector<std::string> frames;
+  std::unique_ptr<std::atomic<std::int64_t>[]> sent_ns;
+  std::vector<std::int64_t> latencies_ns; // engine thread only
+  std::atomic<std::size_t> handled{0};
+};
+
+// Sits in front of KalshiMM so each quote can be attributed to the frame
+// being handled when it was produced.
+class LatencyProbe : public Strategy {
+public:
+  explicit LatencyProbe(std::shared_ptr<KalshiMM> mm) : mm(std::move(mm)) {
+    this->mm->set_quote_handler([this](const std::string &, const Quote &,
+                                       const Quote &) { on_quote(); });
+  }
+
+  void set_run(Run *r) { run.store(r, std::memory_order_release); }
+
+  void handle_feed_event(const FeedEvent &ev,
+                         const KalshiOrderBook *book) override {
+    current_seq = std::visit(
+        [](const auto &v) -> std::int64_t {
+          using T = std::decay_t<decltype(v)>;
+          if constexpr (std::is_same_v<T, SnapshotEvent> ||
+                        std::is_same_v<T, DeltaEvent>)
+            return v.seq;
+          else
+            return -1;
+        },
+        ev.payload);
+    mm->handle_feed_event(ev, book);
+    if (Run *r = run.load(std::memory_order_acquire))
+      r->handled.fetch_add(1, std::memory_order_release);
+  }
+
+private:
+  void on_quote() {
+    Run *r = run.load(std::memory_order_acquire);
+    if (!r || current_seq < r->base_seq)
+      return;
+    const std::size_t i = static_cast<std::size_t>(current_seq - r->base_seq);
+    if (i >= r->frames.size())
+      return;
+    const std::int64_t sent = r->sent_ns[i].load(std::memory_order_acquire);
+    if (sent != 0)
+      r->latencies_ns.push_back(now_ns() - sent);
+  }
+
+  std::shared_ptr<KalshiMM> mm;
+  std::atomic<Run *> run{nullptr};
+  std::int64_t current_seq = -1;
+};
+
+std::string snapshot_frame(std::int64_t seq) {
+  std::ostringstream out;
+  out << R"({"type":"orderbook_snapshot","sid":1,"seq":)" << seq
+      << R"(,"msg":{"market_ticker":")" << kTicker
+      << R"(","yes":[[38,200],[39,150],[40,100]],)"
+      << R"("no":[[53,200],[54,150],[55,100]]}})";
+  return out.str();
+}
+
+// Adds and removes a level one tick inside the touch on alternating sides,
+// so every frame moves the mid and the book never drifts.
+std::string delta_frame(std::int64_t seq, std::size_t i) {
+  static constexpr struct {
+    const char *side;
+    int price;
+    int delta;
+  } kCycle[] = {{"yes", 41, 5}, {"no", 56, 5}, {"yes", 41, -5}, {"no", 56, -5}};
+  const auto &c = kCycle[i % 4];
+  char buf[192];
+  std::snprintf(buf, sizeof(buf),
+                R"({"type":"orderbook_delta","sid":1,"seq":%lld,"msg":{)"
+                R"("market_ticker":"%s","price":%d,"delta":%d,"side":"%s"}})",
+                static_cast<long long>(seq), kTicker.c_str(), c.price, c.delta,
+                c.side);
+  return buf;
+}
+
+struct RunStats {
+  double rate = 0;
+  std::size_t sent = 0;
+  std::size_t quoted = 0;
+  double send_seconds = 0;
+  double drain_seconds = 0;
+  std::size_t max_depth = 0;
+  std::size_t end_depth = 0;
+  std::int64_t p50 = 0, p90 = 0, p99 = 0, p999 = 0, max = 0;
+  bool saturated = false;
+};
+
+std::int64_t percentile(const std::vector<std::int64_t> &sorted, double p) {
+  if (sorted.empty())
+    return 0;
+  const auto i = static_cast<std::size_t>(p * (sorted.size() - 1));
+  return sorted[i];
+}
+
+class Bench {
+public:
+  explicit Bench(int port) : port(port) {}
+
+  bool start() {
+    server = std::make_unique<ix::WebSocketServer>(port, "127.0.0.1");
+    server->disablePerMessageDeflate();
+    server->setOnClientMessageCallback(
+        [this](std::shared_ptr<ix::ConnectionState>, ix::WebSocket &ws,
+               const ix::WebSocketMessagePtr &msg) {
+          if (msg->type == ix::WebSocketMessageType::Message)
+            on_command(ws, msg->str);
+        });
+    auto res = server->listen();
+    if (!res.first) {
+      std::cerr << "bench: listen failed: " << res.second << std::endl;
+      return false;
+    }
+    server->start();
+
+    std::vector<std::string> tickers{kTicker};
+    ASParams as_params{0.1, 1.5, 2.0, 60.0};
+    auto mm = std::make_shared<KalshiMM>(tickers, as_params);
+    probe = std::make_shared<LatencyProbe>(mm);
+    engine = std::make_shared<Engine>(probe);
+    client = std::make_unique<WsClient<KalshiWsAdapter>>(
+        "ws://127.0.0.1:" + std::to_string(port),
+        std::make_shared<KalshiWsAdapter>(), engine, nullptr);
+    client->add_markets("orderbook_delta", {kTicker});
+
+    engine->start();
+    client->start();
+
+    const auto deadline = Clock::now() + std::chrono::seconds(5);
+    while (!subscribed.load() && Clock::now() < deadline)
+      std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    if (!subscribed.load()) {
+      std::cerr << "bench: client never subscribed" << std::endl;
+      return false;
+    }
+    return true;
+  }
+
+  void stop() {
+    if (client)
+      client->stop();
+    if (engine)
+      engine->stop();
+    if (server)
+      server->stop();
+  }
+
+  RunStats run(double rate, double seconds) {
+    const auto n = static_cast<std::size_t>(rate * seconds) + 1;
+    Run r;
+    r.base_seq = next_seq;
+    r.frames.reserve(n);
+    r.frames.push_back(snapshot_frame(next_seq++));
+    for (std::size_t i = 1; i < n; ++i)
+      r.frames.push_back(delta_frame(next_seq++, i));
+    r.sent_ns = std::make_unique<std::atomic<std::int64_t>[]>(n);
+    for (std::size_t i = 0; i < n; ++i)
+      r.sent_ns[i].store(0, std::memory_order_relaxed);
+    r.latencies_ns.reserve(n);
+    probe->set_run(&r);
+
+    std::shared_ptr<ix::WebSocket> peer;
+    for (const auto &c : server->getClients())
+      peer = c;
+
+    RunStats st;
+    st.rate = rate;
+    const auto period = std::chrono::duration<double>(1.0 / rate);
+    const auto started = Clock::now();
+    auto next_sample = started;
+    for (std::size_t i = 0; i < n && peer; ++i) {
+      const auto due =
+          started + std::chrono::duration_cast<Clock::duration>(period * i);
+      auto now = Clock::now();
+      if (due - now > std::chrono::microseconds(200))
+        std::this_thread::sleep_for(due - now - std::chrono::microseconds(100));
+      while (Clock::now() < due) {
+      }
+
+      r.sent_ns[i].store(now_ns(), std::memory_order_release);
+      peer->send(r.frames[i]);
+      ++st.sent;
+
+      now = Clock::now();
+      if (now >= next_sample) {
+        st.max_depth = std::max(st.max_depth, engine->queue_depth());
+        next_sample = now + std::chrono::milliseconds(10);
+      }
+    }
+    const auto sent_all = Clock::now();
+    st.end_depth = engine->queue_depth();
+    st.max_depth = std::max(st.max_depth, st.end_depth);
+
+    const auto drain_deadline = sent_all + std::chrono::seconds(30);
+    while (r.handled.load(std::memory_order_acquire) < st.sent &&
+           Clock::now() < drain_deadline)
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    const auto drained = Clock::now();
+    probe->set_run(nullptr);
+
+    st.send_seconds = std::chrono::duration<double>(sent_all - started).count();
+    st.drain_seconds =
+        std::chrono::duration<double>(drained - sent_all).count();
+    st.quoted = r.latencies_ns.size();
+    std::sort(r.latencies_ns.begin(), r.latencies_ns.end());
+    st.p50 = percentile(r.latencies_ns, 0.50);
+    st.p90 = percentile(r.latencies_ns, 0.90);
+    st.p99 = percentile(r.latencies_ns, 0.99);
+    st.p999 = percentile(r.latencies_ns, 0.999);
+    st.max = r.latencies_ns.empty() ? 0 : r.latencies_ns.back();
+    // Keeping up means the backlog left when sending stops is a small
+    // fraction of what was sent and the sender held its schedule.
+    st.saturated = st.end_depth > std::max<std::size_t>(100, st.sent / 100) ||
+                   st.send_seconds > seconds * 1.1;
+    return st;
+  }
+
+private:
+  void on_command(ix::WebSocket &ws, const std::string &raw) {
+    auto j = nlohmann::json::parse(raw, nullptr, false);
+    if (j.is_discarded() || !j.contains("cmd"))
+      return;
+    const std::int64_t id = j.value("id", std::int64_t{0});
+    if (j["cmd"] == "subscribe") {
+      ws.send(nlohmann::json{{"id", id},
+                             {"type", "subscribed"},
+                             {"msg", {{"channel", "orderbook_delta"},
+                                      {"sid", 1}}}}
+                  .dump());
+      subscribed = true;
+    } else {
+      ws.send(nlohmann::json{{"id", id}, {"type", "ok"}}.dump());
+    }
+  }
+
+  int port;
+  std::int64_t next_seq = 1;
+  std::atomic<bool> subscribed{false};
+
+  std::unique_ptr<ix::WebSocketServer> server;
+  std::shared_ptr<LatencyProbe> probe;
+  std::shared_ptr<Engine> engine;
+  std::unique_ptr<WsClient<KalshiWsAdapter>> client;
+};
+
+void print_header() {
+  std::printf("%10s %9s %9s %9s %9s %9s %9s %9s %9s %9s %s\n", "rate/s",
+              "sent", "quoted", "p50_us", "p90_us", "p99_us", "p99.9_us",
+              "max_us", "max_q", "drain_ms", "");
+}
+
+void print_row(const RunStats &st) {
+  std::printf(
+      "%10.0f %9zu %9zu %9.1f %9.1f %9.1f %9.1f %9.1f %9zu %9.1f %s\n",
+      st.rate, st.sent, st.quoted, st.p50 / 1e3, st.p90 / 1e3, st.p99 / 1e3,
+      st.p999 / 1e3, st.max / 1e3, st.max_depth, st.drain_seconds * 1e3,
+      st.saturated ? "SATURATED" : "");
+  std::fflush(stdout);
+}
+
+std::vector<double> parse_rates(const std::string &s) {
+  std::vector<double> out;
+  std::stringstream in(s);
+  std::string item;
+  while (std::getline(in, item, ','))
+    out.push_back(std::stod(item));
+  return out;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  int port = 18765;
+  double seconds = 3.0;
+  std::vector<double> rates{1000, 10000, 100000};
+  bool search = true;
+  for (int i = 1; i < argc; ++i) {
+    const std::string arg = argv[i];
+    if (arg == "--port" && i + 1 < argc) {
+      port = std::stoi(argv[++i]);
+    } else if (arg == "--seconds" && i + 1 < argc) {
+      seconds = std::stod(argv[++i]);
+    } else if (arg == "--rates" && i + 1 < argc) {
+      rates = parse_rates(argv[++i]);
+    } else if (arg == "--no-search") {
+      search = false;
+    } else {
+      std::cerr << "usage: ./kalshi_latency_bench [--port N] [--seconds S] "
+                   "[--rates 1000,10000,100000] [--no-search]"
+                << std::endl;
+      return 1;
+    }
+  }
+
+  Bench bench(port);
+  if (!bench.start()) {
+    bench.stop();
+    return 1;
+  }
+
+  print_header();
+  for (double rate : rates)
+    print_row(bench.run(rate, seconds));
+
+  if (search) {
+    // Double the rate until the engine queue stops draining. Shorter runs
+    // keep the pre-built frames of the fastest steps in memory.
+    double ok = 0;
+    for (double rate = 1000; rate <= 1'024'000; rate *= 2) {
+      const RunStats st = bench.run(rate, std::min(seconds, 1.0));
+      print_row(st);
+      if (st.saturated) {
+        std::printf("saturation: engine queue grows between %.0f and %.0f "
+                    "msgs/sec\n",
+                    ok, rate);
+        break;
+      }
+      ok = rate;
+    }
+  }
+
+  bench.stop();
+  return 0;
+}
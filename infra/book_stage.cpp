@@ -0,0 +1,52 @@
+#include "book_stage.hpp"
+#include "metrics.hpp"
+#include "strategy/orders/order_manager.hpp"
+
+namespace {
+
+void count_apply_result(KalshiOrderBook::ApplyResult res) {
+  switch (res) {
+  case KalshiOrderBook::ApplyResult::Applied:
+    metric_inc(Counter::BookApplied);
+    break;
+  case KalshiOrderBook::ApplyResult::IgnoredOld:
+    metric_inc(Counter::BookIgnoredOld);
+    break;
+  case KalshiOrderBook::ApplyResult::GapNeedsResync:
+    metric_inc(Counter::BookGapNeedsResync);
+    break;
+  case KalshiOrderBook::ApplyResult::NoSnapshotYet:
+    metric_inc(Counter::BookNoSnapshotYet);
+    break;
+  }
+}
+
+} // namespace
+
+BookStage::BookStage(const std::vector<std::string> &tickers)
+    : manager(tickers) {}
+
+const KalshiOrderBook *BookStage::apply(const FeedEvent &ev) {
+  if (const auto *snap = std::get_if<SnapshotEvent>(&ev.payload)) {
+    count_apply_result(manager.set_ticker_snapshot(ev.ticker, ev.cid, *snap));
+  } else if (const auto *delta = std::get_if<DeltaEvent>(&ev.payload)) {
+    auto res = manager.update_ticker_delta(ev.ticker, ev.cid, *delta);
+    count_apply_result(res);
+    if (res == KalshiOrderBook::ApplyResult::GapNeedsResync) {
+      // handle reconnect
+    }
+  } else if (const auto *trade = std::get_if<TradeEvent>(&ev.payload)) {
+    manager.apply_trade(ev.ticker, *trade);
+  } else if (const auto *t = std::get_if<TickerEvent>(&ev.payload)) {
+    manager.apply_ticker(ev.ticker, *t);
+  } else if (const auto *f = std::get_if<FillEvent>(&ev.payload)) {
+    KalshiOrderBook *book = manager.get_book(ev.ticker);
+    const auto id = f->client_order_id
+                        ? parse_client_order_id(*f->client_order_id)
+                        : std::nullopt;
+    if (book && id)
+      book->on_order_fill(*id, f->count);
+    return book;
+  }
+  return manager.get_book(ev.ticker);
+}
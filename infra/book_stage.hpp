@@ -0,0 +1,27 @@
+#pragma once
+
+#include "protocols/feed_adapter.hpp"
+#include "protocols/kalshi/kalshi_order_book_manager.hpp"
+#include <string>
+#include <vector>
+
+// Keeps one copy of every market's book for all strategies behind an
+// engine. Runs on the engine thread, before the event is dispatched.
+class BookStage {
+public:
+  BookStage() = default;
+  explicit BookStage(const std::vector<std::string> &tickers);
+
+  // Applies a snapshot, delta, trade print or ticker update, or one of our
+  // fills to its order's queue position, and returns the event's book, or
+  // nullptr if the market has none (e.g. a fill for a market never seen on
+  // the feed).
+  const KalshiOrderBook *apply(const FeedEvent &ev);
+
+  KalshiOrderBookManager &books() { return manager; }
+  OrderQueue order_queue() { return OrderQueue(manager); }
+  const KalshiOrderBookManager &books() const { return manager; }
+
+private:
+  KalshiOrderBookManager manager;
+};
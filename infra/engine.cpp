@@ -1,15 +1,271 @@
-#import "engine.hpp"
-#include <iostream>
+#include "engine.hpp"
+#include "metrics.hpp"
+#include "runtime_tuning.hpp"
+#include "utils/alloc_audit.hpp"
+#include <algorithm>
+#include <chrono>
 
-Engine::Engine(std::shared_ptr<Strategy> strat)
-    : strategy(std::move(strat)), running(false) {}
+namespace {
+
+// How often strategies get on_idle() while no events arrive.
+constexpr std::chrono::milliseconds kIdleInterval{100};
+
+// Rough heap footprint of a queued event, for the byte cap.
+std::size_t footprint(const FeedEvent &ev) {
+  std::size_t n = sizeof(FeedEvent) + ev.ticker.capacity();
+  if (const auto *snap = std::get_if<SnapshotEvent>(&ev.payload)) {
+    n += (snap->yes_levels.capacity() + snap->no_levels.capacity()) *
+         sizeof(std::pair<int, int>);
+  } else if (const auto *fill = std::get_if<FillEvent>(&ev.payload)) {
+    n += fill->trade_id.capacity() + fill->order_id.capacity() +
+         fill->market_ticker.capacity();
+  }
+  return n;
+}
+
+bool is_delta(const FeedEvent &ev) {
+  return ev.type == FeedEvent::Type::OrderbookDelta;
+}
+
+// Trade prints and ticker summaries only feed statistics; they are the
+// cheapest thing to lose once no delta is left to drop.
+bool is_droppable_stat(const FeedEvent &ev) {
+  return ev.type == FeedEvent::Type::Trade ||
+         ev.type == FeedEvent::Type::Ticker;
+}
+
+OverflowPolicy parse_policy(const std::string &s) {
+  if (s == "block")
+    return OverflowPolicy::Block;
+  if (s == "conflate")
+    return OverflowPolicy::Conflate;
+  return OverflowPolicy::DropOldest;
+}
+
+} // namespace
+
+EngineLane engine_lane(const FeedEvent &ev) {
+  switch (ev.type) {
+  case FeedEvent::Type::Fill:
+    return EngineLane::Fills;
+  case FeedEvent::Type::OrderbookSnapshot:
+    return EngineLane::Snapshots;
+  default:
+    return EngineLane::MarketData;
+  }
+}
+
+EngineQueueConfig engine_queue_config_from_json(const nlohmann::json &j) {
+  EngineQueueConfig cfg;
+  cfg.capacity = j.value("capacity", cfg.capacity);
+  cfg.max_bytes = j.value("max_mb", cfg.max_bytes >> 20) << 20;
+  cfg.policy = parse_policy(j.value("policy", std::string("drop_oldest")));
+  return cfg;
+}
+
+Engine::Engine() : running(false) {}
+
+Engine::Engine(EngineQueueConfig cfg) : queue_cfg(cfg), running(false) {}
+
+Engine::Engine(std::shared_ptr<Strategy> strat) : running(false) {
+  add_strategy(std::move(strat));
+}
+
+void Engine::add_strategy(std::shared_ptr<Strategy> strat,
+                          const std::vector<std::string> &tickers) {
+  Strategy *s = strat.get();
+  strategies.push_back(std::move(strat));
+  if (tickers.empty()) {
+    every_market.push_back(s);
+  }
+  for (const auto &t : tickers) {
+    book_stage.books().add_ticker(t);
+    by_market[t].push_back(s);
+  }
+  s->attach_books(book_stage.books());
+  s->attach_order_queue(book_stage.order_queue());
+}
+
+void Engine::dispatch(const FeedEvent &ev) {
+  if (ev.type == FeedEvent::Type::OrderbookSnapshot) {
+    // Rebuilding a book allocates its levels; only steady state is audited.
+    run_strategies(ev);
+    return;
+  }
+  KALSHI_NO_ALLOC_ZONE("Engine::dispatch");
+  run_strategies(ev);
+}
+
+void Engine::run_strategies(const FeedEvent &ev) {
+  const KalshiOrderBook *book = book_stage.apply(ev);
+  for (Strategy *s : every_market) {
+    s->handle_feed_event(ev, book);
+  }
+  auto it = by_market.find(ev.ticker);
+  if (it != by_market.end()) {
+    for (Strategy *s : it->second) {
+      s->handle_feed_event(ev, book);
+    }
+  }
+}
+
+bool Engine::full(std::size_t incoming_bytes) const {
+  return (queue_cfg.capacity && queued_events >= queue_cfg.capacity) ||
+         (queue_cfg.max_bytes &&
+          queued_bytes + incoming_bytes > queue_cfg.max_bytes);
+}
+
+bool Engine::conflate(FeedEvent &ev) {
+  auto &events = market_data();
+  auto last = std::find_if(events.rbegin(), events.rend(),
+                           [&](const FeedEvent &q) {
+                             return q.ticker == ev.ticker;
+                           });
+  if (last == events.rend())
+    return false;
+
+  auto *in = std::get_if<DeltaEvent>(&ev.payload);
+  auto *queued = std::get_if<DeltaEvent>(&last->payload);
+  if (in && queued) {
+    const std::int64_t first = in->first_seq ? in->first_seq : in->seq;
+    if (queued->side != in->side || queued->price_cents != in->price_cents ||
+        queued->seq + 1 != first)
+      return false;
+    if (!queued->first_seq)
+      queued->first_seq = queued->seq;
+    queued->seq = in->seq;
+    queued->delta_contracts += in->delta_contracts;
+    return true;
+  }
+  if (ev.type == FeedEvent::Type::Ticker &&
+      last->type == FeedEvent::Type::Ticker) {
+    last->payload = ev.payload;
+    return true;
+  }
+  return false;
+}
+
+bool Engine::drop_oldest(std::string &resync_ticker) {
+  auto &events = market_data();
+  auto oldest = std::find_if(events.begin(), events.end(), is_delta);
+  if (oldest == events.end()) {
+    oldest = std::find_if(events.begin(), events.end(), is_droppable_stat);
+    if (oldest == events.end())
+      return false; // only snapshots and fills, which are never dropped
+    queued_bytes -= footprint(*oldest);
+    events.erase(oldest);
+    --queued_events;
+    ++stats.dropped;
+    metric_inc(Counter::EngineDrops);
+    return true;
+  }
+
+  // The rest of the market's deltas would only hit the gap; drop them too
+  // and wait for a snapshot.
+  resync_ticker = oldest->ticker;
+  std::size_t n = 0;
+  auto keep = std::remove_if(oldest, events.end(), [&](const FeedEvent &q) {
+    if (!is_delta(q) || q.ticker != resync_ticker)
+      return false;
+    queued_bytes -= footprint(q);
+    ++n;
+    return true;
+  });
+  events.erase(keep, events.end());
+  queued_events -= n;
+  stale.insert(resync_ticker);
+  stats.dropped += n;
+  ++stats.resyncs;
+  metric_inc(Counter::EngineDrops, n);
+  metric_inc(Counter::EngineResyncs);
+  return true;
+}
+
+void Engine::supersede_deltas(const std::string &ticker) {
+  auto &events = market_data();
+  std::size_t n = 0;
+  auto keep =
+      std::remove_if(events.begin(), events.end(), [&](const FeedEvent &q) {
+        if (!is_delta(q) || q.ticker != ticker)
+          return false;
+        queued_bytes -= footprint(q);
+        ++n;
+        return true;
+      });
+  events.erase(keep, events.end());
+  queued_events -= n;
+  stats.superseded += n;
+}
 
 void Engine::push(FeedEvent ev) {
+  std::vector<std::string> resyncs;
+  bool queued = false;
   {
     std::unique_lock<std::mutex> lock(m);
-    events.push(ev);
+    const EngineLane lane = engine_lane(ev);
+    if (lane == EngineLane::Snapshots) {
+      stale.erase(ev.ticker); // resynced
+      // The snapshot is dispatched ahead of the market data lane, so the
+      // market's older deltas would land on the new book out of order.
+      // It already contains them.
+      supersede_deltas(ev.ticker);
+    }
+
+    const std::size_t bytes = footprint(ev);
+    bool merged = false;
+    if (lane == EngineLane::MarketData && full(bytes)) {
+      switch (queue_cfg.policy) {
+      case OverflowPolicy::Block:
+        ++stats.blocked;
+        // Before start() nothing drains the queue, so it just grows.
+        space_cv.wait(lock, [&] { return !full(bytes) || !running; });
+        break;
+      case OverflowPolicy::Conflate:
+        if (conflate(ev)) {
+          merged = true;
+          ++stats.conflated;
+          metric_inc(Counter::EngineConflated);
+          break;
+        }
+        [[fallthrough]];
+      case OverflowPolicy::DropOldest: {
+        std::string ticker;
+        while (full(bytes) && drop_oldest(ticker)) {
+          if (!ticker.empty())
+            resyncs.push_back(std::move(ticker));
+          ticker.clear();
+        }
+        break;
+      }
+      }
+    }
+
+    if (merged) {
+      // Folded into an event already queued.
+    } else if (is_delta(ev) && stale.count(ev.ticker)) {
+      ++stats.dropped;
+      metric_inc(Counter::EngineDrops);
+    } else {
+      queued_bytes += bytes;
+      lanes[static_cast<std::size_t>(lane)].push_back(std::move(ev));
+      ++queued_events;
+      queued = true;
+      if (queued_events > stats.high_water) {
+        stats.high_water = queued_events;
+        metric_set(Gauge::EngineQueueHighWater,
+                   static_cast<std::int64_t>(stats.high_water));
+      }
+    }
+  }
+  if (queued)
+    cv.notify_one();
+  if (resync_handler) {
+    // Counted in EngineResyncs; this runs on the receive thread, so it
+    // does not log.
+    for (const auto &t : resyncs) {
+      resync_handler(t);
+    }
   }
-  cv.notify_one();
 }
 
 void Engine::start() {
@@ -18,25 +274,66 @@ void Engine::start() {
 }
 
 void Engine::stop() {
-  running = false;
+  {
+    std::lock_guard<std::mutex> lock(m);
+    running = false;
+  }
   cv.notify_all();
+  space_cv.notify_all();
   if (processing_thread.joinable()) {
     processing_thread.join();
   }
 }
 
+std::size_t Engine::queue_depth() {
+  std::lock_guard<std::mutex> lock(m);
+  return queued_events;
+}
+
+EngineQueueStats Engine::queue_stats() {
+  std::lock_guard<std::mutex> lock(m);
+  EngineQueueStats s = stats;
+  s.depth = queued_events;
+  s.bytes = queued_bytes;
+  for (std::size_t i = 0; i < kEngineLanes; ++i) {
+    s.lane_depth[i] = lanes[i].size();
+  }
+  return s;
+}
+
 void Engine::process_feed() {
+  RuntimeTuning::instance().tune_current_thread("engine");
   while (running) {
     FeedEvent ev;
     {
       std::unique_lock<std::mutex> lock(m);
-      cv.wait(lock, [&] { return !events.empty() || !running; });
-      if (!running && events.empty()) {
-        break;
+      if (queued_events == 0 && running) {
+        lock.unlock();
+        for (const auto &s : strategies) {
+          s->on_idle();
+        }
+        lock.lock();
+        cv.wait_for(lock, kIdleInterval,
+                    [&] { return queued_events > 0 || !running; });
+      }
+      if (queued_events == 0) {
+        if (!running)
+          break;
+        continue; // idle again
       }
-      ev = std::move(events.front());
-      events.pop();
+      // Highest non-empty lane; re-checked after every event so a fill
+      // waits for at most the one already being dispatched.
+      auto &lane = *std::find_if(lanes.begin(), lanes.end(),
+                                 [](const auto &l) { return !l.empty(); });
+      queued_bytes -= footprint(lane.front());
+      ev = std::move(lane.front());
+      lane.pop_front();
+      --queued_events;
+      metric_set(Gauge::EngineQueueDepth,
+                 static_cast<std::int64_t>(queued_events));
     }
-    strategy->handle_feed_event(ev);
+    space_cv.notify_one();
+    dispatch(ev);
+    metric_inc(Counter::EngineEvents);
   }
 }
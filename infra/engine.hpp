@@ -1,26 +1,142 @@
 #pragma once
 
+#include "book_stage.hpp"
 #include "protocols/feed_adapter.hpp"
 #include "strategy/strategy.hpp"
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
 #include <memory>
 #include <mutex>
-#include <queue>
+#include <nlohmann/json.hpp>
+#include <string>
 #include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+// The queue is split into lanes that the engine drains highest first, so a
+// fill never waits behind a burst of deltas. Each lane keeps push order.
+enum class EngineLane : std::size_t {
+  Fills,      // our executions; inventory must not lag the book
+  Snapshots,  // book rebuilds; each supersedes its market's queued deltas
+  MarketData, // deltas, trade prints and ticker summaries
+};
+constexpr std::size_t kEngineLanes = 3;
+
+EngineLane engine_lane(const FeedEvent &ev);
+
+// What push() does with market data when the queue is at capacity. Fills
+// and snapshots are always queued; they count toward the cap but never
+// wait or get dropped.
+enum class OverflowPolicy {
+  // Wait for the engine to make room. Nothing is lost; the feed backs up
+  // into the socket instead.
+  Block,
+  // Drop every queued delta of the market with the oldest one, ignore its
+  // deltas until a new snapshot arrives, and ask for that snapshot through
+  // the resync handler. Other markets are untouched.
+  DropOldest,
+  // Fold the event into the market's latest queued event where that loses
+  // nothing (consecutive deltas at one level, a newer ticker summary);
+  // otherwise as DropOldest.
+  Conflate
+};
+
+struct EngineQueueConfig {
+  std::size_t capacity = 1 << 16; // events; 0 is unbounded
+  std::size_t max_bytes = 256u << 20; // approximate footprint; 0 is no cap
+  OverflowPolicy policy = OverflowPolicy::DropOldest;
+};
+
+// Reads the "engine_queue" section of runner.json.
+EngineQueueConfig engine_queue_config_from_json(const nlohmann::json &j);
+
+struct EngineQueueStats {
+  std::size_t depth = 0;
+  std::size_t high_water = 0;
+  std::size_t bytes = 0;
+  std::uint64_t dropped = 0;   // events discarded by DropOldest/Conflate
+  std::uint64_t conflated = 0; // events folded into a queued one
+  std::uint64_t resyncs = 0;   // markets sent for a fresh snapshot
+  std::uint64_t blocked = 0;   // pushes that had to wait
+  std::uint64_t superseded = 0; // deltas made moot by a newer snapshot
+  std::array<std::size_t, kEngineLanes> lane_depth{};
+};
 
 class Engine {
-  std::shared_ptr<Strategy> strategy;
+public:
+  // Called on the pushing thread, outside the queue lock, with a market
+  // whose deltas were dropped; it should request a new snapshot.
+  using ResyncHandler = std::function<void(const std::string &ticker)>;
+
+private:
+  BookStage book_stage;
+  std::vector<std::shared_ptr<Strategy>> strategies;
+  std::vector<Strategy *> every_market;
+  std::unordered_map<std::string, std::vector<Strategy *>> by_market;
+
+  EngineQueueConfig queue_cfg;
+  ResyncHandler resync_handler;
+
   std::mutex m;
   std::condition_variable cv;
-  std::queue<FeedEvent> events;
+  std::condition_variable space_cv;
+  std::array<std::deque<FeedEvent>, kEngineLanes> lanes;
+  std::size_t queued_events = 0; // across all lanes
+  std::size_t queued_bytes = 0;
+  // Markets whose deltas are dropped until their next snapshot.
+  std::unordered_set<std::string> stale;
+  EngineQueueStats stats;
   std::atomic<bool> running;
   std::thread processing_thread;
 
 public:
+  Engine();
+  explicit Engine(EngineQueueConfig cfg);
+  // Same as add_strategy(strat).
   explicit Engine(std::shared_ptr<Strategy> strat);
+
+  // Register before start(). A strategy sees only events for `tickers`, or
+  // every event if `tickers` is empty. Every-market strategies are called
+  // first, then the rest in registration order.
+  void add_strategy(std::shared_ptr<Strategy> strat,
+                    const std::vector<std::string> &tickers = {});
+
+  // Set before start().
+  void set_resync_handler(ResyncHandler h) { resync_handler = std::move(h); }
+
+  // The shared books. Mutate only before start() (checkpoint restore, REST
+  // seeding); afterwards they belong to the engine thread.
+  KalshiOrderBookManager &books() { return book_stage.books(); }
+
   void push(FeedEvent ev);
   void start();
   void stop();
 
+  // Events pushed but not yet handed to the strategies.
+  std::size_t queue_depth();
+  EngineQueueStats queue_stats();
+
+  // Runs one event through the book stage and the strategies on the
+  // calling thread. process_feed() uses it; so can a caller with no thread.
+  // Everything but snapshots runs in a no-allocation zone in the
+  // KALSHI_ALLOC_AUDIT build.
+  void dispatch(const FeedEvent &ev);
+
 private:
   void process_feed();
+  void run_strategies(const FeedEvent &ev);
+
+  std::deque<FeedEvent> &market_data() {
+    return lanes[static_cast<std::size_t>(EngineLane::MarketData)];
+  }
+  bool full(std::size_t incoming_bytes) const;
+  bool conflate(FeedEvent &ev);
+  bool drop_oldest(std::string &resync_ticker);
+  void supersede_deltas(const std::string &ticker);
 };
@@ -0,0 +1,274 @@
+#include "feed_latency_monitor.hpp"
+
+#include "metrics.hpp"
+#include <algorithm>
+#include <bit>
+#include <optional>
+
+namespace {
+
+// Coarsest unit `ts_ns` is a whole multiple of: a stamp in whole seconds is
+// up to a second older than the event it marks.
+std::int64_t stamp_resolution_ns(std::int64_t ts_ns) {
+  for (std::int64_t unit : {1'000'000'000LL, 1'000'000LL, 1'000LL}) {
+    if (ts_ns % unit == 0)
+      return unit;
+  }
+  return 1;
+}
+
+} // namespace
+
+FeedLatencyConfig feed_latency_config_from_json(const nlohmann::json &j) {
+  FeedLatencyConfig cfg;
+  cfg.window = std::chrono::milliseconds(
+      j.value("window_ms", std::int64_t(cfg.window.count())));
+  cfg.windows = j.value("windows", cfg.windows);
+  cfg.floor_windows = j.value("floor_windows", cfg.floor_windows);
+  cfg.lag_threshold = std::chrono::milliseconds(
+      j.value("lag_threshold_ms", std::int64_t(cfg.lag_threshold.count())));
+  cfg.min_samples = j.value("min_samples", cfg.min_samples);
+  return cfg;
+}
+
+RollingLatency::RollingLatency(std::int64_t slot_ns_, std::size_t n)
+    : slot_ns(std::max<std::int64_t>(slot_ns_, 1)),
+      slots(std::max<std::size_t>(n, 1)) {}
+
+std::size_t RollingLatency::bucket(std::int64_t delay_ns) {
+  const std::uint64_t us =
+      static_cast<std::uint64_t>(std::max<std::int64_t>(delay_ns, 0)) / 1000;
+  if (us < 4)
+    return us;
+  // us is in [2^e, 2^(e+1)); its top three bits pick one of four buckets.
+  const auto e = static_cast<std::size_t>(std::bit_width(us)) - 1;
+  const std::size_t b = 4 * e - 8 + (us >> (e - 2));
+  return std::min(b, kBuckets - 1);
+}
+
+std::int64_t RollingLatency::bucket_ceiling_ns(std::size_t b) {
+  if (b < 4)
+    return static_cast<std::int64_t>(b + 1) * 1000 - 1;
+  const std::size_t e = (b + 4) / 4;
+  const std::uint64_t mantissa = (b + 4) % 4 + 4;
+  const std::uint64_t next_us = (mantissa + 1) << (e - 2);
+  return static_cast<std::int64_t>(next_us) * 1000 - 1;
+}
+
+void RollingLatency::record(std::int64_t now_ns, std::int64_t delay_ns) {
+  Slot *s = &slots[head];
+  if (s->total == 0 || now_ns >= s->start_ns + slot_ns) {
+    if (s->total != 0) {
+      head = (head + 1) % slots.size();
+      s = &slots[head];
+    }
+    *s = Slot{};
+    s->start_ns = now_ns - now_ns % slot_ns;
+  }
+  ++s->counts[bucket(delay_ns)];
+  ++s->total;
+  s->max_ns = std::max(s->max_ns, delay_ns);
+}
+
+LatencyStats RollingLatency::stats(std::int64_t now_ns) const {
+  const std::int64_t horizon =
+      now_ns - static_cast<std::int64_t>(slots.size()) * slot_ns;
+  std::array<std::uint64_t, kBuckets> counts{};
+  LatencyStats out;
+  for (const Slot &s : slots) {
+    if (s.total == 0 || s.start_ns + slot_ns <= horizon)
+      continue;
+    for (std::size_t b = 0; b < kBuckets; ++b) {
+      counts[b] += s.counts[b];
+    }
+    out.samples += s.total;
+    out.max_ns = std::max(out.max_ns, s.max_ns);
+  }
+  if (out.samples == 0)
+    return out;
+
+  auto percentile = [&](double p) {
+    const auto rank = static_cast<std::uint64_t>(
+        std::max(1.0, p * static_cast<double>(out.samples) + 0.5));
+    std::uint64_t seen = 0;
+    for (std::size_t b = 0; b < kBuckets; ++b) {
+      seen += counts[b];
+      if (seen >= rank)
+        return std::min(bucket_ceiling_ns(b), out.max_ns);
+    }
+    return out.max_ns;
+  };
+  out.p50_ns = percentile(0.50);
+  out.p90_ns = percentile(0.90);
+  out.p99_ns = percentile(0.99);
+  return out;
+}
+
+void RollingLatency::clear() {
+  for (Slot &s : slots) {
+    s = Slot{};
+  }
+  head = 0;
+}
+
+FeedLatencyMonitor::FeedLatencyMonitor(FeedLatencyConfig c)
+    : cfg(c), window_ns(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                            c.window)
+                            .count()) {
+  for (int i = 0; i < kMaxConnections; ++i) {
+    connections.emplace_back(window_ns, cfg.windows);
+  }
+}
+
+std::int64_t FeedLatencyMonitor::floor_locked(std::int64_t now_ns) const {
+  if (!have_floor)
+    return window_min_ns;
+  const auto fit = static_cast<std::int64_t>(
+      floor_a + floor_b * static_cast<double>(now_ns - floor_t0));
+  // A path faster than the fit has seen lowers the floor at once.
+  return window_has_sample ? std::min(fit, window_min_ns) : fit;
+}
+
+void FeedLatencyMonitor::close_floor_window() {
+  if (!window_has_sample)
+    return;
+  minima.emplace_back(window_start_ns + window_ns / 2, window_min_ns);
+  while (minima.size() > std::max<std::size_t>(cfg.floor_windows, 1)) {
+    minima.pop_front();
+  }
+  window_has_sample = false;
+
+  // Least squares through the minima, x in ns from the oldest, then again
+  // through those on or below the first line. The second pass follows the
+  // lower envelope, so a connection that starts lagging does not pull the
+  // floor up with it.
+  floor_t0 = minima.front().first;
+  auto fit = [&](bool below_only) {
+    double n = 0, sx = 0, sy = 0, sxx = 0, sxy = 0;
+    for (const auto &[t, min] : minima) {
+      const double x = static_cast<double>(t - floor_t0);
+      const double y = static_cast<double>(min);
+      if (below_only && y > floor_a + floor_b * x)
+        continue;
+      n += 1;
+      sx += x;
+      sy += y;
+      sxx += x * x;
+      sxy += x * y;
+    }
+    if (n < 2 && below_only)
+      return;
+    const double denom = n * sxx - sx * sx;
+    floor_b = denom > 0 ? (n * sxy - sx * sy) / denom : 0.0;
+    floor_a = (sy - floor_b * sx) / n;
+  };
+  fit(false);
+  fit(true);
+  have_floor = true;
+}
+
+void FeedLatencyMonitor::record(int connection, const std::string &ticker,
+                                std::int64_t exchange_ts_ns,
+                                std::int64_t recv_ts_ns) {
+  const std::int64_t raw = recv_ts_ns - exchange_ts_ns;
+  std::optional<LatencyStats> lagging;
+  {
+    std::lock_guard<std::mutex> lock(m);
+    if (recv_ts_ns - window_start_ns >= window_ns) {
+      close_floor_window();
+      window_start_ns = recv_ts_ns;
+    }
+    if (!window_has_sample || raw < window_min_ns) {
+      window_min_ns = raw;
+      window_has_sample = true;
+    }
+    // Rounding puts a uniform [0, resolution) on top of the real delay;
+    // taking half of it off keeps the median on the real delay.
+    const std::int64_t excess = std::max<std::int64_t>(
+        raw - floor_locked(recv_ts_ns) -
+            stamp_resolution_ns(exchange_ts_ns) / 2,
+        0);
+
+    auto it = markets.find(ticker);
+    if (it == markets.end()) {
+      it = markets.try_emplace(ticker, window_ns, cfg.windows).first;
+    }
+    it->second.record(recv_ts_ns, excess);
+
+    if (connection < 0 || connection >= kMaxConnections)
+      return;
+    RollingLatency &conn = connections[connection];
+    conn.record(recv_ts_ns, excess);
+    if (recv_ts_ns < next_check_ns[connection])
+      return;
+    next_check_ns[connection] = recv_ts_ns + window_ns;
+
+    const LatencyStats st = conn.stats(recv_ts_ns);
+    metric_set(Gauge::FeedLatencyP50Us, st.p50_ns / 1000);
+    metric_set(Gauge::FeedLatencyP99Us, st.p99_ns / 1000);
+    metric_set(Gauge::FeedClockFloorUs, floor_locked(recv_ts_ns) / 1000);
+    const std::int64_t threshold =
+        std::chrono::duration_cast<std::chrono::nanoseconds>(
+            cfg.lag_threshold)
+            .count();
+    if (st.samples >= cfg.min_samples && st.p50_ns > threshold) {
+      ++alerts;
+      metric_inc(Counter::FeedLagAlerts);
+      conn.clear();
+      lagging = st;
+    }
+  }
+  if (lagging && lag_handler)
+    lag_handler(connection, *lagging);
+}
+
+LatencyStats FeedLatencyMonitor::market(const std::string &ticker,
+                                        std::int64_t now_ns) const {
+  std::lock_guard<std::mutex> lock(m);
+  auto it = markets.find(ticker);
+  return it == markets.end() ? LatencyStats{} : it->second.stats(now_ns);
+}
+
+LatencyStats FeedLatencyMonitor::connection(int c,
+                                            std::int64_t now_ns) const {
+  if (c < 0 || c >= kMaxConnections)
+    return {};
+  std::lock_guard<std::mutex> lock(m);
+  return connections[c].stats(now_ns);
+}
+
+std::vector<std::pair<std::string, LatencyStats>>
+FeedLatencyMonitor::worst_markets(std::size_t n, std::int64_t now_ns) const {
+  std::vector<std::pair<std::string, LatencyStats>> out;
+  {
+    std::lock_guard<std::mutex> lock(m);
+    out.reserve(markets.size());
+    for (const auto &[ticker, hist] : markets) {
+      LatencyStats st = hist.stats(now_ns);
+      if (st.samples)
+        out.emplace_back(ticker, st);
+    }
+  }
+  n = std::min(n, out.size());
+  std::partial_sort(out.begin(), out.begin() + n, out.end(),
+                    [](const auto &a, const auto &b) {
+                      return a.second.p99_ns > b.second.p99_ns;
+                    });
+  out.resize(n);
+  return out;
+}
+
+std::int64_t FeedLatencyMonitor::floor_ns(std::int64_t now_ns) const {
+  std::lock_guard<std::mutex> lock(m);
+  return floor_locked(now_ns);
+}
+
+double FeedLatencyMonitor::drift_ns_per_sec() const {
+  std::lock_guard<std::mutex> lock(m);
+  return floor_b * 1e9;
+}
+
+std::uint64_t FeedLatencyMonitor::lag_alerts() const {
+  std::lock_guard<std::mutex> lock(m);
+  return alerts;
+}
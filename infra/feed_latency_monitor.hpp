@@ -0,0 +1,139 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <nlohmann/json.hpp>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+struct FeedLatencyConfig {
+  // The rolling distributions cover `windows` slots of `window` each.
+  std::chrono::milliseconds window{10000};
+  std::size_t windows = 6;
+  // Per-window minimum delays kept to fit the clock floor.
+  std::size_t floor_windows = 30;
+  // A connection whose median delay over the floor exceeds this, across at
+  // least `min_samples` messages, is flagged as lagging.
+  std::chrono::milliseconds lag_threshold{250};
+  std::size_t min_samples = 50;
+};
+
+// Reads the "feed_latency" section of runner.json.
+FeedLatencyConfig feed_latency_config_from_json(const nlohmann::json &j);
+
+// Delay percentiles over the rolling window, in ns over the floor.
+struct LatencyStats {
+  std::uint64_t samples = 0;
+  std::int64_t p50_ns = 0;
+  std::int64_t p90_ns = 0;
+  std::int64_t p99_ns = 0;
+  std::int64_t max_ns = 0;
+};
+
+// Bucketed delays over a ring of time slots. Buckets are log-linear, four
+// per power of two of microseconds, so a percentile is within 25% of the
+// true value.
+class RollingLatency {
+public:
+  static constexpr std::size_t kBuckets = 128;
+
+  RollingLatency(std::int64_t slot_ns, std::size_t slots);
+
+  void record(std::int64_t now_ns, std::int64_t delay_ns);
+  // Slots that started more than slots * slot_ns before `now_ns` are
+  // ignored.
+  LatencyStats stats(std::int64_t now_ns) const;
+  void clear();
+
+  static std::size_t bucket(std::int64_t delay_ns);
+  // Largest delay that falls in bucket `b`.
+  static std::int64_t bucket_ceiling_ns(std::size_t b);
+
+private:
+  struct Slot {
+    std::int64_t start_ns = 0;
+    std::int64_t max_ns = 0;
+    std::uint32_t total = 0;
+    std::array<std::uint32_t, kBuckets> counts{};
+  };
+
+  std::int64_t slot_ns;
+  std::vector<Slot> slots;
+  std::size_t head = 0;
+};
+
+// One-way feed latency: the exchange's timestamp on a message against our
+// wall-clock receive time, per market and per connection. Clocks are not
+// assumed to agree, so every delay is measured against a floor: the
+// smallest delay seen, which is the clock offset plus the fastest path.
+// The floor is a least-squares line along the lower envelope of recent
+// per-window minima, which follows a drifting local clock. Kalshi's `ts`
+// is mostly whole seconds, which adds up to a second to a delay; the
+// minima come from messages stamped just after a tick, and half a tick is
+// taken off every delay so the median is not moved. What is left is lag
+// on our side or the exchange's, beyond the best path seen.
+//
+// Called from the WebSocket receive threads; one lock guards everything.
+class FeedLatencyMonitor {
+public:
+  // Called outside the lock, on the receive thread that saw the lag. The
+  // connection's distribution is cleared, so it is flagged again only
+  // after min_samples fresh messages.
+  using LagHandler =
+      std::function<void(int connection, const LatencyStats &stats)>;
+
+  static constexpr int kMaxConnections = 2;
+
+  explicit FeedLatencyMonitor(FeedLatencyConfig cfg = {});
+
+  // Set before the feed starts.
+  void set_lag_handler(LagHandler h) { lag_handler = std::move(h); }
+
+  void record(int connection, const std::string &ticker,
+              std::int64_t exchange_ts_ns, std::int64_t recv_ts_ns);
+
+  LatencyStats market(const std::string &ticker, std::int64_t now_ns) const;
+  LatencyStats connection(int c, std::int64_t now_ns) const;
+  // Markets by descending p99.
+  std::vector<std::pair<std::string, LatencyStats>>
+  worst_markets(std::size_t n, std::int64_t now_ns) const;
+
+  // Expected receive minus exchange time of an undelayed message at
+  // `now_ns`, and how fast it moves in ns per second.
+  std::int64_t floor_ns(std::int64_t now_ns) const;
+  double drift_ns_per_sec() const;
+
+  std::uint64_t lag_alerts() const;
+
+private:
+  std::int64_t floor_locked(std::int64_t now_ns) const;
+  void close_floor_window();
+
+  FeedLatencyConfig cfg;
+  std::int64_t window_ns;
+  LagHandler lag_handler;
+
+  mutable std::mutex m;
+  std::unordered_map<std::string, RollingLatency> markets;
+  std::vector<RollingLatency> connections;
+  std::array<std::int64_t, kMaxConnections> next_check_ns{};
+
+  // Floor: the current window's minimum and the fitted line through past
+  // ones, delay = floor_a + floor_b * (t - floor_t0).
+  std::int64_t window_start_ns = 0;
+  std::int64_t window_min_ns = 0;
+  bool window_has_sample = false;
+  std::deque<std::pair<std::int64_t, std::int64_t>> minima; // (t, min)
+  bool have_floor = false;
+  std::int64_t floor_t0 = 0;
+  double floor_a = 0;
+  double floor_b = 0;
+  std::uint64_t alerts = 0;
+};
@@ -0,0 +1,126 @@
+#include "metrics.hpp"
+
+#include <sstream>
+
+namespace {
+
+constexpr std::array<MetricInfo, kNumCounters> kCounterInfo = {{
+    {"kalshi_ws_messages_total", "WebSocket data frames received"},
+    {"kalshi_ws_parse_failures_total",
+     "Frames the feed adapter could not turn into a FeedEvent"},
+    {"kalshi_ws_reconnects_total", "WebSocket reconnect attempts"},
+    {"kalshi_ws_failovers_total",
+     "Promotions of the hot-standby connection to primary"},
+    {"kalshi_ws_subscription_commands_total",
+     "Subscribe, update and unsubscribe commands sent"},
+    {"kalshi_ws_subscription_errors_total",
+     "Subscription commands rejected by the server"},
+    {"kalshi_engine_events_total", "Feed events dispatched by the engine"},
+    {"kalshi_engine_drops_total",
+     "Feed events dropped because the engine queue was full"},
+    {"kalshi_engine_conflated_total",
+     "Feed events folded into one already queued"},
+    {"kalshi_engine_resyncs_total",
+     "Markets sent for a new snapshot after their deltas were dropped"},
+    {"kalshi_book_applied_total", "Snapshots and deltas applied to books"},
+    {"kalshi_book_ignored_old_total",
+     "Snapshots and deltas dropped as older than the book"},
+    {"kalshi_book_gap_resync_total",
+     "Deltas that arrived after a sequence gap"},
+    {"kalshi_book_no_snapshot_total",
+     "Deltas that arrived before the first snapshot"},
+    {"kalshi_fills_total", "Fills applied to position ledgers"},
+    {"kalshi_risk_rejects_total", "Quote legs blocked by the risk gate"},
+    {"kalshi_series_signals_total",
+     "Event-series sums crossing an arbitrage threshold"},
+    {"kalshi_recorder_samples_total",
+     "Book samples handed to the recorder's writer"},
+    {"kalshi_recorder_drops_total",
+     "Book samples dropped because the recorder ring was full"},
+    {"kalshi_feed_lag_alerts_total",
+     "Feed connections flagged for lagging the exchange"},
+}};
+
+constexpr std::array<MetricInfo, kNumGauges> kGaugeInfo = {{
+    {"kalshi_engine_queue_depth", "Events waiting in the engine queue"},
+    {"kalshi_engine_queue_high_water", "Deepest the engine queue has been"},
+    {"kalshi_feed_latency_p50_us",
+     "Median feed delay over the clock floor, last checked connection"},
+    {"kalshi_feed_latency_p99_us",
+     "99th percentile feed delay over the clock floor, last checked "
+     "connection"},
+    {"kalshi_feed_clock_floor_us",
+     "Fitted receive minus exchange time of an undelayed message"},
+}};
+
+} // namespace
+
+const MetricInfo &metric_info(Counter c) {
+  return kCounterInfo[static_cast<std::size_t>(c)];
+}
+
+const MetricInfo &metric_info(Gauge g) {
+  return kGaugeInfo[static_cast<std::size_t>(g)];
+}
+
+Metrics &Metrics::instance() {
+  static Metrics inst;
+  return inst;
+}
+
+MetricsShard *Metrics::acquire_shard() {
+  std::lock_guard<std::mutex> lock(m);
+  for (std::size_t i = 0; i < kMaxShards; ++i) {
+    if (!in_use[i]) {
+      in_use[i] = true;
+      if (i + 1 > high_water.load(std::memory_order_relaxed)) {
+        high_water.store(i + 1, std::memory_order_release);
+      }
+      return &shards[i];
+    }
+  }
+  return &overflow;
+}
+
+void Metrics::release_shard(MetricsShard *shard) {
+  // Counters are cumulative and stay with the shard for the next owner.
+  if (shard == &overflow)
+    return;
+  std::lock_guard<std::mutex> lock(m);
+  in_use[static_cast<std::size_t>(shard - shards.data())] = false;
+}
+
+MetricsSnapshot Metrics::collect() const {
+  MetricsSnapshot snap;
+  auto add = [&](const MetricsShard &s) {
+    for (std::size_t i = 0; i < kNumCounters; ++i)
+      snap.counters[i] += s.counters[i].load(std::memory_order_relaxed);
+  };
+
+  const std::size_t n = high_water.load(std::memory_order_acquire);
+  for (std::size_t i = 0; i < n; ++i) {
+    add(shards[i]);
+  }
+  add(overflow);
+  for (std::size_t i = 0; i < kNumGauges; ++i)
+    snap.gauges[i] = gauges[i].load(std::memory_order_relaxed);
+  return snap;
+}
+
+std::string Metrics::render_prometheus() const {
+  const MetricsSnapshot snap = collect();
+  std::ostringstream out;
+  for (std::size_t i = 0; i < kNumCounters; ++i) {
+    const MetricInfo &info = kCounterInfo[i];
+    out << "# HELP " << info.name << ' ' << info.help << '\n'
+        << "# TYPE " << info.name << " counter\n"
+        << info.name << ' ' << snap.counters[i] << '\n';
+  }
+  for (std::size_t i = 0; i < kNumGauges; ++i) {
+    const MetricInfo &info = kGaugeInfo[i];
+    out << "# HELP " << info.name << ' ' << info.help << '\n'
+        << "# TYPE " << info.name << " gauge\n"
+        << info.name << ' ' << snap.gauges[i] << '\n';
+  }
+  return out.str();
+}
@@ -0,0 +1,129 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+enum class Counter : std::uint16_t {
+  WsMessages,
+  WsParseFailures,
+  WsReconnects,
+  WsFailovers,
+  WsSubscriptionCommands,
+  WsSubscriptionErrors,
+  EngineEvents,
+  EngineDrops,
+  EngineConflated,
+  EngineResyncs,
+  BookApplied,
+  BookIgnoredOld,
+  BookGapNeedsResync,
+  BookNoSnapshotYet,
+  Fills,
+  RiskRejects,
+  SeriesSignals,
+  RecorderSamples,
+  RecorderDrops,
+  FeedLagAlerts,
+  Count
+};
+
+enum class Gauge : std::uint16_t {
+  EngineQueueDepth,
+  EngineQueueHighWater,
+  FeedLatencyP50Us,
+  FeedLatencyP99Us,
+  FeedClockFloorUs,
+  Count
+};
+
+constexpr std::size_t kNumCounters = static_cast<std::size_t>(Counter::Count);
+constexpr std::size_t kNumGauges = static_cast<std::size_t>(Gauge::Count);
+
+struct MetricInfo {
+  const char *name;
+  const char *help;
+};
+
+const MetricInfo &metric_info(Counter c);
+const MetricInfo &metric_info(Gauge g);
+
+// One per thread. Only the owning thread writes, so updates are a plain
+// load/add/store (relaxed atomics compile to ordinary movs) and readers sum
+// shards on demand. The overflow shard is `shared` and takes a fetch_add
+// instead. Aligned so neighbouring shards never share a cache line.
+struct alignas(64) MetricsShard {
+  bool shared = false;
+  std::array<std::atomic<std::uint64_t>, kNumCounters> counters{};
+};
+
+struct MetricsSnapshot {
+  std::array<std::uint64_t, kNumCounters> counters{};
+  std::array<std::int64_t, kNumGauges> gauges{};
+};
+
+class Metrics {
+public:
+  static constexpr std::size_t kMaxShards = 64;
+
+  static Metrics &instance();
+
+  MetricsSnapshot collect() const;
+
+  // A gauge is a level, not a count: summing one across threads means
+  // nothing, so each has a single slot and the last write wins.
+  std::atomic<std::int64_t> &gauge(Gauge g) {
+    return gauges[static_cast<std::size_t>(g)];
+  }
+
+  std::string render_prometheus() const;
+
+private:
+  Metrics() { overflow.shared = true; }
+  Metrics(const Metrics &) = delete;
+  Metrics &operator=(const Metrics &) = delete;
+
+  friend struct ShardLease;
+
+  MetricsShard *acquire_shard();
+  void release_shard(MetricsShard *shard);
+
+  std::array<MetricsShard, kMaxShards> shards;
+  std::array<bool, kMaxShards> in_use{};
+  std::atomic<std::size_t> high_water{0};
+  MetricsShard overflow; // shared fallback once every shard is leased
+  alignas(64) std::array<std::atomic<std::int64_t>, kNumGauges> gauges{};
+  mutable std::mutex m;
+};
+
+// Leases a shard for the lifetime of a thread and hands it back on exit so
+// short-lived threads (one per reconnect) do not exhaust the registry.
+struct ShardLease {
+  MetricsShard *shard;
+  ShardLease() : shard(Metrics::instance().acquire_shard()) {}
+  ~ShardLease() { Metrics::instance().release_shard(shard); }
+};
+
+inline MetricsShard &metrics_shard() {
+  thread_local ShardLease lease;
+  return *lease.shard;
+}
+
+inline void metric_inc(Counter c, std::uint64_t n = 1) {
+  MetricsShard &shard = metrics_shard();
+  auto &slot = shard.counters[static_cast<std::size_t>(c)];
+  if (shard.shared) {
+    slot.fetch_add(n, std::memory_order_relaxed);
+    return;
+  }
+  slot.store(slot.load(std::memory_order_relaxed) + n,
+             std::memory_order_relaxed);
+}
+
+inline void metric_set(Gauge g, std::int64_t v) {
+  Metrics::instance().gauge(g).store(v, std::memory_order_relaxed);
+}
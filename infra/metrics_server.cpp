@@ -0,0 +1,146 @@
+#include "metrics_server.hpp"
+
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <iostream>
+#include <ixwebsocket/IXHttpServer.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+MetricsServer::MetricsServer(MetricsServerConfig c) : cfg(std::move(c)) {}
+
+MetricsServer::~MetricsServer() { stop(); }
+
+bool MetricsServer::start() {
+  if (cfg.port > 0) {
+    http = std::make_unique<ix::HttpServer>(cfg.port, cfg.host);
+    http->setOnConnectionCallback(
+        [](ix::HttpRequestPtr request,
+           std::shared_ptr<ix::ConnectionState>) -> ix::HttpResponsePtr {
+          if (request->uri != "/metrics") {
+            return std::make_shared<ix::HttpResponse>(
+                404, "Not Found", ix::HttpErrorCode::Ok,
+                ix::WebSocketHttpHeaders{}, "");
+          }
+          ix::WebSocketHttpHeaders headers;
+          headers["Content-Type"] = "text/plain; version=0.0.4";
+          return std::make_shared<ix::HttpResponse>(
+              200, "OK", ix::HttpErrorCode::Ok, headers,
+              Metrics::instance().render_prometheus());
+        });
+
+    auto res = http->listen();
+    if (!res.first) {
+      std::cerr << "Metrics endpoint failed to listen on " << cfg.host << ":"
+                << cfg.port << ": " << res.second << std::endl;
+      http.reset();
+      return false;
+    }
+    http->start();
+    std::cout << "Metrics endpoint on http://" << cfg.host << ":" << cfg.port
+              << "/metrics" << std::endl;
+  }
+
+  if (!cfg.shm_name.empty()) {
+    if (!open_page())
+      return false;
+    {
+      std::lock_guard<std::mutex> lock(m);
+      running = true;
+    }
+    publisher = std::thread(&MetricsServer::publish_loop, this);
+  }
+  return true;
+}
+
+void MetricsServer::stop() {
+  {
+    std::lock_guard<std::mutex> lock(m);
+    running = false;
+  }
+  cv.notify_all();
+  if (publisher.joinable())
+    publisher.join();
+
+  if (http) {
+    http->stop();
+    http.reset();
+  }
+  close_page();
+}
+
+bool MetricsServer::open_page() {
+  int fd = shm_open(cfg.shm_name.c_str(), O_CREAT | O_RDWR, 0644);
+  if (fd < 0) {
+    std::cerr << "shm_open failed for " << cfg.shm_name << ": "
+              << std::strerror(errno) << std::endl;
+    return false;
+  }
+  if (ftruncate(fd, sizeof(MetricsPage)) != 0) {
+    std::cerr << "ftruncate failed for " << cfg.shm_name << ": "
+              << std::strerror(errno) << std::endl;
+    close(fd);
+    return false;
+  }
+  void *addr = mmap(nullptr, sizeof(MetricsPage), PROT_READ | PROT_WRITE,
+                    MAP_SHARED, fd, 0);
+  close(fd);
+  if (addr == MAP_FAILED) {
+    std::cerr << "mmap failed for " << cfg.shm_name << ": "
+              << std::strerror(errno) << std::endl;
+    return false;
+  }
+
+  page = static_cast<MetricsPage *>(addr);
+  std::memset(static_cast<void *>(page), 0, sizeof(MetricsPage));
+  page->version = MetricsPage::kVersion;
+  page->num_counters = kNumCounters;
+  page->num_gauges = kNumGauges;
+  for (std::size_t i = 0; i < kNumCounters; ++i) {
+    std::strncpy(page->counter_names[i], metric_info(Counter(i)).name,
+                 MetricsPage::kNameLen - 1);
+  }
+  for (std::size_t i = 0; i < kNumGauges; ++i) {
+    std::strncpy(page->gauge_names[i], metric_info(Gauge(i)).name,
+                 MetricsPage::kNameLen - 1);
+  }
+  // Magic goes last so a sidecar never sees a half-initialised page.
+  std::atomic_thread_fence(std::memory_order_release);
+  page->magic = MetricsPage::kMagic;
+  return true;
+}
+
+void MetricsServer::close_page() {
+  if (!page)
+    return;
+  munmap(page, sizeof(MetricsPage));
+  shm_unlink(cfg.shm_name.c_str());
+  page = nullptr;
+}
+
+void MetricsServer::publish_loop() {
+  std::unique_lock<std::mutex> lock(m);
+  while (running) {
+    lock.unlock();
+    publish_page();
+    lock.lock();
+    cv.wait_for(lock, cfg.shm_interval, [&] { return !running; });
+  }
+}
+
+void MetricsServer::publish_page() {
+  const MetricsSnapshot snap = Metrics::instance().collect();
+  const std::uint64_t seq = page->seq.load(std::memory_order_relaxed);
+
+  page->seq.store(seq + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  for (std::size_t i = 0; i < kNumCounters; ++i)
+    page->counters[i] = snap.counters[i];
+  for (std::size_t i = 0; i < kNumGauges; ++i)
+    page->gauges[i] = snap.gauges[i];
+  page->published_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                           std::chrono::system_clock::now().time_since_epoch())
+                           .count();
+  page->seq.store(seq + 2, std::memory_order_release);
+}
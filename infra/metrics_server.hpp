@@ -0,0 +1,69 @@
+#pragma once
+
+#include "metrics.hpp"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+namespace ix {
+class HttpServer;
+}
+
+// Layout of the shared-memory page read by sidecars. Values are guarded by a
+// seqlock: `seq` is odd while the publisher is writing, so a reader copies
+// the values and retries if `seq` changed or was odd.
+struct MetricsPage {
+  static constexpr std::uint64_t kMagic = 0x43495254454d4d4bULL; // "KMMETRIC"
+  static constexpr std::uint32_t kVersion = 1;
+  static constexpr std::size_t kNameLen = 64;
+
+  std::uint64_t magic;
+  std::uint32_t version;
+  std::uint32_t num_counters;
+  std::uint32_t num_gauges;
+  std::uint32_t reserved;
+  std::atomic<std::uint64_t> seq;
+  std::int64_t published_ns;
+  char counter_names[kNumCounters][kNameLen];
+  char gauge_names[kNumGauges][kNameLen];
+  std::uint64_t counters[kNumCounters];
+  std::int64_t gauges[kNumGauges];
+};
+
+struct MetricsServerConfig {
+  std::string host = "127.0.0.1";
+  int port = 9464; // 0 disables the HTTP endpoint
+  std::string shm_name;  // e.g. "/kalshi_mm_metrics"; empty disables shm
+  std::chrono::milliseconds shm_interval{250};
+};
+
+// Serves Metrics::render_prometheus() on GET /metrics and mirrors the
+// aggregated values into a POSIX shared-memory page at a fixed interval.
+class MetricsServer {
+public:
+  explicit MetricsServer(MetricsServerConfig cfg);
+  ~MetricsServer();
+
+  bool start();
+  void stop();
+
+private:
+  bool open_page();
+  void close_page();
+  void publish_loop();
+  void publish_page();
+
+  MetricsServerConfig cfg;
+  std::unique_ptr<ix::HttpServer> http;
+  MetricsPage *page = nullptr;
+
+  std::thread publisher;
+  std::mutex m;
+  std::condition_variable cv;
+  bool running = false;
+};
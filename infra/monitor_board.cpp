@@ -0,0 +1,147 @@
+#include "monitor_board.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+
+namespace {
+
+std::int64_t wall_ns() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::system_clock::now().time_since_epoch())
+      .count();
+}
+
+nlohmann::json levels_json(const std::array<MonitorLevel, kMonitorDepth> &l,
+                           std::uint32_t depth) {
+  nlohmann::json out = nlohmann::json::array();
+  for (std::uint32_t i = 0; i < depth && l[i].price; ++i)
+    out.push_back({l[i].price, l[i].size});
+  return out;
+}
+
+nlohmann::json quote_json(const Quote &q) {
+  return {{"bid", q.bid}, {"ask", q.ask}};
+}
+
+} // namespace
+
+MonitorBoard::MonitorBoard(std::size_t max_markets, std::uint32_t d)
+    : slots(new Slot[max_markets]), cap(max_markets),
+      depth(std::clamp<std::uint32_t>(d, 1, kMonitorDepth)) {}
+
+MonitorBoard::Slot *MonitorBoard::slot(const std::string &ticker) {
+  auto it = index.find(ticker);
+  if (it != index.end())
+    return &slots[it->second];
+  const std::size_t i = used.load(std::memory_order_relaxed);
+  if (i == cap) {
+    if (!warned_full) {
+      std::cerr << "[MONITOR] board full at " << cap << " markets; "
+                << ticker << " and later markets are not shown" << std::endl;
+      warned_full = true;
+    }
+    return nullptr;
+  }
+  index.emplace(ticker, i);
+  Slot &s = slots[i];
+  std::strncpy(s.view.ticker, ticker.c_str(), sizeof(s.view.ticker) - 1);
+  s.view.depth = depth;
+  // Readers only look at slots below `used`, so the ticker is visible first.
+  used.store(i + 1, std::memory_order_release);
+  return &s;
+}
+
+template <typename Fn>
+bool MonitorBoard::write(const std::string &ticker, Fn &&fn) {
+  Slot *s = slot(ticker);
+  if (!s)
+    return false;
+  const std::uint64_t seq = s->seq.load(std::memory_order_relaxed);
+  s->seq.store(seq + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  fn(s->view);
+  s->view.ts_ns = wall_ns();
+  s->seq.store(seq + 2, std::memory_order_release);
+  return true;
+}
+
+bool MonitorBoard::update_book(const std::string &ticker,
+                               const OrderBook &book) {
+  return write(ticker, [&](MarketView &v) {
+    for (Side side : {Side::YES, Side::NO}) {
+      auto &out = side == Side::YES ? v.yes : v.no;
+      const auto &levels = book.bids(side);
+      auto it = levels.begin();
+      for (std::uint32_t i = 0; i < depth; ++i) {
+        if (it != levels.end()) {
+          out[i] = {it->first, it->second};
+          ++it;
+        } else {
+          out[i] = {};
+        }
+      }
+    }
+    v.has_book = true;
+  });
+}
+
+bool MonitorBoard::update_quote(const std::string &ticker, const Quote &yes,
+                                const Quote &no) {
+  return write(ticker, [&](MarketView &v) {
+    v.yes_quote = yes;
+    v.no_quote = no;
+    v.has_quote = true;
+  });
+}
+
+bool MonitorBoard::update_pnl(const std::string &ticker,
+                              const TickerSnapshotPnL &pnl) {
+  return write(ticker, [&](MarketView &v) {
+    v.pnl = pnl;
+    v.has_pnl = true;
+  });
+}
+
+std::uint64_t MonitorBoard::read(std::size_t i, MarketView &out) const {
+  const Slot &s = slots[i];
+  for (;;) {
+    const std::uint64_t before = s.seq.load(std::memory_order_acquire);
+    if (before & 1)
+      continue;
+    std::memcpy(static_cast<void *>(&out), &s.view, sizeof(out));
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (s.seq.load(std::memory_order_relaxed) == before)
+      return before;
+  }
+}
+
+nlohmann::json market_view_json(const MarketView &v) {
+  nlohmann::json j;
+  j["ticker"] = std::string(v.ticker, strnlen(v.ticker, sizeof(v.ticker)));
+  j["ts_ns"] = v.ts_ns;
+  if (v.has_book) {
+    // A YES ask is a NO bid at 100 - price.
+    const int ask = v.no[0].price ? 100 - v.no[0].price : 0;
+    j["yes_bid"] = v.yes[0].price;
+    j["yes_bid_size"] = v.yes[0].size;
+    j["yes_ask"] = ask;
+    j["yes_ask_size"] = v.no[0].size;
+    j["depth"] = {{"yes", levels_json(v.yes, v.depth)},
+                  {"no", levels_json(v.no, v.depth)}};
+  }
+  if (v.has_quote) {
+    j["quote"] = {{"yes", quote_json(v.yes_quote)},
+                  {"no", quote_json(v.no_quote)}};
+  }
+  if (v.has_pnl) {
+    j["pnl"] = {{"yes_pos", v.pnl.yes_pos},
+                {"no_pos", v.pnl.no_pos},
+                {"cash_cents", v.pnl.cash_cents},
+                {"realized_pnl_cents", v.pnl.realized_pnl_cents},
+                {"unrealized_pnl_cents", v.pnl.unrealized_pnl_cents},
+                {"equity_cents", v.pnl.equity_cents}};
+  }
+  return j;
+}
@@ -0,0 +1,84 @@
+#pragma once
+
+#include "order_book.hpp"
+#include "strategy/positions/ticker_position_ledger.hpp"
+#include "strategy/types.hpp"
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <nlohmann/json.hpp>
+#include <string>
+#include <unordered_map>
+
+constexpr int kMonitorDepth = 10;
+
+struct MonitorLevel {
+  int price = 0; // cents; 0 means no level
+  int size = 0;
+};
+
+// What the dashboard shows for one market. Plain data, so it can be copied
+// out through a seqlock.
+struct MarketView {
+  char ticker[64];
+  std::int64_t ts_ns; // wall clock of the last update
+  std::uint32_t depth;
+  std::array<MonitorLevel, kMonitorDepth> yes; // bids, best first
+  std::array<MonitorLevel, kMonitorDepth> no;
+  Quote yes_quote;
+  Quote no_quote;
+  TickerSnapshotPnL pnl;
+  bool has_book;
+  bool has_quote;
+  bool has_pnl;
+};
+
+// Latest per-market state for monitoring, written by the engine thread and
+// read by anyone. Each market has a fixed slot guarded by a seqlock: the
+// writer never waits, and a reader copies the slot and retries if a write
+// overlapped, so no reader can slow the engine down. Slots are handed out
+// on first update and never reused.
+class MonitorBoard {
+public:
+  explicit MonitorBoard(std::size_t max_markets = 1024,
+                        std::uint32_t depth = 5);
+
+  MonitorBoard(const MonitorBoard &) = delete;
+  MonitorBoard &operator=(const MonitorBoard &) = delete;
+
+  // Engine thread. False once every slot is taken by other markets.
+  bool update_book(const std::string &ticker, const OrderBook &book);
+  bool update_quote(const std::string &ticker, const Quote &yes,
+                    const Quote &no);
+  bool update_pnl(const std::string &ticker, const TickerSnapshotPnL &pnl);
+
+  // Any thread. Markets [0, size()) can be read.
+  std::size_t size() const { return used.load(std::memory_order_acquire); }
+  std::size_t capacity() const { return cap; }
+  // Bumped by every update; compare to see whether a market changed.
+  std::uint64_t version(std::size_t i) const {
+    return slots[i].seq.load(std::memory_order_acquire);
+  }
+  // Consistent copy of market i; returns the version it was taken at.
+  std::uint64_t read(std::size_t i, MarketView &out) const;
+
+private:
+  struct alignas(64) Slot {
+    std::atomic<std::uint64_t> seq{0}; // odd while being written
+    MarketView view{};
+  };
+
+  Slot *slot(const std::string &ticker);
+  template <typename Fn> bool write(const std::string &ticker, Fn &&fn);
+
+  std::unique_ptr<Slot[]> slots;
+  std::size_t cap;
+  std::uint32_t depth;
+  std::atomic<std::size_t> used{0};
+  std::unordered_map<std::string, std::size_t> index; // engine thread
+  bool warned_full = false;
+};
+
+nlohmann::json market_view_json(const MarketView &v);
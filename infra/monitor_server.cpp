@@ -0,0 +1,143 @@
+#include "monitor_server.hpp"
+#include "runtime_tuning.hpp"
+
+#include <iostream>
+#include <ixwebsocket/IXWebSocketServer.h>
+
+MonitorServerConfig monitor_server_config_from_json(const nlohmann::json &j) {
+  MonitorServerConfig cfg;
+  cfg.host = j.value("host", cfg.host);
+  cfg.port = j.value("port", cfg.port);
+  cfg.rate_hz = j.value("rate_hz", cfg.rate_hz);
+  cfg.depth = j.value("depth", cfg.depth);
+  cfg.max_markets = j.value("max_markets", cfg.max_markets);
+  cfg.max_buffered_bytes =
+      j.value("max_buffered_bytes", cfg.max_buffered_bytes);
+  return cfg;
+}
+
+MonitorServer::MonitorServer(MonitorServerConfig c)
+    : cfg(std::move(c)), board_(cfg.max_markets, cfg.depth) {
+  if (cfg.rate_hz <= 0)
+    cfg.rate_hz = 10;
+}
+
+MonitorServer::~MonitorServer() { stop(); }
+
+bool MonitorServer::start() {
+  server = std::make_unique<ix::WebSocketServer>(cfg.port, cfg.host);
+  server->setOnClientMessageCallback(
+      [this](std::shared_ptr<ix::ConnectionState>, ix::WebSocket &ws,
+             const ix::WebSocketMessagePtr &msg) {
+        std::lock_guard<std::mutex> lock(clients_m);
+        if (msg->type == ix::WebSocketMessageType::Open) {
+          needs_snapshot[&ws] = true;
+        } else if (msg->type == ix::WebSocketMessageType::Close) {
+          needs_snapshot.erase(&ws);
+        }
+      });
+  auto res = server->listen();
+  if (!res.first) {
+    std::cerr << "Monitor server failed to listen on " << cfg.host << ":"
+              << cfg.port << ": " << res.second << std::endl;
+    server.reset();
+    return false;
+  }
+  server->start();
+  std::cout << "Monitor feed on ws://" << cfg.host << ":" << cfg.port
+            << std::endl;
+
+  {
+    std::lock_guard<std::mutex> lock(m);
+    running = true;
+  }
+  publisher = std::thread(&MonitorServer::publish_loop, this);
+  return true;
+}
+
+void MonitorServer::stop() {
+  {
+    std::lock_guard<std::mutex> lock(m);
+    running = false;
+  }
+  cv.notify_all();
+  if (publisher.joinable())
+    publisher.join();
+  if (server) {
+    server->stop();
+    server.reset();
+  }
+}
+
+void MonitorServer::handle_feed_event(const FeedEvent &ev,
+                                      const KalshiOrderBook *book) {
+  if (ev.type != FeedEvent::Type::OrderbookSnapshot &&
+      ev.type != FeedEvent::Type::OrderbookDelta)
+    return;
+  if (book && book->has_snapshot)
+    board_.update_book(ev.ticker, book->book);
+}
+
+void MonitorServer::publish_loop() {
+  RuntimeTuning::instance().tune_current_thread("monitor");
+  const auto period = std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::duration<double>(1.0 / cfg.rate_hz));
+  std::unique_lock<std::mutex> lock(m);
+  while (running) {
+    lock.unlock();
+    publish();
+    lock.lock();
+    cv.wait_for(lock, period, [&] { return !running; });
+  }
+}
+
+void MonitorServer::publish() {
+  // Copy out everything that moved since the last push; later writes to
+  // the same market simply supersede what was read here.
+  const std::size_t n = board_.size();
+  sent_version.resize(n, 0);
+  views.resize(n);
+  nlohmann::json changed = nlohmann::json::array();
+  for (std::size_t i = 0; i < n; ++i) {
+    if (board_.version(i) != sent_version[i]) {
+      sent_version[i] = board_.read(i, views[i]);
+      changed.push_back(market_view_json(views[i]));
+    }
+  }
+
+  std::string update_frame;
+  std::string snapshot_frame;
+  for (const auto &client : server->getClients()) {
+    bool snapshot = false;
+    {
+      std::lock_guard<std::mutex> lock(clients_m);
+      auto it = needs_snapshot.find(client.get());
+      if (it == needs_snapshot.end())
+        continue; // open not seen yet
+      if (client->bufferedAmount() > cfg.max_buffered_bytes) {
+        // Stuck or slow: skip it and resend the whole board once it drains.
+        it->second = true;
+        continue;
+      }
+      snapshot = it->second;
+      it->second = false;
+    }
+    if (snapshot) {
+      if (snapshot_frame.empty()) {
+        nlohmann::json all = nlohmann::json::array();
+        for (std::size_t i = 0; i < n; ++i) {
+          if (sent_version[i])
+            all.push_back(market_view_json(views[i]));
+        }
+        snapshot_frame =
+            nlohmann::json{{"type", "snapshot"}, {"markets", all}}.dump();
+      }
+      client->sendText(snapshot_frame);
+    } else if (!changed.empty()) {
+      if (update_frame.empty())
+        update_frame =
+            nlohmann::json{{"type", "update"}, {"markets", changed}}.dump();
+      client->sendText(update_frame);
+    }
+  }
+}
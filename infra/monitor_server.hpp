@@ -0,0 +1,82 @@
+#pragma once
+
+#include "monitor_board.hpp"
+#include "strategy/strategy.hpp"
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace ix {
+class WebSocket;
+class WebSocketServer;
+} // namespace ix
+
+struct MonitorServerConfig {
+  std::string host = "127.0.0.1";
+  int port = 9465;
+  double rate_hz = 10; // pushes per second, at most
+  std::uint32_t depth = 5;
+  std::size_t max_markets = 1024;
+  // A client with more than this queued on its socket is skipped until it
+  // drains, then sent a full snapshot.
+  std::size_t max_buffered_bytes = 1 << 20;
+};
+
+// Reads the "monitor" section of runner.json.
+MonitorServerConfig monitor_server_config_from_json(const nlohmann::json &j);
+
+// Local dashboard feed. Registered with the engine like a strategy, it
+// copies each changed book into a MonitorBoard; quotes and PnL go in
+// through board(). A publisher thread wakes rate_hz times a second and
+// sends every connected WebSocket client the markets whose version moved,
+// as one JSON frame:
+//   {"type":"update","markets":[{"ticker":...,"yes_bid":...,"depth":...,
+//    "quote":...,"pnl":...}, ...]}
+// New clients, and clients that fell behind, get {"type":"snapshot",...}
+// with every market. Updates between two pushes are conflated, and the
+// engine never waits on the publisher or on a socket.
+class MonitorServer : public Strategy {
+public:
+  explicit MonitorServer(MonitorServerConfig cfg);
+  ~MonitorServer() override;
+
+  MonitorServer(const MonitorServer &) = delete;
+  MonitorServer &operator=(const MonitorServer &) = delete;
+
+  bool start();
+  void stop();
+
+  void handle_feed_event(const FeedEvent &ev,
+                         const KalshiOrderBook *book) override;
+
+  // Engine thread, for quote and PnL updates.
+  MonitorBoard &board() { return board_; }
+
+private:
+  void publish_loop();
+  void publish();
+
+  MonitorServerConfig cfg;
+  MonitorBoard board_;
+  std::unique_ptr<ix::WebSocketServer> server;
+
+  // Publisher thread.
+  std::vector<std::uint64_t> sent_version; // by market slot
+  std::vector<MarketView> views;
+
+  // Clients owed a full snapshot; set by the server's callbacks.
+  std::mutex clients_m;
+  std::unordered_map<const ix::WebSocket *, bool> needs_snapshot;
+
+  std::thread publisher;
+  std::mutex m;
+  std::condition_variable cv;
+  bool running = false;
+};
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <optional>
+#include <random>
+
+struct BackoffConfig {
+  std::chrono::milliseconds initial{100};
+  std::chrono::milliseconds max{10000};
+  double multiplier = 2.0;
+  // A connection that stayed up this long resets the backoff; shorter ones
+  // count as another failed attempt so a flapping server is not hammered.
+  std::chrono::milliseconds stable_after{10000};
+};
+
+struct ReconnectConfig {
+  BackoffConfig backoff;
+  // Auth headers are re-signed on this cadence so a reconnect never waits
+  // on a signature; anything older than header_max_age is re-signed inline.
+  std::chrono::milliseconds header_refresh{3000};
+  std::chrono::milliseconds header_max_age{5000};
+  // Keep a second authenticated connection open and fail over to it.
+  bool hot_standby = false;
+};
+
+// Full-jitter exponential backoff whose first retry is immediate.
+class ReconnectBackoff {
+public:
+  explicit ReconnectBackoff(BackoffConfig cfg = {})
+      : cfg(cfg), rng(std::random_device{}()) {}
+
+  std::chrono::milliseconds next_delay() {
+    const int n = attempt++;
+    if (n == 0)
+      return std::chrono::milliseconds(0);
+    const double cap = std::min<double>(
+        static_cast<double>(cfg.max.count()),
+        cfg.initial.count() * std::pow(cfg.multiplier, n - 1));
+    std::uniform_real_distribution<double> jitter(0.0, cap);
+    return std::chrono::milliseconds(static_cast<long long>(jitter(rng)));
+  }
+
+  void on_connected(std::chrono::steady_clock::time_point now) {
+    opened_at = now;
+  }
+
+  void on_disconnected(std::chrono::steady_clock::time_point now) {
+    if (opened_at && now - *opened_at >= cfg.stable_after)
+      attempt = 0;
+    opened_at.reset();
+  }
+
+  int attempts() const { return attempt; }
+
+private:
+  BackoffConfig cfg;
+  std::mt19937_64 rng;
+  int attempt = 0;
+  std::optional<std::chrono::steady_clock::time_point> opened_at;
+};
@@ -0,0 +1,295 @@
+#include "rest_bootstrap.hpp"
+
+#include "thread_pool.hpp"
+#include <chrono>
+#include <iostream>
+#include <mutex>
+#include <unordered_set>
+
+namespace {
+
+constexpr int kPageLimit = 1000;
+
+// One side of an "orderbook" object: [[price, size], ...].
+std::vector<std::pair<int, int>> parse_levels(const nlohmann::json &book,
+                                              const char *side) {
+  std::vector<std::pair<int, int>> out;
+  const auto j = book.find(side);
+  if (j == book.end() || !j->is_array())
+    return out; // the API sends null for an empty side
+  out.reserve(j->size());
+  for (const auto &level : *j) {
+    if (level.is_array() && level.size() >= 2 && level[0].is_number() &&
+        level[1].is_number()) {
+      out.emplace_back(level[0].get<int>(), level[1].get<int>());
+    }
+  }
+  return out;
+}
+
+} // namespace
+
+RestBootstrapConfig rest_bootstrap_config_from_json(const nlohmann::json &j) {
+  RestBootstrapConfig cfg;
+  cfg.url = j.value("url", cfg.url);
+  cfg.series = j.value("series", cfg.series);
+  cfg.events = j.value("events", cfg.events);
+  cfg.books = j.value("books", cfg.books);
+  cfg.positions = j.value("positions", cfg.positions);
+  cfg.depth = j.value("depth", cfg.depth);
+  cfg.connections = j.value("connections", cfg.connections);
+  cfg.timeout_secs = j.value("timeout_secs", cfg.timeout_secs);
+  return cfg;
+}
+
+RestBootstrap::RestBootstrap(RestBootstrapConfig cfg_, RestTransport &t)
+    : cfg(std::move(cfg_)), transport(t) {
+  std::string host;
+  split_rest_url(cfg.url, host, prefix);
+}
+
+bool RestBootstrap::fetch_pages(const std::string &path, const char *field,
+                                std::vector<nlohmann::json> &items,
+                                std::size_t &requests) {
+  std::string cursor;
+  while (true) {
+    const std::string page =
+        cursor.empty() ? path : path + "&cursor=" + url_encode(cursor);
+    RestResponse res = transport.get(page);
+    ++requests;
+    if (!res.ok()) {
+      std::cerr << "[BOOTSTRAP] GET " << page << " failed: " << res.status
+                << " " << res.error << std::endl;
+      return false;
+    }
+    nlohmann::json j = nlohmann::json::parse(res.body, nullptr, false);
+    if (j.is_discarded() || !j.is_object()) {
+      std::cerr << "[BOOTSTRAP] GET " << page << ": unparsable body"
+                << std::endl;
+      return false;
+    }
+    if (j.contains(field) && j[field].is_array()) {
+      for (auto &item : j[field]) {
+        items.push_back(std::move(item));
+      }
+    }
+    const auto c = j.find("cursor");
+    std::string next = c != j.end() && c->is_string() ? c->get<std::string>()
+                                                      : std::string();
+    if (next.empty() || next == cursor)
+      return true;
+    cursor = std::move(next);
+  }
+}
+
+BootstrapResult RestBootstrap::run(const std::vector<std::string> &tickers) {
+  const auto started = std::chrono::steady_clock::now();
+  BootstrapResult out;
+  std::mutex m; // guards `out` while the pool runs
+  ThreadPool pool(cfg.connections);
+
+  // Market lists and positions first; one task per list, pages in order.
+  const std::size_t lists = cfg.series.size() + cfg.events.size();
+  std::vector<std::vector<std::string>> found(lists);
+  for (std::size_t i = 0; i < lists; ++i) {
+    const bool is_series = i < cfg.series.size();
+    const std::string &name =
+        is_series ? cfg.series[i] : cfg.events[i - cfg.series.size()];
+    const char *filter = is_series ? "series_ticker=" : "event_ticker=";
+    const std::string path = prefix + "/markets?" + filter + url_encode(name) +
+                             "&status=open&limit=" +
+                             std::to_string(kPageLimit);
+    pool.submit([&, i, path] {
+      std::vector<nlohmann::json> markets;
+      std::size_t requests = 0;
+      const bool ok = fetch_pages(path, "markets", markets, requests);
+      for (const auto &mk : markets) {
+        const auto t = mk.find("ticker");
+        if (t != mk.end() && t->is_string())
+          found[i].push_back(t->get<std::string>());
+      }
+      std::lock_guard<std::mutex> lock(m);
+      out.requests += requests;
+      out.failures += ok ? 0 : 1;
+    });
+  }
+
+  if (cfg.positions) {
+    pool.submit([&] {
+      std::vector<nlohmann::json> items;
+      std::size_t requests = 0;
+      const bool ok = fetch_pages(
+          prefix + "/portfolio/positions?count_filter=position&limit=" +
+              std::to_string(kPageLimit),
+          "market_positions", items, requests);
+      std::vector<BootstrapPosition> positions;
+      for (const auto &p : items) {
+        BootstrapPosition bp;
+        bp.ticker = p.value("ticker", std::string());
+        bp.position = p.value("position", 0);
+        bp.exposure_cents = p.value("market_exposure", 0LL);
+        bp.realized_pnl_cents = p.value("realized_pnl", 0LL);
+        if (!bp.ticker.empty())
+          positions.push_back(std::move(bp));
+      }
+      std::lock_guard<std::mutex> lock(m);
+      out.requests += requests;
+      if (ok) {
+        out.positions = std::move(positions);
+        out.positions_complete = true;
+      } else {
+        ++out.failures;
+      }
+    });
+  }
+  pool.wait_idle();
+
+  std::unordered_set<std::string> seen;
+  auto add = [&](const std::string &t) {
+    if (seen.insert(t).second)
+      out.tickers.push_back(t);
+  };
+  for (const auto &t : tickers) {
+    add(t);
+  }
+  for (const auto &list : found) {
+    for (const auto &t : list) {
+      add(t);
+    }
+  }
+
+  if (cfg.books) {
+    std::vector<BootstrapBook> books(out.tickers.size());
+    std::vector<char> fetched(out.tickers.size(), 0);
+    const std::string depth =
+        cfg.depth > 0 ? "?depth=" + std::to_string(cfg.depth) : "";
+    for (std::size_t i = 0; i < out.tickers.size(); ++i) {
+      pool.submit([&, i] {
+        const std::string &ticker = out.tickers[i];
+        const std::string path =
+            prefix + "/markets/" + url_encode(ticker) + "/orderbook" + depth;
+        RestResponse res = transport.get(path);
+        nlohmann::json j = res.ok()
+                               ? nlohmann::json::parse(res.body, nullptr, false)
+                               : nlohmann::json();
+        const bool ok = j.is_object() && j.contains("orderbook") &&
+                        j["orderbook"].is_object();
+        if (ok) {
+          books[i].ticker = ticker;
+          books[i].yes = parse_levels(j["orderbook"], "yes");
+          books[i].no = parse_levels(j["orderbook"], "no");
+          fetched[i] = 1;
+        } else {
+          std::cerr << "[BOOTSTRAP] GET " << path << " failed: " << res.status
+                    << " " << res.error << std::endl;
+        }
+        std::lock_guard<std::mutex> lock(m);
+        ++out.requests;
+        out.failures += ok ? 0 : 1;
+      });
+    }
+    pool.wait_idle();
+    for (std::size_t i = 0; i < books.size(); ++i) {
+      if (fetched[i])
+        out.books.push_back(std::move(books[i]));
+    }
+  }
+
+  const auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+                      std::chrono::steady_clock::now() - started)
+                      .count();
+  std::cout << "[BOOTSTRAP] " << out.tickers.size() << " markets, "
+            << out.books.size() << " books, " << out.positions.size()
+            << " positions in " << ms << " ms (" << out.requests
+            << " requests, " << out.failures << " failed)" << std::endl;
+  return out;
+}
+
+void seed_books(const BootstrapResult &r, KalshiOrderBookManager &books) {
+  for (const auto &b : r.books) {
+    books.seed_book(b.ticker, b.yes, b.no);
+  }
+}
+
+std::size_t restore_positions(const BootstrapResult &r,
+                              PositionManager &positions) {
+  std::size_t replaced = 0;
+  auto replace = [&](const std::string &ticker, const LedgerState &s,
+                     int local, int exchange) {
+    if (local != exchange) {
+      std::cerr << "[BOOTSTRAP] " << ticker << ": local position " << local
+                << ", exchange " << exchange << "; using the exchange's"
+                << std::endl;
+    }
+    positions.restore_ledger(ticker, s);
+    ++replaced;
+  };
+
+  std::unordered_set<std::string> held;
+  for (const auto &p : r.positions) {
+    held.insert(p.ticker);
+    const TickerPositionLedger *ledger = positions.get_ledger(p.ticker);
+    const int local =
+        ledger ? ledger->yes_position() - ledger->no_position() : 0;
+    if (ledger && local == p.position)
+      continue;
+
+    LedgerState s = ledger ? ledger->state() : LedgerState{};
+    const int qty = p.position > 0 ? p.position : -p.position;
+    s.yes_pos = p.position > 0 ? qty : 0;
+    s.no_pos = p.position < 0 ? qty : 0;
+    const int vwap = qty ? static_cast<int>(p.exposure_cents / qty) : 0;
+    s.vwap_yes_cents = s.yes_pos ? vwap : 0;
+    s.vwap_no_cents = s.no_pos ? vwap : 0;
+    s.cash_cents = -p.exposure_cents;
+    s.realized_pnl_cents = p.realized_pnl_cents;
+    replace(p.ticker, s, local, p.position);
+  }
+
+  // Only a full listing proves that a market we think we hold is flat.
+  if (r.positions_complete) {
+    std::vector<std::pair<std::string, LedgerState>> flat;
+    positions.for_each_ledger([&](const TickerPositionLedger &l) {
+      if (held.count(l.ticker()) || l.yes_position() - l.no_position() == 0)
+        return;
+      LedgerState s = l.state();
+      s.yes_pos = s.no_pos = 0;
+      s.vwap_yes_cents = s.vwap_no_cents = 0;
+      flat.emplace_back(l.ticker(), s);
+    });
+    for (const auto &[ticker, s] : flat) {
+      const TickerPositionLedger *l = positions.get_ledger(ticker);
+      replace(ticker, s, l->yes_position() - l->no_position(), 0);
+    }
+  }
+  return replaced;
+}
+
+std::string url_encode(std::string_view s) {
+  static constexpr char kHex[] = "0123456789ABCDEF";
+  std::string out;
+  out.reserve(s.size());
+  for (unsigned char c : s) {
+    if ((c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z') ||
+        (c >= '0' && c <= '9') || c == '-' || c == '_' || c == '.' ||
+        c == '~') {
+      out.push_back(static_cast<char>(c));
+    } else {
+      out.push_back('%');
+      out.push_back(kHex[c >> 4]);
+      out.push_back(kHex[c & 0xf]);
+    }
+  }
+  return out;
+}
+
+void split_rest_url(const std::string &url, std::string &host,
+                    std::string &prefix) {
+  const auto scheme = url.find("://");
+  const auto slash =
+      url.find('/', scheme == std::string::npos ? 0 : scheme + 3);
+  host = url.substr(0, slash);
+  prefix = slash == std::string::npos ? std::string() : url.substr(slash);
+  while (!prefix.empty() && prefix.back() == '/')
+    prefix.pop_back();
+}
@@ -0,0 +1,89 @@
+#pragma once
+
+#include "protocols/kalshi/kalshi_order_book_manager.hpp"
+#include "protocols/kalshi/kalshi_rest.hpp"
+#include "strategy/positions/position_manager.hpp"
+#include <cstddef>
+#include <nlohmann/json.hpp>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+struct RestBootstrapConfig {
+  std::string url = "https://api.elections.kalshi.com/trade-api/v2";
+  std::vector<std::string> series; // open markets of each are added
+  std::vector<std::string> events;
+  bool books = true;     // fetch every market's book
+  bool positions = true; // fetch our positions
+  int depth = 0;         // book levels per side; 0 is all
+  std::size_t connections = 8;
+  int timeout_secs = 10;
+};
+
+// Reads the "bootstrap" section of runner.json.
+RestBootstrapConfig rest_bootstrap_config_from_json(const nlohmann::json &j);
+
+struct BootstrapBook {
+  std::string ticker;
+  std::vector<std::pair<int, int>> yes; // (price, size), as in SnapshotEvent
+  std::vector<std::pair<int, int>> no;
+};
+
+struct BootstrapPosition {
+  std::string ticker;
+  int position = 0; // net: positive YES, negative NO
+  long long exposure_cents = 0; // cost of the open position
+  long long realized_pnl_cents = 0;
+};
+
+struct BootstrapResult {
+  // Configured markets first, then discovered ones; no duplicates.
+  std::vector<std::string> tickers;
+  std::vector<BootstrapBook> books;
+  std::vector<BootstrapPosition> positions;
+  bool positions_complete = false; // every page of positions arrived
+  std::size_t requests = 0;
+  std::size_t failures = 0; // requests that gave no usable answer
+};
+
+// Fills in what the WS feed would otherwise take minutes to deliver for a
+// large universe: the open markets of configured series and events, every
+// market's book and our positions, fetched concurrently over at most
+// `connections` requests at a time. Lists are paged with the API's
+// cursor. Run before the engine starts; a failed request is logged and
+// counted, and the feed fills the gap.
+class RestBootstrap {
+public:
+  RestBootstrap(RestBootstrapConfig cfg, RestTransport &transport);
+
+  BootstrapResult run(const std::vector<std::string> &tickers);
+
+private:
+  // Appends every page of `path` (which already has a query) to `items`,
+  // taken from the `field` array of each page. False if a page failed.
+  bool fetch_pages(const std::string &path, const char *field,
+                   std::vector<nlohmann::json> &items,
+                   std::size_t &requests);
+
+  RestBootstrapConfig cfg;
+  RestTransport &transport;
+  std::string prefix; // path part of cfg.url
+};
+
+// Installs the fetched books; the feed's own snapshots replace them.
+void seed_books(const BootstrapResult &r, KalshiOrderBookManager &books);
+
+// Exchange positions are authoritative. A ledger that already agrees on
+// the net position (restored from a checkpoint or journal, with its full
+// history) is kept; any other is replaced and the mismatch logged.
+// Returns the number of ledgers replaced.
+std::size_t restore_positions(const BootstrapResult &r,
+                              PositionManager &positions);
+
+// Percent-encodes a query parameter value.
+std::string url_encode(std::string_view s);
+
+// Splits "https://host[:port]/prefix" into its host and path prefix.
+void split_rest_url(const std::string &url, std::string &host,
+                    std::string &prefix);
@@ -0,0 +1,251 @@
+#include "runtime_tuning.hpp"
+
+#include <alloca.h>
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <malloc.h>
+#include <new>
+#include <pthread.h>
+#include <sched.h>
+#include <sstream>
+#include <sys/mman.h>
+
+namespace {
+
+std::size_t round_up(std::size_t n, std::size_t to) {
+  return (n + to - 1) / to * to;
+}
+
+std::string read_first_line(const char *path) {
+  std::ifstream f(path);
+  std::string line;
+  std::getline(f, line);
+  return line;
+}
+
+std::string describe_affinity(pthread_t t) {
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  if (pthread_getaffinity_np(t, sizeof(set), &set) != 0)
+    return "?";
+  std::ostringstream os;
+  const char *sep = "";
+  for (int c = 0; c < CPU_SETSIZE; ++c) {
+    if (CPU_ISSET(c, &set)) {
+      os << sep << c;
+      sep = ",";
+    }
+  }
+  return os.str();
+}
+
+std::string describe_sched(pthread_t t) {
+  int policy = 0;
+  sched_param sp{};
+  if (pthread_getschedparam(t, &policy, &sp) != 0)
+    return "?";
+  if (policy == SCHED_FIFO)
+    return "FIFO/" + std::to_string(sp.sched_priority);
+  if (policy == SCHED_RR)
+    return "RR/" + std::to_string(sp.sched_priority);
+  return "OTHER";
+}
+
+void prefault_stack(std::size_t bytes) {
+  if (bytes == 0)
+    return;
+  auto *p = static_cast<volatile char *>(alloca(bytes));
+  for (std::size_t i = 0; i < bytes; i += 4096) {
+    p[i] = 0;
+  }
+}
+
+void prefault_heap(std::size_t bytes) {
+  // Keep freed memory in the heap instead of returning it to the kernel,
+  // and serve large blocks from it rather than fresh mmaps.
+  mallopt(M_TRIM_THRESHOLD, -1);
+  mallopt(M_MMAP_MAX, 0);
+  char *p = static_cast<char *>(std::malloc(bytes));
+  if (!p) {
+    std::cerr << "[TUNE] could not pre-fault " << bytes << " heap bytes"
+              << std::endl;
+    return;
+  }
+  for (std::size_t i = 0; i < bytes; i += 4096) {
+    p[i] = 0;
+  }
+  std::free(p);
+  std::cout << "[TUNE] pre-faulted " << (bytes >> 20) << " MiB of heap"
+            << std::endl;
+}
+
+HugePages parse_huge_pages(const std::string &s) {
+  if (s == "transparent")
+    return HugePages::Transparent;
+  if (s == "explicit")
+    return HugePages::Explicit;
+  return HugePages::Off;
+}
+
+} // namespace
+
+RuntimeTuningConfig runtime_tuning_from_json(const nlohmann::json &j) {
+  RuntimeTuningConfig cfg;
+  cfg.lock_memory = j.value("lock_memory", cfg.lock_memory);
+  cfg.prefault_heap_bytes =
+      j.value("prefault_heap_mb", std::size_t{0}) * 1024 * 1024;
+  cfg.prefault_stack_bytes =
+      j.value("prefault_stack_kb", std::size_t{0}) * 1024;
+  cfg.huge_pages = parse_huge_pages(j.value("huge_pages", std::string("off")));
+  if (j.contains("threads")) {
+    for (const auto &[role, tj] : j["threads"].items()) {
+      ThreadTuning t;
+      t.cpus = tj.value("cpus", std::vector<int>{});
+      t.fifo_priority = tj.value("fifo_priority", 0);
+      cfg.threads[role] = std::move(t);
+    }
+  }
+  return cfg;
+}
+
+RuntimeTuning &RuntimeTuning::instance() {
+  static RuntimeTuning tuning;
+  return tuning;
+}
+
+HugePages RuntimeTuning::huge_pages() const {
+  std::lock_guard<std::mutex> lock(m);
+  return cfg.huge_pages;
+}
+
+void RuntimeTuning::configure(const RuntimeTuningConfig &c) {
+  {
+    std::lock_guard<std::mutex> lock(m);
+    cfg = c;
+  }
+
+  if (c.huge_pages == HugePages::Transparent) {
+    std::cout << "[TUNE] transparent huge pages: "
+              << read_first_line("/sys/kernel/mm/transparent_hugepage/enabled")
+              << std::endl;
+  } else if (c.huge_pages == HugePages::Explicit) {
+    std::cout << "[TUNE] reserved huge pages: "
+              << read_first_line("/proc/sys/vm/nr_hugepages") << std::endl;
+  }
+
+  if (c.prefault_heap_bytes > 0) {
+    prefault_heap(c.prefault_heap_bytes);
+  }
+
+  if (c.lock_memory) {
+    if (mlockall(MCL_CURRENT | MCL_FUTURE) == 0) {
+      std::cout << "[TUNE] memory locked" << std::endl;
+    } else {
+      std::cerr << "[TUNE] mlockall failed: " << std::strerror(errno)
+                << " (check RLIMIT_MEMLOCK / CAP_IPC_LOCK)" << std::endl;
+    }
+  }
+}
+
+void RuntimeTuning::tune_current_thread(const char *role) {
+  thread_local std::string tuned_as;
+  if (tuned_as == role)
+    return;
+  tuned_as = role;
+
+  ThreadTuning t;
+  std::size_t stack_bytes = 0;
+  {
+    std::lock_guard<std::mutex> lock(m);
+    auto it = cfg.threads.find(role);
+    if (it == cfg.threads.end())
+      return;
+    t = it->second;
+    stack_bytes = cfg.prefault_stack_bytes;
+  }
+
+  const pthread_t self = pthread_self();
+  char name[16];
+  std::snprintf(name, sizeof(name), "kmm-%s", role);
+  pthread_setname_np(self, name);
+
+  if (!t.cpus.empty()) {
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (int c : t.cpus) {
+      if (c >= 0 && c < CPU_SETSIZE)
+        CPU_SET(c, &set);
+    }
+    if (int rc = pthread_setaffinity_np(self, sizeof(set), &set)) {
+      std::cerr << "[TUNE] " << role
+                << ": affinity failed: " << std::strerror(rc) << std::endl;
+    }
+  }
+
+  if (t.fifo_priority > 0) {
+    sched_param sp{};
+    sp.sched_priority = t.fifo_priority;
+    if (int rc = pthread_setschedparam(self, SCHED_FIFO, &sp)) {
+      std::cerr << "[TUNE] " << role << ": SCHED_FIFO/" << t.fifo_priority
+                << " failed: " << std::strerror(rc)
+                << " (needs CAP_SYS_NICE or RLIMIT_RTPRIO)" << std::endl;
+    }
+  }
+
+  prefault_stack(stack_bytes);
+
+  std::cout << "[TUNE] " << role << ": cpus " << describe_affinity(self)
+            << " sched " << describe_sched(self) << std::endl;
+}
+
+void *alloc_hot_memory(std::size_t bytes) {
+  const std::size_t len = round_up(bytes, kHugePageSize);
+  const HugePages mode = RuntimeTuning::instance().huge_pages();
+
+  if (mode == HugePages::Explicit) {
+    void *p = mmap(nullptr, len, PROT_READ | PROT_WRITE,
+                   MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB | MAP_POPULATE,
+                   -1, 0);
+    if (p != MAP_FAILED)
+      return p;
+    std::cerr << "[TUNE] no reserved huge pages for " << (len >> 20)
+              << " MiB: " << std::strerror(errno) << "; using THP"
+              << std::endl;
+  }
+
+  // Over-map so the region can be trimmed to a 2 MiB boundary, which THP
+  // needs to back it with huge pages.
+  const std::size_t span = len + kHugePageSize;
+  void *raw = mmap(nullptr, span, PROT_READ | PROT_WRITE,
+                   MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (raw == MAP_FAILED)
+    throw std::bad_alloc();
+  const auto base = reinterpret_cast<std::uintptr_t>(raw);
+  const std::uintptr_t aligned = round_up(base, kHugePageSize);
+  if (aligned > base)
+    munmap(raw, aligned - base);
+  const std::uintptr_t end = base + span;
+  if (end > aligned + len)
+    munmap(reinterpret_cast<void *>(aligned + len), end - (aligned + len));
+
+  void *p = reinterpret_cast<void *>(aligned);
+  if (mode != HugePages::Off && madvise(p, len, MADV_HUGEPAGE) != 0) {
+    std::cerr << "[TUNE] MADV_HUGEPAGE failed: " << std::strerror(errno)
+              << std::endl;
+  }
+  // Fault every page now rather than on the first hot-path write.
+  for (std::size_t i = 0; i < len; i += 4096) {
+    static_cast<volatile char *>(p)[i] = 0;
+  }
+  return p;
+}
+
+void free_hot_memory(void *p, std::size_t bytes) {
+  if (p)
+    munmap(p, round_up(bytes, kHugePageSize));
+}
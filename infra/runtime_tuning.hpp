@@ -0,0 +1,95 @@
+#pragma once
+
+#include <cstddef>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <nlohmann/json.hpp>
+#include <string>
+#include <vector>
+
+enum class HugePages { Off, Transparent, Explicit };
+
+struct ThreadTuning {
+  std::vector<int> cpus; // empty leaves the affinity alone
+  int fifo_priority = 0; // 1-99 switches to SCHED_FIFO; 0 keeps SCHED_OTHER
+};
+
+struct RuntimeTuningConfig {
+  // Keyed by thread role: "main", "engine", "ws_recv", "reconnect",
+  // "subscriptions", "pool", "recorder", "monitor".
+  std::map<std::string, ThreadTuning> threads;
+  bool lock_memory = false;             // mlockall(MCL_CURRENT | MCL_FUTURE)
+  std::size_t prefault_heap_bytes = 0;  // touched once and kept by malloc
+  std::size_t prefault_stack_bytes = 0; // touched on every tuned thread
+  HugePages huge_pages = HugePages::Off;
+};
+
+// Reads the "tuning" section of runner.json.
+RuntimeTuningConfig runtime_tuning_from_json(const nlohmann::json &j);
+
+// Startup tuning for a latency-sensitive process. configure() runs once in
+// main before any thread starts; each thread then calls
+// tune_current_thread() with its role as its first action. Every step logs
+// what the kernel actually granted, since most of them can silently fall
+// short without privileges.
+class RuntimeTuning {
+public:
+  static RuntimeTuning &instance();
+
+  void configure(const RuntimeTuningConfig &cfg);
+
+  // Pins and prioritises the calling thread per its role and pre-faults its
+  // stack. Repeat calls with the same role on a thread do nothing, so it is
+  // safe from callbacks that fire on every reconnect.
+  void tune_current_thread(const char *role);
+
+  HugePages huge_pages() const;
+
+private:
+  RuntimeTuning() = default;
+  RuntimeTuning(const RuntimeTuning &) = delete;
+  RuntimeTuning &operator=(const RuntimeTuning &) = delete;
+
+  mutable std::mutex m;
+  RuntimeTuningConfig cfg;
+};
+
+constexpr std::size_t kHugePageSize = 2 * 1024 * 1024;
+
+// Pre-faulted anonymous memory for hot arenas and queues, 2 MiB aligned and
+// backed by huge pages as configured, falling back to normal pages.
+// `bytes` is rounded up to kHugePageSize; pass the same value to free.
+void *alloc_hot_memory(std::size_t bytes);
+void free_hot_memory(void *p, std::size_t bytes);
+
+// Allocator for large, long-lived containers (tables, rings). Requests
+// under one huge page go to operator new.
+template <typename T> struct HotAllocator {
+  using value_type = T;
+
+  HotAllocator() = default;
+  template <typename U> HotAllocator(const HotAllocator<U> &) {}
+
+  T *allocate(std::size_t n) {
+    const std::size_t bytes = n * sizeof(T);
+    if (bytes < kHugePageSize)
+      return std::allocator<T>().allocate(n);
+    return static_cast<T *>(alloc_hot_memory(bytes));
+  }
+
+  void deallocate(T *p, std::size_t n) {
+    const std::size_t bytes = n * sizeof(T);
+    if (bytes < kHugePageSize)
+      std::allocator<T>().deallocate(p, n);
+    else
+      free_hot_memory(p, bytes);
+  }
+
+  template <typename U> bool operator==(const HotAllocator<U> &) const {
+    return true;
+  }
+  template <typename U> bool operator!=(const HotAllocator<U> &) const {
+    return false;
+  }
+};
@@ -0,0 +1,70 @@
+#pragma once
+
+#include "runtime_tuning.hpp"
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+// Bounded single-producer single-consumer queue. Each side keeps a private
+// copy of the other side's index and only reloads it when the ring looks
+// full (producer) or empty (consumer), so the steady state touches no
+// shared cache line but the slot itself. Capacity is rounded up to a power
+// of two; slots come from HotAllocator, so large rings are pre-faulted.
+template <typename T> class SpscRing {
+public:
+  explicit SpscRing(std::size_t capacity) : slots(round_up_pow2(capacity)) {
+    mask = slots.size() - 1;
+  }
+
+  SpscRing(const SpscRing &) = delete;
+  SpscRing &operator=(const SpscRing &) = delete;
+
+  // Producer only. False if the ring is full.
+  bool try_push(const T &v) {
+    const std::size_t t = tail.load(std::memory_order_relaxed);
+    if (t - head_cache > mask) {
+      head_cache = head.load(std::memory_order_acquire);
+      if (t - head_cache > mask)
+        return false;
+    }
+    slots[t & mask] = v;
+    tail.store(t + 1, std::memory_order_release);
+    return true;
+  }
+
+  // Consumer only. False if the ring is empty.
+  bool try_pop(T &out) {
+    const std::size_t h = head.load(std::memory_order_relaxed);
+    if (h == tail_cache) {
+      tail_cache = tail.load(std::memory_order_acquire);
+      if (h == tail_cache)
+        return false;
+    }
+    out = slots[h & mask];
+    head.store(h + 1, std::memory_order_release);
+    return true;
+  }
+
+  // Approximate from any thread other than the two ends.
+  std::size_t size() const {
+    return tail.load(std::memory_order_acquire) -
+           head.load(std::memory_order_acquire);
+  }
+  std::size_t capacity() const { return slots.size(); }
+
+private:
+  static std::size_t round_up_pow2(std::size_t n) {
+    std::size_t p = 1;
+    while (p < n)
+      p <<= 1;
+    return p;
+  }
+
+  std::vector<T, HotAllocator<T>> slots;
+  std::size_t mask = 0;
+
+  alignas(64) std::atomic<std::size_t> head{0}; // next slot to pop
+  std::size_t tail_cache = 0;                   // consumer's view of tail
+  alignas(64) std::atomic<std::size_t> tail{0}; // next slot to push
+  std::size_t head_cache = 0;                   // producer's view of head
+};
@@ -0,0 +1,402 @@
+#include "state_checkpoint.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <fcntl.h>
+#include <iostream>
+#include <sys/mman.h>
+#include <unistd.h>
+
+namespace {
+
+constexpr std::uint64_t kMagic = 0x54504b434b4d4d4bULL; // "KMMKCKPT"
+constexpr std::uint32_t kVersion = 3;
+constexpr int kPriceLevels = 101; // index = price in cents
+constexpr int kNoMark = -1;
+
+std::uint64_t fnv1a(std::uint64_t h, const void *data, std::size_t n) {
+  const auto *p = static_cast<const unsigned char *>(data);
+  for (std::size_t i = 0; i < n; ++i) {
+    h ^= p[i];
+    h *= 1099511628211ull;
+  }
+  return h;
+}
+
+std::uint64_t image_checksum(std::uint64_t count, std::uint64_t journal,
+                             std::int64_t written_ns, const void *recs,
+                             std::size_t record_bytes) {
+  std::uint64_t h = 14695981039346656037ull;
+  h = fnv1a(h, &count, sizeof(count));
+  h = fnv1a(h, &journal, sizeof(journal));
+  h = fnv1a(h, &written_ns, sizeof(written_ns));
+  return fnv1a(h, recs, record_bytes);
+}
+
+} // namespace
+
+struct StateCheckpoint::Header {
+  std::uint64_t magic;
+  std::uint32_t version;
+  std::uint32_t record_size;
+  std::uint64_t max_markets;
+  std::atomic<std::uint64_t> epoch; // 0 = nothing written yet
+};
+
+// begin/end bracket the records so a slot a crash interrupted is
+// detectable on restore; the checksum catches one whose pages did not all
+// reach the disk.
+struct StateCheckpoint::SlotHeader {
+  std::atomic<std::uint64_t> begin_epoch;
+  std::atomic<std::uint64_t> end_epoch;
+  std::uint64_t count;
+  std::uint64_t journal_records;
+  std::int64_t written_ns;
+  std::uint64_t checksum; // of the fields above after end_epoch, and records
+};
+
+struct StateCheckpoint::Record {
+  char ticker[64];
+  std::int32_t yes_pos;
+  std::int32_t no_pos;
+  std::int32_t vwap_yes_cents;
+  std::int32_t vwap_no_cents;
+  std::int64_t cash_cents;
+  std::int64_t realized_pnl_cents;
+  std::int32_t yes_mark_cents;
+  std::int32_t no_mark_cents;
+  std::int64_t last_ts;
+  std::uint8_t has_ledger;
+  std::uint8_t has_book;
+  std::uint8_t pad[6];
+  std::int32_t yes_levels[kPriceLevels];
+  std::int32_t no_levels[kPriceLevels];
+};
+
+StateCheckpoint::StateCheckpoint(CheckpointConfig c)
+    : cfg(std::move(c)), staging(cfg.max_markets) {
+  // Sized up front so write() only allocates for a market's key.
+  record_index.reserve(cfg.max_markets);
+}
+
+StateCheckpoint::~StateCheckpoint() {
+  stop();
+  if (base) {
+    msync(base, mapped, MS_ASYNC);
+    munmap(base, mapped);
+  }
+}
+
+std::size_t StateCheckpoint::slot_bytes() const {
+  return sizeof(SlotHeader) + cfg.max_markets * sizeof(Record);
+}
+
+std::size_t StateCheckpoint::file_bytes() const {
+  return sizeof(Header) + 2 * slot_bytes();
+}
+
+StateCheckpoint::SlotHeader *StateCheckpoint::slot(std::size_t i) const {
+  return reinterpret_cast<SlotHeader *>(base + sizeof(Header) +
+                                        i * slot_bytes());
+}
+
+StateCheckpoint::Record *StateCheckpoint::records(std::size_t i) const {
+  return reinterpret_cast<Record *>(reinterpret_cast<unsigned char *>(slot(i)) +
+                                    sizeof(SlotHeader));
+}
+
+bool StateCheckpoint::open() {
+  int fd = ::open(cfg.path.c_str(), O_RDWR | O_CREAT, 0644);
+  if (fd < 0) {
+    std::cerr << "checkpoint: cannot open " << cfg.path << ": "
+              << std::strerror(errno) << std::endl;
+    return false;
+  }
+
+  mapped = file_bytes();
+  if (ftruncate(fd, static_cast<off_t>(mapped)) != 0) {
+    std::cerr << "checkpoint: cannot size " << cfg.path << ": "
+              << std::strerror(errno) << std::endl;
+    ::close(fd);
+    return false;
+  }
+
+  void *addr =
+      mmap(nullptr, mapped, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  ::close(fd);
+  if (addr == MAP_FAILED) {
+    std::cerr << "checkpoint: mmap failed for " << cfg.path << ": "
+              << std::strerror(errno) << std::endl;
+    return false;
+  }
+  base = static_cast<unsigned char *>(addr);
+
+  auto *h = reinterpret_cast<Header *>(base);
+  if (h->magic != kMagic || h->version != kVersion ||
+      h->record_size != sizeof(Record) || h->max_markets != cfg.max_markets) {
+    init_header();
+  }
+  return true;
+}
+
+void StateCheckpoint::init_header() {
+  std::memset(base, 0, mapped);
+  auto *h = reinterpret_cast<Header *>(base);
+  h->version = kVersion;
+  h->record_size = sizeof(Record);
+  h->max_markets = cfg.max_markets;
+  h->epoch.store(0, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  h->magic = kMagic;
+}
+
+std::uint64_t StateCheckpoint::epoch() const {
+  if (!base)
+    return 0;
+  return reinterpret_cast<Header *>(base)->epoch.load(
+      std::memory_order_acquire);
+}
+
+void StateCheckpoint::start() {
+  {
+    std::lock_guard<std::mutex> lock(m);
+    if (running || !base)
+      return;
+    running = true;
+  }
+  writer = std::thread(&StateCheckpoint::writer_loop, this);
+}
+
+void StateCheckpoint::stop() {
+  {
+    std::lock_guard<std::mutex> lock(m);
+    running = false;
+  }
+  cv.notify_all();
+  if (writer.joinable())
+    writer.join();
+}
+
+void StateCheckpoint::writer_loop() {
+  std::unique_lock<std::mutex> lock(m);
+  while (true) {
+    cv.wait(lock, [&] { return pending.load() || !running; });
+    if (pending.load()) {
+      lock.unlock();
+      commit();
+      lock.lock();
+      pending.store(false, std::memory_order_release);
+    } else if (!running) {
+      break;
+    }
+  }
+}
+
+bool StateCheckpoint::write(const PositionManager &positions,
+                            const KalshiOrderBookManager &books,
+                            std::uint64_t journal_records) {
+  if (!base || pending.load(std::memory_order_acquire))
+    return false;
+
+  // Record positions are stable across writes; the map only allocates when
+  // a market is seen for the first time.
+  Record *recs = staging.data();
+  const std::size_t n = record_index.size();
+  for (std::size_t i = 0; i < n; ++i) {
+    recs[i].has_ledger = 0;
+    recs[i].has_book = 0;
+  }
+  std::size_t written = n;
+  auto find_or_add = [&](const std::string &ticker) -> Record * {
+    auto it = record_index.find(ticker);
+    if (it == record_index.end()) {
+      if (written == cfg.max_markets ||
+          ticker.size() >= sizeof(Record::ticker))
+        return nullptr;
+      it = record_index.emplace(ticker, written++).first;
+    }
+    Record *r = &recs[it->second];
+    if (!r->has_ledger && !r->has_book) {
+      std::memset(r, 0, sizeof(Record));
+      std::memcpy(r->ticker, ticker.data(), ticker.size());
+      r->yes_mark_cents = kNoMark;
+      r->no_mark_cents = kNoMark;
+    }
+    return r;
+  };
+
+  // Ledgers first: they are what matters on restart, so when the file is
+  // full the surplus books are the ones that get dropped.
+  positions.for_each_ledger([&](const TickerPositionLedger &ledger) {
+    Record *r = find_or_add(ledger.ticker());
+    if (!r)
+      return;
+    const LedgerState s = ledger.state();
+    r->has_ledger = 1;
+    r->yes_pos = s.yes_pos;
+    r->no_pos = s.no_pos;
+    r->vwap_yes_cents = s.vwap_yes_cents;
+    r->vwap_no_cents = s.vwap_no_cents;
+    r->cash_cents = s.cash_cents;
+    r->realized_pnl_cents = s.realized_pnl_cents;
+    r->yes_mark_cents = s.yes_mark_cents.value_or(kNoMark);
+    r->no_mark_cents = s.no_mark_cents.value_or(kNoMark);
+    r->last_ts = s.last_ts;
+  });
+
+  books.for_each_book([&](const KalshiOrderBook &kb) {
+    if (!kb.has_snapshot)
+      return;
+    Record *r = find_or_add(kb.ticker);
+    if (!r)
+      return;
+    r->has_book = 1;
+    std::memset(r->yes_levels, 0, sizeof(r->yes_levels));
+    std::memset(r->no_levels, 0, sizeof(r->no_levels));
+    for (const auto &[price, vol] : kb.book.bids(Side::YES)) {
+      if (price > 0 && price < kPriceLevels)
+        r->yes_levels[price] = vol;
+    }
+    for (const auto &[price, vol] : kb.book.bids(Side::NO)) {
+      if (price > 0 && price < kPriceLevels)
+        r->no_levels[price] = vol;
+    }
+  });
+  staged_count = written;
+  staged_journal = journal_records;
+
+  bool threaded;
+  {
+    std::lock_guard<std::mutex> lock(m);
+    threaded = running;
+    if (threaded)
+      pending.store(true, std::memory_order_release);
+  }
+  if (threaded) {
+    cv.notify_one();
+  } else {
+    commit();
+  }
+  return true;
+}
+
+// Copies the staged image into the free slot, syncs it, and only then
+// points the epoch at it.
+void StateCheckpoint::commit() {
+  auto *h = reinterpret_cast<Header *>(base);
+  const std::uint64_t next = h->epoch.load(std::memory_order_relaxed) + 1;
+  const std::size_t si = next & 1;
+  SlotHeader *sh = slot(si);
+
+  sh->begin_epoch.store(next, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  const std::size_t bytes = staged_count * sizeof(Record);
+  std::memcpy(records(si), staging.data(), bytes);
+  sh->count = staged_count;
+  sh->journal_records = staged_journal;
+  sh->written_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                       std::chrono::system_clock::now().time_since_epoch())
+                       .count();
+  sh->checksum = image_checksum(sh->count, sh->journal_records,
+                                sh->written_ns, records(si), bytes);
+  sh->end_epoch.store(next, std::memory_order_release);
+
+  static const std::size_t page =
+      static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+  const std::size_t from =
+      (reinterpret_cast<unsigned char *>(sh) - base) & ~(page - 1);
+  const std::size_t to = static_cast<std::size_t>(
+      reinterpret_cast<unsigned char *>(records(si)) + bytes - base);
+  if (msync(base + from, to - from, MS_SYNC) != 0) {
+    std::cerr << "checkpoint: msync failed for " << cfg.path << ": "
+              << std::strerror(errno) << std::endl;
+    return;
+  }
+  h->epoch.store(next, std::memory_order_release);
+  if (msync(base, page, MS_SYNC) != 0) {
+    std::cerr << "checkpoint: msync failed for " << cfg.path << ": "
+              << std::strerror(errno) << std::endl;
+    return;
+  }
+  if (on_durable)
+    on_durable(staged_journal);
+}
+
+const StateCheckpoint::SlotHeader *
+StateCheckpoint::latest_complete_slot(std::size_t *index) const {
+  if (!base)
+    return nullptr;
+
+  const std::uint64_t e = epoch();
+  // Fall back to the older slot if the newest one is torn.
+  for (std::uint64_t candidate : {e, e - 1}) {
+    if (candidate == 0 || candidate > e)
+      continue;
+    const std::size_t si = candidate & 1;
+    const SlotHeader *sh = slot(si);
+    if (sh->begin_epoch.load(std::memory_order_acquire) != candidate ||
+        sh->end_epoch.load(std::memory_order_acquire) != candidate ||
+        sh->count > cfg.max_markets ||
+        sh->checksum != image_checksum(sh->count, sh->journal_records,
+                                       sh->written_ns, records(si),
+                                       sh->count * sizeof(Record)))
+      continue;
+    *index = si;
+    return sh;
+  }
+  return nullptr;
+}
+
+std::uint64_t StateCheckpoint::journal_records() const {
+  std::size_t si = 0;
+  const SlotHeader *sh = latest_complete_slot(&si);
+  return sh ? sh->journal_records : 0;
+}
+
+bool StateCheckpoint::restore(PositionManager &positions,
+                              KalshiOrderBookManager &books) const {
+  std::size_t si = 0;
+  const SlotHeader *sh = latest_complete_slot(&si);
+  if (!sh)
+    return false;
+
+  const Record *recs = records(si);
+  const std::size_t n = std::min<std::uint64_t>(sh->count, cfg.max_markets);
+  std::vector<std::pair<int, int>> yes, no;
+  for (std::size_t i = 0; i < n; ++i) {
+    const Record &r = recs[i];
+    const std::string ticker(r.ticker, strnlen(r.ticker, sizeof(r.ticker)));
+
+    if (r.has_ledger) {
+      LedgerState s;
+      s.yes_pos = r.yes_pos;
+      s.no_pos = r.no_pos;
+      s.vwap_yes_cents = r.vwap_yes_cents;
+      s.vwap_no_cents = r.vwap_no_cents;
+      s.cash_cents = r.cash_cents;
+      s.realized_pnl_cents = r.realized_pnl_cents;
+      if (r.yes_mark_cents != kNoMark)
+        s.yes_mark_cents = r.yes_mark_cents;
+      if (r.no_mark_cents != kNoMark)
+        s.no_mark_cents = r.no_mark_cents;
+      s.last_ts = r.last_ts;
+      positions.restore_ledger(ticker, s);
+    }
+
+    if (r.has_book) {
+      yes.clear();
+      no.clear();
+      for (int px = 1; px < kPriceLevels; ++px) {
+        if (r.yes_levels[px] > 0)
+          yes.emplace_back(px, r.yes_levels[px]);
+        if (r.no_levels[px] > 0)
+          no.emplace_back(px, r.no_levels[px]);
+      }
+      books.seed_book(ticker, yes, no);
+    }
+  }
+  return true;
+}
@@ -0,0 +1,102 @@
+#pragma once
+
+#include "protocols/kalshi/kalshi_order_book_manager.hpp"
+#include "strategy/positions/position_manager.hpp"
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+struct CheckpointConfig {
+  std::string path;
+  std::size_t max_markets = 1024;
+};
+
+// Warm-start state in a memory-mapped file. The file holds two slots; each
+// write fills the slot the current epoch is not using and only then bumps
+// the epoch, so a crash mid-write always leaves the previous checkpoint
+// intact. Each slot carries a checksum of its image, so a slot the kernel
+// only partly wrote out before a power loss is rejected too.
+//
+// write() only copies the state into an in-memory image. Once start()ed, a
+// background thread moves that image into the file and syncs it, so the
+// engine thread never touches the disk.
+class StateCheckpoint {
+public:
+  // Called on the writer thread once a checkpoint is on disk, with the
+  // journal size it covers.
+  using DurableHandler = std::function<void(std::uint64_t journal_records)>;
+
+  explicit StateCheckpoint(CheckpointConfig cfg);
+  ~StateCheckpoint();
+
+  StateCheckpoint(const StateCheckpoint &) = delete;
+  StateCheckpoint &operator=(const StateCheckpoint &) = delete;
+
+  // Maps the file, creating and sizing it if needed. A file written with a
+  // different layout is reinitialised.
+  bool open();
+
+  // Set before start().
+  void set_durable_handler(DurableHandler h) { on_durable = std::move(h); }
+
+  void start();
+  // Writes out the image write() last handed over, then joins the thread.
+  void stop();
+
+  // Engine thread, between events. `journal_records` is the fill journal
+  // size the ledgers reflect, so recovery only replays fills after it.
+  // Returns false, copying nothing, while the previous image is still
+  // being written. Without start() the image is written out before this
+  // returns.
+  bool write(const PositionManager &positions,
+             const KalshiOrderBookManager &books,
+             std::uint64_t journal_records = 0);
+
+  // Returns false if the file holds no complete checkpoint.
+  bool restore(PositionManager &positions,
+               KalshiOrderBookManager &books) const;
+
+  std::uint64_t epoch() const;
+
+  // Journal size recorded with the checkpoint restore() would load.
+  std::uint64_t journal_records() const;
+
+private:
+  struct Header;
+  struct SlotHeader;
+  struct Record;
+
+  const SlotHeader *latest_complete_slot(std::size_t *index) const;
+  SlotHeader *slot(std::size_t i) const;
+  Record *records(std::size_t i) const;
+  std::size_t slot_bytes() const;
+  std::size_t file_bytes() const;
+  void init_header();
+  void commit();
+  void writer_loop();
+
+  CheckpointConfig cfg;
+  unsigned char *base = nullptr;
+  std::size_t mapped = 0;
+
+  // The image write() fills, and what goes with it. Engine thread only
+  // while `pending` is false; writer thread only while it is true.
+  std::vector<Record> staging;
+  std::unordered_map<std::string, std::size_t> record_index;
+  std::size_t staged_count = 0;
+  std::uint64_t staged_journal = 0;
+  std::atomic<bool> pending{false};
+
+  DurableHandler on_durable;
+  std::thread writer;
+  std::mutex m;
+  std::condition_variable cv;
+  bool running = false;
+};
@@ -0,0 +1,385 @@
+#include "subscription_manager.hpp"
+
+#include "metrics.hpp"
+#include <algorithm>
+#include <iostream>
+
+namespace {
+
+// The sid a "subscribed" ack assigns, or 0 if the frame does not carry one.
+std::int64_t acked_sid(const nlohmann::json &j) {
+  const auto it = j.find("msg");
+  if (it == j.end() || !it->is_object())
+    return 0;
+  const auto sid = it->find("sid");
+  return sid != it->end() && sid->is_number_integer()
+             ? sid->get<std::int64_t>()
+             : 0;
+}
+
+} // namespace
+
+SubscriptionManager::SubscriptionManager(SubscriptionConfig c)
+    : cfg(c), tokens(static_cast<double>(c.burst)),
+      last_refill(Clock::now()) {}
+
+std::size_t SubscriptionManager::new_batch(const std::string &channel,
+                                           bool market_filtered) {
+  Batch b;
+  b.channel = channel;
+  b.market_filtered = market_filtered;
+  batches.push_back(std::move(b));
+  const std::size_t idx = batches.size() - 1;
+  channel_batches[channel].push_back(idx);
+  queue.push_back(Op{OpKind::Subscribe, idx, {}, 0});
+  return idx;
+}
+
+void SubscriptionManager::subscribe(const std::string &channel,
+                                    const nlohmann::json &params) {
+  std::lock_guard<std::mutex> lock(m);
+  for (std::size_t b : channel_batches[channel]) {
+    if (!batches[b].market_filtered && !batches[b].removed)
+      return;
+  }
+  const std::size_t b = new_batch(channel, false);
+  batches[b].params = json_fragments(params);
+}
+
+void SubscriptionManager::unsubscribe(const std::string &channel) {
+  std::lock_guard<std::mutex> lock(m);
+  auto it = channel_batches.find(channel);
+  if (it == channel_batches.end())
+    return;
+  for (std::size_t b : it->second) {
+    Batch &batch = batches[b];
+    if (batch.removed)
+      continue;
+    batch.removed = true;
+    if (batch.state != BatchState::Unsent)
+      queue.push_back(Op{OpKind::Unsubscribe, b, {}, 0});
+  }
+  channel_batches.erase(it);
+  market_batch.erase(channel);
+}
+
+void SubscriptionManager::add_markets(const std::string &channel,
+                                      const std::vector<std::string> &tickers) {
+  std::lock_guard<std::mutex> lock(m);
+  auto &index = market_batch[channel];
+  auto &owned = channel_batches[channel];
+
+  std::unordered_map<std::size_t, std::vector<std::string>> additions;
+  std::size_t open = SIZE_MAX;
+  for (const auto &t : tickers) {
+    if (index.count(t))
+      continue;
+
+    if (open == SIZE_MAX || batches[open].tickers.size() >= cfg.batch_size) {
+      open = SIZE_MAX;
+      for (auto rit = owned.rbegin(); rit != owned.rend(); ++rit) {
+        const Batch &b = batches[*rit];
+        if (b.market_filtered && !b.removed &&
+            b.tickers.size() < cfg.batch_size) {
+          open = *rit;
+          break;
+        }
+      }
+      if (open == SIZE_MAX)
+        open = new_batch(channel, true);
+    }
+
+    Batch &b = batches[open];
+    b.tickers.push_back(t);
+    index.emplace(t, open);
+    // Batches not yet sent pick the ticker up with their subscribe command.
+    if (b.state != BatchState::Unsent)
+      additions[open].push_back(t);
+  }
+
+  for (auto &[b, ts] : additions) {
+    queue.push_back(Op{OpKind::AddMarkets, b, std::move(ts), 0});
+  }
+}
+
+void SubscriptionManager::remove_markets(
+    const std::string &channel, const std::vector<std::string> &tickers) {
+  std::lock_guard<std::mutex> lock(m);
+  auto cit = market_batch.find(channel);
+  if (cit == market_batch.end())
+    return;
+  auto &index = cit->second;
+
+  std::unordered_map<std::size_t, std::vector<std::string>> removals;
+  for (const auto &t : tickers) {
+    auto it = index.find(t);
+    if (it == index.end())
+      continue;
+    Batch &b = batches[it->second];
+    b.tickers.erase(std::remove(b.tickers.begin(), b.tickers.end(), t),
+                    b.tickers.end());
+    if (b.state != BatchState::Unsent)
+      removals[it->second].push_back(t);
+    if (b.tickers.empty() && b.state == BatchState::Unsent)
+      b.removed = true;
+    index.erase(it);
+  }
+
+  for (auto &[b, ts] : removals) {
+    Batch &batch = batches[b];
+    if (batch.tickers.empty()) {
+      batch.removed = true;
+      queue.push_back(Op{OpKind::Unsubscribe, b, {}, 0});
+    } else {
+      queue.push_back(Op{OpKind::DeleteMarkets, b, std::move(ts), 0});
+    }
+  }
+}
+
+void SubscriptionManager::resync_market(const std::string &channel,
+                                        const std::string &ticker) {
+  std::lock_guard<std::mutex> lock(m);
+  auto cit = market_batch.find(channel);
+  if (cit == market_batch.end())
+    return;
+  auto it = cit->second.find(ticker);
+  if (it == cit->second.end())
+    return;
+  const std::size_t b = it->second;
+  if (batches[b].state == BatchState::Unsent)
+    return;
+  queue.push_back(Op{OpKind::DeleteMarkets, b, {ticker}, 0});
+  queue.push_back(Op{OpKind::AddMarkets, b, {ticker}, 0});
+}
+
+void SubscriptionManager::on_connected() {
+  std::lock_guard<std::mutex> lock(m);
+  queue.clear();
+  in_flight.clear();
+  timed_out.clear();
+  rejected.clear();
+  for (std::size_t i = 0; i < batches.size(); ++i) {
+    Batch &b = batches[i];
+    b.state = BatchState::Unsent;
+    b.sid = 0;
+    if (!b.removed)
+      queue.push_back(Op{OpKind::Subscribe, i, {}, 0});
+  }
+}
+
+bool SubscriptionManager::ready(const Op &op) const {
+  const Batch &b = batches[op.batch];
+  switch (op.kind) {
+  case OpKind::Subscribe:
+    return b.state == BatchState::Unsent;
+  case OpKind::Unsubscribe:
+    return op.sid != 0 || b.state == BatchState::Active;
+  case OpKind::AddMarkets:
+  case OpKind::DeleteMarkets:
+    return b.state == BatchState::Active;
+  }
+  return false;
+}
+
+void SubscriptionManager::encode(const Op &op, std::int64_t id,
+                                 std::string &out) const {
+  const Batch &b = batches[op.batch];
+  switch (op.kind) {
+  case OpKind::Subscribe:
+    if (b.market_filtered) {
+      encode_subscribe(out, id, b.channel, b.params, &b.tickers);
+    } else {
+      encode_subscribe(out, id, b.channel, b.params);
+    }
+    break;
+  case OpKind::AddMarkets:
+  case OpKind::DeleteMarkets:
+    encode_update_subscription(out, id, b.sid, op.kind == OpKind::AddMarkets,
+                               op.tickers);
+    break;
+  case OpKind::Unsubscribe:
+    encode_unsubscribe(out, id, op.sid ? op.sid : b.sid);
+    break;
+  }
+}
+
+void SubscriptionManager::refill(Clock::time_point now) {
+  const double elapsed =
+      std::chrono::duration<double>(now - last_refill).count();
+  last_refill = now;
+  tokens = std::min(static_cast<double>(cfg.burst),
+                    tokens + elapsed * cfg.max_commands_per_sec);
+}
+
+SubscriptionManager::Clock::time_point
+SubscriptionManager::pump(Clock::time_point now, const Send &send) {
+  std::lock_guard<std::mutex> lock(m);
+  refill(now);
+
+  for (auto it = in_flight.begin(); it != in_flight.end();) {
+    if (now - it->second.sent_at < cfg.ack_timeout) {
+      ++it;
+      continue;
+    }
+    Op op = std::move(it->second.op);
+    std::cerr << "No ack for subscription command " << it->first
+              << ", resending" << std::endl;
+    if (op.kind == OpKind::Subscribe)
+      batches[op.batch].state = BatchState::Unsent;
+    timed_out.emplace(it->first, TimedOut{op.kind, op.batch});
+    queue.push_front(std::move(op));
+    it = in_flight.erase(it);
+  }
+
+  for (Op &op : rejected) {
+    auto delay = cfg.retry_initial;
+    for (int i = 1; i < op.failures && delay < cfg.retry_max; ++i) {
+      delay *= 2;
+    }
+    op.not_before = now + std::min(delay, cfg.retry_max);
+    queue.push_back(std::move(op));
+  }
+  rejected.clear();
+
+  auto next = Clock::time_point::max();
+  bool blocked = false;
+  for (auto it = queue.begin(); it != queue.end();) {
+    const Batch &b = batches[it->batch];
+    if (b.removed && it->kind != OpKind::Unsubscribe) {
+      it = queue.erase(it);
+      continue;
+    }
+    if (it->not_before > now) {
+      next = std::min(next, it->not_before);
+      ++it;
+      continue;
+    }
+    if (!ready(*it)) {
+      // Waiting on a sid; the ack handler wakes the caller.
+      ++it;
+      continue;
+    }
+    if (tokens < 1.0) {
+      blocked = true;
+      break;
+    }
+
+    const std::int64_t id = next_id++;
+    encode(*it, id, send_buf);
+    if (!send(send_buf)) {
+      blocked = true;
+      break;
+    }
+    metric_inc(Counter::WsSubscriptionCommands);
+    tokens -= 1.0;
+    if (it->kind == OpKind::Subscribe)
+      batches[it->batch].state = BatchState::Pending;
+    in_flight.emplace(id, InFlight{std::move(*it), now});
+    it = queue.erase(it);
+  }
+
+  if (blocked) {
+    const double wait = (1.0 - std::min(tokens, 1.0)) /
+                        std::max(cfg.max_commands_per_sec, 1e-3);
+    next = std::min(
+        next, now + std::chrono::duration_cast<Clock::duration>(
+                        std::chrono::duration<double>(std::max(wait, 1e-3))));
+  }
+  for (const auto &[_, f] : in_flight) {
+    next = std::min(next, f.sent_at + cfg.ack_timeout);
+  }
+  return next;
+}
+
+bool SubscriptionManager::on_control_message(std::string_view raw) {
+  // Runs on the socket's receive thread, so nothing here may throw: every
+  // field is type-checked before it is read.
+  const nlohmann::json j = nlohmann::json::parse(raw, nullptr, false);
+  if (j.is_discarded() || !j.is_object())
+    return false;
+  const auto type_it = j.find("type");
+  if (type_it == j.end() || !type_it->is_string())
+    return false;
+  const auto &type = type_it->get_ref<const std::string &>();
+  if (type != "subscribed" && type != "ok" && type != "unsubscribed" &&
+      type != "error")
+    return false;
+
+  std::lock_guard<std::mutex> lock(m);
+  const auto id_it = j.find("id");
+  if (id_it == j.end() || !id_it->is_number_integer())
+    return true;
+  const auto id = id_it->get<std::int64_t>();
+  auto it = in_flight.find(id);
+  if (it == in_flight.end()) {
+    // A late ack for a command already resent: its sid duplicates the one
+    // the resend brings, so drop it.
+    auto late = timed_out.find(id);
+    if (late == timed_out.end())
+      return true;
+    if (type == "subscribed" && late->second.kind == OpKind::Subscribe) {
+      const auto sid = acked_sid(j);
+      if (sid) {
+        std::cerr << "Late ack for subscription command " << id
+                  << "; unsubscribing duplicate sid " << sid << std::endl;
+        queue.push_back(Op{OpKind::Unsubscribe, late->second.batch, {}, sid});
+      }
+    }
+    timed_out.erase(late);
+    return true;
+  }
+
+  Op &op = it->second.op;
+  Batch &b = batches[op.batch];
+  if (type == "error") {
+    metric_inc(Counter::WsSubscriptionErrors);
+    std::cerr << "Subscription command " << it->first
+              << " failed: " << j.value("msg", nlohmann::json::object()).dump()
+              << std::endl;
+    if (op.kind == OpKind::Subscribe)
+      b.state = BatchState::Unsent;
+    // Retried with backoff; ops queued behind a subscribe wait for it. A
+    // rejected unsubscribe has nothing left to undo.
+    if (op.kind != OpKind::Unsubscribe) {
+      ++op.failures;
+      rejected.push_back(std::move(op));
+    }
+  } else if (type == "subscribed" && op.kind == OpKind::Subscribe) {
+    b.sid = acked_sid(j);
+    b.state = BatchState::Active;
+  } else if (op.kind == OpKind::Unsubscribe && op.sid == 0) {
+    b.state = BatchState::Unsent;
+    b.sid = 0;
+  }
+  in_flight.erase(it);
+  return true;
+}
+
+std::vector<std::string> SubscriptionManager::channels() const {
+  std::lock_guard<std::mutex> lock(m);
+  std::vector<std::string> out;
+  out.reserve(channel_batches.size());
+  for (const auto &[channel, _] : channel_batches) {
+    out.push_back(channel);
+  }
+  return out;
+}
+
+std::vector<std::string>
+SubscriptionManager::markets(const std::string &channel) const {
+  std::lock_guard<std::mutex> lock(m);
+  std::vector<std::string> out;
+  auto it = market_batch.find(channel);
+  if (it == market_batch.end())
+    return out;
+  out.reserve(it->second.size());
+  for (const auto &[ticker, _] : it->second) {
+    out.push_back(ticker);
+  }
+  return out;
+}
+
+std::size_t SubscriptionManager::pending_acks() const {
+  std::lock_guard<std::mutex> lock(m);
+  return in_flight.size();
+}
@@ -0,0 +1,130 @@
+#pragma once
+
+#include "protocols/kalshi/kalshi_commands.hpp"
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <nlohmann/json.hpp>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+struct SubscriptionConfig {
+  std::size_t batch_size = 500;       // market_tickers per subscribe command
+  double max_commands_per_sec = 10.0; // sustained send rate
+  std::size_t burst = 5;              // commands that may go out back-to-back
+  std::chrono::milliseconds ack_timeout{5000};
+  // A command the server rejects is retried after retry_initial, doubling
+  // with each rejection up to retry_max.
+  std::chrono::milliseconds retry_initial{500};
+  std::chrono::milliseconds retry_max{30000};
+};
+
+// Tracks what the feed should be subscribed to and turns it into paced
+// commands. Market tickers are packed into batches of `batch_size`, one
+// subscribe command (and one sid) per batch. Runtime adds and removes go out
+// as update_subscription commands against the batch's sid, so nothing else is
+// resent. After a reconnect every batch is replayed through the same pacer.
+class SubscriptionManager {
+public:
+  using Clock = std::chrono::steady_clock;
+  using Send = std::function<bool(const std::string &)>;
+
+  explicit SubscriptionManager(SubscriptionConfig cfg = {});
+
+  // Channel-wide subscription without a market filter (e.g. "fill").
+  void subscribe(const std::string &channel,
+                 const nlohmann::json &params = nlohmann::json::object());
+  void unsubscribe(const std::string &channel);
+
+  void add_markets(const std::string &channel,
+                   const std::vector<std::string> &tickers);
+  void remove_markets(const std::string &channel,
+                      const std::vector<std::string> &tickers);
+
+  // Asks for a fresh snapshot of one market by removing it from its batch's
+  // subscription and adding it back. Membership is unchanged; a batch not
+  // yet subscribed needs nothing, as its subscribe brings the snapshot.
+  void resync_market(const std::string &channel, const std::string &ticker);
+
+  // Forget server-side state and queue every batch for resubscription.
+  void on_connected();
+
+  // Sends what the pacer allows. Returns when there will next be something
+  // to do (Clock::time_point::max() if idle).
+  Clock::time_point pump(Clock::time_point now, const Send &send);
+
+  // Consumes subscribed/ok/unsubscribed/error responses. Returns false for
+  // anything else.
+  bool on_control_message(std::string_view raw);
+
+  std::vector<std::string> channels() const;
+  std::vector<std::string> markets(const std::string &channel) const;
+  std::size_t pending_acks() const;
+
+private:
+  enum class BatchState { Unsent, Pending, Active };
+
+  struct Batch {
+    std::string channel;
+    // Extra params for channel-wide subscriptions, rendered once.
+    std::vector<JsonFragment> params;
+    std::vector<std::string> tickers;
+    bool market_filtered = true;
+    BatchState state = BatchState::Unsent;
+    std::int64_t sid = 0;
+    bool removed = false;
+  };
+
+  enum class OpKind { Subscribe, AddMarkets, DeleteMarkets, Unsubscribe };
+
+  struct Op {
+    OpKind kind;
+    std::size_t batch;
+    std::vector<std::string> tickers; // Add/DeleteMarkets only
+    // Unsubscribe only: a stray sid to drop instead of the batch's own.
+    std::int64_t sid = 0;
+    int failures = 0; // error acks so far
+    Clock::time_point not_before{};
+  };
+
+  struct InFlight {
+    Op op;
+    Clock::time_point sent_at;
+  };
+
+  // A command resent after its ack timed out; a late ack may still come.
+  struct TimedOut {
+    OpKind kind;
+    std::size_t batch;
+  };
+
+  std::size_t new_batch(const std::string &channel, bool market_filtered);
+  bool ready(const Op &op) const;
+  // Writes the command into `out`, reusing its storage.
+  void encode(const Op &op, std::int64_t id, std::string &out) const;
+  void refill(Clock::time_point now);
+
+  SubscriptionConfig cfg;
+  mutable std::mutex m;
+
+  std::vector<Batch> batches;
+  std::unordered_map<std::string, std::vector<std::size_t>> channel_batches;
+  // channel -> ticker -> batch index
+  std::unordered_map<std::string, std::unordered_map<std::string, std::size_t>>
+      market_batch;
+
+  std::deque<Op> queue;
+  std::unordered_map<std::int64_t, InFlight> in_flight;
+  std::unordered_map<std::int64_t, TimedOut> timed_out; // until reconnect
+  std::vector<Op> rejected; // re-queued with backoff by the next pump()
+  std::int64_t next_id = 1;
+  std::string send_buf;
+
+  double tokens;
+  Clock::time_point last_refill;
+};
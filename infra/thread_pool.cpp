@@ -0,0 +1,97 @@
+#include "thread_pool.hpp"
+#include "runtime_tuning.hpp"
+
+ThreadPool::ThreadPool(std::size_t threads) {
+  if (threads == 0)
+    threads = 1;
+  queues.reserve(threads);
+  for (std::size_t i = 0; i < threads; ++i) {
+    queues.push_back(std::make_unique<Queue>());
+  }
+  workers.reserve(threads);
+  for (std::size_t i = 0; i < threads; ++i) {
+    workers.emplace_back(&ThreadPool::worker_loop, this, i);
+  }
+}
+
+ThreadPool::~ThreadPool() {
+  {
+    std::lock_guard<std::mutex> lock(m);
+    running = false;
+  }
+  work_cv.notify_all();
+  for (auto &t : workers) {
+    t.join();
+  }
+}
+
+void ThreadPool::submit(Task task) {
+  const std::size_t q =
+      next_queue.fetch_add(1, std::memory_order_relaxed) % queues.size();
+  // Counted before it becomes visible so a worker can never pick it up
+  // and decrement first.
+  {
+    std::lock_guard<std::mutex> lock(m);
+    ++pending;
+    ++queued;
+  }
+  {
+    std::lock_guard<std::mutex> lock(queues[q]->m);
+    queues[q]->tasks.push_back(std::move(task));
+  }
+  work_cv.notify_one();
+}
+
+void ThreadPool::wait_idle() {
+  std::unique_lock<std::mutex> lock(m);
+  idle_cv.wait(lock, [&] { return pending == 0; });
+}
+
+bool ThreadPool::pop_local(std::size_t self, Task &out) {
+  Queue &q = *queues[self];
+  std::lock_guard<std::mutex> lock(q.m);
+  if (q.tasks.empty())
+    return false;
+  out = std::move(q.tasks.back());
+  q.tasks.pop_back();
+  return true;
+}
+
+bool ThreadPool::steal(std::size_t self, Task &out) {
+  for (std::size_t i = 1; i < queues.size(); ++i) {
+    Queue &q = *queues[(self + i) % queues.size()];
+    std::lock_guard<std::mutex> lock(q.m);
+    if (!q.tasks.empty()) {
+      out = std::move(q.tasks.front());
+      q.tasks.pop_front();
+      return true;
+    }
+  }
+  return false;
+}
+
+void ThreadPool::worker_loop(std::size_t self) {
+  RuntimeTuning::instance().tune_current_thread("pool");
+  Task task;
+  while (true) {
+    if (pop_local(self, task) || steal(self, task)) {
+      {
+        std::lock_guard<std::mutex> lock(m);
+        --queued;
+      }
+      task();
+      task = nullptr;
+      std::lock_guard<std::mutex> lock(m);
+      if (--pending == 0)
+        idle_cv.notify_all();
+      continue;
+    }
+
+    std::unique_lock<std::mutex> lock(m);
+    if (!running)
+      return;
+    // A task pushed after our scan has already bumped `queued`, so this
+    // cannot miss a wakeup.
+    work_cv.wait(lock, [&] { return !running || queued > 0; });
+  }
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed-size pool with one task deque per worker. Submissions are spread
+// round-robin; a worker drains its own deque from the back and, once empty,
+// steals from the front of the others, so uneven tasks still keep every
+// core busy.
+class ThreadPool {
+public:
+  using Task = std::function<void()>;
+
+  explicit ThreadPool(
+      std::size_t threads = std::thread::hardware_concurrency());
+  ~ThreadPool();
+
+  ThreadPool(const ThreadPool &) = delete;
+  ThreadPool &operator=(const ThreadPool &) = delete;
+
+  void submit(Task task);
+
+  // Blocks until every submitted task has finished.
+  void wait_idle();
+
+  std::size_t size() const { return workers.size(); }
+
+private:
+  struct Queue {
+    std::mutex m;
+    std::deque<Task> tasks;
+  };
+
+  void worker_loop(std::size_t self);
+  bool pop_local(std::size_t self, Task &out);
+  bool steal(std::size_t self, Task &out);
+
+  std::vector<std::unique_ptr<Queue>> queues;
+  std::vector<std::thread> workers;
+
+  std::mutex m;
+  std::condition_variable work_cv;
+  std::condition_variable idle_cv;
+  std::size_t pending = 0; // submitted but not finished
+  std::size_t queued = 0;  // submitted but not picked up
+  bool running = true;
+  std::atomic<std::size_t> next_queue{0};
+};
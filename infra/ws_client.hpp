@@ -1,39 +1,65 @@
 #pragma once
 
 #include "engine.hpp"
+#include "feed_latency_monitor.hpp"
+#include "metrics.hpp"
+#include "reconnect_backoff.hpp"
+#include "runtime_tuning.hpp"
+#include "subscription_manager.hpp"
+#include <array>
 #include <atomic>
+#include <chrono>
 #include <condition_variable>
+#include <functional>
 #include <iostream>
 #include <ixwebsocket/IXWebSocket.h>
 #include <memory>
 #include <mutex>
 #include <nlohmann/json.hpp>
 #include <string>
+#include <thread>
+#include <unordered_map>
 #include <vector>
 
-template <typename Adapter> class WsClient {
+// `Socket` is ix::WebSocket outside of tests.
+template <typename Adapter, typename Socket = ix::WebSocket> class WsClient {
 public:
   using HeadersFactory = std::function<ix::WebSocketHttpHeaders()>;
+  using Clock = std::chrono::steady_clock;
 
   WsClient(std::string url_, std::shared_ptr<Adapter> adapter,
-           std::shared_ptr<Engine> engine, HeadersFactory headers_factory)
+           std::shared_ptr<Engine> engine, HeadersFactory headers_factory,
+           SubscriptionConfig sub_cfg = {}, ReconnectConfig reconnect_cfg = {})
       : url(std::move(url_)), adapter(adapter), engine(engine),
         headers_factory(std::move(headers_factory)), connected(false),
+        subscriptions(sub_cfg), reconnect_cfg(reconnect_cfg),
+        num_conns(reconnect_cfg.hot_standby ? 2 : 1),
         reconnect_needed(false) {
-    ws.setUrl(url);
-    ws.disableAutomaticReconnection();
-    ws.setMaxWaitBetweenReconnectionRetries(10000);
-    ws.setMinWaitBetweenReconnectionRetries(1000);
-    ws.setOnMessageCallback(
-        [this](const ix::WebSocketMessagePtr &msg) { handle_message(msg); });
+    for (int i = 0; i < num_conns; ++i) {
+      Connection &c = conns[i];
+      c.backoff = ReconnectBackoff(reconnect_cfg.backoff);
+      c.ws.setUrl(url);
+      c.ws.disableAutomaticReconnection();
+      c.ws.setOnMessageCallback([this, i](const ix::WebSocketMessagePtr &msg) {
+        handle_message(i, msg);
+      });
+    }
   }
 
   ~WsClient() { stop(); }
 
   void start() {
     running = true;
-    apply_headers();
+    refresh_headers();
+    {
+      std::lock_guard<std::mutex> lock(reconnect_mutex);
+      for (int i = 0; i < num_conns; ++i) {
+        conns[i].restart = true;
+        conns[i].restart_at = Clock::now();
+      }
+    }
     reconnect_thread = std::thread([this] { loop(); });
+    subscription_thread = std::thread([this] { subscription_loop(); });
   }
 
   void stop() {
@@ -43,157 +69,195 @@ public:
       reconnect_needed = true;
     }
     reconnect_cv.notify_all();
+    wake_subscriptions();
 
-    ws.stop();
     if (reconnect_thread.joinable())
       reconnect_thread.join();
+    if (subscription_thread.joinable())
+      subscription_thread.join();
 
-    ws.setOnMessageCallback(nullptr);
+    for (int i = 0; i < num_conns; ++i) {
+      conns[i].ws.stop();
+      conns[i].ws.setOnMessageCallback(nullptr);
+      conns[i].open = false;
+    }
     connected = false;
   }
 
+  // Restarts dropped connections once their backoff expires and keeps the
+  // auth headers pre-signed in between.
   void loop() {
+    RuntimeTuning::instance().tune_current_thread("reconnect");
+    auto next_refresh = Clock::now() + reconnect_cfg.header_refresh;
+    std::unique_lock<std::mutex> lock(reconnect_mutex);
     while (running.load()) {
-      apply_headers();
-      ws.start();
-      {
-        std::unique_lock<std::mutex> lock(reconnect_mutex);
-        reconnect_cv.wait(
-            lock, [&] { return !running.load() || reconnect_needed.load(); });
-        if (!running.load())
-          break;
-        reconnect_needed = false;
+      auto now = Clock::now();
+      if (now >= next_refresh) {
+        lock.unlock();
+        refresh_headers();
+        lock.lock();
+        next_refresh = now + reconnect_cfg.header_refresh;
+      }
+
+      auto wake = next_refresh;
+      for (int i = 0; i < num_conns && running.load(); ++i) {
+        Connection &c = conns[i];
+        if (!c.restart)
+          continue;
+        if (now < c.restart_at) {
+          wake = std::min(wake, c.restart_at);
+          continue;
+        }
+        c.restart = false;
+        lock.unlock();
+        restart_connection(i);
+        lock.lock();
       }
 
-      ws.stop();
-      std::this_thread::sleep_for(std::chrono::seconds(2));
+      reconnect_cv.wait_until(lock, wake, [&] {
+        return !running.load() || reconnect_needed.load();
+      });
+      reconnect_needed = false;
     }
   }
 
   bool is_connected() const { return connected.load(); }
 
-  ix::ReadyState get_ready_state() const { return ws.getReadyState(); }
+  ix::ReadyState get_ready_state() const {
+    return conns[active.load()].ws.getReadyState();
+  }
 
+  // `market_tickers` in params are batched and paced by the subscription
+  // manager; any other params apply to a channel-wide subscription.
   void subscribe(const std::string &channel,
                  const nlohmann::json &params = nlohmann::json::object()) {
-    std::lock_guard<std::mutex> lock(sub_mutex);
-
-    nlohmann::json sub_msg = {
-        {"id", next_id++}, {"cmd", "subscribe"}, {"params", params}};
-
-    if (!sub_msg["params"].contains("channels")) {
-      sub_msg["params"]["channels"] = nlohmann::json::array();
-    }
-    sub_msg["params"]["channels"].push_back(channel);
-
-    std::string msg_str = sub_msg.dump();
-    auto result = ws.send(msg_str);
-
-    if (result.success) {
-      subscriptions[channel] = params;
-      std::cout << "Subscribed to " << channel << std::endl;
+    if (params.contains("market_tickers")) {
+      subscriptions.add_markets(
+          channel, params["market_tickers"].get<std::vector<std::string>>());
     } else {
-      std::cerr << "Failed to subscribe to " << channel << std::endl;
+      subscriptions.subscribe(channel, params);
     }
+    wake_subscriptions();
   }
 
   void
   subscribe_multiple(const std::vector<std::string> &channels,
                      const nlohmann::json &params = nlohmann::json::object()) {
-    std::lock_guard<std::mutex> lock(sub_mutex);
-
-    nlohmann::json sub_msg = {
-        {"id", next_id++}, {"cmd", "subscribe"}, {"params", params}};
-
-    sub_msg["params"]["channels"] = channels;
-
-    std::string msg_str = sub_msg.dump();
-    auto result = ws.send(msg_str);
-
-    if (result.success) {
-      for (const auto &channel : channels) {
-        subscriptions[channel] = params;
-      }
-      std::cout << "Subscribed to multiple channels" << std::endl;
+    for (const auto &channel : channels) {
+      subscribe(channel, params);
     }
   }
 
   void unsubscribe(const std::string &channel,
                    const nlohmann::json &params = nlohmann::json::object()) {
-    std::lock_guard<std::mutex> lock(sub_mutex);
-
-    nlohmann::json unsub_msg = {
-        {"id", next_id++}, {"cmd", "unsubscribe"}, {"params", params}};
-
-    if (!unsub_msg["params"].contains("channels")) {
-      unsub_msg["params"]["channels"] = nlohmann::json::array();
+    if (params.contains("market_tickers")) {
+      subscriptions.remove_markets(
+          channel, params["market_tickers"].get<std::vector<std::string>>());
+    } else {
+      subscriptions.unsubscribe(channel);
     }
-    unsub_msg["params"]["channels"].push_back(channel);
-
-    std::string msg_str = unsub_msg.dump();
-    ws.send(msg_str);
+    wake_subscriptions();
+  }
 
-    subscriptions.erase(channel);
+  void add_markets(const std::string &channel,
+                   const std::vector<std::string> &tickers) {
+    subscriptions.add_markets(channel, tickers);
+    wake_subscriptions();
   }
 
-  std::vector<std::string> get_subscribed_channels() const {
-    std::lock_guard<std::mutex> lock(sub_mutex);
-    std::vector<std::string> channels;
-    channels.reserve(subscriptions.size());
-    for (const auto &[channel, _] : subscriptions) {
-      channels.push_back(channel);
-    }
-    return channels;
+  void remove_markets(const std::string &channel,
+                      const std::vector<std::string> &tickers) {
+    subscriptions.remove_markets(channel, tickers);
+    wake_subscriptions();
   }
 
-  void resubscribe_all() {
-    std::lock_guard<std::mutex> lock(sub_mutex);
+  // Re-requests the book snapshot of one market, e.g. after the engine
+  // dropped its deltas.
+  void resync_market(const std::string &ticker) {
+    subscriptions.resync_market("orderbook_delta", ticker);
+    wake_subscriptions();
+  }
 
-    if (subscriptions.empty())
-      return;
+  std::vector<std::string> get_subscribed_channels() const {
+    return subscriptions.channels();
+  }
 
-    for (const auto &[channel, params] : subscriptions) {
-      nlohmann::json sub_msg = {
-          {"id", next_id++}, {"cmd", "subscribe"}, {"params", params}};
+  const SubscriptionManager &subscription_manager() const {
+    return subscriptions;
+  }
 
-      if (!sub_msg["params"].contains("channels")) {
-        sub_msg["params"]["channels"] = nlohmann::json::array();
-      }
-      sub_msg["params"]["channels"].push_back(channel);
+  void resubscribe_all() {
+    subscriptions.on_connected();
+    wake_subscriptions();
+  }
 
-      ws.send(sub_msg.dump());
-    }
+  // Set before start(). Every event with an exchange timestamp is recorded
+  // against its connection.
+  void set_latency_monitor(std::shared_ptr<FeedLatencyMonitor> monitor) {
+    latency = std::move(monitor);
+  }
 
-    std::cout << "Resubscribed to all channels" << std::endl;
+  // Drops connection `idx` as if it had failed: the standby, if open, is
+  // promoted and `idx` reconnects after its backoff. For a connection that
+  // stays up but lags. The socket is left open until the reconnect, since
+  // this may run on its own receive thread.
+  void recycle_connection(int idx) {
+    if (idx < 0 || idx >= num_conns || !conns[idx].open.load())
+      return;
+    std::cout << "Recycling connection " << idx << std::endl;
+    on_connection_lost(idx);
   }
 
 private:
-  void handle_message(const ix::WebSocketMessagePtr &msg) {
+  struct Connection {
+    Socket ws;
+    std::atomic<bool> open{false};
+    // Set while restart_connection stops the socket; the Close that causes
+    // is not a drop.
+    std::atomic<bool> stopping{false};
+    bool started = false;
+    // Guarded by reconnect_mutex.
+    bool restart = false;
+    Clock::time_point restart_at{};
+    ReconnectBackoff backoff;
+  };
+
+  void handle_message(int idx, const ix::WebSocketMessagePtr &msg) {
     switch (msg->type) {
     case ix::WebSocketMessageType::Open:
-      connected = true;
-      std::cout << "Connected to " << url << std::endl;
-      resubscribe_all();
+      // Callbacks run on ixwebsocket's receive thread.
+      RuntimeTuning::instance().tune_current_thread("ws_recv");
+      on_open(idx);
       break;
 
     case ix::WebSocketMessageType::Close:
-      connected = false;
       std::cout << "Disconnected: " << msg->closeInfo.reason
                 << " (code: " << msg->closeInfo.code << ")" << std::endl;
-      {
-        std::unique_lock<std::mutex> lock(reconnect_mutex);
-        reconnect_needed = true;
-      }
-      reconnect_cv.notify_one();
-
+      on_connection_lost(idx);
       break;
 
     case ix::WebSocketMessageType::Message:
+      // Only the active connection carries subscriptions; anything a
+      // just-demoted connection still delivers is stale.
+      if (idx != active.load(std::memory_order_relaxed))
+        break;
+      metric_inc(Counter::WsMessages);
       if (adapter) {
+        const std::int64_t recv_ns =
+            std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::system_clock::now().time_since_epoch())
+                .count();
         if (auto ev = adapter->parse(msg->str)) {
+          ev->recv_ts_ns = recv_ns;
+          if (latency && ev->exchange_ts_ns)
+            latency->record(idx, ev->ticker, ev->exchange_ts_ns, recv_ns);
           if (engine) {
             engine->push(*ev);
           }
+        } else if (subscriptions.on_control_message(msg->str)) {
+          wake_subscriptions();
+        } else {
+          metric_inc(Counter::WsParseFailures);
         }
       }
       break;
@@ -203,13 +267,7 @@ private:
                 << " (status: " << msg->errorInfo.http_status
                 << ", retries: " << msg->errorInfo.retries
                 << ", wait: " << msg->errorInfo.wait_time << "ms)\n";
-      connected = false;
-      {
-        std::unique_lock<std::mutex> lock(reconnect_mutex);
-        reconnect_needed = true;
-      }
-      reconnect_cv.notify_one();
-
+      on_connection_lost(idx);
       break;
 
     case ix::WebSocketMessageType::Ping:
@@ -223,25 +281,156 @@ private:
     }
   }
 
-  void apply_headers() {
+  void on_open(int idx) {
+    conns[idx].open = true;
+    {
+      std::lock_guard<std::mutex> lock(reconnect_mutex);
+      conns[idx].backoff.on_connected(Clock::now());
+    }
+
+    if (idx == active.load() || !connected.load()) {
+      active = idx;
+      connected = true;
+      std::cout << "Connected to " << url << std::endl;
+      resubscribe_all();
+    } else {
+      std::cout << "Standby connected to " << url << std::endl;
+    }
+  }
+
+  void on_connection_lost(int idx) {
+    const auto now = Clock::now();
+    Connection &c = conns[idx];
+    if (c.stopping.load())
+      return;
+    c.open = false;
+
+    bool promoted = false;
+    if (idx == active.load()) {
+      const int other = 1 - idx;
+      if (num_conns == 2 && conns[other].open.load()) {
+        active = other;
+        promoted = true;
+      } else {
+        connected = false;
+      }
+    }
+
+    {
+      std::lock_guard<std::mutex> lock(reconnect_mutex);
+      // Error and Close can both fire for one drop.
+      if (!c.restart) {
+        c.backoff.on_disconnected(now);
+        c.restart = true;
+        c.restart_at = now + c.backoff.next_delay();
+        reconnect_needed = true;
+      }
+    }
+    reconnect_cv.notify_one();
+
+    if (promoted) {
+      metric_inc(Counter::WsFailovers);
+      std::cout << "Promoted standby connection" << std::endl;
+      resubscribe_all();
+    }
+  }
+
+  void restart_connection(int idx) {
+    Connection &c = conns[idx];
+    // A recycled connection is still open here.
+    c.stopping = true;
+    c.ws.stop();
+    c.stopping = false;
+    c.open = false;
+    apply_headers(c.ws);
+    if (c.started)
+      metric_inc(Counter::WsReconnects);
+    c.started = true;
+    c.ws.start();
+  }
+
+  // Drains the subscription manager's queue at the pace it allows, waking
+  // early when new work or an ack arrives.
+  void subscription_loop() {
+    RuntimeTuning::instance().tune_current_thread("subscriptions");
+    using Clock = SubscriptionManager::Clock;
+    std::unique_lock<std::mutex> lock(subscription_mutex);
+    while (running.load()) {
+      auto next = Clock::time_point::max();
+      if (connected.load()) {
+        lock.unlock();
+        next = subscriptions.pump(Clock::now(), [this](const std::string &m) {
+          return conns[active.load()].ws.send(m).success;
+        });
+        lock.lock();
+      }
+      if (subscription_work || !running.load()) {
+        subscription_work = false;
+        continue;
+      }
+      if (next == Clock::time_point::max()) {
+        subscription_cv.wait(
+            lock, [&] { return subscription_work || !running.load(); });
+      } else {
+        subscription_cv.wait_until(
+            lock, next, [&] { return subscription_work || !running.load(); });
+      }
+      subscription_work = false;
+    }
+  }
+
+  void wake_subscriptions() {
+    {
+      std::lock_guard<std::mutex> lock(subscription_mutex);
+      subscription_work = true;
+    }
+    subscription_cv.notify_one();
+  }
+
+  void refresh_headers() {
     if (!headers_factory)
       return;
 
     auto headers = headers_factory();
-    ws.setExtraHeaders(headers);
+    std::lock_guard<std::mutex> lock(headers_mutex);
+    prepared_headers = std::move(headers);
+    prepared_at = Clock::now();
+  }
+
+  void apply_headers(Socket &ws) {
+    if (!headers_factory)
+      return;
+
+    std::unique_lock<std::mutex> lock(headers_mutex);
+    if (Clock::now() - prepared_at > reconnect_cfg.header_max_age) {
+      lock.unlock();
+      refresh_headers();
+      lock.lock();
+    }
+    ws.setExtraHeaders(prepared_headers);
   }
 
   std::string url;
   std::shared_ptr<Adapter> adapter;
   std::shared_ptr<Engine> engine;
+  std::shared_ptr<FeedLatencyMonitor> latency;
   HeadersFactory headers_factory;
-  ix::WebSocket ws;
   std::atomic<bool> connected;
 
-  mutable std::mutex sub_mutex;
-  std::unordered_map<std::string, nlohmann::json>
-      subscriptions; // channel -> params
-  std::atomic<int> next_id = 1;
+  std::mutex headers_mutex;
+  ix::WebSocketHttpHeaders prepared_headers;
+  Clock::time_point prepared_at{};
+
+  SubscriptionManager subscriptions;
+  std::mutex subscription_mutex;
+  std::condition_variable subscription_cv;
+  std::thread subscription_thread;
+  bool subscription_work = false;
+
+  ReconnectConfig reconnect_cfg;
+  std::array<Connection, 2> conns;
+  int num_conns;
+  std::atomic<int> active{0};
 
   mutable std::mutex reconnect_mutex;
   std::condition_variable reconnect_cv;
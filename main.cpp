@@ -1,10 +1,19 @@
 #include "infra/engine.hpp"
+#include "infra/feed_latency_monitor.hpp"
+#include "infra/metrics_server.hpp"
+#include "infra/monitor_server.hpp"
+#include "infra/rest_bootstrap.hpp"
+#include "infra/runtime_tuning.hpp"
 #include "infra/ws_client.hpp"
 #include "protocols/kalshi/kalshi_auth.hpp"
+#include "protocols/kalshi/kalshi_rest.hpp"
 #include "protocols/kalshi/kalshi_ws_adapter.hpp"
+#include "recorder/book_recorder.hpp"
 #include "strategy/kalshi_mm.hpp"
 #include <IXWebSocketHttpHeaders.h>
+#include <atomic>
 #include <chrono>
+#include <csignal>
 #include <ctime>
 #include <fstream>
 #include <ixwebsocket/IXHttpClient.h>
@@ -12,6 +21,30 @@
 #include <ostream>
 #include <thread>
 
+namespace {
+
+std::atomic<RiskGate *> kill_switch_target{nullptr};
+
+// SIGUSR1 trips the risk gate's kill switch; every quote leg is blocked
+// from then on.
+void on_kill_signal(int) {
+  if (RiskGate *gate = kill_switch_target.load())
+    gate->kill();
+}
+
+MarketLimits market_limits_from_json(const nlohmann::json &j,
+                                     MarketLimits l) {
+  l.max_position = j.value("max_position", l.max_position);
+  l.max_notional_cents = j.value("max_notional_cents", l.max_notional_cents);
+  l.max_order_size = j.value("max_order_size", l.max_order_size);
+  l.price_band_cents = j.value("price_band_cents", l.price_band_cents);
+  l.max_orders_per_sec = j.value("max_orders_per_sec", l.max_orders_per_sec);
+  l.order_burst = j.value("order_burst", l.order_burst);
+  return l;
+}
+
+} // namespace
+
 int main(int argc, char **argv) {
   if (argc != 2) {
     std::cerr << "usage: ./kalshi_mm path/to/runner.json" << std::endl;
@@ -28,17 +61,221 @@ int main(int argc, char **argv) {
 
   const std::string url = "wss://api.elections.kalshi.com/trade-api/ws/v2";
 
-  std::vector<std::string> tickers = {"KXNBAPLAYOFF-26-CHI"};
-  std::shared_ptr<Strategy> kalshi_mm = std::make_shared<KalshiMM>(tickers);
-  std::shared_ptr<Engine> engine = std::make_shared<Engine>(kalshi_mm);
+  // Before any thread or hot arena exists, so both pick up the settings.
+  if (j.contains("tuning")) {
+    RuntimeTuning::instance().configure(runtime_tuning_from_json(j["tuning"]));
+    RuntimeTuning::instance().tune_current_thread("main");
+  }
 
-  std::shared_ptr<KalshiWsAdapter> kalshi_adapter =
-      std::make_shared<KalshiWsAdapter>();
+  std::unique_ptr<MetricsServer> metrics_server;
+  if (j.contains("metrics")) {
+    const auto &mj = j["metrics"];
+    MetricsServerConfig mcfg;
+    mcfg.host = mj.value("host", mcfg.host);
+    mcfg.port = mj.value("port", mcfg.port);
+    mcfg.shm_name = mj.value("shm_name", mcfg.shm_name);
+    mcfg.shm_interval = std::chrono::milliseconds(
+        mj.value("shm_interval_ms", int(mcfg.shm_interval.count())));
+    metrics_server = std::make_unique<MetricsServer>(mcfg);
+    metrics_server->start();
+  }
 
   KalshiAuth::instance().configure_from_file(
       j["kalshi_private_key_path"].get<std::string>(),
       j["kalshi_key_id"].get<std::string>());
 
+  std::vector<std::string> tickers = j.value(
+      "markets", std::vector<std::string>{"KXNBAPLAYOFF-26-CHI"});
+
+  // Discovers series/event markets and pulls books and positions over REST,
+  // so quoting need not wait for the feed's snapshots.
+  std::unique_ptr<BootstrapResult> bootstrap;
+  if (j.contains("bootstrap")) {
+    const RestBootstrapConfig bcfg =
+        rest_bootstrap_config_from_json(j["bootstrap"]);
+    std::string host, prefix;
+    split_rest_url(bcfg.url, host, prefix);
+    KalshiRestTransport transport(host, bcfg.connections, bcfg.timeout_secs);
+    bootstrap = std::make_unique<BootstrapResult>(
+        RestBootstrap(bcfg, transport).run(tickers));
+    tickers = bootstrap->tickers;
+  }
+  std::vector<std::string> channels =
+      j.value("channels", std::vector<std::string>{"orderbook_delta"});
+  ASParams as_params{0.1, 1.5, 2.0, 60.0};
+  auto kalshi_mm = std::make_shared<KalshiMM>(tickers, as_params);
+
+  // Books live in the engine and are shared by every registered strategy.
+  std::shared_ptr<Engine> engine = std::make_shared<Engine>(
+      engine_queue_config_from_json(
+          j.value("engine_queue", nlohmann::json::object())));
+  engine->add_strategy(kalshi_mm, tickers);
+
+  std::size_t journal_from = 0;
+  std::shared_ptr<StateCheckpoint> checkpoint;
+  if (j.contains("checkpoint")) {
+    const auto &cj = j["checkpoint"];
+    CheckpointConfig ccfg;
+    ccfg.path = cj.value("path", std::string("kalshi_mm.ckpt"));
+    ccfg.max_markets = cj.value("max_markets", ccfg.max_markets);
+    checkpoint = std::make_shared<StateCheckpoint>(ccfg);
+    if (checkpoint->open()) {
+      if (kalshi_mm->restore_checkpoint(*checkpoint, engine->books())) {
+        std::cout << "Restored checkpoint epoch " << checkpoint->epoch()
+                  << " from " << ccfg.path << std::endl;
+        journal_from = checkpoint->journal_records();
+      }
+      kalshi_mm->set_checkpoint(
+          checkpoint,
+          std::chrono::milliseconds(cj.value("interval_ms", 1000)));
+    } else {
+      checkpoint.reset();
+    }
+  }
+
+  std::shared_ptr<FillJournal> fill_journal;
+  if (j.contains("fill_journal")) {
+    const auto &fj = j["fill_journal"];
+    FillJournalConfig fcfg;
+    fcfg.path = fj.value("path", std::string("kalshi_mm.fills"));
+    fcfg.capacity = fj.value("capacity", fcfg.capacity);
+    fcfg.group_commit = std::chrono::microseconds(
+        fj.value("group_commit_us", int(fcfg.group_commit.count())));
+    fill_journal = std::make_shared<FillJournal>(fcfg);
+    if (fill_journal->open()) {
+      std::size_t replayed =
+          kalshi_mm->replay_journal(*fill_journal, journal_from);
+      std::cout << "Replayed " << replayed << " fills from " << fcfg.path
+                << std::endl;
+      fill_journal->start();
+      kalshi_mm->set_fill_journal(fill_journal);
+    }
+  }
+  // After the journal, so each durable checkpoint can compact it.
+  if (checkpoint)
+    checkpoint->start();
+
+  if (bootstrap) {
+    const std::size_t replaced =
+        kalshi_mm->restore_bootstrap(*bootstrap, engine->books());
+    std::cout << "Seeded " << bootstrap->books.size()
+              << " books from REST; " << replaced
+              << " ledgers taken from the exchange" << std::endl;
+  }
+
+  std::shared_ptr<RiskGate> risk_gate;
+  if (j.contains("risk")) {
+    const auto &rj = j["risk"];
+    const MarketLimits defaults = market_limits_from_json(rj, MarketLimits{});
+    PortfolioLimits portfolio;
+    if (rj.contains("portfolio")) {
+      const auto &pj = rj["portfolio"];
+      portfolio.max_gross_contracts =
+          pj.value("max_gross_contracts", portfolio.max_gross_contracts);
+      portfolio.max_notional_cents =
+          pj.value("max_notional_cents", portfolio.max_notional_cents);
+      portfolio.max_loss_cents =
+          pj.value("max_loss_cents", portfolio.max_loss_cents);
+    }
+    risk_gate = std::make_shared<RiskGate>(defaults, portfolio);
+    if (rj.contains("markets")) {
+      for (const auto &[ticker, mj] : rj["markets"].items()) {
+        risk_gate->set_limits(ticker, market_limits_from_json(mj, defaults));
+      }
+    }
+    // After recovery, so the gate starts from the restored positions.
+    kalshi_mm->set_risk_gate(risk_gate, rj.value("order_size", 1));
+    kill_switch_target = risk_gate.get();
+    std::signal(SIGUSR1, on_kill_signal);
+  }
+
+  if (j.contains("event_series")) {
+    const auto &ej = j["event_series"];
+    SeriesThresholds thresholds;
+    thresholds.bid_sum_above =
+        ej.value("bid_sum_above", thresholds.bid_sum_above);
+    thresholds.ask_sum_below =
+        ej.value("ask_sum_below", thresholds.ask_sum_below);
+    auto series = std::make_shared<EventSeriesIndex>(thresholds);
+    series->set_callback([](const std::string &event, SeriesSignal signal,
+                            bool active, const SeriesTop &top) {
+      std::cerr << "[SERIES] " << event
+                << (signal == SeriesSignal::BidSumAbove ? " bid_sum "
+                                                        : " ask_sum ")
+                << (active ? "crossed" : "cleared")
+                << " bids=" << top.bid_sum << " asks=" << top.ask_sum
+                << " legs=" << top.legs << std::endl;
+    });
+    kalshi_mm->set_event_series(series);
+  }
+
+  std::shared_ptr<MonitorServer> monitor;
+  if (j.contains("monitor")) {
+    monitor = std::make_shared<MonitorServer>(
+        monitor_server_config_from_json(j["monitor"]));
+    if (monitor->start()) {
+      engine->add_strategy(monitor);
+      const KalshiMM *mm = kalshi_mm.get();
+      kalshi_mm->set_quote_handler([monitor, mm](const std::string &ticker,
+                                                 const Quote &yes,
+                                                 const Quote &no) {
+        monitor->board().update_quote(ticker, yes, no);
+        if (const auto *ledger = mm->positions().get_ledger(ticker))
+          monitor->board().update_pnl(ticker, ledger->snapshot());
+      });
+    } else {
+      monitor.reset();
+    }
+  }
+
+  std::shared_ptr<BookRecorder> recorder;
+  if (j.contains("recorder")) {
+    recorder = std::make_shared<BookRecorder>(
+        book_recorder_config_from_json(j["recorder"]));
+    if (recorder->open()) {
+      engine->add_strategy(recorder);
+      recorder->start();
+    } else {
+      recorder.reset();
+    }
+  }
+
+  std::shared_ptr<KalshiWsAdapter> kalshi_adapter =
+      std::make_shared<KalshiWsAdapter>();
+
+  SubscriptionConfig sub_cfg;
+  if (j.contains("subscriptions")) {
+    const auto &sj = j["subscriptions"];
+    sub_cfg.batch_size = sj.value("batch_size", sub_cfg.batch_size);
+    sub_cfg.max_commands_per_sec =
+        sj.value("max_commands_per_sec", sub_cfg.max_commands_per_sec);
+    sub_cfg.burst = sj.value("burst", sub_cfg.burst);
+    sub_cfg.ack_timeout = std::chrono::milliseconds(
+        sj.value("ack_timeout_ms", int(sub_cfg.ack_timeout.count())));
+    sub_cfg.retry_initial = std::chrono::milliseconds(
+        sj.value("retry_initial_ms", int(sub_cfg.retry_initial.count())));
+    sub_cfg.retry_max = std::chrono::milliseconds(
+        sj.value("retry_max_ms", int(sub_cfg.retry_max.count())));
+  }
+
+  ReconnectConfig reconnect_cfg;
+  if (j.contains("reconnect")) {
+    const auto &rj = j["reconnect"];
+    auto ms = [&](const char *key, std::chrono::milliseconds def) {
+      return std::chrono::milliseconds(rj.value(key, int(def.count())));
+    };
+    reconnect_cfg.backoff.initial =
+        ms("initial_backoff_ms", reconnect_cfg.backoff.initial);
+    reconnect_cfg.backoff.max = ms("max_backoff_ms", reconnect_cfg.backoff.max);
+    reconnect_cfg.backoff.stable_after =
+        ms("stable_after_ms", reconnect_cfg.backoff.stable_after);
+    reconnect_cfg.header_refresh =
+        ms("header_refresh_ms", reconnect_cfg.header_refresh);
+    reconnect_cfg.header_max_age =
+        ms("header_max_age_ms", reconnect_cfg.header_max_age);
+    reconnect_cfg.hot_standby = rj.value("hot_standby", false);
+  }
+
   WsClient<KalshiWsAdapter> kalshi_client(url, kalshi_adapter, engine, []() {
     std::string ts;
     std::string signature =
@@ -51,21 +288,78 @@ int main(int argc, char **argv) {
     headers["Origin"] = "";
 
     return headers;
+  }, sub_cfg, reconnect_cfg);
+
+  // The engine drops a market's deltas when its queue overflows; ask the
+  // exchange for a new snapshot of it.
+  engine->set_resync_handler([&kalshi_client](const std::string &ticker) {
+    kalshi_client.resync_market(ticker);
   });
 
-  engine->start();
-  kalshi_client.start();
+  // Exchange-to-local delay per market and connection. A lagging
+  // connection is logged and, if asked, dropped so the standby takes over.
+  std::shared_ptr<FeedLatencyMonitor> feed_latency;
+  if (j.contains("feed_latency")) {
+    const auto &fj = j["feed_latency"];
+    feed_latency = std::make_shared<FeedLatencyMonitor>(
+        feed_latency_config_from_json(fj));
+    const bool reconnect_lagging = fj.value("reconnect_lagging", false);
+    feed_latency->set_lag_handler(
+        [&kalshi_client, reconnect_lagging](int c, const LatencyStats &st) {
+          std::cerr << "[FEEDLAT] connection " << c << " lagging: p50 "
+                    << st.p50_ns / 1000000 << " ms, p99 "
+                    << st.p99_ns / 1000000 << " ms over " << st.samples
+                    << " messages" << std::endl;
+          if (reconnect_lagging)
+            kalshi_client.recycle_connection(c);
+        });
+    kalshi_client.set_latency_monitor(feed_latency);
+  }
 
-  while (!kalshi_client.is_connected()) {
-    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  // Queued now, sent in paced batches once the socket opens.
+  for (const auto &channel : channels) {
+    kalshi_client.add_markets(channel, tickers);
   }
 
-  kalshi_client.subscribe("orderbook_delta", {{"market_tickers", tickers}});
+  engine->start();
+  kalshi_client.start();
 
   std::this_thread::sleep_for(std::chrono::seconds(30));
 
   kalshi_client.stop();
   engine->stop();
+  if (feed_latency) {
+    const std::int64_t now =
+        std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::system_clock::now().time_since_epoch())
+            .count();
+    for (int c = 0; c < FeedLatencyMonitor::kMaxConnections; ++c) {
+      const LatencyStats st = feed_latency->connection(c, now);
+      if (st.samples)
+        std::cout << "[FEEDLAT] connection " << c << ": " << st.samples
+                  << " messages, p50 " << st.p50_ns / 1000 << " us, p99 "
+                  << st.p99_ns / 1000 << " us" << std::endl;
+    }
+    std::cout << "[FEEDLAT] clock floor " << feed_latency->floor_ns(now) / 1000
+              << " us, drift " << feed_latency->drift_ns_per_sec()
+              << " ns/s, " << feed_latency->lag_alerts() << " lag alerts"
+              << std::endl;
+    for (const auto &[ticker, st] : feed_latency->worst_markets(5, now)) {
+      std::cout << "[FEEDLAT]   " << ticker << " p99 " << st.p99_ns / 1000
+                << " us" << std::endl;
+    }
+  }
+  if (recorder)
+    recorder->stop();
+  if (monitor)
+    monitor->stop();
+  if (checkpoint)
+    checkpoint->stop();
+  if (fill_journal)
+    fill_journal->stop();
+  if (metrics_server)
+    metrics_server->stop();
+  kill_switch_target = nullptr;
 
   return 0;
 }
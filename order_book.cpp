@@ -24,43 +24,45 @@ void OrderBook::update_delta(int price, int delta, Side side) {
   }
 }
 
-std::pair<int, int> OrderBook::best_no_bid() {
+std::pair<int, int> OrderBook::best_no_bid() const {
   if (no_bids.empty())
     return {0, 0};
   return *no_bids.begin();
 }
 
-std::pair<int, int> OrderBook::best_no_ask() {
+std::pair<int, int> OrderBook::best_no_ask() const {
   auto [yes_bid_price, yes_bid_vol] = best_yes_bid();
   if (yes_bid_price == 0)
     return {0, 0};
   return {100 - yes_bid_price, yes_bid_vol};
 }
 
-std::pair<int, int> OrderBook::best_yes_bid() {
+std::pair<int, int> OrderBook::best_yes_bid() const {
   if (yes_bids.empty())
     return {0, 0};
   return *yes_bids.begin();
 }
 
-std::pair<int, int> OrderBook::best_yes_ask() {
+std::pair<int, int> OrderBook::best_yes_ask() const {
   auto [no_bid_price, no_bid_vol] = best_no_bid();
   if (no_bid_price == 0)
     return {0, 0};
   return {100 - no_bid_price, no_bid_vol};
 }
 
-int OrderBook::no_spread() { return best_no_ask().first - best_no_bid().first; }
+int OrderBook::no_spread() const {
+  return best_no_ask().first - best_no_bid().first;
+}
 
-int OrderBook::yes_spread() {
+int OrderBook::yes_spread() const {
   return best_yes_ask().first - best_yes_bid().first;
 }
 
-double OrderBook::no_midspot() {
+double OrderBook::no_midspot() const {
   return (best_no_ask().first + best_no_bid().first) / 2.0;
 }
 
-double OrderBook::yes_midspot() {
+double OrderBook::yes_midspot() const {
   return (best_yes_ask().first + best_yes_bid().first) / 2.0;
 }
 
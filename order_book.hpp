@@ -5,9 +5,13 @@
 #include <string>
 
 class OrderBook {
+public:
+  using Levels = std::map<int, int, std::greater<int>>;
+
+private:
   std::string ticker;
-  std::map<int, int, std::greater<int>> no_bids;
-  std::map<int, int, std::greater<int>> yes_bids;
+  Levels no_bids;
+  Levels yes_bids;
 
 public:
   explicit OrderBook(std::string &_ticker);
@@ -18,13 +22,17 @@ public:
 
   void update_delta(int price, int delta, Side side);
 
-  std::pair<int, int> best_no_bid();
-  std::pair<int, int> best_no_ask();
-  std::pair<int, int> best_yes_bid();
-  std::pair<int, int> best_yes_ask();
-  int no_spread();
-  int yes_spread();
-  double no_midspot();
-  double yes_midspot();
+  const Levels &bids(Side side) const {
+    return side == Side::NO ? no_bids : yes_bids;
+  }
+
+  std::pair<int, int> best_no_bid() const;
+  std::pair<int, int> best_no_ask() const;
+  std::pair<int, int> best_yes_bid() const;
+  std::pair<int, int> best_yes_ask() const;
+  int no_spread() const;
+  int yes_spread() const;
+  double no_midspot() const;
+  double yes_midspot() const;
   void clear();
 };
@@ -1,7 +1,10 @@
 #pragma once
 
+#include <cstdint>
+#include <optional>
 #include <string>
 #include <string_view>
+#include <variant>
 #include <vector>
 
 enum class Side { NO, YES };
@@ -19,6 +22,9 @@ struct DeltaEvent {
   int price_cents;
   int delta_contracts;
   std::int64_t seq;
+  // Set when the engine queue conflates consecutive deltas at one level:
+  // the event then stands for every seq in [first_seq, seq]. 0 means seq.
+  std::int64_t first_seq = 0;
 };
 
 struct FillEvent {
@@ -37,12 +43,41 @@ struct FillEvent {
   Side purchased_side; // "yes" or "no"
 };
 
+// Public trade print from the `trade` channel.
+struct TradeEvent {
+  int yes_price;
+  int count;
+  Side taker_side;
+  std::int64_t ts;
+};
+
+// Market summary from the `ticker` channel.
+struct TickerEvent {
+  int price; // last traded YES price
+  int yes_bid;
+  int yes_ask;
+  std::int64_t volume;
+  std::int64_t open_interest;
+  std::int64_t ts;
+};
+
 struct FeedEvent {
   Exchange exchange;
-  enum class Type { OrderbookSnapshot, OrderbookDelta, Fill } type;
+  enum class Type {
+    OrderbookSnapshot,
+    OrderbookDelta,
+    Fill,
+    Trade,
+    Ticker
+  } type;
   int64_t cid;
   std::string ticker;
-  std::variant<SnapshotEvent, DeltaEvent, FillEvent> payload;
+  // Wall-clock ns since the epoch: the exchange's timestamp on the message
+  // and when we received it. 0 when unknown.
+  std::int64_t exchange_ts_ns = 0;
+  std::int64_t recv_ts_ns = 0;
+  std::variant<SnapshotEvent, DeltaEvent, FillEvent, TradeEvent, TickerEvent>
+      payload;
 };
 
 struct FeedAdapter {
@@ -1,6 +1,7 @@
 #include "kalshi_auth.hpp"
 #include "utils/rsa_pss.hpp"
 
+#include <charconv>
 #include <chrono>
 #include <stdexcept>
 
@@ -24,26 +25,67 @@ void KalshiAuth::configure_from_file(const std::string &key_path,
 std::string KalshiAuth::sign_request(const std::string &method,
                                      const std::string &path,
                                      std::string &timestamp_ms_out) const {
+  std::string signature;
+  sign_request(method, path, timestamp_ms_out, signature);
+  return signature;
+}
+
+void KalshiAuth::sign_request(std::string_view method, std::string_view path,
+                              std::string &timestamp_ms_out,
+                              std::string &signature_out) const {
   if (!key_) {
     throw std::runtime_error("KalshiAuth not configured: private key missing");
   }
 
+  // Rebuilt only if the key is reloaded.
+  thread_local std::unique_ptr<PssSigner> signer;
+  thread_local std::string message;
+  if (!signer || signer->key() != key_.get()) {
+    signer = std::make_unique<PssSigner>(key_.get());
+  }
+  if (!signer->ok()) {
+    throw std::runtime_error("Signing failed");
+  }
+
   auto now = std::chrono::system_clock::now();
   auto timestamp = std::chrono::duration_cast<std::chrono::milliseconds>(
                        now.time_since_epoch())
                        .count();
-  timestamp_ms_out = std::to_string(timestamp);
+  char ts[24];
+  const auto ts_end = std::to_chars(ts, ts + sizeof(ts), timestamp).ptr;
+  timestamp_ms_out.assign(ts, ts_end);
 
-  auto pos = path.find('?');
-  std::string path_no_query =
-      (pos == std::string::npos ? path : path.substr(0, pos));
+  path = path.substr(0, path.find('?'));
 
-  std::string message = timestamp_ms_out + method + path_no_query;
+  message.assign(ts, ts_end);
+  message.append(method);
+  message.append(path);
 
-  std::string signature;
-  if (!signPssSha256(key_.get(), message, signature)) {
+  if (!signer->sign(message, signature_out)) {
     throw std::runtime_error("Signing failed");
   }
+}
 
-  return signature;
+void KalshiAuth::set_signing_threads(std::size_t n) {
+  pool_.reset();
+  if (n > 0) {
+    pool_ = std::make_unique<ThreadPool>(n);
+  }
+}
+
+std::future<SignedRequest>
+KalshiAuth::sign_request_async(std::string method, std::string path) const {
+  auto task = std::make_shared<std::packaged_task<SignedRequest()>>(
+      [this, method = std::move(method), path = std::move(path)]() {
+        SignedRequest out;
+        sign_request(method, path, out.timestamp_ms, out.signature);
+        return out;
+      });
+  std::future<SignedRequest> result = task->get_future();
+  if (pool_) {
+    pool_->submit([task]() { (*task)(); });
+  } else {
+    (*task)();
+  }
+  return result;
 }
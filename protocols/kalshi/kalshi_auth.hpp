@@ -1,12 +1,26 @@
 #pragma once
 
+#include "infra/thread_pool.hpp"
+
+#include <cstddef>
+#include <future>
+#include <memory>
 #include <openssl/pem.h>
 #include <string>
+#include <string_view>
 
 namespace Botan {
 class Private_Key;
 }
 
+struct SignedRequest {
+  std::string timestamp_ms;
+  std::string signature;
+};
+
+// Signs "<timestamp><METHOD><path without query>" with RSA-PSS. Each thread
+// keeps its own pre-configured signer and message buffer, so sign_request()
+// is safe to call concurrently and only allocates the returned strings.
 class KalshiAuth {
 public:
   static KalshiAuth &instance();
@@ -16,6 +30,21 @@ public:
 
   std::string sign_request(const std::string &method, const std::string &path,
                            std::string &timestamp_ms_out) const;
+  // Same, reusing the caller's strings.
+  void sign_request(std::string_view method, std::string_view path,
+                    std::string &timestamp_ms_out,
+                    std::string &signature_out) const;
+
+  // RSA signing dominates request latency; with n > 0 sign_request_async()
+  // runs on a pool of n threads so a burst of orders signs in parallel.
+  // 0 (the default) signs inline on the caller. Not thread-safe against
+  // concurrent sign_request_async() calls; set it up at startup.
+  void set_signing_threads(std::size_t n);
+  std::size_t signing_threads() const {
+    return pool_ ? pool_->size() : 0;
+  }
+  std::future<SignedRequest> sign_request_async(std::string method,
+                                                std::string path) const;
 
   const std::string &api_key_id() const { return api_key_id_; }
 
@@ -30,6 +59,7 @@ private:
 
   std::unique_ptr<EVP_PKEY, void (*)(EVP_PKEY *)> key_{nullptr, EVP_PKEY_free};
   std::string api_key_id_;
+  std::unique_ptr<ThreadPool> pool_;
 };
 
 #define KALSHI_AUTH KalshiAuth::instance()
@@ -0,0 +1,74 @@
+#include "kalshi_commands.hpp"
+
+std::vector<JsonFragment> json_fragments(const nlohmann::json &obj) {
+  std::vector<JsonFragment> out;
+  if (!obj.is_object())
+    return out;
+  out.reserve(obj.size());
+  for (const auto &[key, value] : obj.items()) {
+    out.push_back({key, value.dump()});
+  }
+  return out;
+}
+
+namespace kalshi_commands_detail {
+
+void begin_command(std::string &out, std::string_view cmd, std::int64_t id) {
+  out.assign(R"({"cmd":")");
+  out.append(cmd);
+  out.append(R"(","id":)");
+  append_json_int(out, id);
+  out.append(R"(,"params":{)");
+}
+
+} // namespace kalshi_commands_detail
+
+void encode_unsubscribe(std::string &out, std::int64_t id, std::int64_t sid) {
+  kalshi_commands_detail::begin_command(out, "unsubscribe", id);
+  out.append(R"("sids":[)");
+  append_json_int(out, sid);
+  out.append("]}}");
+}
+
+namespace {
+
+// Members up to and including "count", which every order body starts with.
+void order_head(std::string &out, const OrderPayload &o) {
+  out.assign(R"({"action":"buy","client_order_id":)");
+  append_json_string(out, o.client_order_id);
+  out.append(R"(,"count":)");
+  append_json_int(out, o.count);
+  // Keys are sorted: no_price comes before side, yes_price last.
+  if (o.side == Side::NO) {
+    out.append(R"(,"no_price":)");
+    append_json_int(out, o.price);
+    out.append(R"(,"side":"no","ticker":)");
+  } else {
+    out.append(R"(,"side":"yes","ticker":)");
+  }
+  append_json_string(out, o.ticker);
+}
+
+void yes_price_tail(std::string &out, const OrderPayload &o) {
+  if (o.side == Side::YES) {
+    out.append(R"(,"yes_price":)");
+    append_json_int(out, o.price);
+  }
+  out.push_back('}');
+}
+
+} // namespace
+
+void encode_create_order(std::string &out, const OrderPayload &o) {
+  order_head(out, o);
+  out.append(R"(,"type":"limit")");
+  yes_price_tail(out, o);
+}
+
+void encode_amend_order(std::string &out, const OrderPayload &o,
+                        std::string_view updated_client_order_id) {
+  order_head(out, o);
+  out.append(R"(,"updated_client_order_id":)");
+  append_json_string(out, updated_client_order_id);
+  yes_price_tail(out, o);
+}
@@ -0,0 +1,137 @@
+#pragma once
+
+#include "protocols/feed_adapter.hpp"
+#include "utils/json_append.hpp"
+#include <cstdint>
+#include <nlohmann/json.hpp>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Outbound Kalshi payloads, written straight into a reusable buffer. Each
+// encoder replaces the contents of `out` with exactly what building the
+// nlohmann::json equivalent and calling dump() would give (keys sorted),
+// without building the tree. Ticker and id ranges are any range of things
+// convertible to std::string_view.
+
+// One member of a params object, rendered once: raw key, dumped value.
+struct JsonFragment {
+  std::string key;
+  std::string value;
+};
+
+// Renders the members of `obj` in key order; anything but an object has
+// none.
+std::vector<JsonFragment> json_fragments(const nlohmann::json &obj);
+
+namespace kalshi_commands_detail {
+
+void begin_command(std::string &out, std::string_view cmd, std::int64_t id);
+
+// Writes `extra` into an open params object, with "channels" and (if
+// `tickers` is set) "market_tickers" merged in at their sorted positions.
+// Those two replace members of the same name in `extra`.
+template <typename Tickers>
+void subscribe_params(std::string &out, std::string_view channel,
+                      const std::vector<JsonFragment> &extra,
+                      const Tickers *tickers) {
+  bool first = true;
+  auto member = [&](std::string_view key) {
+    if (!first)
+      out.push_back(',');
+    first = false;
+    append_json_string(out, key);
+    out.push_back(':');
+  };
+  bool channels_done = false;
+  bool tickers_done = tickers == nullptr;
+  // Emits the fixed members that sort before `key`, or all that are left.
+  auto fixed_before = [&](std::string_view key, bool rest = false) {
+    if (!channels_done && (rest || std::string_view("channels") < key)) {
+      member("channels");
+      out.push_back('[');
+      append_json_string(out, channel);
+      out.push_back(']');
+      channels_done = true;
+    }
+    if (!tickers_done &&
+        (rest || std::string_view("market_tickers") < key)) {
+      member("market_tickers");
+      append_json_string_array(out, *tickers);
+      tickers_done = true;
+    }
+  };
+
+  for (const JsonFragment &f : extra) {
+    fixed_before(f.key);
+    if (f.key == "channels" || (tickers && f.key == "market_tickers"))
+      continue;
+    member(f.key);
+    out.append(f.value);
+  }
+  fixed_before({}, true);
+}
+
+} // namespace kalshi_commands_detail
+
+// {"cmd":"subscribe","id":id,"params":{...extra,"channels":[channel],
+// "market_tickers":[...]}}. A null `tickers` subscribes the whole channel.
+template <typename Tickers>
+void encode_subscribe(std::string &out, std::int64_t id,
+                      std::string_view channel,
+                      const std::vector<JsonFragment> &extra,
+                      const Tickers *tickers) {
+  kalshi_commands_detail::begin_command(out, "subscribe", id);
+  kalshi_commands_detail::subscribe_params(out, channel, extra, tickers);
+  out.append("}}");
+}
+
+inline void encode_subscribe(std::string &out, std::int64_t id,
+                             std::string_view channel,
+                             const std::vector<JsonFragment> &extra) {
+  encode_subscribe<std::vector<std::string>>(out, id, channel, extra,
+                                             nullptr);
+}
+
+// {"cmd":"update_subscription","id":id,"params":{"action":"add_markets"
+// or "delete_markets","market_tickers":[...],"sids":[sid]}}
+template <typename Tickers>
+void encode_update_subscription(std::string &out, std::int64_t id,
+                                std::int64_t sid, bool add,
+                                const Tickers &tickers) {
+  kalshi_commands_detail::begin_command(out, "update_subscription", id);
+  out.append(add ? R"("action":"add_markets","market_tickers":)"
+                 : R"("action":"delete_markets","market_tickers":)");
+  append_json_string_array(out, tickers);
+  out.append(R"(,"sids":[)");
+  append_json_int(out, sid);
+  out.append("]}}");
+}
+
+// {"cmd":"unsubscribe","id":id,"params":{"sids":[sid]}}
+void encode_unsubscribe(std::string &out, std::int64_t id, std::int64_t sid);
+
+// A limit buy; every Kalshi order buys YES or NO.
+struct OrderPayload {
+  std::string_view ticker;
+  std::string_view client_order_id;
+  Side side = Side::YES;
+  int price = 0; // cents, on `side`
+  int count = 0;
+};
+
+// Body of POST /portfolio/orders.
+void encode_create_order(std::string &out, const OrderPayload &o);
+
+// Body of POST /portfolio/orders/{order_id}/amend: the order's new price
+// and count, renamed to `updated_client_order_id`.
+void encode_amend_order(std::string &out, const OrderPayload &o,
+                        std::string_view updated_client_order_id);
+
+// Body of DELETE /portfolio/orders/batched: {"ids":[...]}
+template <typename Ids>
+void encode_batch_cancel(std::string &out, const Ids &order_ids) {
+  out.assign(R"({"ids":)");
+  append_json_string_array(out, order_ids);
+  out.push_back('}');
+}
@@ -1,4 +1,5 @@
 #include "kalshi_order_book.hpp"
+#include <algorithm>
 #include <cassert>
 
 KalshiOrderBook::ApplyResult
@@ -8,6 +9,10 @@ KalshiOrderBook::apply_snapshot(const SnapshotEvent &snap) {
   book.set_snapshot(snap.yes_levels, snap.no_levels);
   last_seq = snap.seq;
   has_snapshot = true;
+  // Only the new level sizes are known; clamp every estimate to them.
+  for (auto &[key, orders] : queued) {
+    on_level_shrunk(key, 0);
+  }
   return ApplyResult::Applied;
 }
 
@@ -17,9 +22,100 @@ KalshiOrderBook::apply_delta(const DeltaEvent &delta) {
     return ApplyResult::NoSnapshotYet;
   if (delta.seq <= last_seq)
     return ApplyResult::IgnoredOld;
-  if (delta.seq > last_seq + 1)
+  const std::int64_t first = delta.first_seq ? delta.first_seq : delta.seq;
+  if (first > last_seq + 1)
     return ApplyResult::GapNeedsResync;
   book.update_delta(delta.price_cents, delta.delta_contracts, delta.side);
   last_seq = delta.seq;
+  // Volume joining a level queues behind us, so only decreases matter.
+  if (delta.delta_contracts < 0 && !queued.empty()) {
+    on_level_shrunk(level_key(delta.side, delta.price_cents),
+                    -delta.delta_contracts);
+  }
   return ApplyResult::Applied;
 }
+
+int KalshiOrderBook::level_size(int key) const {
+  const auto &levels = book.bids(key > 0 ? Side::YES : Side::NO);
+  auto it = levels.find(key > 0 ? key : -key);
+  return it == levels.end() ? 0 : it->second;
+}
+
+void KalshiOrderBook::on_level_shrunk(int key, int decrease) {
+  auto it = queued.find(key);
+  if (it == queued.end())
+    return;
+  const int level = level_size(key);
+  for (QueuedOrder &o : it->second) {
+    if (queue_model == QueueModel::Optimistic) {
+      o.ahead = std::max(0, o.ahead - decrease);
+    }
+    // Whatever the model, no more can be ahead than the level holds besides
+    // our own contracts.
+    o.ahead = std::min(o.ahead, std::max(0, level - o.remaining));
+  }
+}
+
+void KalshiOrderBook::track_order(std::uint64_t id, Side side, int price,
+                                  int count) {
+  const int key = level_key(side, price);
+  const int level = level_size(key);
+  // The pessimistic model assumes our order is not on the level yet, so all
+  // of it is ahead; the optimistic one that it already is.
+  const int ahead = queue_model == QueueModel::Pessimistic
+                        ? level
+                        : std::max(0, level - count);
+  untrack_order(id);
+  queued[key].push_back(QueuedOrder{id, count, ahead});
+  order_level[id] = key;
+}
+
+KalshiOrderBook::QueuedOrder *KalshiOrderBook::find_order(std::uint64_t id,
+                                                          int *key) {
+  auto lit = order_level.find(id);
+  if (lit == order_level.end())
+    return nullptr;
+  *key = lit->second;
+  auto &orders = queued[lit->second];
+  auto it = std::find_if(orders.begin(), orders.end(),
+                         [&](const QueuedOrder &o) { return o.id == id; });
+  assert(it != orders.end());
+  return &*it;
+}
+
+void KalshiOrderBook::on_order_fill(std::uint64_t id, int count) {
+  int key = 0;
+  QueuedOrder *o = find_order(id, &key);
+  if (!o)
+    return;
+  o->remaining -= count;
+  o->ahead = 0; // anything ahead of a filled order has traded
+  if (o->remaining <= 0) {
+    untrack_order(id);
+  }
+}
+
+void KalshiOrderBook::untrack_order(std::uint64_t id) {
+  int key = 0;
+  if (!find_order(id, &key))
+    return;
+  auto &orders = queued[key];
+  orders.erase(std::remove_if(orders.begin(), orders.end(),
+                              [&](const QueuedOrder &o) { return o.id == id; }),
+               orders.end());
+  if (orders.empty()) {
+    queued.erase(key);
+  }
+  order_level.erase(id);
+}
+
+std::optional<int> KalshiOrderBook::queue_ahead(std::uint64_t id) const {
+  auto lit = order_level.find(id);
+  if (lit == order_level.end())
+    return std::nullopt;
+  for (const QueuedOrder &o : queued.at(lit->second)) {
+    if (o.id == id)
+      return o.ahead;
+  }
+  return std::nullopt;
+}
@@ -1,5 +1,51 @@
+#pragma once
+
 #include "order_book.hpp"
+#include <cstdint>
+#include <optional>
 #include <string>
+#include <unordered_map>
+#include <vector>
+
+// How a shrinking level is assumed to affect the volume ahead of our order.
+// Pessimistic: cancels come from behind us first, so the queue ahead only
+// shrinks once the level is smaller than it. Optimistic: every decrease
+// comes from ahead of us.
+enum class QueueModel { Pessimistic, Optimistic };
+
+// Public prints for one market, folded in one trade at a time.
+struct MarketTradeStats {
+  int last_price = 0; // YES cents; 0 before the first print
+  int last_count = 0;
+  Side last_taker = Side::YES;
+  std::int64_t last_ts = 0;
+  std::int64_t trades = 0;
+  std::int64_t volume = 0;           // contracts
+  std::int64_t yes_taker_volume = 0; // contracts lifted by YES takers
+  std::int64_t notional_cents = 0;   // sum of yes_price * count
+
+  void on_trade(const TradeEvent &t) {
+    last_price = t.yes_price;
+    last_count = t.count;
+    last_taker = t.taker_side;
+    last_ts = t.ts;
+    ++trades;
+    volume += t.count;
+    notional_cents += static_cast<std::int64_t>(t.yes_price) * t.count;
+    if (t.taker_side == Side::YES)
+      yes_taker_volume += t.count;
+  }
+
+  // Volume-weighted YES price since the first print seen, in cents.
+  double vwap() const {
+    return volume ? static_cast<double>(notional_cents) / volume : 0.0;
+  }
+  // Share of volume taken by YES buyers, in [-1, 1]; positive means YES
+  // takers are lifting.
+  double taker_imbalance() const {
+    return volume ? (2.0 * yes_taker_volume - volume) / volume : 0.0;
+  }
+};
 
 struct KalshiOrderBook {
   std::string ticker;
@@ -7,6 +53,11 @@ struct KalshiOrderBook {
   std::int64_t last_seq = 0;
   std::int64_t cid = 0;
   bool has_snapshot = false;
+  QueueModel queue_model = QueueModel::Pessimistic;
+  // Trade and ticker channel state; kept across resubscribes.
+  MarketTradeStats trades;
+  TickerEvent last_ticker{};
+  bool has_ticker = false;
 
   enum class ApplyResult { Applied, IgnoredOld, GapNeedsResync, NoSnapshotYet };
 
@@ -15,4 +66,36 @@ struct KalshiOrderBook {
   ApplyResult apply_snapshot(const SnapshotEvent &snap);
 
   ApplyResult apply_delta(const DeltaEvent &d);
+
+  // Queue position of our own resting orders, keyed by client order id.
+  // Engine thread only; the engine drives these through OrderQueue and its
+  // fills. track_order runs on ack and estimates the volume ahead from the
+  // current level size; deltas at that price then shrink it.
+  void track_order(std::uint64_t id, Side side, int price, int count);
+  // Our own fill; the order is dropped once nothing remains.
+  void on_order_fill(std::uint64_t id, int count);
+  // Cancel acked. Call before the feed's matching negative delta so our own
+  // contracts leaving the level are not counted as queue progress.
+  void untrack_order(std::uint64_t id);
+  // Estimated contracts ahead of the order, or nullopt if it is not tracked.
+  std::optional<int> queue_ahead(std::uint64_t id) const;
+  std::size_t tracked_orders() const { return order_level.size(); }
+
+private:
+  struct QueuedOrder {
+    std::uint64_t id;
+    int remaining;
+    int ahead;
+  };
+
+  static int level_key(Side side, int price) {
+    return side == Side::YES ? price : -price;
+  }
+  int level_size(int key) const;
+  void on_level_shrunk(int key, int decrease);
+  QueuedOrder *find_order(std::uint64_t id, int *key);
+
+  // Our orders by price level, so a delta only touches its own level.
+  std::unordered_map<int, std::vector<QueuedOrder>> queued;
+  std::unordered_map<std::uint64_t, int> order_level;
 };
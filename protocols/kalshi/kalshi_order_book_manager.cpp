@@ -8,8 +8,23 @@ KalshiOrderBookManager::KalshiOrderBookManager(
 }
 
 void KalshiOrderBookManager::add_ticker(const std::string &ticker) {
-  if (books.find(ticker) == books.end()) {
-    books.emplace(ticker, KalshiOrderBook{ticker});
+  find_or_add(ticker);
+}
+
+KalshiOrderBook &
+KalshiOrderBookManager::find_or_add(const std::string &ticker) {
+  auto it = books.find(ticker);
+  if (it == books.end()) {
+    it = books.emplace(ticker, KalshiOrderBook{ticker}).first;
+    it->second.queue_model = queue_model;
+  }
+  return it->second;
+}
+
+void KalshiOrderBookManager::set_queue_model(QueueModel model) {
+  queue_model = model;
+  for (auto &[_, book] : books) {
+    book.queue_model = model;
   }
 }
 
@@ -21,26 +36,47 @@ KalshiOrderBook *KalshiOrderBookManager::get_book(const std::string &ticker) {
 }
 
 KalshiOrderBook::ApplyResult KalshiOrderBookManager::set_ticker_snapshot(
-    std::string &ticker, std::int64_t cid, const SnapshotEvent &snap) {
+    const std::string &ticker, std::int64_t cid, const SnapshotEvent &snap) {
   auto &book = get_or_create_book(ticker, cid);
   return book.apply_snapshot(snap);
 }
 
 KalshiOrderBook::ApplyResult KalshiOrderBookManager::update_ticker_delta(
-    std::string &ticker, std::int64_t cid, const DeltaEvent &delta) {
+    const std::string &ticker, std::int64_t cid, const DeltaEvent &delta) {
   auto &book = get_or_create_book(ticker, cid);
   return book.apply_delta(delta);
 }
 
+void KalshiOrderBookManager::apply_trade(const std::string &ticker,
+                                         const TradeEvent &trade) {
+  find_or_add(ticker).trades.on_trade(trade);
+}
+
+void KalshiOrderBookManager::apply_ticker(const std::string &ticker,
+                                          const TickerEvent &t) {
+  KalshiOrderBook &kb = find_or_add(ticker);
+  kb.last_ticker = t;
+  kb.has_ticker = true;
+}
+
+void KalshiOrderBookManager::seed_book(
+    const std::string &ticker, const std::vector<std::pair<int, int>> &yes,
+    const std::vector<std::pair<int, int>> &no) {
+  KalshiOrderBook &kb = find_or_add(ticker);
+  if (kb.cid != 0) {
+    cid_to_ticker.erase(kb.cid);
+  }
+  // cid 0 never matches a live channel, so the first feed message resets it.
+  kb.cid = 0;
+  kb.last_seq = 0;
+  kb.book.set_snapshot(yes, no);
+  kb.has_snapshot = true;
+}
+
 KalshiOrderBook &
 KalshiOrderBookManager::get_or_create_book(const std::string &ticker,
                                            std::int64_t cid) {
-  auto it = books.find(ticker);
-  if (it == books.end()) {
-    it = books.emplace(ticker, KalshiOrderBook{ticker}).first;
-  }
-
-  KalshiOrderBook &kb = it->second;
+  KalshiOrderBook &kb = find_or_add(ticker);
 
   if (kb.cid != cid) {
     if (kb.cid != 0) {
@@ -55,3 +91,17 @@ KalshiOrderBookManager::get_or_create_book(const std::string &ticker,
 
   return kb;
 }
+
+bool OrderQueue::on_ack(const std::string &ticker, std::uint64_t id,
+                        Side side, int price, int remaining) {
+  KalshiOrderBook *book = books->get_book(ticker);
+  if (!book || !book->has_snapshot)
+    return false;
+  book->track_order(id, side, price, remaining);
+  return true;
+}
+
+void OrderQueue::on_cancel(const std::string &ticker, std::uint64_t id) {
+  if (KalshiOrderBook *book = books->get_book(ticker))
+    book->untrack_order(id);
+}
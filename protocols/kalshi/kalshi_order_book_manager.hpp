@@ -1,4 +1,9 @@
+#pragma once
+
 #include "kalshi_order_book.hpp"
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
 
 class KalshiOrderBookManager {
 public:
@@ -10,18 +15,60 @@ public:
 
   KalshiOrderBook *get_book(const std::string &ticker);
 
-  KalshiOrderBook::ApplyResult set_ticker_snapshot(std::string &ticker,
+  KalshiOrderBook::ApplyResult set_ticker_snapshot(const std::string &ticker,
                                                    std::int64_t cid,
                                                    const SnapshotEvent &snap);
 
-  KalshiOrderBook::ApplyResult update_ticker_delta(std::string &ticker,
+  KalshiOrderBook::ApplyResult update_ticker_delta(const std::string &ticker,
                                                    std::int64_t cid,
                                                    const DeltaEvent &delta);
 
+  // Trade prints and ticker summaries; the book is created if needed.
+  void apply_trade(const std::string &ticker, const TradeEvent &trade);
+  void apply_ticker(const std::string &ticker, const TickerEvent &t);
+
+  // Installs levels from an out-of-band source (checkpoint, REST). The book
+  // is usable immediately and is replaced as soon as the feed delivers a
+  // snapshot on a live channel.
+  void seed_book(const std::string &ticker,
+                 const std::vector<std::pair<int, int>> &yes,
+                 const std::vector<std::pair<int, int>> &no);
+
+  // Applies to every current and future book.
+  void set_queue_model(QueueModel model);
+
+  template <typename Fn> void for_each_book(Fn &&fn) const {
+    for (const auto &[_, book] : books) {
+      fn(book);
+    }
+  }
+
 private:
+  KalshiOrderBook &find_or_add(const std::string &ticker);
   KalshiOrderBook &get_or_create_book(const std::string &ticker,
                                       std::int64_t cid);
 
   std::unordered_map<std::string, KalshiOrderBook> books;
   std::unordered_map<std::int64_t, std::string> cid_to_ticker;
+  QueueModel queue_model = QueueModel::Pessimistic;
+};
+
+// Where our resting orders sit in each market's queue; see
+// KalshiOrderBook::track_order. The engine applies our fills itself,
+// matched on client_order_id; acks and cancels come from whatever sends
+// the orders, which reports them here. Engine thread only.
+class OrderQueue {
+public:
+  explicit OrderQueue(KalshiOrderBookManager &books) : books(&books) {}
+
+  // Order `id` now rests with `remaining` contracts at `price` on `side`.
+  // Returns false if the market has no book to measure the queue against.
+  bool on_ack(const std::string &ticker, std::uint64_t id, Side side,
+              int price, int remaining);
+  // Call before the feed delivers the delta our cancel causes, so our own
+  // contracts leaving the level do not count as queue progress.
+  void on_cancel(const std::string &ticker, std::uint64_t id);
+
+private:
+  KalshiOrderBookManager *books;
 };
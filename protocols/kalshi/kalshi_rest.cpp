@@ -0,0 +1,66 @@
+#include "kalshi_rest.hpp"
+
+#include "kalshi_auth.hpp"
+#include <exception>
+#include <ixwebsocket/IXHttpClient.h>
+
+struct KalshiRestTransport::Slot {
+  ix::HttpClient client;
+  std::string timestamp;
+  std::string signature;
+};
+
+KalshiRestTransport::KalshiRestTransport(std::string host_,
+                                         std::size_t connections,
+                                         int timeout_secs_)
+    : host(std::move(host_)), timeout_secs(timeout_secs_) {
+  if (connections == 0)
+    connections = 1;
+  for (std::size_t i = 0; i < connections; ++i) {
+    slots.push_back(std::make_unique<Slot>());
+    idle.push_back(slots.back().get());
+  }
+}
+
+KalshiRestTransport::~KalshiRestTransport() = default;
+
+KalshiRestTransport::Slot *KalshiRestTransport::acquire() {
+  std::unique_lock<std::mutex> lock(m);
+  cv.wait(lock, [&] { return !idle.empty(); });
+  Slot *s = idle.back();
+  idle.pop_back();
+  return s;
+}
+
+void KalshiRestTransport::release(Slot *s) {
+  {
+    std::lock_guard<std::mutex> lock(m);
+    idle.push_back(s);
+  }
+  cv.notify_one();
+}
+
+RestResponse KalshiRestTransport::get(const std::string &path) {
+  Slot *s = acquire();
+  RestResponse out;
+  try {
+    KalshiAuth::instance().sign_request("GET", path, s->timestamp,
+                                        s->signature);
+    const std::string url = host + path;
+    auto args = s->client.createRequest(url, "GET");
+    args->extraHeaders["KALSHI-ACCESS-KEY"] =
+        KalshiAuth::instance().api_key_id();
+    args->extraHeaders["KALSHI-ACCESS-TIMESTAMP"] = s->timestamp;
+    args->extraHeaders["KALSHI-ACCESS-SIGNATURE"] = s->signature;
+    args->connectTimeout = timeout_secs;
+    args->transferTimeout = timeout_secs;
+    auto res = s->client.get(url, args);
+    out.status = res->statusCode;
+    out.body = std::move(res->body);
+    out.error = std::move(res->errorMsg);
+  } catch (const std::exception &e) {
+    out.error = e.what();
+  }
+  release(s);
+  return out;
+}
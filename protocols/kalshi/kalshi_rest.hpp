@@ -0,0 +1,53 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+struct RestResponse {
+  int status = 0;    // HTTP status; 0 if the request never completed
+  std::string body;
+  std::string error; // transport error, if any
+  bool ok() const { return status >= 200 && status < 300; }
+};
+
+// Issues GETs against the trade API. `path` is the full request path with
+// its query, e.g. "/trade-api/v2/markets?limit=1000". Implementations must
+// be safe to call from several threads at once.
+class RestTransport {
+public:
+  virtual ~RestTransport() = default;
+  virtual RestResponse get(const std::string &path) = 0;
+};
+
+// Signed requests, at most `connections` in flight. Each slot owns one
+// ix::HttpClient, but that client opens a new socket (and TLS session) for
+// every request and closes it after, so there is no keep-alive: the slots
+// only bound concurrency. A caller blocks while every slot is busy. Every
+// request is signed through KalshiAuth, which must be configured first.
+class KalshiRestTransport : public RestTransport {
+public:
+  // `host` is scheme and authority only, e.g.
+  // "https://api.elections.kalshi.com".
+  KalshiRestTransport(std::string host, std::size_t connections,
+                      int timeout_secs = 10);
+  ~KalshiRestTransport() override;
+
+  RestResponse get(const std::string &path) override;
+
+private:
+  struct Slot;
+
+  Slot *acquire();
+  void release(Slot *s);
+
+  std::string host;
+  int timeout_secs;
+  std::vector<std::unique_ptr<Slot>> slots;
+  std::vector<Slot *> idle;
+  std::mutex m;
+  std::condition_variable cv;
+};
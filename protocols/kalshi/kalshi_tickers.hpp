@@ -0,0 +1,12 @@
+#pragma once
+
+#include <string_view>
+
+// Kalshi market tickers are the event ticker plus a final "-<outcome>"
+// segment (KXNBAPLAYOFF-26-CHI belongs to KXNBAPLAYOFF-26). Tickers without
+// a dash are their own event.
+inline std::string_view event_ticker(std::string_view market_ticker) {
+  const auto dash = market_ticker.rfind('-');
+  return dash == std::string_view::npos ? market_ticker
+                                        : market_ticker.substr(0, dash);
+}
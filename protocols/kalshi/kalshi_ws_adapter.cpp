@@ -1,6 +1,66 @@
 #include "protocols/kalshi/kalshi_ws_adapter.hpp"
+#include <charconv>
+#include <chrono>
 #include <nlohmann/json.hpp>
 
+namespace {
+
+// The message's `ts` in ns since the epoch, or 0. Integer stamps are seconds
+// on most channels; the unit is taken from the magnitude so ms, us and ns
+// stamps work too. String stamps are RFC 3339 in UTC.
+std::int64_t exchange_ts_ns(const nlohmann::json &msg) {
+  const auto it = msg.find("ts");
+  if (it == msg.end())
+    return 0;
+  if (it->is_number()) {
+    const auto v = it->get<std::int64_t>();
+    if (v <= 0)
+      return 0;
+    if (v < 100'000'000'000LL)
+      return v * 1'000'000'000;
+    if (v < 100'000'000'000'000LL)
+      return v * 1'000'000;
+    if (v < 100'000'000'000'000'000LL)
+      return v * 1'000;
+    return v;
+  }
+  if (!it->is_string())
+    return 0;
+
+  // YYYY-MM-DDTHH:MM:SS[.fraction]Z
+  const std::string &s = it->get_ref<const std::string &>();
+  if (s.size() < 19)
+    return 0;
+  auto field = [&](std::size_t pos, std::size_t len) {
+    int v = -1;
+    std::from_chars(s.data() + pos, s.data() + pos + len, v);
+    return v;
+  };
+  const int y = field(0, 4), mo = field(5, 2), d = field(8, 2);
+  const int h = field(11, 2), mi = field(14, 2), sec = field(17, 2);
+  if (y < 0 || mo < 0 || d < 0 || h < 0 || mi < 0 || sec < 0)
+    return 0;
+  const std::chrono::year_month_day date{
+      std::chrono::year(y), std::chrono::month(static_cast<unsigned>(mo)),
+      std::chrono::day(static_cast<unsigned>(d))};
+  if (!date.ok())
+    return 0;
+  std::int64_t ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                        std::chrono::sys_days(date).time_since_epoch())
+                        .count();
+  ns += ((h * 60LL + mi) * 60 + sec) * 1'000'000'000LL;
+  if (s.size() > 20 && s[19] == '.') {
+    std::int64_t scale = 100'000'000;
+    for (std::size_t i = 20; i < s.size() && s[i] >= '0' && s[i] <= '9';
+         ++i, scale /= 10) {
+      ns += (s[i] - '0') * scale;
+    }
+  }
+  return ns;
+}
+
+} // namespace
+
 std::optional<FeedEvent> KalshiWsAdapter::parse(std::string_view raw) {
   nlohmann::json jdata = nlohmann::json::parse(raw, nullptr, false);
   if (jdata.is_discarded()) {
@@ -12,10 +72,10 @@ std::optional<FeedEvent> KalshiWsAdapter::parse(std::string_view raw) {
   }
   const std::string type = jdata["type"].get<std::string>();
   const int sid = jdata["sid"].get<int>();
-  const std::int64_t seq = jdata["seq"].get<std::int64_t>();
   const auto &msg = jdata["msg"];
   FeedEvent ev;
   ev.exchange = Exchange::KALSHI;
+  ev.exchange_ts_ns = exchange_ts_ns(msg);
 
   if (type == "orderbook_snapshot") {
     if (!jdata.contains("seq")) {
@@ -122,7 +182,6 @@ std::optional<FeedEvent> KalshiWsAdapter::parse(std::string_view raw) {
     }
 
     // ----- Wrap into FeedEvent -----
-    FeedEvent ev;
     ev.type = FeedEvent::Type::Fill;
     ev.ticker = fill.market_ticker;
     ev.cid = sid;
@@ -130,5 +189,44 @@ std::optional<FeedEvent> KalshiWsAdapter::parse(std::string_view raw) {
     return ev;
   }
 
+  // trade and ticker only take the fields the strategy uses.
+  if (type == "trade") {
+    if (!msg.contains("market_ticker") || !msg.contains("yes_price") ||
+        !msg.contains("count")) {
+      return std::nullopt;
+    }
+    TradeEvent t;
+    t.yes_price = msg["yes_price"].get<int>();
+    t.count = msg["count"].get<int>();
+    t.taker_side = msg.value("taker_side", std::string()) == "yes" ? Side::YES
+                                                                  : Side::NO;
+    t.ts = msg.value("ts", std::int64_t{0});
+
+    ev.type = FeedEvent::Type::Trade;
+    ev.ticker = msg["market_ticker"].get<std::string>();
+    ev.cid = sid;
+    ev.payload = t;
+    return ev;
+  }
+
+  if (type == "ticker") {
+    if (!msg.contains("market_ticker")) {
+      return std::nullopt;
+    }
+    TickerEvent t;
+    t.price = msg.value("price", 0);
+    t.yes_bid = msg.value("yes_bid", 0);
+    t.yes_ask = msg.value("yes_ask", 0);
+    t.volume = msg.value("volume", std::int64_t{0});
+    t.open_interest = msg.value("open_interest", std::int64_t{0});
+    t.ts = msg.value("ts", std::int64_t{0});
+
+    ev.type = FeedEvent::Type::Ticker;
+    ev.ticker = msg["market_ticker"].get<std::string>();
+    ev.cid = sid;
+    ev.payload = t;
+    return ev;
+  }
+
   return std::nullopt;
 }
@@ -0,0 +1,226 @@
+#include "book_columns.hpp"
+
+#ifdef KALSHI_RECORDER_ZSTD
+#include <zstd.h>
+#endif
+#ifdef KALSHI_RECORDER_LZ4
+#include <lz4.h>
+#endif
+
+namespace {
+
+void put_varint(std::vector<unsigned char> &out, std::uint64_t v) {
+  while (v >= 0x80) {
+    out.push_back(static_cast<unsigned char>(v | 0x80));
+    v >>= 7;
+  }
+  out.push_back(static_cast<unsigned char>(v));
+}
+
+bool get_varint(const unsigned char *&p, const unsigned char *end,
+                std::uint64_t &v) {
+  v = 0;
+  for (int shift = 0; shift < 64 && p < end; shift += 7) {
+    const unsigned char b = *p++;
+    v |= static_cast<std::uint64_t>(b & 0x7f) << shift;
+    if (!(b & 0x80))
+      return true;
+  }
+  return false;
+}
+
+std::uint64_t zigzag(std::int64_t v) {
+  return (static_cast<std::uint64_t>(v) << 1) ^
+         static_cast<std::uint64_t>(v >> 63);
+}
+
+std::int64_t unzigzag(std::uint64_t v) {
+  return static_cast<std::int64_t>(v >> 1) ^ -static_cast<std::int64_t>(v & 1);
+}
+
+// Yes levels then no levels, so a column index addresses either ladder.
+RecordedLevel &level(BookSample &s, std::uint32_t col, std::uint32_t depth) {
+  return col < depth ? s.yes[col] : s.no[col - depth];
+}
+
+const RecordedLevel &level(const BookSample &s, std::uint32_t col,
+                           std::uint32_t depth) {
+  return col < depth ? s.yes[col] : s.no[col - depth];
+}
+
+} // namespace
+
+Compression parse_compression(const std::string &s) {
+  if (s == "zstd")
+    return Compression::Zstd;
+  if (s == "lz4")
+    return Compression::Lz4;
+  return Compression::None;
+}
+
+const char *to_string(Compression c) {
+  switch (c) {
+  case Compression::Zstd:
+    return "zstd";
+  case Compression::Lz4:
+    return "lz4";
+  case Compression::None:
+    break;
+  }
+  return "none";
+}
+
+bool compression_available(Compression c) {
+  switch (c) {
+  case Compression::None:
+    return true;
+  case Compression::Zstd:
+#ifdef KALSHI_RECORDER_ZSTD
+    return true;
+#else
+    return false;
+#endif
+  case Compression::Lz4:
+#ifdef KALSHI_RECORDER_LZ4
+    return true;
+#else
+    return false;
+#endif
+  }
+  return false;
+}
+
+std::uint32_t recording_checksum(const unsigned char *p, std::size_t n) {
+  std::uint32_t h = 2166136261u;
+  for (std::size_t i = 0; i < n; ++i) {
+    h ^= p[i];
+    h *= 16777619u;
+  }
+  return h;
+}
+
+void encode_columns(const BookSample *rows, std::size_t n, std::uint32_t depth,
+                    std::vector<unsigned char> &out) {
+  std::int64_t prev_ts = 0;
+  for (std::size_t i = 0; i < n; ++i) {
+    put_varint(out, zigzag(rows[i].ts_ns - prev_ts));
+    prev_ts = rows[i].ts_ns;
+  }
+  for (std::uint32_t col = 0; col < 2 * depth; ++col) {
+    std::int64_t prev_price = 0;
+    for (std::size_t i = 0; i < n; ++i) {
+      const std::int64_t price = level(rows[i], col, depth).price;
+      put_varint(out, zigzag(price - prev_price));
+      prev_price = price;
+    }
+    for (std::size_t i = 0; i < n; ++i) {
+      const std::int32_t size = level(rows[i], col, depth).size;
+      put_varint(out, static_cast<std::uint32_t>(size));
+    }
+  }
+}
+
+bool decode_columns(const unsigned char *p, std::size_t len, std::size_t n,
+                    std::uint32_t depth, std::uint32_t market,
+                    std::vector<BookSample> &out) {
+  if (depth > static_cast<std::uint32_t>(kMaxRecordedDepth))
+    return false;
+  const unsigned char *end = p + len;
+  const std::size_t base = out.size();
+  out.resize(base + n);
+  BookSample *rows = out.data() + base;
+
+  std::uint64_t v = 0;
+  std::int64_t ts = 0;
+  for (std::size_t i = 0; i < n; ++i) {
+    if (!get_varint(p, end, v))
+      return false;
+    ts += unzigzag(v);
+    rows[i].ts_ns = ts;
+    rows[i].market = market;
+    rows[i].depth = depth;
+  }
+  for (std::uint32_t col = 0; col < 2 * depth; ++col) {
+    std::int64_t price = 0;
+    for (std::size_t i = 0; i < n; ++i) {
+      if (!get_varint(p, end, v))
+        return false;
+      price += unzigzag(v);
+      level(rows[i], col, depth).price = static_cast<std::int32_t>(price);
+    }
+    for (std::size_t i = 0; i < n; ++i) {
+      if (!get_varint(p, end, v))
+        return false;
+      level(rows[i], col, depth).size = static_cast<std::int32_t>(v);
+    }
+  }
+  return p == end;
+}
+
+bool compress_block(Compression c, const std::vector<unsigned char> &raw,
+                    std::vector<unsigned char> &out) {
+  switch (c) {
+  case Compression::None:
+    out = raw;
+    return true;
+  case Compression::Zstd: {
+#ifdef KALSHI_RECORDER_ZSTD
+    out.resize(ZSTD_compressBound(raw.size()));
+    const std::size_t n =
+        ZSTD_compress(out.data(), out.size(), raw.data(), raw.size(), 3);
+    if (ZSTD_isError(n))
+      return false;
+    out.resize(n);
+    return true;
+#else
+    return false;
+#endif
+  }
+  case Compression::Lz4: {
+#ifdef KALSHI_RECORDER_LZ4
+    out.resize(LZ4_compressBound(static_cast<int>(raw.size())));
+    const int n = LZ4_compress_default(
+        reinterpret_cast<const char *>(raw.data()),
+        reinterpret_cast<char *>(out.data()), static_cast<int>(raw.size()),
+        static_cast<int>(out.size()));
+    if (n <= 0)
+      return false;
+    out.resize(static_cast<std::size_t>(n));
+    return true;
+#else
+    return false;
+#endif
+  }
+  }
+  return false;
+}
+
+bool decompress_block(Compression c, const unsigned char *p, std::size_t n,
+                      std::size_t raw_bytes, std::vector<unsigned char> &out) {
+  switch (c) {
+  case Compression::None:
+    out.assign(p, p + n);
+    return n == raw_bytes;
+  case Compression::Zstd: {
+#ifdef KALSHI_RECORDER_ZSTD
+    out.resize(raw_bytes);
+    const std::size_t got = ZSTD_decompress(out.data(), raw_bytes, p, n);
+    return !ZSTD_isError(got) && got == raw_bytes;
+#else
+    return false;
+#endif
+  }
+  case Compression::Lz4: {
+#ifdef KALSHI_RECORDER_LZ4
+    out.resize(raw_bytes);
+    const int got = LZ4_decompress_safe(
+        reinterpret_cast<const char *>(p), reinterpret_cast<char *>(out.data()),
+        static_cast<int>(n), static_cast<int>(raw_bytes));
+    return got >= 0 && static_cast<std::size_t>(got) == raw_bytes;
+#else
+    return false;
+#endif
+  }
+  }
+  return false;
+}
@@ -0,0 +1,104 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+constexpr int kMaxRecordedDepth = 10;
+
+struct RecordedLevel {
+  std::int32_t price = 0; // cents; 0 means no level
+  std::int32_t size = 0;
+};
+
+// One observation of a market's book: both bid ladders, best level first.
+// Plain data, so the engine thread can hand it to the writer by copy.
+struct BookSample {
+  std::int64_t ts_ns = 0; // wall clock
+  std::uint32_t market = 0;
+  std::uint32_t depth = 0; // levels kept per side
+  std::array<RecordedLevel, kMaxRecordedDepth> yes{};
+  std::array<RecordedLevel, kMaxRecordedDepth> no{};
+
+  int yes_bid() const { return yes[0].price; }
+  int yes_bid_size() const { return yes[0].size; }
+  // Implied by the best NO bid; 0 if there is none.
+  int yes_ask() const { return no[0].price ? 100 - no[0].price : 0; }
+  int yes_ask_size() const { return no[0].size; }
+
+  // Size-weighted mid in YES cents, leaning toward the thinner side; 0 if
+  // either side is empty.
+  double microprice() const {
+    const int bid = yes_bid(), ask = yes_ask();
+    const double bs = yes_bid_size(), as = yes_ask_size();
+    if (!bid || !ask || bs + as <= 0)
+      return 0.0;
+    return (bid * as + ask * bs) / (bs + as);
+  }
+};
+
+enum class Compression : std::uint8_t { None, Zstd, Lz4 };
+
+Compression parse_compression(const std::string &s);
+const char *to_string(Compression c);
+// Whether this build links the codec (KALSHI_RECORDER_ZSTD / _LZ4).
+bool compression_available(Compression c);
+
+// On-disk layout. A recording is a FileHeader followed by blocks; each
+// block holds up to rows_per_block samples of one market as columns and
+// starts with a BlockHeader, the ticker, then the (possibly compressed)
+// payload. The sidecar index (<path>.idx) has one IndexEntry per block so
+// a reader can jump to a time window without touching other blocks.
+constexpr char kRecordingMagic[8] = {'K', 'B', 'O', 'O', 'K', 'R', 'E', 'C'};
+constexpr std::uint32_t kRecordingVersion = 1;
+constexpr std::uint32_t kBlockMagic = 0x314b4c42; // "BLK1"
+
+struct RecordingFileHeader {
+  char magic[8];
+  std::uint32_t version;
+  std::uint32_t depth;
+};
+
+struct RecordingBlockHeader {
+  std::uint32_t magic;
+  std::uint32_t checksum; // FNV-1a of the stored payload
+  std::int64_t first_ts_ns;
+  std::int64_t last_ts_ns;
+  std::uint32_t rows;
+  std::uint32_t raw_bytes;    // encoded columns before compression
+  std::uint32_t stored_bytes; // payload as written
+  std::uint8_t compression;
+  std::uint8_t ticker_len;
+  std::uint8_t pad[2];
+};
+
+struct RecordingIndexEntry {
+  std::int64_t first_ts_ns;
+  std::int64_t last_ts_ns;
+  std::uint64_t offset; // of the block header
+  std::uint32_t rows;
+  std::uint32_t pad;
+  char ticker[64];
+};
+
+std::uint32_t recording_checksum(const unsigned char *p, std::size_t n);
+
+// Column encoding: timestamps as a zigzag varint delta from the previous
+// row (the first from zero), then for each side and level a price column
+// delta-coded the same way and a size column as plain varints. Book
+// prices move a tick or two and sizes are small, so most values fit in one
+// byte.
+void encode_columns(const BookSample *rows, std::size_t n, std::uint32_t depth,
+                    std::vector<unsigned char> &out);
+// Appends `n` rows to `out`; false if the payload is malformed.
+bool decode_columns(const unsigned char *p, std::size_t len, std::size_t n,
+                    std::uint32_t depth, std::uint32_t market,
+                    std::vector<BookSample> &out);
+
+// False if the codec is not compiled in or fails.
+bool compress_block(Compression c, const std::vector<unsigned char> &raw,
+                    std::vector<unsigned char> &out);
+bool decompress_block(Compression c, const unsigned char *p, std::size_t n,
+                      std::size_t raw_bytes, std::vector<unsigned char> &out);
@@ -0,0 +1,256 @@
+#include "book_recorder.hpp"
+#include "infra/metrics.hpp"
+#include "infra/runtime_tuning.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+
+namespace {
+
+std::int64_t wall_ns() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::system_clock::now().time_since_epoch())
+      .count();
+}
+
+void copy_levels(const OrderBook::Levels &levels, std::uint32_t depth,
+                 std::array<RecordedLevel, kMaxRecordedDepth> &out) {
+  std::uint32_t i = 0;
+  for (auto it = levels.begin(); it != levels.end() && i < depth; ++it, ++i) {
+    out[i].price = it->first;
+    out[i].size = it->second;
+  }
+}
+
+bool same(const RecordedLevel &a, const RecordedLevel &b) {
+  return a.price == b.price && a.size == b.size;
+}
+
+} // namespace
+
+BookRecorderConfig book_recorder_config_from_json(const nlohmann::json &j) {
+  BookRecorderConfig cfg;
+  cfg.path = j.value("path", cfg.path);
+  cfg.mode = j.value("mode", std::string("top_of_book")) == "interval"
+                 ? SampleMode::Interval
+                 : SampleMode::TopOfBook;
+  cfg.interval = std::chrono::milliseconds(
+      j.value("interval_ms", int(cfg.interval.count())));
+  cfg.depth = std::min<std::uint32_t>(j.value("depth", cfg.depth),
+                                      kMaxRecordedDepth);
+  cfg.rows_per_block = j.value("rows_per_block", cfg.rows_per_block);
+  cfg.ring_capacity = j.value("ring_capacity", cfg.ring_capacity);
+  cfg.compression = parse_compression(j.value("compression", std::string()));
+  cfg.flush_interval = std::chrono::milliseconds(
+      j.value("flush_interval_ms", int(cfg.flush_interval.count())));
+  return cfg;
+}
+
+BookRecorder::BookRecorder(BookRecorderConfig c)
+    : cfg(std::move(c)), ring(cfg.ring_capacity) {
+  cfg.depth = std::clamp<std::uint32_t>(cfg.depth, 1, kMaxRecordedDepth);
+  cfg.rows_per_block = std::max<std::size_t>(cfg.rows_per_block, 1);
+}
+
+BookRecorder::~BookRecorder() {
+  stop();
+  if (data)
+    std::fclose(data);
+  if (index)
+    std::fclose(index);
+}
+
+bool BookRecorder::open() {
+  if (!compression_available(cfg.compression)) {
+    std::cerr << "[REC] " << to_string(cfg.compression)
+              << " not built in; writing uncompressed blocks" << std::endl;
+    cfg.compression = Compression::None;
+  }
+  data = std::fopen(cfg.path.c_str(), "wb");
+  index = std::fopen((cfg.path + ".idx").c_str(), "wb");
+  if (!data || !index) {
+    std::cerr << "[REC] cannot create " << cfg.path << ": "
+              << std::strerror(errno) << std::endl;
+    return false;
+  }
+  RecordingFileHeader h{};
+  std::memcpy(h.magic, kRecordingMagic, sizeof(h.magic));
+  h.version = kRecordingVersion;
+  h.depth = cfg.depth;
+  if (std::fwrite(&h, sizeof(h), 1, data) != 1) {
+    std::cerr << "[REC] write failed: " << cfg.path << std::endl;
+    return false;
+  }
+  std::fflush(data);
+  offset = sizeof(h);
+  return true;
+}
+
+void BookRecorder::start() {
+  if (!data || running.exchange(true))
+    return;
+  writer = std::thread(&BookRecorder::writer_loop, this);
+}
+
+void BookRecorder::stop() {
+  running = false;
+  if (writer.joinable())
+    writer.join();
+}
+
+BookRecorder::MarketState &BookRecorder::market(const std::string &ticker) {
+  auto it = markets.find(ticker);
+  if (it != markets.end())
+    return it->second;
+  MarketState st{};
+  {
+    std::lock_guard<std::mutex> lock(names_m);
+    st.id = static_cast<std::uint32_t>(names.size());
+    names.push_back(ticker);
+  }
+  return markets.emplace(ticker, st).first->second;
+}
+
+void BookRecorder::handle_feed_event(const FeedEvent &ev,
+                                     const KalshiOrderBook *book) {
+  if (ev.type != FeedEvent::Type::OrderbookSnapshot &&
+      ev.type != FeedEvent::Type::OrderbookDelta)
+    return;
+  if (!book || !book->has_snapshot)
+    return;
+
+  MarketState &st = market(ev.ticker);
+  const auto &yes = book->book.bids(Side::YES);
+  const auto &no = book->book.bids(Side::NO);
+  const RecordedLevel yes_top =
+      yes.empty() ? RecordedLevel{} : RecordedLevel{yes.begin()->first,
+                                                    yes.begin()->second};
+  const RecordedLevel no_top =
+      no.empty() ? RecordedLevel{}
+                 : RecordedLevel{no.begin()->first, no.begin()->second};
+
+  const std::int64_t now = wall_ns();
+  if (st.sampled && ev.type == FeedEvent::Type::OrderbookDelta) {
+    if (cfg.mode == SampleMode::TopOfBook) {
+      if (same(yes_top, st.yes_top) && same(no_top, st.no_top))
+        return;
+    } else if (now - st.last_ts_ns <
+               std::chrono::nanoseconds(cfg.interval).count()) {
+      return;
+    }
+  }
+  st.sampled = true;
+  st.yes_top = yes_top;
+  st.no_top = no_top;
+  st.last_ts_ns = now;
+
+  BookSample s;
+  s.ts_ns = now;
+  s.market = st.id;
+  s.depth = cfg.depth;
+  copy_levels(yes, cfg.depth, s.yes);
+  copy_levels(no, cfg.depth, s.no);
+  if (ring.try_push(s)) {
+    sampled.store(sampled.load(std::memory_order_relaxed) + 1,
+                  std::memory_order_relaxed);
+    metric_inc(Counter::RecorderSamples);
+  } else {
+    dropped.store(dropped.load(std::memory_order_relaxed) + 1,
+                  std::memory_order_relaxed);
+    metric_inc(Counter::RecorderDrops);
+  }
+}
+
+void BookRecorder::writer_loop() {
+  RuntimeTuning::instance().tune_current_thread("recorder");
+  auto last_flush = std::chrono::steady_clock::now();
+  while (running.load(std::memory_order_acquire)) {
+    const std::size_t n = drain();
+    const auto now = std::chrono::steady_clock::now();
+    if (now - last_flush >= cfg.flush_interval) {
+      flush_all();
+      last_flush = now;
+    }
+    if (n == 0)
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  drain();
+  flush_all();
+}
+
+std::size_t BookRecorder::drain() {
+  std::size_t n = 0;
+  BookSample s;
+  while (ring.try_pop(s)) {
+    ++n;
+    if (s.market >= pending.size())
+      pending.resize(s.market + 1);
+    auto &rows = pending[s.market];
+    rows.push_back(s);
+    if (rows.size() >= cfg.rows_per_block)
+      write_block(s.market);
+  }
+  return n;
+}
+
+void BookRecorder::flush_all() {
+  for (std::uint32_t id = 0; id < pending.size(); ++id) {
+    if (!pending[id].empty())
+      write_block(id);
+  }
+}
+
+void BookRecorder::write_block(std::uint32_t id) {
+  auto &rows = pending[id];
+  std::string ticker;
+  {
+    std::lock_guard<std::mutex> lock(names_m);
+    ticker = names[id];
+  }
+  // The index keeps the ticker in a fixed field; the block matches it.
+  if (ticker.size() >= sizeof(RecordingIndexEntry::ticker))
+    ticker.resize(sizeof(RecordingIndexEntry::ticker) - 1);
+
+  raw.clear();
+  encode_columns(rows.data(), rows.size(), cfg.depth, raw);
+  Compression codec = cfg.compression;
+  if (!compress_block(codec, raw, packed)) {
+    codec = Compression::None;
+    packed = raw;
+  }
+
+  RecordingBlockHeader h{};
+  h.magic = kBlockMagic;
+  h.checksum = recording_checksum(packed.data(), packed.size());
+  h.first_ts_ns = rows.front().ts_ns;
+  h.last_ts_ns = rows.back().ts_ns;
+  h.rows = static_cast<std::uint32_t>(rows.size());
+  h.raw_bytes = static_cast<std::uint32_t>(raw.size());
+  h.stored_bytes = static_cast<std::uint32_t>(packed.size());
+  h.compression = static_cast<std::uint8_t>(codec);
+  h.ticker_len = static_cast<std::uint8_t>(ticker.size());
+
+  RecordingIndexEntry e{};
+  e.first_ts_ns = h.first_ts_ns;
+  e.last_ts_ns = h.last_ts_ns;
+  e.offset = offset;
+  e.rows = h.rows;
+  std::strncpy(e.ticker, ticker.c_str(), sizeof(e.ticker) - 1);
+
+  // The index is flushed after the data, so it never points past it.
+  const bool ok =
+      std::fwrite(&h, sizeof(h), 1, data) == 1 &&
+      std::fwrite(ticker.data(), 1, ticker.size(), data) == ticker.size() &&
+      std::fwrite(packed.data(), 1, packed.size(), data) == packed.size() &&
+      std::fflush(data) == 0 &&
+      std::fwrite(&e, sizeof(e), 1, index) == 1 && std::fflush(index) == 0;
+  if (!ok) {
+    std::cerr << "[REC] write failed: " << cfg.path << ": "
+              << std::strerror(errno) << std::endl;
+  }
+  offset += sizeof(h) + ticker.size() + packed.size();
+  rows.clear();
+  blocks_written.fetch_add(1, std::memory_order_release);
+}
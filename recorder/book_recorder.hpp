@@ -0,0 +1,111 @@
+#pragma once
+
+#include "book_columns.hpp"
+#include "infra/spsc_ring.hpp"
+#include "strategy/strategy.hpp"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <nlohmann/json.hpp>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+enum class SampleMode {
+  TopOfBook, // whenever the best price or size on either side changes
+  Interval   // at most once per interval per market, on a book change
+};
+
+struct BookRecorderConfig {
+  std::string path = "kalshi_books.rec"; // index goes to <path>.idx
+  SampleMode mode = SampleMode::TopOfBook;
+  std::chrono::milliseconds interval{100};
+  std::uint32_t depth = 5; // levels per side, up to kMaxRecordedDepth
+  std::size_t rows_per_block = 4096;
+  std::size_t ring_capacity = 1 << 16;
+  Compression compression = Compression::None;
+  // Partial blocks are written at least this often, bounding what a crash
+  // loses.
+  std::chrono::milliseconds flush_interval{5000};
+};
+
+// Reads the "recorder" section of runner.json.
+BookRecorderConfig book_recorder_config_from_json(const nlohmann::json &j);
+
+// Research recorder for BBO and depth. Registered with the engine like a
+// strategy, it copies the top `depth` levels of each changed book into a
+// fixed-size BookSample and pushes it onto an SPSC ring; nothing else
+// happens on the engine thread. A writer thread groups samples into
+// per-market column blocks (see book_columns.hpp) and appends them to the
+// recording and its time index. Samples are dropped, and counted, if the
+// writer falls a full ring behind.
+class BookRecorder : public Strategy {
+public:
+  explicit BookRecorder(BookRecorderConfig cfg);
+  ~BookRecorder() override;
+
+  BookRecorder(const BookRecorder &) = delete;
+  BookRecorder &operator=(const BookRecorder &) = delete;
+
+  // Creates (truncating) the recording and its index. Call before start().
+  bool open();
+
+  void start();
+  // Drains the ring and writes every partial block.
+  void stop();
+
+  void handle_feed_event(const FeedEvent &ev,
+                         const KalshiOrderBook *book) override;
+
+  std::uint64_t samples() const {
+    return sampled.load(std::memory_order_relaxed);
+  }
+  std::uint64_t drops() const {
+    return dropped.load(std::memory_order_relaxed);
+  }
+  std::uint64_t blocks() const {
+    return blocks_written.load(std::memory_order_acquire);
+  }
+
+private:
+  struct MarketState {
+    std::uint32_t id;
+    RecordedLevel yes_top;
+    RecordedLevel no_top;
+    std::int64_t last_ts_ns = 0;
+    bool sampled = false;
+  };
+
+  MarketState &market(const std::string &ticker);
+  void writer_loop();
+  std::size_t drain();
+  void write_block(std::uint32_t id);
+  void flush_all();
+
+  BookRecorderConfig cfg;
+  SpscRing<BookSample> ring;
+
+  // Engine thread.
+  std::unordered_map<std::string, MarketState> markets;
+  std::atomic<std::uint64_t> sampled{0};
+  std::atomic<std::uint64_t> dropped{0};
+
+  // Ticker by market id; appended by the engine thread on first sight.
+  std::mutex names_m;
+  std::vector<std::string> names;
+
+  // Writer thread.
+  std::vector<std::vector<BookSample>> pending; // by market id
+  std::vector<unsigned char> raw;
+  std::vector<unsigned char> packed;
+  std::FILE *data = nullptr;
+  std::FILE *index = nullptr;
+  std::uint64_t offset = 0;
+  std::atomic<std::uint64_t> blocks_written{0};
+
+  std::thread writer;
+  std::atomic<bool> running{false};
+};
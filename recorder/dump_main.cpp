@@ -0,0 +1,56 @@
+#include "recorder/recording_reader.hpp"
+#include <cstdio>
+#include <iostream>
+#include <limits>
+#include <string>
+
+// Lists the markets in a recording, or prints one market's samples in a
+// time window as CSV.
+int main(int argc, char **argv) {
+  if (argc != 2 && argc != 3 && argc != 5) {
+    std::cerr << "usage: ./kalshi_recording_dump path/to/books.rec "
+                 "[ticker [from_ns to_ns]]"
+              << std::endl;
+    return 1;
+  }
+
+  RecordingReader reader;
+  if (!reader.open(argv[1]))
+    return 1;
+
+  if (argc == 2) {
+    std::cout << reader.block_count() << " blocks, depth " << reader.depth()
+              << '\n';
+    for (const auto &t : reader.markets())
+      std::cout << t << '\n';
+    return 0;
+  }
+
+  std::int64_t from = std::numeric_limits<std::int64_t>::min();
+  std::int64_t to = std::numeric_limits<std::int64_t>::max();
+  if (argc == 5) {
+    from = std::stoll(argv[3]);
+    to = std::stoll(argv[4]);
+  }
+  std::vector<BookSample> rows;
+  std::size_t blocks = 0;
+  if (!reader.read(argv[2], from, to, rows, &blocks))
+    return 1;
+
+  std::printf("ts_ns,yes_bid,yes_bid_size,yes_ask,yes_ask_size,microprice");
+  for (std::uint32_t i = 0; i < reader.depth(); ++i)
+    std::printf(",yes%u_px,yes%u_sz,no%u_px,no%u_sz", i, i, i, i);
+  std::printf("\n");
+  for (const auto &r : rows) {
+    std::printf("%lld,%d,%d,%d,%d,%.3f", static_cast<long long>(r.ts_ns),
+                r.yes_bid(), r.yes_bid_size(), r.yes_ask(), r.yes_ask_size(),
+                r.microprice());
+    for (std::uint32_t i = 0; i < r.depth; ++i)
+      std::printf(",%d,%d,%d,%d", r.yes[i].price, r.yes[i].size,
+                  r.no[i].price, r.no[i].size);
+    std::printf("\n");
+  }
+  std::cerr << rows.size() << " samples from " << blocks << " blocks"
+            << std::endl;
+  return 0;
+}
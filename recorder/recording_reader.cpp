@@ -0,0 +1,144 @@
+#include "recording_reader.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <iostream>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+bool read_at(int fd, void *buf, std::size_t n, std::uint64_t off) {
+  auto *p = static_cast<unsigned char *>(buf);
+  while (n > 0) {
+    const ssize_t got = ::pread(fd, p, n, static_cast<off_t>(off));
+    if (got <= 0)
+      return false;
+    p += got;
+    off += static_cast<std::uint64_t>(got);
+    n -= static_cast<std::size_t>(got);
+  }
+  return true;
+}
+
+} // namespace
+
+RecordingReader::~RecordingReader() {
+  if (fd >= 0)
+    ::close(fd);
+}
+
+bool RecordingReader::open(const std::string &path) {
+  fd = ::open(path.c_str(), O_RDONLY);
+  if (fd < 0) {
+    std::cerr << "[REC] cannot open " << path << ": " << std::strerror(errno)
+              << std::endl;
+    return false;
+  }
+  RecordingFileHeader h{};
+  if (!read_at(fd, &h, sizeof(h), 0) ||
+      std::memcmp(h.magic, kRecordingMagic, sizeof(h.magic)) != 0 ||
+      h.version != kRecordingVersion ||
+      h.depth > static_cast<std::uint32_t>(kMaxRecordedDepth)) {
+    std::cerr << "[REC] not a book recording: " << path << std::endl;
+    return false;
+  }
+  depth_ = h.depth;
+  return load_index(path + ".idx") || scan_blocks();
+}
+
+void RecordingReader::add_block(const std::string &ticker, const Block &b) {
+  if (market_ids.emplace(ticker, tickers.size()).second)
+    tickers.push_back(ticker);
+  by_market[ticker].push_back(b);
+  ++blocks;
+}
+
+bool RecordingReader::load_index(const std::string &idx_path) {
+  const int ifd = ::open(idx_path.c_str(), O_RDONLY);
+  if (ifd < 0)
+    return false;
+  struct stat st{};
+  ::fstat(ifd, &st);
+  const std::size_t n =
+      static_cast<std::size_t>(st.st_size) / sizeof(RecordingIndexEntry);
+  std::vector<RecordingIndexEntry> entries(n);
+  const bool ok =
+      read_at(ifd, entries.data(), n * sizeof(RecordingIndexEntry), 0);
+  ::close(ifd);
+  if (!ok)
+    return false;
+  for (const auto &e : entries) {
+    add_block(std::string(e.ticker, strnlen(e.ticker, sizeof(e.ticker))),
+              Block{e.first_ts_ns, e.last_ts_ns, e.offset, e.rows});
+  }
+  return true;
+}
+
+bool RecordingReader::scan_blocks() {
+  std::cerr << "[REC] no index; scanning block headers" << std::endl;
+  std::uint64_t off = sizeof(RecordingFileHeader);
+  RecordingBlockHeader h{};
+  char ticker[256];
+  // A short or corrupt header marks the end of what was written.
+  while (read_at(fd, &h, sizeof(h), off) && h.magic == kBlockMagic &&
+         read_at(fd, ticker, h.ticker_len, off + sizeof(h))) {
+    add_block(std::string(ticker, h.ticker_len),
+              Block{h.first_ts_ns, h.last_ts_ns, off, h.rows});
+    off += sizeof(h) + h.ticker_len + h.stored_bytes;
+  }
+  return true;
+}
+
+bool RecordingReader::read(const std::string &ticker, std::int64_t from_ns,
+                           std::int64_t to_ns, std::vector<BookSample> &out,
+                           std::size_t *blocks_read) const {
+  if (blocks_read)
+    *blocks_read = 0;
+  auto it = by_market.find(ticker);
+  if (it == by_market.end())
+    return true;
+  const auto &list = it->second;
+  const std::uint32_t id = market_ids.at(ticker);
+
+  // Blocks of one market never overlap in time, so last_ts is sorted too.
+  auto b = std::lower_bound(
+      list.begin(), list.end(), from_ns,
+      [](const Block &blk, std::int64_t t) { return blk.last_ts_ns < t; });
+
+  std::vector<unsigned char> stored;
+  std::vector<unsigned char> raw;
+  std::vector<BookSample> rows;
+  for (; b != list.end() && b->first_ts_ns < to_ns; ++b) {
+    RecordingBlockHeader h{};
+    if (!read_at(fd, &h, sizeof(h), b->offset) || h.magic != kBlockMagic) {
+      std::cerr << "[REC] bad block header at " << b->offset << std::endl;
+      return false;
+    }
+    stored.resize(h.stored_bytes);
+    if (!read_at(fd, stored.data(), stored.size(),
+                 b->offset + sizeof(h) + h.ticker_len) ||
+        recording_checksum(stored.data(), stored.size()) != h.checksum) {
+      std::cerr << "[REC] corrupt block at " << b->offset << std::endl;
+      return false;
+    }
+    const auto codec = static_cast<Compression>(h.compression);
+    rows.clear();
+    if (!decompress_block(codec, stored.data(), stored.size(), h.raw_bytes,
+                          raw) ||
+        !decode_columns(raw.data(), raw.size(), h.rows, depth_, id, rows)) {
+      std::cerr << "[REC] cannot decode " << to_string(codec)
+                << " block at " << b->offset << std::endl;
+      return false;
+    }
+    if (blocks_read)
+      ++*blocks_read;
+    for (const auto &r : rows) {
+      if (r.ts_ns >= from_ns && r.ts_ns < to_ns)
+        out.push_back(r);
+    }
+  }
+  return true;
+}
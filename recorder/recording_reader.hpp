@@ -0,0 +1,54 @@
+#pragma once
+
+#include "book_columns.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Random access to a BookRecorder file. open() loads the time index
+// (<path>.idx, or a scan of the block headers if it is missing); read()
+// then decodes only the blocks of one market that overlap the requested
+// window. Safe to read from several threads once opened.
+class RecordingReader {
+public:
+  RecordingReader() = default;
+  ~RecordingReader();
+
+  RecordingReader(const RecordingReader &) = delete;
+  RecordingReader &operator=(const RecordingReader &) = delete;
+
+  bool open(const std::string &path);
+
+  std::uint32_t depth() const { return depth_; }
+  // Recorded tickers in first-seen order; BookSample::market indexes it.
+  const std::vector<std::string> &markets() const { return tickers; }
+  std::size_t block_count() const { return blocks; }
+
+  // Appends the samples of `ticker` with from_ns <= ts_ns < to_ns, in time
+  // order. `blocks_read`, if given, receives how many blocks were decoded.
+  bool read(const std::string &ticker, std::int64_t from_ns,
+            std::int64_t to_ns, std::vector<BookSample> &out,
+            std::size_t *blocks_read = nullptr) const;
+
+private:
+  struct Block {
+    std::int64_t first_ts_ns;
+    std::int64_t last_ts_ns;
+    std::uint64_t offset;
+    std::uint32_t rows;
+  };
+
+  bool load_index(const std::string &idx_path);
+  bool scan_blocks();
+  void add_block(const std::string &ticker, const Block &b);
+
+  int fd = -1;
+  std::uint32_t depth_ = 0;
+  std::size_t blocks = 0;
+  std::vector<std::string> tickers;
+  // Per market, in file order, which is also time order.
+  std::unordered_map<std::string, std::vector<Block>> by_market;
+  std::unordered_map<std::string, std::uint32_t> market_ids;
+};
@@ -1,5 +1,6 @@
 #include "avellaneda_stoikov.hpp"
 #include <algorithm>
+#include <cmath>
 
 AvellanedaStoikov::AvellanedaStoikov(ASParams p) : params(p) {}
 
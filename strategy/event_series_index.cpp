@@ -0,0 +1,78 @@
+#include "event_series_index.hpp"
+
+#include "infra/metrics.hpp"
+#include "protocols/kalshi/kalshi_tickers.hpp"
+
+EventSeriesIndex::EventSeriesIndex(SeriesThresholds t) : thresholds(t) {}
+
+EventSeriesIndex::Index
+EventSeriesIndex::add_market(const std::string &ticker) {
+  auto [it, inserted] =
+      leg_index.try_emplace(ticker, static_cast<Index>(legs.size()));
+  if (!inserted)
+    return it->second;
+
+  const std::string event(event_ticker(ticker));
+  auto [sit, new_series] = series_index.try_emplace(
+      event, static_cast<std::uint32_t>(series_.size()));
+  if (new_series) {
+    Series s;
+    s.event = event;
+    series_.push_back(std::move(s));
+  }
+
+  Series &s = series_[sit->second];
+  ++s.top.legs;
+  // A new leg starts empty: no bid, no ask.
+  s.top.ask_sum += 100;
+  ++s.top.missing_asks;
+  legs.push_back(Leg{sit->second});
+  return it->second;
+}
+
+void EventSeriesIndex::update(Index i, int best_yes_bid, int best_yes_ask) {
+  Leg &leg = legs[i];
+  if (leg.bid == best_yes_bid && leg.ask == best_yes_ask)
+    return;
+
+  Series &s = series_[leg.series];
+  s.top.bid_sum += best_yes_bid - leg.bid;
+  s.top.ask_sum += (best_yes_ask ? best_yes_ask : 100) -
+                   (leg.ask ? leg.ask : 100);
+  s.top.missing_asks += (best_yes_ask == 0) - (leg.ask == 0);
+  leg.bid = best_yes_bid;
+  leg.ask = best_yes_ask;
+  evaluate(s);
+}
+
+void EventSeriesIndex::update(const std::string &ticker, int best_yes_bid,
+                              int best_yes_ask) {
+  auto it = leg_index.find(ticker);
+  if (it != leg_index.end())
+    update(it->second, best_yes_bid, best_yes_ask);
+}
+
+void EventSeriesIndex::evaluate(Series &s) {
+  const bool bids_above = s.top.bid_sum > thresholds.bid_sum_above;
+  // Buying every leg only locks in the payout if every leg can be bought.
+  const bool asks_below =
+      s.top.missing_asks == 0 && s.top.ask_sum < thresholds.ask_sum_below;
+
+  if (bids_above != s.bids_above) {
+    s.bids_above = bids_above;
+    metric_inc(Counter::SeriesSignals);
+    if (callback)
+      callback(s.event, SeriesSignal::BidSumAbove, bids_above, s.top);
+  }
+  if (asks_below != s.asks_below) {
+    s.asks_below = asks_below;
+    metric_inc(Counter::SeriesSignals);
+    if (callback)
+      callback(s.event, SeriesSignal::AskSumBelow, asks_below, s.top);
+  }
+}
+
+const SeriesTop *EventSeriesIndex::series(const std::string &event) const {
+  auto it = series_index.find(event);
+  return it == series_index.end() ? nullptr : &series_[it->second].top;
+}
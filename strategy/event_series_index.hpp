@@ -0,0 +1,74 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Sum of top-of-book YES prices across the mutually exclusive markets of
+// one event. A leg without a bid contributes 0 to bid_sum; a leg without an
+// ask contributes 100 to ask_sum and is counted in missing_asks.
+struct SeriesTop {
+  int legs = 0;
+  int bid_sum = 0;
+  int ask_sum = 0;
+  int missing_asks = 0;
+};
+
+struct SeriesThresholds {
+  // Selling YES on every leg pays more than the single 100c payout.
+  int bid_sum_above = 100;
+  // Buying YES on every leg costs less than the guaranteed 100c payout.
+  int ask_sum_below = 100;
+};
+
+enum class SeriesSignal { BidSumAbove, AskSumBelow };
+
+// Groups markets by event (see event_ticker) and keeps each event's sums
+// current as member tops change. An update touches one leg and one series,
+// so it costs the same for a two-leg event as for a fifty-leg one.
+class EventSeriesIndex {
+public:
+  using Index = std::uint32_t;
+  // `active` is true when the sum crosses into the signal, false when it
+  // crosses back out.
+  using Callback = std::function<void(const std::string &event, SeriesSignal,
+                                      bool active, const SeriesTop &)>;
+
+  explicit EventSeriesIndex(SeriesThresholds thresholds = {});
+
+  // Returns the existing slot if the market is already known.
+  Index add_market(const std::string &ticker);
+  void set_callback(Callback cb) { callback = std::move(cb); }
+
+  // Best YES bid and ask for a member; 0 means that side is empty.
+  void update(Index i, int best_yes_bid, int best_yes_ask);
+  // Ignored for markets that were never added.
+  void update(const std::string &ticker, int best_yes_bid, int best_yes_ask);
+
+  const SeriesTop *series(const std::string &event) const;
+
+private:
+  struct Leg {
+    std::uint32_t series;
+    int bid = 0;
+    int ask = 0; // 0 while there is no ask
+  };
+
+  struct Series {
+    std::string event;
+    SeriesTop top;
+    bool bids_above = false;
+    bool asks_below = false;
+  };
+
+  void evaluate(Series &s);
+
+  SeriesThresholds thresholds;
+  Callback callback;
+  std::vector<Leg> legs;
+  std::unordered_map<std::string, Index> leg_index;
+  std::vector<Series> series_;
+  std::unordered_map<std::string, std::uint32_t> series_index;
+};
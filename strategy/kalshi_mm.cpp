@@ -1,33 +1,160 @@
 #include "kalshi_mm.hpp"
+#include "infra/metrics.hpp"
 #include "protocols/feed_adapter.hpp"
 #include "strategy/avellaneda_stoikov.hpp"
+#include <cmath>
+#include <iostream>
 
 KalshiMM::KalshiMM(std::vector<std::string> &tickers, ASParams &as_params)
-    : order_books(tickers), as_quoter(as_params),
+    : as_quoter(as_params),
       kalshi_positions(Exchange::KALSHI, tickers) {}
 
-void KalshiMM::handle_feed_event(FeedEvent ev) {
-  std::visit(
-      [&](auto &&v) {
-        using T = std::decay_t<decltype(v)>;
-        if constexpr (std::is_same_v<T, SnapshotEvent>) {
-          order_books.set_ticker_snapshot(ev.ticker, ev.cid, v);
-        } else if constexpr (std::is_same_v<T, DeltaEvent>) {
-          auto apply_res =
-              order_books.update_ticker_delta(ev.ticker, ev.cid, v);
-          if (apply_res == KalshiOrderBook::ApplyResult::GapNeedsResync) {
-            // handle reconnect
-          }
-        } else if constexpr (std::is_same_v<T, FillEvent>) {
-          kalshi_positions.on_fill(v);
-        }
-      },
-      ev.payload);
-
-  auto *kb = order_books.get_book(ev.ticker);
+bool KalshiMM::restore_checkpoint(const StateCheckpoint &cp,
+                                  KalshiOrderBookManager &books) {
+  return cp.restore(kalshi_positions, books);
+}
+
+std::size_t KalshiMM::replay_journal(const FillJournal &j, std::size_t from) {
+  return j.replay(kalshi_positions, from, &seen_trades);
+}
+
+std::size_t KalshiMM::restore_bootstrap(const BootstrapResult &r,
+                                        KalshiOrderBookManager &books) {
+  seed_books(r, books);
+  return restore_positions(r, kalshi_positions);
+}
+
+void KalshiMM::set_fill_journal(std::shared_ptr<FillJournal> j) {
+  journal = std::move(j);
+  wire_compaction();
+}
+
+void KalshiMM::set_quote_handler(QuoteHandler h) {
+  quote_handler = std::move(h);
+}
+
+void KalshiMM::set_risk_gate(std::shared_ptr<RiskGate> gate, int size) {
+  risk = std::move(gate);
+  order_size = size;
+  risk_state.clear();
+  if (!risk)
+    return;
+  risk->set_portfolio(&kalshi_positions.portfolio());
+  kalshi_positions.for_each_ledger([&](const TickerPositionLedger &ledger) {
+    risk_state.emplace(ledger.ticker(),
+                       RiskState{risk->add_market(ledger.ticker())});
+    sync_risk(ledger.ticker());
+  });
+}
+
+void KalshiMM::sync_risk(const std::string &ticker) {
+  auto it = risk_state.find(ticker);
+  const TickerPositionLedger *ledger = kalshi_positions.get_ledger(ticker);
+  if (it == risk_state.end() || !ledger)
+    return;
+  risk->on_position(it->second.index, ledger->yes_position(),
+                    ledger->no_position(), ledger->open_cost_cents());
+}
+
+void KalshiMM::apply_risk(const std::string &ticker, int fair_yes_cents,
+                          Quote &yes_quote, Quote &no_quote) {
+  auto it = risk_state.find(ticker);
+  if (it == risk_state.end()) {
+    yes_quote = no_quote = Quote{0, 0};
+    metric_inc(Counter::RiskRejects, 2);
+    return;
+  }
+  RiskState &rs = it->second;
+  const std::int64_t now =
+      std::chrono::duration_cast<std::chrono::nanoseconds>(
+          std::chrono::steady_clock::now().time_since_epoch())
+          .count();
+
+  // The YES bid is a YES buy; the YES ask is a NO buy at 100 - ask. The NO
+  // quote mirrors the same two orders.
+  if (risk->check(rs.index, Side::YES, yes_quote.bid, order_size,
+                  fair_yes_cents, now,
+                  yes_quote.bid != rs.working.bid) != RiskCheck::Ok) {
+    metric_inc(Counter::RiskRejects);
+    yes_quote.bid = 0;
+    no_quote.ask = 0;
+  }
+  if (risk->check(rs.index, Side::NO, 100 - yes_quote.ask, order_size,
+                  100 - fair_yes_cents, now,
+                  yes_quote.ask != rs.working.ask) != RiskCheck::Ok) {
+    metric_inc(Counter::RiskRejects);
+    yes_quote.ask = 0;
+    no_quote.bid = 0;
+  }
+  rs.working = yes_quote;
+}
+
+void KalshiMM::set_event_series(std::shared_ptr<EventSeriesIndex> idx) {
+  series = std::move(idx);
+  if (!series)
+    return;
+  kalshi_positions.for_each_ledger([&](const TickerPositionLedger &ledger) {
+    series->add_market(ledger.ticker());
+  });
+}
+
+void KalshiMM::set_checkpoint(std::shared_ptr<StateCheckpoint> cp,
+                              std::chrono::milliseconds interval) {
+  checkpoint = std::move(cp);
+  checkpoint_interval = interval;
+  next_checkpoint = std::chrono::steady_clock::now() + interval;
+  wire_compaction();
+}
+
+void KalshiMM::wire_compaction() {
+  if (!checkpoint || !journal)
+    return;
+  // Runs on the checkpoint's writer thread; the journal's flusher does the
+  // compacting.
+  checkpoint->set_durable_handler(
+      [j = journal](std::uint64_t records) { j->request_compact(records); });
+}
+
+void KalshiMM::on_idle() {
+  if (checkpoint && books) {
+    auto now = std::chrono::steady_clock::now();
+    if (now >= next_checkpoint &&
+        checkpoint->write(kalshi_positions, *books,
+                          journal ? journal->size() : 0)) {
+      next_checkpoint = now + checkpoint_interval;
+    }
+  }
+}
+
+void KalshiMM::handle_feed_event(const FeedEvent &ev,
+                                 const KalshiOrderBook *kb) {
+  if (const auto *fill = std::get_if<FillEvent>(&ev.payload)) {
+    if (!fill->trade_id.empty() && !seen_trades.insert(fill->trade_id))
+      return; // redelivered; already in the ledgers
+    if (journal && !journal->append(*fill)) {
+      std::cerr << "[ERROR] fill journal full or closed; fill "
+                << fill->trade_id << " is not durable" << std::endl;
+      if (risk)
+        risk->kill();
+    }
+    kalshi_positions.on_fill(*fill);
+    metric_inc(Counter::Fills);
+    if (risk) {
+      sync_risk(fill->market_ticker);
+    }
+  }
+
   if (!kb || !kb->has_snapshot) {
     return; // no usable book yet
   }
+  if (ev.type == FeedEvent::Type::Trade || ev.type == FeedEvent::Type::Ticker) {
+    return; // folded into kb->trades by the engine; the book is unchanged
+  }
+
+  if (series) {
+    series->update(ev.ticker, kb->book.best_yes_bid().first,
+                   kb->book.best_yes_ask().first);
+  }
 
   double no_fair_price = kb->book.no_midspot();   // in cents
   double yes_fair_price = kb->book.yes_midspot(); // in cents
@@ -39,13 +166,19 @@ void KalshiMM::handle_feed_event(FeedEvent ev) {
 
   const int yes_mark_cents = static_cast<int>(std::round(yes_fair_price));
   const int no_mark_cents = static_cast<int>(std::round(no_fair_price));
-  const_cast<TickerPositionLedger *>(ledger)->set_marks(yes_mark_cents,
-                                                        no_mark_cents);
+  kalshi_positions.set_marks(ev.ticker, yes_mark_cents, no_mark_cents);
 
-  auto snap = ledger->snapshot();
-  int yes_inventory = snap.yes_pos;
-  int no_inventory = snap.no_pos;
+  int yes_inventory = ledger->yes_position();
+  int no_inventory = ledger->no_position();
 
   Quote yes_quote = as_quoter.compute(yes_fair_price, yes_inventory);
   Quote no_quote = as_quoter.compute(no_fair_price, no_inventory);
+
+  if (risk) {
+    apply_risk(ev.ticker, yes_mark_cents, yes_quote, no_quote);
+  }
+
+  if (quote_handler) {
+    quote_handler(ev.ticker, yes_quote, no_quote);
+  }
 }
@@ -1,19 +1,100 @@
 #pragma once
 
+#include "infra/rest_bootstrap.hpp"
+#include "infra/state_checkpoint.hpp"
+#include "event_series_index.hpp"
+#include "positions/fill_journal.hpp"
 #include "positions/position_manager.hpp"
 #include "protocols/kalshi/kalshi_order_book_manager.hpp"
+#include "risk_gate.hpp"
 #include "strategy.hpp"
 #include "strategy/avellaneda_stoikov.hpp"
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <unordered_map>
 
 class KalshiMM : public Strategy {
-  KalshiOrderBookManager order_books;
+public:
+  using QuoteHandler = std::function<void(const std::string &ticker,
+                                          const Quote &yes, const Quote &no)>;
+
+private:
+  const KalshiOrderBookManager *books = nullptr; // engine-owned
   AvellanedaStoikov as_quoter;
   PositionManager kalshi_positions;
 
+  std::shared_ptr<StateCheckpoint> checkpoint;
+  std::chrono::steady_clock::duration checkpoint_interval{};
+  std::chrono::steady_clock::time_point next_checkpoint{};
+
+  std::shared_ptr<FillJournal> journal;
+  // Recent trade ids, including those replayed from the journal; the feed
+  // redelivers fills after a reconnect.
+  TradeIdFilter seen_trades;
+  QuoteHandler quote_handler;
+
+  std::shared_ptr<RiskGate> risk;
+  int order_size = 1;
+  struct RiskState {
+    RiskGate::Index index;
+    Quote working{0, 0}; // last YES quote that passed
+  };
+  std::unordered_map<std::string, RiskState> risk_state;
+
+  std::shared_ptr<EventSeriesIndex> series;
+
 public:
   KalshiMM(std::vector<std::string> &tickers, ASParams &as_params);
 
-  void handle_feed_event(FeedEvent ev) override;
+  void handle_feed_event(const FeedEvent &ev,
+                         const KalshiOrderBook *book) override;
+  void attach_books(const KalshiOrderBookManager &b) override { books = &b; }
+  // Takes the checkpoint when one is due.
+  void on_idle() override;
+
+  // Recovery; must run before the engine starts. Restores the checkpoint
+  // (if any) into the ledgers and the engine's `books`, then replays the
+  // journal fills the checkpoint had not seen.
+  bool restore_checkpoint(const StateCheckpoint &cp,
+                          KalshiOrderBookManager &books);
+  std::size_t replay_journal(const FillJournal &j, std::size_t from);
+  // Last: seeds `books` from REST and reconciles the ledgers with the
+  // exchange's positions. Returns the number of ledgers replaced.
+  std::size_t restore_bootstrap(const BootstrapResult &r,
+                                KalshiOrderBookManager &books);
+
+  // Snapshot ledgers and books into `cp` at most every `interval`, when the
+  // engine thread is idle; `cp` writes them out on its own thread once
+  // started. Books are only written once attached to an engine. Set this
+  // and the journal before starting `cp`.
+  void set_checkpoint(std::shared_ptr<StateCheckpoint> cp,
+                      std::chrono::milliseconds interval);
+
+  // Fills are appended to `j` before they touch the ledgers. A fill that
+  // cannot be journaled is logged as an error and trips the risk gate's
+  // kill switch. Each checkpoint that reaches the disk lets `j` compact
+  // away the records it covers, once `j` is half full.
+  void set_fill_journal(std::shared_ptr<FillJournal> j);
+
+  // Receives every quote computed, on the thread that handled the event.
+  void set_quote_handler(QuoteHandler h);
+
+  // Vets each quote leg of `size` contracts before the quote handler sees
+  // it; a rejected leg is zeroed. Every ticker is registered with the gate.
+  void set_risk_gate(std::shared_ptr<RiskGate> gate, int size = 1);
+
+  // Feeds every book's top into `idx` after each update. Every ticker is
+  // registered under its event.
+  void set_event_series(std::shared_ptr<EventSeriesIndex> idx);
+
+  const PositionManager &positions() const { return kalshi_positions; }
 
   void avellaneda_stoikov_price();
+
+private:
+  void apply_risk(const std::string &ticker, int fair_yes_cents,
+                  Quote &yes_quote, Quote &no_quote);
+  void sync_risk(const std::string &ticker);
+  void wire_compaction();
 };
@@ -0,0 +1,242 @@
+#include "order_manager.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+constexpr std::uint64_t kSeqMask = (std::uint64_t{1} << 48) - 1;
+
+int hex_value(char c) {
+  if (c >= '0' && c <= '9')
+    return c - '0';
+  if (c >= 'a' && c <= 'f')
+    return c - 'a' + 10;
+  if (c >= 'A' && c <= 'F')
+    return c - 'A' + 10;
+  return -1;
+}
+
+} // namespace
+
+void format_client_order_id(ClientOrderId id, char *out) {
+  static constexpr char digits[] = "0123456789abcdef";
+  for (std::size_t i = kClientOrderIdChars; i-- > 0;) {
+    out[i] = digits[id & 0xf];
+    id >>= 4;
+  }
+}
+
+std::optional<ClientOrderId> parse_client_order_id(std::string_view s) {
+  if (s.size() != kClientOrderIdChars)
+    return std::nullopt;
+  ClientOrderId id = 0;
+  for (char c : s) {
+    const int v = hex_value(c);
+    if (v < 0)
+      return std::nullopt;
+    id = (id << 4) | static_cast<ClientOrderId>(v);
+  }
+  return id;
+}
+
+const char *to_string(OrderState s) {
+  switch (s) {
+  case OrderState::PendingNew:
+    return "pending_new";
+  case OrderState::Acked:
+    return "acked";
+  case OrderState::PartiallyFilled:
+    return "partially_filled";
+  case OrderState::PendingCancel:
+    return "pending_cancel";
+  case OrderState::Filled:
+    return "filled";
+  case OrderState::Cancelled:
+    return "cancelled";
+  case OrderState::Rejected:
+    return "rejected";
+  }
+  return "unknown";
+}
+
+OrderManager::OrderManager(std::size_t max_live_, std::uint16_t session)
+    : max_live(std::max<std::size_t>(max_live_, 1)),
+      session_bits(static_cast<std::uint64_t>(session) << 48) {
+  // Load factor stays at or below one half.
+  std::size_t cap = 2;
+  unsigned bits = 1;
+  while (cap < 2 * max_live) {
+    cap <<= 1;
+    ++bits;
+  }
+  slots.resize(cap);
+  mask = cap - 1;
+  shift = 64 - bits;
+}
+
+OrderManager::Index OrderManager::add_market(const std::string &ticker) {
+  auto [it, inserted] =
+      market_index.try_emplace(ticker, static_cast<Index>(tickers.size()));
+  if (inserted)
+    tickers.push_back(ticker);
+  return it->second;
+}
+
+std::size_t OrderManager::home(ClientOrderId id) const {
+  // Ids are sequential; Fibonacci hashing spreads them over the table.
+  return static_cast<std::size_t>((id * 0x9E3779B97F4A7C15ull) >> shift);
+}
+
+std::size_t OrderManager::probe(ClientOrderId id) const {
+  for (std::size_t i = home(id);; i = (i + 1) & mask) {
+    const Slot &s = slots[i];
+    if (!s.used)
+      return slots.size();
+    if (s.order.id == id)
+      return i;
+  }
+}
+
+OrderManager::Slot *OrderManager::lookup(ClientOrderId id) {
+  const std::size_t i = probe(id);
+  return i == slots.size() ? nullptr : &slots[i];
+}
+
+const Order *OrderManager::find(ClientOrderId id) const {
+  const std::size_t i = probe(id);
+  return i == slots.size() ? nullptr : &slots[i].order;
+}
+
+std::optional<ClientOrderId> OrderManager::submit(Index market, Side side,
+                                                  int price, int count,
+                                                  std::int64_t now_ns) {
+  if (live >= max_live)
+    return std::nullopt;
+  const ClientOrderId id = session_bits | (next_seq++ & kSeqMask);
+
+  std::size_t i = home(id);
+  while (slots[i].used) {
+    i = (i + 1) & mask;
+  }
+  Slot &s = slots[i];
+  s.used = true;
+  s.order = Order{};
+  s.order.id = id;
+  s.order.market = market;
+  s.order.side = side;
+  s.order.price = price;
+  s.order.count = count;
+  s.order.sent_ns = now_ns;
+  ++live;
+  return id;
+}
+
+void OrderManager::erase(Slot *s) {
+  // Backward-shift deletion: pull later members of the probe run into the
+  // hole so lookups never need tombstones.
+  std::size_t hole = static_cast<std::size_t>(s - slots.data());
+  for (std::size_t i = (hole + 1) & mask; slots[i].used; i = (i + 1) & mask) {
+    const std::size_t h = home(slots[i].order.id);
+    // Movable if its home is not in (hole, i], cyclically.
+    const bool movable =
+        hole < i ? (h <= hole || h > i) : (h <= hole && h > i);
+    if (movable) {
+      slots[hole].order = slots[i].order;
+      hole = i;
+    }
+  }
+  slots[hole].used = false;
+  --live;
+}
+
+bool OrderManager::finish(Slot *s, Order *last) {
+  if (last)
+    *last = s->order;
+  // An order filled before its ack waits for it: the ack is the only place
+  // its exchange id comes from.
+  const bool awaiting_ack = s->order.state == OrderState::Filled &&
+                            s->order.exchange_id[0] == '\0';
+  if (is_terminal(s->order.state) && !awaiting_ack)
+    erase(s);
+  return true;
+}
+
+bool OrderManager::on_ack(ClientOrderId id, std::string_view exchange_order_id,
+                          Order *last) {
+  Slot *s = lookup(id);
+  if (!s)
+    return false;
+  // A fill that beat the ack has already moved the order on; the ack still
+  // carries its exchange id, but is a duplicate once that is known.
+  const bool pending = s->order.state == OrderState::PendingNew;
+  if (!pending && s->order.exchange_id[0] != '\0')
+    return false;
+  if (!pending && s->order.state != OrderState::PartiallyFilled &&
+      s->order.state != OrderState::Filled &&
+      s->order.state != OrderState::PendingCancel)
+    return false;
+  const std::size_t n =
+      std::min(exchange_order_id.size(), s->order.exchange_id.size() - 1);
+  std::memcpy(s->order.exchange_id.data(), exchange_order_id.data(), n);
+  s->order.exchange_id[n] = '\0';
+  if (pending)
+    s->order.state = OrderState::Acked;
+  return finish(s, last);
+}
+
+bool OrderManager::on_reject(ClientOrderId id, Order *last) {
+  Slot *s = lookup(id);
+  if (!s || s->order.state != OrderState::PendingNew)
+    return false;
+  s->order.state = OrderState::Rejected;
+  return finish(s, last);
+}
+
+bool OrderManager::request_cancel(ClientOrderId id, Order *last) {
+  Slot *s = lookup(id);
+  if (!s || (s->order.state != OrderState::Acked &&
+             s->order.state != OrderState::PartiallyFilled))
+    return false;
+  s->order.state = OrderState::PendingCancel;
+  return finish(s, last);
+}
+
+bool OrderManager::on_cancel(ClientOrderId id, Order *last) {
+  Slot *s = lookup(id);
+  if (!s || s->order.state == OrderState::PendingNew ||
+      s->order.state == OrderState::Filled)
+    return false;
+  s->order.state = OrderState::Cancelled;
+  return finish(s, last);
+}
+
+bool OrderManager::on_cancel_reject(ClientOrderId id, Order *last) {
+  Slot *s = lookup(id);
+  if (!s || s->order.state != OrderState::PendingCancel)
+    return false;
+  s->order.state =
+      s->order.filled > 0 ? OrderState::PartiallyFilled : OrderState::Acked;
+  return finish(s, last);
+}
+
+bool OrderManager::on_fill(ClientOrderId id, int count, Order *last) {
+  Slot *s = lookup(id);
+  if (!s || count <= 0 || s->order.state == OrderState::Filled)
+    return false;
+  Order &o = s->order;
+  // A fill can beat the ack over the wire; it implies the ack.
+  o.filled = std::min(o.count, o.filled + count);
+  if (o.filled == o.count)
+    o.state = OrderState::Filled;
+  else if (o.state != OrderState::PendingCancel)
+    o.state = OrderState::PartiallyFilled;
+  return finish(s, last);
+}
+
+bool OrderManager::on_fill(const FillEvent &fill, Order *last) {
+  if (!fill.client_order_id)
+    return false;
+  auto id = parse_client_order_id(*fill.client_order_id);
+  return id && on_fill(*id, fill.count, last);
+}
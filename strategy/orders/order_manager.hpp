@@ -0,0 +1,119 @@
+#pragma once
+
+#include "infra/runtime_tuning.hpp"
+#include "protocols/feed_adapter.hpp"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+// Client order ids are a 16-bit session tag over a 48-bit sequence, sent to
+// the exchange as 16 lowercase hex digits.
+using ClientOrderId = std::uint64_t;
+
+constexpr std::size_t kClientOrderIdChars = 16;
+
+// Writes exactly kClientOrderIdChars characters; no terminator.
+void format_client_order_id(ClientOrderId id, char *out);
+std::optional<ClientOrderId> parse_client_order_id(std::string_view s);
+
+enum class OrderState : std::uint8_t {
+  PendingNew,
+  Acked,
+  PartiallyFilled,
+  PendingCancel,
+  Filled,
+  Cancelled,
+  Rejected,
+};
+
+const char *to_string(OrderState s);
+
+inline bool is_terminal(OrderState s) {
+  return s == OrderState::Filled || s == OrderState::Cancelled ||
+         s == OrderState::Rejected;
+}
+
+struct Order {
+  ClientOrderId id = 0;
+  std::uint32_t market = 0; // OrderManager::add_market index
+  Side side = Side::YES;
+  int price = 0;
+  int count = 0;
+  int filled = 0;
+  OrderState state = OrderState::PendingNew;
+  std::int64_t sent_ns = 0;
+  std::array<char, 40> exchange_id{}; // NUL-terminated Kalshi order id
+};
+
+// Lifecycle of our orders: pending -> acked -> partially filled ->
+// filled/cancelled, plus rejects and pending cancels. Live orders sit in a
+// preallocated open-addressing table keyed by client id (linear probing,
+// backward-shift deletion), so submits and every ack, fill and cancel are
+// O(1) without allocating. An order leaves the table when it reaches a
+// terminal state, except that one filled in full before its ack stays
+// until the ack brings its exchange id. Engine thread only.
+class OrderManager {
+public:
+  using Index = std::uint32_t;
+
+  // `max_live` orders may be open at once; the table holds twice that.
+  explicit OrderManager(std::size_t max_live = 4096,
+                        std::uint16_t session = 0);
+
+  // Returns the existing index if the market is already known.
+  Index add_market(const std::string &ticker);
+  const std::string &ticker(Index i) const { return tickers[i]; }
+
+  // Registers a new order as PendingNew. Returns nullopt when max_live
+  // orders are already open.
+  std::optional<ClientOrderId> submit(Index market, Side side, int price,
+                                      int count, std::int64_t now_ns);
+
+  // Each returns false (and leaves the order alone) if the id is unknown
+  // or the transition is not valid from the order's state. The order
+  // passed to `last` is its state after the transition, which is the only
+  // copy left once it goes terminal.
+  bool on_ack(ClientOrderId id, std::string_view exchange_order_id,
+              Order *last = nullptr);
+  bool on_reject(ClientOrderId id, Order *last = nullptr);
+  bool request_cancel(ClientOrderId id, Order *last = nullptr);
+  // Also accepted without a request, for exchange-initiated cancels.
+  bool on_cancel(ClientOrderId id, Order *last = nullptr);
+  bool on_cancel_reject(ClientOrderId id, Order *last = nullptr);
+  bool on_fill(ClientOrderId id, int count, Order *last = nullptr);
+  // Matches on client_order_id; fills without one are not ours.
+  bool on_fill(const FillEvent &fill, Order *last = nullptr);
+
+  const Order *find(ClientOrderId id) const;
+  std::size_t live_orders() const { return live; }
+  std::size_t max_live_orders() const { return max_live; }
+
+private:
+  struct Slot {
+    bool used = false;
+    Order order;
+  };
+
+  std::size_t home(ClientOrderId id) const;
+  // Slot index of `id`, or slots.size() if absent.
+  std::size_t probe(ClientOrderId id) const;
+  Slot *lookup(ClientOrderId id);
+  void erase(Slot *s);
+  bool finish(Slot *s, Order *last);
+
+  std::vector<Slot, HotAllocator<Slot>> slots;
+  std::size_t mask;
+  std::size_t max_live;
+  std::size_t live = 0;
+  unsigned shift;
+  std::uint64_t next_seq = 1;
+  std::uint64_t session_bits;
+
+  std::vector<std::string> tickers;
+  std::unordered_map<std::string, Index> market_index;
+};
@@ -0,0 +1,399 @@
+#include "fill_journal.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstddef>
+#include <cstring>
+#include <fcntl.h>
+#include <iostream>
+#include <string_view>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <unordered_set>
+
+namespace {
+
+constexpr std::uint32_t kRecordMagic = 0x4c4e524a; // "JRNL"
+constexpr std::uint32_t kFileMagic = 0x5244484a;   // "JHDR"
+constexpr std::size_t kHeaderBytes = 4096;
+
+// Start of the file. A journal from before compaction has a blank header
+// and its records start at 0.
+struct FileHeader {
+  std::uint32_t magic;
+  std::uint32_t reserved;
+  std::uint64_t first_seq;
+};
+
+// Makes a rename in `path`'s directory durable.
+bool sync_parent_dir(const std::string &path) {
+  const auto slash = path.rfind('/');
+  const std::string dir =
+      slash == std::string::npos ? "." : path.substr(0, slash + 1);
+  int fd = ::open(dir.c_str(), O_RDONLY | O_DIRECTORY);
+  if (fd < 0)
+    return false;
+  const bool ok = fsync(fd) == 0;
+  ::close(fd);
+  return ok;
+}
+
+std::uint32_t fnv1a(const unsigned char *p, std::size_t n) {
+  std::uint32_t h = 2166136261u;
+  for (std::size_t i = 0; i < n; ++i) {
+    h ^= p[i];
+    h *= 16777619u;
+  }
+  return h;
+}
+
+template <std::size_t N>
+void copy_field(char (&dst)[N], std::string_view src) {
+  const std::size_t n = std::min(src.size(), N - 1);
+  std::memcpy(dst, src.data(), n);
+  dst[n] = '\0';
+}
+
+template <std::size_t N> std::string_view field(const char (&src)[N]) {
+  return {src, strnlen(src, N)};
+}
+
+} // namespace
+
+struct FillJournal::Record {
+  std::uint32_t magic;
+  std::uint32_t checksum; // over every byte after this field
+  std::uint64_t seq;
+  std::int64_t ts;
+  std::int32_t yes_price;
+  std::int32_t count;
+  std::int32_t post_position;
+  std::uint8_t side;
+  std::uint8_t purchased_side;
+  std::uint8_t action;
+  std::uint8_t is_taker;
+  char trade_id[48];
+  char order_id[48];
+  char market_ticker[64];
+  char client_order_id[48];
+  std::uint8_t has_client_order_id;
+  std::uint8_t pad[7];
+
+  std::uint32_t compute_checksum() const {
+    const auto *p = reinterpret_cast<const unsigned char *>(this);
+    constexpr std::size_t off = offsetof(Record, seq);
+    return fnv1a(p + off, sizeof(Record) - off);
+  }
+};
+
+FillJournal::FillJournal(FillJournalConfig c) : cfg(std::move(c)) {}
+
+FillJournal::~FillJournal() {
+  stop();
+  if (renaming_fd >= 0)
+    ::close(renaming_fd);
+  if (base) {
+    munmap(base, mapped);
+  }
+}
+
+FillJournal::Record *FillJournal::record(std::size_t i) const {
+  return reinterpret_cast<Record *>(base + kHeaderBytes + i * sizeof(Record));
+}
+
+bool FillJournal::open() {
+  int fd = ::open(cfg.path.c_str(), O_RDWR | O_CREAT, 0644);
+  if (fd < 0) {
+    std::cerr << "fill journal: cannot open " << cfg.path << ": "
+              << std::strerror(errno) << std::endl;
+    return false;
+  }
+
+  mapped = kHeaderBytes + cfg.capacity * sizeof(Record);
+  struct stat st {};
+  if (fstat(fd, &st) == 0 && static_cast<std::size_t>(st.st_size) > mapped) {
+    // Never truncate records written with a larger capacity.
+    mapped = static_cast<std::size_t>(st.st_size);
+    cfg.capacity = (mapped - kHeaderBytes) / sizeof(Record);
+  }
+  if (ftruncate(fd, static_cast<off_t>(mapped)) != 0) {
+    std::cerr << "fill journal: cannot size " << cfg.path << ": "
+              << std::strerror(errno) << std::endl;
+    ::close(fd);
+    return false;
+  }
+
+  void *addr =
+      mmap(nullptr, mapped, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  ::close(fd);
+  if (addr == MAP_FAILED) {
+    std::cerr << "fill journal: mmap failed for " << cfg.path << ": "
+              << std::strerror(errno) << std::endl;
+    return false;
+  }
+  base = static_cast<unsigned char *>(addr);
+
+  auto *h = reinterpret_cast<FileHeader *>(base);
+  if (h->magic != kFileMagic) {
+    h->magic = kFileMagic;
+    h->first_seq = 0;
+    msync(base, kHeaderBytes, MS_SYNC);
+  }
+  const std::uint64_t first = h->first_seq;
+  first_seq.store(first, std::memory_order_release);
+
+  // The first record that is blank or fails its checksum marks the tail;
+  // anything after a torn write is discarded.
+  std::size_t n = 0;
+  while (n < cfg.capacity) {
+    const Record *r = record(n);
+    if (r->magic != kRecordMagic || r->checksum != r->compute_checksum() ||
+        r->seq != first + n)
+      break;
+    ++n;
+  }
+  next = n;
+  published.store(n, std::memory_order_release);
+  synced.store(n, std::memory_order_release);
+  return true;
+}
+
+void FillJournal::start() {
+  {
+    std::lock_guard<std::mutex> lock(m);
+    if (running || !base)
+      return;
+    running = true;
+  }
+  flusher = std::thread(&FillJournal::flush_loop, this);
+}
+
+void FillJournal::stop() {
+  {
+    std::lock_guard<std::mutex> lock(m);
+    running = false;
+  }
+  cv.notify_all();
+  if (flusher.joinable())
+    flusher.join();
+  if (base)
+    flush();
+}
+
+bool FillJournal::append(const FillEvent &f) {
+  std::lock_guard<std::mutex> lock(swap_mutex);
+  if (!base)
+    return false;
+  if (next == cfg.capacity)
+    return false;
+
+  Record *r = record(next);
+  r->magic = 0;
+  r->seq = first_seq.load(std::memory_order_relaxed) + next;
+  r->ts = f.ts;
+  r->yes_price = f.yes_price;
+  r->count = f.count;
+  r->post_position = f.post_position;
+  r->side = static_cast<std::uint8_t>(f.side);
+  r->purchased_side = static_cast<std::uint8_t>(f.purchased_side);
+  r->action = static_cast<std::uint8_t>(f.action);
+  r->is_taker = f.is_taker;
+  copy_field(r->trade_id, f.trade_id);
+  copy_field(r->order_id, f.order_id);
+  copy_field(r->market_ticker, f.market_ticker);
+  r->has_client_order_id = f.client_order_id.has_value();
+  copy_field(r->client_order_id, f.client_order_id.value_or(""));
+  std::memset(r->pad, 0, sizeof(r->pad));
+  r->checksum = r->compute_checksum();
+  r->magic = kRecordMagic;
+
+  ++next;
+  published.store(next, std::memory_order_release);
+  return true;
+}
+
+void FillJournal::request_compact(std::uint64_t upto) {
+  std::uint64_t cur = compact_upto.load(std::memory_order_relaxed);
+  while (cur < upto &&
+         !compact_upto.compare_exchange_weak(cur, upto,
+                                             std::memory_order_release)) {
+  }
+}
+
+void FillJournal::flush_loop() {
+  std::unique_lock<std::mutex> lock(m);
+  while (running) {
+    cv.wait_for(lock, cfg.group_commit, [&] { return !running; });
+    lock.unlock();
+    flush();
+    const std::uint64_t upto = compact_upto.load(std::memory_order_acquire);
+    if (upto > first() && size() - first() >= cfg.capacity / 2)
+      compact(upto);
+    lock.lock();
+  }
+}
+
+// The flusher is the only thread that changes `base`, so it reads the
+// published records without a lock. The engine keeps appending to the old
+// file until the new one holds everything published so far; the records
+// that arrive during the copy are moved under swap_mutex. The rename only
+// happens once the new file is synced, and nothing appended to it counts
+// as durable before then, so a crash in between leaves the old file with
+// every record that did.
+bool FillJournal::compact(std::uint64_t upto) {
+  if (renaming_fd >= 0 && !finish_compact())
+    return false;
+  const std::uint64_t first = first_seq.load(std::memory_order_relaxed);
+  if (!base || upto <= first)
+    return base != nullptr;
+  const std::size_t copied = published.load(std::memory_order_acquire);
+  const std::size_t drop =
+      static_cast<std::size_t>(std::min<std::uint64_t>(upto - first, copied));
+
+  const std::string tmp = cfg.path + ".tmp";
+  const int fd = ::open(tmp.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+  if (fd < 0 || ftruncate(fd, static_cast<off_t>(mapped)) != 0) {
+    std::cerr << "fill journal: cannot create " << tmp << ": "
+              << std::strerror(errno) << std::endl;
+    if (fd >= 0)
+      ::close(fd);
+    return false;
+  }
+  void *addr =
+      mmap(nullptr, mapped, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  if (addr == MAP_FAILED) {
+    std::cerr << "fill journal: mmap failed for " << tmp << ": "
+              << std::strerror(errno) << std::endl;
+    ::close(fd);
+    return false;
+  }
+  auto *fresh = static_cast<unsigned char *>(addr);
+  auto *h = reinterpret_cast<FileHeader *>(fresh);
+  h->magic = kFileMagic;
+  h->first_seq = first + drop;
+  // Records carry their own seq and checksum, so they move as they are.
+  std::memcpy(fresh + kHeaderBytes, record(drop),
+              (copied - drop) * sizeof(Record));
+
+  if (msync(fresh, kHeaderBytes + (copied - drop) * sizeof(Record),
+            MS_SYNC) != 0) {
+    std::cerr << "fill journal: cannot write " << tmp << ": "
+              << std::strerror(errno) << std::endl;
+    ::close(fd);
+    munmap(fresh, mapped);
+    std::remove(tmp.c_str());
+    return false;
+  }
+
+  unsigned char *old = base;
+  {
+    std::lock_guard<std::mutex> lock(swap_mutex);
+    std::memcpy(fresh + kHeaderBytes + (copied - drop) * sizeof(Record),
+                record(copied), (next - copied) * sizeof(Record));
+    base = fresh;
+    next -= drop;
+    first_seq.store(first + drop, std::memory_order_release);
+    published.store(next, std::memory_order_release);
+    // Only what the old file already had on disk stays counted.
+    const std::size_t was = synced.load(std::memory_order_relaxed);
+    synced.store(was > drop ? was - drop : 0, std::memory_order_release);
+  }
+  munmap(old, mapped);
+  renaming_fd = fd;
+  return finish_compact();
+}
+
+bool FillJournal::finish_compact() {
+  const std::string tmp = cfg.path + ".tmp";
+  const std::size_t end = published.load(std::memory_order_acquire);
+  if (msync(base, kHeaderBytes + end * sizeof(Record), MS_SYNC) != 0 ||
+      fsync(renaming_fd) != 0 ||
+      std::rename(tmp.c_str(), cfg.path.c_str()) != 0) {
+    // Appends already go to the new file; flush() tries again.
+    std::cerr << "fill journal: cannot replace " << cfg.path << ": "
+              << std::strerror(errno) << std::endl;
+    return false;
+  }
+  ::close(renaming_fd);
+  renaming_fd = -1;
+  if (!sync_parent_dir(cfg.path)) {
+    std::cerr << "fill journal: cannot sync the directory of " << cfg.path
+              << std::endl;
+  }
+  synced.store(end, std::memory_order_release);
+  return true;
+}
+
+void FillJournal::flush() {
+  if (renaming_fd >= 0) {
+    finish_compact();
+    return;
+  }
+  const std::size_t end = published.load(std::memory_order_acquire);
+  const std::size_t begin = synced.load(std::memory_order_relaxed);
+  if (end == begin)
+    return;
+
+  static const std::size_t page =
+      static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+  const std::size_t from = kHeaderBytes + begin * sizeof(Record);
+  const std::size_t to = kHeaderBytes + end * sizeof(Record);
+  const std::size_t aligned = from & ~(page - 1);
+  if (msync(base + aligned, to - aligned, MS_SYNC) != 0) {
+    std::cerr << "fill journal: msync failed: " << std::strerror(errno)
+              << std::endl;
+    return;
+  }
+  synced.store(end, std::memory_order_release);
+}
+
+std::size_t FillJournal::replay(PositionManager &positions,
+                                std::uint64_t from,
+                                TradeIdFilter *trade_ids) const {
+  const std::uint64_t first = this->first();
+  const std::size_t end = published.load(std::memory_order_acquire);
+  if (from < first) {
+    std::cerr << "[ERROR] fill journal starts at record " << first
+              << " but the ledgers only cover " << from
+              << "; the fills in between are lost" << std::endl;
+  }
+  std::unordered_set<std::string_view> seen;
+  seen.reserve(end);
+
+  std::size_t applied = 0;
+  for (std::size_t i = 0; i < end; ++i) {
+    const Record *r = record(i);
+    // Same rule as the live path: a fill without a trade_id is never a
+    // duplicate.
+    const std::string_view id = field(r->trade_id);
+    bool fresh = true;
+    if (!id.empty()) {
+      fresh = seen.insert(id).second;
+      if (fresh && trade_ids)
+        trade_ids->insert(id);
+    }
+    if (first + i < from || !fresh)
+      continue;
+
+    FillEvent f{};
+    f.trade_id = std::string(field(r->trade_id));
+    f.order_id = std::string(field(r->order_id));
+    f.market_ticker = std::string(field(r->market_ticker));
+    f.is_taker = r->is_taker;
+    f.side = static_cast<Side>(r->side);
+    f.purchased_side = static_cast<Side>(r->purchased_side);
+    f.action = static_cast<Action>(r->action);
+    f.yes_price = r->yes_price;
+    f.count = r->count;
+    f.ts = r->ts;
+    f.post_position = r->post_position;
+    if (r->has_client_order_id)
+      f.client_order_id = std::string(field(r->client_order_id));
+
+    positions.add_ticker(f.market_ticker);
+    positions.on_fill(f);
+    ++applied;
+  }
+  return applied;
+}
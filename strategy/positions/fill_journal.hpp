@@ -0,0 +1,115 @@
+#pragma once
+
+#include "position_manager.hpp"
+#include "protocols/feed_adapter.hpp"
+#include "trade_id_filter.hpp"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+
+struct FillJournalConfig {
+  std::string path;
+  std::size_t capacity = 1 << 18; // records; the file is sized up front
+  std::chrono::microseconds group_commit{1000};
+};
+
+// Write-ahead log of fills. Records are fixed-size and copied straight into a
+// pre-sized mmap'd file by the engine thread; a background thread msyncs
+// whatever has been appended since its last pass, so many fills share one
+// flush and the engine never touches the disk.
+//
+// Records are numbered from the first fill ever journaled. compact() drops
+// those a durable checkpoint already covers, so the file only ever holds
+// the fills since the last checkpoint or so. Once started, the flusher
+// thread compacts on its own, as request_compact() allows.
+class FillJournal {
+public:
+  explicit FillJournal(FillJournalConfig cfg);
+  ~FillJournal();
+
+  FillJournal(const FillJournal &) = delete;
+  FillJournal &operator=(const FillJournal &) = delete;
+
+  // Maps the file and finds the end of the valid records. Call before
+  // replay() and start().
+  bool open();
+
+  void start();
+  void stop();
+
+  // Engine thread. Returns false if the journal is full or not open; the
+  // fill is then not durable, which the caller must treat as an error.
+  bool append(const FillEvent &f);
+
+  // Any thread. Records before `upto` are covered by a checkpoint that is
+  // already on disk; the flusher compacts them away once the journal is
+  // half full.
+  void request_compact(std::uint64_t upto);
+
+  // Drops records before `upto`: the rest is copied to a new file that is
+  // synced and renamed over the old one. append() only waits for the few
+  // records that arrive meanwhile to be copied, never for the disk. False
+  // if that failed, in which case the journal is unchanged. The flusher
+  // calls it; call it directly only while the journal is not started.
+  bool compact(std::uint64_t upto);
+
+  // Rebuilds ledgers from records [from, size()), skipping any trade_id that
+  // already appears earlier in the journal. Every trade_id in the file is
+  // added to `trade_ids` if given. Returns fills applied.
+  std::size_t replay(PositionManager &positions, std::uint64_t from = 0,
+                     TradeIdFilter *trade_ids = nullptr) const;
+
+  // Number of the first record still in the file.
+  std::uint64_t first() const {
+    return first_seq.load(std::memory_order_acquire);
+  }
+
+  // One past the last record appended (including those recovered by
+  // open()).
+  std::uint64_t size() const {
+    return first() + published.load(std::memory_order_acquire);
+  }
+
+  // One past the last record known to be on disk.
+  std::uint64_t durable() const {
+    return first() + synced.load(std::memory_order_acquire);
+  }
+
+  // Records the file has room for.
+  std::size_t capacity() const { return cfg.capacity; }
+
+private:
+  struct Record;
+
+  Record *record(std::size_t i) const;
+  void flush_loop();
+  void flush();
+  bool finish_compact();
+
+  FillJournalConfig cfg;
+  unsigned char *base = nullptr;
+  std::size_t mapped = 0;
+
+  // Counts below are of records in the file, from first_seq.
+  std::atomic<std::uint64_t> first_seq{0};
+  std::size_t next = 0; // guarded by swap_mutex
+  std::atomic<std::size_t> published{0};
+  std::atomic<std::size_t> synced{0};
+  // Held by append(), and by compact() while it moves the engine onto the
+  // new file; never across I/O.
+  std::mutex swap_mutex;
+  std::atomic<std::uint64_t> compact_upto{0};
+  // The new file while it waits to be renamed over the old one; flusher
+  // only.
+  int renaming_fd = -1;
+
+  std::thread flusher;
+  std::mutex m;
+  std::condition_variable cv;
+  bool running = false;
+};
@@ -0,0 +1,56 @@
+#include "portfolio_aggregator.hpp"
+
+#include "protocols/kalshi/kalshi_tickers.hpp"
+#include <cstdlib>
+
+PortfolioAggregator::Index
+PortfolioAggregator::add_market(const std::string &ticker) {
+  auto [it, inserted] =
+      market_index.try_emplace(ticker, static_cast<Index>(markets.size()));
+  if (!inserted)
+    return it->second;
+
+  auto [eit, new_event] = event_index.try_emplace(
+      std::string(event_ticker(ticker)),
+      static_cast<std::uint32_t>(events.size()));
+  if (new_event)
+    events.push_back(0);
+
+  Contribution c;
+  c.event = eit->second;
+  markets.push_back(c);
+  return it->second;
+}
+
+void PortfolioAggregator::update(Index i, const TickerPositionLedger &ledger) {
+  const TickerSnapshotPnL s = ledger.snapshot();
+  Contribution &old = markets[i];
+
+  Contribution now;
+  now.event = old.event;
+  now.cash = s.cash_cents;
+  now.realized = s.realized_pnl_cents;
+  now.unrealized = s.unrealized_pnl_cents;
+  now.open_cost = ledger.open_cost_cents();
+  now.gross = std::abs(s.yes_pos) + std::abs(s.no_pos);
+  now.net = s.yes_pos - s.no_pos;
+  // Unrealized PnL is marked value minus cost, so value = cost + unrealized.
+  now.exposure = now.open_cost + now.unrealized;
+
+  total.cash_cents += now.cash - old.cash;
+  total.realized_pnl_cents += now.realized - old.realized;
+  total.unrealized_pnl_cents += now.unrealized - old.unrealized;
+  total.open_cost_cents += now.open_cost - old.open_cost;
+  total.gross_contracts += now.gross - old.gross;
+  total.net_contracts += now.net - old.net;
+  total.pnl_cents = total.realized_pnl_cents + total.unrealized_pnl_cents;
+  total.equity_cents = total.cash_cents + total.pnl_cents;
+  events[now.event] += now.exposure - old.exposure;
+  old = now;
+}
+
+long long
+PortfolioAggregator::event_exposure_cents(const std::string &event) const {
+  auto it = event_index.find(event);
+  return it == event_index.end() ? 0 : events[it->second];
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#include "ticker_position_ledger.hpp"
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+struct PortfolioTotals {
+  long long cash_cents = 0;
+  long long realized_pnl_cents = 0;
+  long long unrealized_pnl_cents = 0;
+  long long pnl_cents = 0;       // realized + unrealized
+  long long equity_cents = 0;    // same definition as TickerSnapshotPnL
+  long long open_cost_cents = 0; // cost basis of every open contract
+  long long gross_contracts = 0; // |yes| + |no| over all markets
+  long long net_contracts = 0;   // yes - no over all markets
+};
+
+// Running portfolio totals. Each market's last contribution is kept, so a
+// fill or mark change moves the totals (and its event's exposure) by the
+// difference instead of rescanning every ledger.
+class PortfolioAggregator {
+public:
+  using Index = std::uint32_t;
+
+  // Returns the existing slot if the market is already known.
+  Index add_market(const std::string &ticker);
+
+  // Re-reads one ledger after a fill, mark change or restore.
+  void update(Index i, const TickerPositionLedger &ledger);
+
+  const PortfolioTotals &totals() const { return total; }
+
+  // Marked value of open contracts (cost basis where unmarked) in the
+  // event series the market belongs to.
+  long long event_exposure_cents(const std::string &event) const;
+
+  template <typename Fn> void for_each_event(Fn &&fn) const {
+    for (const auto &[event, e] : event_index) {
+      fn(event, events[e]);
+    }
+  }
+
+private:
+  struct Contribution {
+    long long cash = 0;
+    long long realized = 0;
+    long long unrealized = 0;
+    long long open_cost = 0;
+    long long gross = 0;
+    long long net = 0;
+    long long exposure = 0;
+    std::uint32_t event = 0;
+  };
+
+  std::vector<Contribution> markets;
+  std::unordered_map<std::string, Index> market_index;
+  std::vector<long long> events; // exposure per event series
+  std::unordered_map<std::string, std::uint32_t> event_index;
+  PortfolioTotals total;
+};
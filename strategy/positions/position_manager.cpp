@@ -4,27 +4,53 @@ PositionManager::PositionManager(Exchange exch,
                                  const std::vector<std::string> &tickers)
     : exchange(exch) {
   for (const auto &t : tickers) {
-    auto key = make_key(exchange, t);
-    ledgers.emplace(key, TickerPositionLedger(t));
+    add_ticker(t);
   }
 }
 
 void PositionManager::on_fill(const FillEvent &f) {
-  std::string key = make_key(exchange, f.market_ticker);
-
-  auto it = ledgers.find(key);
+  auto it = ledgers.find(f.market_ticker);
   if (it == ledgers.end()) {
     return;
   }
 
-  it->second.on_fill(f);
+  it->second.ledger.on_fill(f);
+  aggregator.update(it->second.slot, it->second.ledger);
+}
+
+void PositionManager::set_marks(const std::string &ticker, int yes_mark_cents,
+                                int no_mark_cents) {
+  auto it = ledgers.find(ticker);
+  if (it == ledgers.end())
+    return;
+  it->second.ledger.set_marks(yes_mark_cents, no_mark_cents);
+  aggregator.update(it->second.slot, it->second.ledger);
 }
 
 const TickerPositionLedger *
 PositionManager::get_ledger(const std::string &ticker) const {
-  const std::string key = make_key(exchange, ticker);
-  auto it = ledgers.find(key);
+  auto it = ledgers.find(ticker);
   if (it == ledgers.end())
     return nullptr;
-  return &it->second;
+  return &it->second.ledger;
+}
+
+PositionManager::Entry &PositionManager::entry(const std::string &ticker) {
+  auto it = ledgers.find(ticker);
+  if (it == ledgers.end()) {
+    it = ledgers
+             .emplace(ticker, Entry{TickerPositionLedger(ticker),
+                                    aggregator.add_market(ticker)})
+             .first;
+  }
+  return it->second;
+}
+
+void PositionManager::add_ticker(const std::string &ticker) { entry(ticker); }
+
+void PositionManager::restore_ledger(const std::string &ticker,
+                                     const LedgerState &state) {
+  Entry &e = entry(ticker);
+  e.ledger.restore(state);
+  aggregator.update(e.slot, e.ledger);
 }
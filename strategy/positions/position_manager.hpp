@@ -1,3 +1,6 @@
+#pragma once
+
+#include "portfolio_aggregator.hpp"
 #include "protocols/feed_adapter.hpp"
 #include "ticker_position_ledger.hpp"
 #include <unordered_map>
@@ -8,12 +11,36 @@ public:
 
   void on_fill(const FillEvent &f);
 
+  void set_marks(const std::string &ticker, int yes_mark_cents,
+                 int no_mark_cents);
+
   const TickerPositionLedger *get_ledger(const std::string &ticker) const;
 
-private:
-  static inline std::string make_key(Exchange v, const std::string &ticker) {
-    return std::to_string(static_cast<int>(v)) + ":" + ticker;
+  void add_ticker(const std::string &ticker);
+
+  // Creates the ledger if it does not exist yet.
+  void restore_ledger(const std::string &ticker, const LedgerState &state);
+
+  // Kept current by every fill, mark and restore above.
+  const PortfolioAggregator &portfolio() const { return aggregator; }
+
+  template <typename Fn> void for_each_ledger(Fn &&fn) const {
+    for (const auto &[_, entry] : ledgers) {
+      fn(entry.ledger);
+    }
   }
-  std::unordered_map<std::string, TickerPositionLedger> ledgers;
+
+private:
+  struct Entry {
+    TickerPositionLedger ledger;
+    PortfolioAggregator::Index slot;
+  };
+
+  Entry &entry(const std::string &ticker);
+
+  // Keyed by ticker alone: every ledger here is on `exchange`, and a
+  // lookup by the caller's string does not allocate.
+  std::unordered_map<std::string, Entry> ledgers;
+  PortfolioAggregator aggregator;
   Exchange exchange;
 };
@@ -62,6 +62,32 @@ TickerSnapshotPnL TickerPositionLedger::snapshot() const {
   return s;
 }
 
+LedgerState TickerPositionLedger::state() const {
+  LedgerState s;
+  s.yes_pos = yes_pos;
+  s.no_pos = no_pos;
+  s.vwap_yes_cents = vwap_yes_c;
+  s.vwap_no_cents = vwap_no_c;
+  s.cash_cents = cash_c;
+  s.realized_pnl_cents = realized_pnl_c;
+  s.yes_mark_cents = yes_mark_c;
+  s.no_mark_cents = no_mark_c;
+  s.last_ts = last_ts;
+  return s;
+}
+
+void TickerPositionLedger::restore(const LedgerState &s) {
+  yes_pos = s.yes_pos;
+  no_pos = s.no_pos;
+  vwap_yes_c = s.vwap_yes_cents;
+  vwap_no_c = s.vwap_no_cents;
+  cash_c = s.cash_cents;
+  realized_pnl_c = s.realized_pnl_cents;
+  yes_mark_c = s.yes_mark_cents;
+  no_mark_c = s.no_mark_cents;
+  last_ts = s.last_ts;
+}
+
 void TickerPositionLedger::apply_fill_one_side(Action act, int qty, int price_c,
                                                int &pos, int &vwap_cents,
                                                bool /*isYes*/) {
@@ -1,6 +1,7 @@
 #pragma once
 #include "protocols/feed_adapter.hpp"
 #include <algorithm>
+#include <cstdlib>
 #include <cstdint>
 #include <optional>
 #include <string>
@@ -16,6 +17,19 @@ struct TickerSnapshotPnL {
   int vwap_no_cents = 0;      // avg cost of open NO position (if pos!=0)
 };
 
+// Raw ledger fields, used to checkpoint and restore a ledger verbatim.
+struct LedgerState {
+  int yes_pos = 0;
+  int no_pos = 0;
+  int vwap_yes_cents = 0;
+  int vwap_no_cents = 0;
+  long long cash_cents = 0;
+  long long realized_pnl_cents = 0;
+  std::optional<int> yes_mark_cents;
+  std::optional<int> no_mark_cents;
+  std::int64_t last_ts = 0;
+};
+
 class TickerPositionLedger {
 public:
   explicit TickerPositionLedger(std::string ticker);
@@ -29,6 +43,17 @@ public:
 
   const std::string &ticker() const { return ticker_; }
 
+  int yes_position() const { return yes_pos; }
+  int no_position() const { return no_pos; }
+  // Cost basis of the open contracts on both sides.
+  long long open_cost_cents() const {
+    return static_cast<long long>(std::abs(yes_pos)) * vwap_yes_c +
+           static_cast<long long>(std::abs(no_pos)) * vwap_no_c;
+  }
+
+  LedgerState state() const;
+  void restore(const LedgerState &s);
+
 private:
   void apply_fill_one_side(Action act, int qty, int price_c, int &pos,
                            int &vwap_cents, bool /*isYes*/);
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string_view>
+#include <vector>
+
+// The last `capacity` trade ids seen, as 64-bit hashes in a fixed
+// open-addressed table, so the feed's redelivered fills can be dropped
+// without allocating. The oldest id is forgotten once it is full.
+class TradeIdFilter {
+public:
+  explicit TradeIdFilter(std::size_t capacity = 1 << 16)
+      : ring(capacity ? capacity : 1) {
+    std::size_t n = 2;
+    while (n < 2 * ring.size())
+      n <<= 1;
+    table.assign(n, 0);
+  }
+
+  // True if `id` is new to the filter, which then remembers it.
+  bool insert(std::string_view id) {
+    const std::uint64_t h = key(id);
+    std::size_t i = slot(h);
+    for (; table[i]; i = (i + 1) & (table.size() - 1)) {
+      if (table[i] == h)
+        return false;
+    }
+    if (count == ring.size()) {
+      erase(ring[head]);
+    } else {
+      ++count;
+    }
+    i = slot(h); // erase() may have shifted the probe run
+    while (table[i])
+      i = (i + 1) & (table.size() - 1);
+    table[i] = h;
+    ring[head] = h;
+    head = (head + 1) % ring.size();
+    return true;
+  }
+
+  std::size_t size() const { return count; }
+
+private:
+  static std::uint64_t key(std::string_view id) {
+    const std::uint64_t h = std::hash<std::string_view>{}(id);
+    return h ? h : 1; // 0 marks an empty slot
+  }
+  std::size_t slot(std::uint64_t h) const {
+    return static_cast<std::size_t>(h * 0x9e3779b97f4a7c15ull) &
+           (table.size() - 1);
+  }
+
+  // Backward-shift deletion keeps every probe run unbroken.
+  void erase(std::uint64_t h) {
+    const std::size_t mask = table.size() - 1;
+    std::size_t i = slot(h);
+    while (table[i] != h) {
+      if (!table[i])
+        return;
+      i = (i + 1) & mask;
+    }
+    for (std::size_t j = (i + 1) & mask; table[j]; j = (j + 1) & mask) {
+      const std::size_t home = slot(table[j]);
+      // Move j back into the hole at i unless its home lies in (i, j].
+      if (((j - home) & mask) >= ((j - i) & mask)) {
+        table[i] = table[j];
+        i = j;
+      }
+    }
+    table[i] = 0;
+  }
+
+  std::vector<std::uint64_t> table;
+  std::vector<std::uint64_t> ring; // insertion order, for eviction
+  std::size_t head = 0;
+  std::size_t count = 0;
+};
@@ -0,0 +1,120 @@
+#include "risk_gate.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+
+const char *to_string(RiskCheck c) {
+  switch (c) {
+  case RiskCheck::Ok:
+    return "ok";
+  case RiskCheck::KillSwitch:
+    return "kill_switch";
+  case RiskCheck::PriceRange:
+    return "price_range";
+  case RiskCheck::PriceBand:
+    return "price_band";
+  case RiskCheck::OrderSize:
+    return "order_size";
+  case RiskCheck::Position:
+    return "position";
+  case RiskCheck::Notional:
+    return "notional";
+  case RiskCheck::PortfolioContracts:
+    return "portfolio_contracts";
+  case RiskCheck::PortfolioNotional:
+    return "portfolio_notional";
+  case RiskCheck::PortfolioLoss:
+    return "portfolio_loss";
+  case RiskCheck::OrderRate:
+    return "order_rate";
+  }
+  return "unknown";
+}
+
+RiskGate::RiskGate(MarketLimits d, PortfolioLimits p)
+    : defaults(d), portfolio(p) {}
+
+void RiskGate::apply(Row &r, const MarketLimits &l) {
+  r.max_position = l.max_position;
+  r.max_order_size = l.max_order_size;
+  r.price_band = l.price_band_cents;
+  r.max_notional = l.max_notional_cents;
+  r.tokens_per_ns = l.max_orders_per_sec * 1e-9;
+  r.burst = l.order_burst;
+  r.tokens = std::min(r.tokens, r.burst);
+}
+
+RiskGate::Index RiskGate::add_market(const std::string &ticker) {
+  auto [it, inserted] =
+      index.try_emplace(ticker, static_cast<Index>(rows.size()));
+  if (inserted) {
+    Row r{};
+    r.tokens = defaults.order_burst;
+    apply(r, defaults);
+    rows.push_back(r);
+  }
+  return it->second;
+}
+
+void RiskGate::set_limits(const std::string &ticker,
+                          const MarketLimits &limits) {
+  apply(rows[add_market(ticker)], limits);
+}
+
+std::optional<RiskGate::Index>
+RiskGate::find(const std::string &ticker) const {
+  auto it = index.find(ticker);
+  if (it == index.end())
+    return std::nullopt;
+  return it->second;
+}
+
+RiskCheck RiskGate::check(Index i, Side side, int price, int count,
+                          int fair_cents, std::int64_t now_ns,
+                          bool new_order) {
+  if (killed_.load(std::memory_order_relaxed))
+    return RiskCheck::KillSwitch;
+  if (price < 1 || price > 99 || count <= 0)
+    return RiskCheck::PriceRange;
+
+  Row &r = rows[i];
+  if (std::abs(price - fair_cents) > r.price_band)
+    return RiskCheck::PriceBand;
+  if (count > r.max_order_size)
+    return RiskCheck::OrderSize;
+
+  const int net_after = r.net_pos + (side == Side::YES ? count : -count);
+  if (std::abs(net_after) > r.max_position)
+    return RiskCheck::Position;
+  const long long order_cost = static_cast<long long>(price) * count;
+  if (r.cost + order_cost > r.max_notional)
+    return RiskCheck::Notional;
+  if (gross_contracts_ + count > portfolio.max_gross_contracts)
+    return RiskCheck::PortfolioContracts;
+  if (notional_cents_ + order_cost > portfolio.max_notional_cents)
+    return RiskCheck::PortfolioNotional;
+  if (pnl_source &&
+      pnl_source->totals().pnl_cents < -portfolio.max_loss_cents)
+    return RiskCheck::PortfolioLoss;
+
+  if (new_order) {
+    const double refill = (now_ns - r.refilled_ns) * r.tokens_per_ns;
+    r.refilled_ns = now_ns;
+    r.tokens = std::min(r.burst, r.tokens + std::max(0.0, refill));
+    if (r.tokens < 1.0)
+      return RiskCheck::OrderRate;
+    r.tokens -= 1.0;
+  }
+  return RiskCheck::Ok;
+}
+
+void RiskGate::on_position(Index i, int yes_pos, int no_pos,
+                           long long open_cost_cents) {
+  Row &r = rows[i];
+  const int gross = std::abs(yes_pos) + std::abs(no_pos);
+  gross_contracts_ += gross - r.gross;
+  notional_cents_ += open_cost_cents - r.cost;
+  r.net_pos = yes_pos - no_pos;
+  r.gross = gross;
+  r.cost = open_cost_cents;
+}
@@ -0,0 +1,109 @@
+#pragma once
+
+#include "protocols/feed_adapter.hpp"
+#include "strategy/positions/portfolio_aggregator.hpp"
+#include <atomic>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+struct MarketLimits {
+  int max_position = 50;                // |yes - no| once the order fills
+  long long max_notional_cents = 5'000; // open cost plus the order
+  int max_order_size = 25;
+  int price_band_cents = 15; // allowed distance from fair value
+  double max_orders_per_sec = 10.0;
+  double order_burst = 5.0;
+};
+
+struct PortfolioLimits {
+  long long max_gross_contracts = 500;
+  long long max_notional_cents = 50'000;
+  // Stop adding risk once realized + unrealized PnL across the portfolio
+  // falls this far below zero.
+  long long max_loss_cents = 10'000;
+};
+
+enum class RiskCheck : std::uint8_t {
+  Ok,
+  KillSwitch,
+  PriceRange,
+  PriceBand,
+  OrderSize,
+  Position,
+  Notional,
+  PortfolioContracts,
+  PortfolioNotional,
+  PortfolioLoss,
+  OrderRate,
+};
+
+const char *to_string(RiskCheck c);
+
+// Pre-trade checks for the quote path. Limits are resolved once into a flat
+// per-market table, so a check is an index plus a handful of compares; the
+// ticker lookup only happens on setup. Every order is a buy on one side of
+// the book (a YES ask is a NO bid at 100 - ask), matching how Kalshi rests
+// it. Not thread-safe apart from the kill switch, which any thread (or a
+// signal handler) may flip.
+class RiskGate {
+public:
+  using Index = std::uint32_t;
+
+  explicit RiskGate(MarketLimits defaults = {}, PortfolioLimits portfolio = {});
+
+  // Returns the existing index if the market is already known.
+  Index add_market(const std::string &ticker);
+  void set_limits(const std::string &ticker, const MarketLimits &limits);
+  std::optional<Index> find(const std::string &ticker) const;
+
+  // `fair_cents` is fair value on `side`. Only new orders (not a resend of
+  // a working price) are charged against the order rate.
+  RiskCheck check(Index i, Side side, int price, int count, int fair_cents,
+                  std::int64_t now_ns, bool new_order);
+
+  // Mirrors a market's ledger after a fill; portfolio totals move by the
+  // difference.
+  void on_position(Index i, int yes_pos, int no_pos,
+                   long long open_cost_cents);
+
+  // Source of portfolio PnL for the loss limit; unchecked while unset.
+  void set_portfolio(const PortfolioAggregator *p) { pnl_source = p; }
+
+  void kill() { killed_.store(true, std::memory_order_relaxed); }
+  void resume() { killed_.store(false, std::memory_order_relaxed); }
+  bool killed() const { return killed_.load(std::memory_order_relaxed); }
+
+  long long gross_contracts() const { return gross_contracts_; }
+  long long notional_cents() const { return notional_cents_; }
+
+private:
+  struct alignas(64) Row {
+    // limits
+    int max_position;
+    int max_order_size;
+    int price_band;
+    long long max_notional;
+    double tokens_per_ns;
+    double burst;
+    // state
+    int net_pos = 0;
+    int gross = 0;
+    long long cost = 0;
+    double tokens;
+    std::int64_t refilled_ns = 0;
+  };
+
+  static void apply(Row &r, const MarketLimits &l);
+
+  MarketLimits defaults;
+  PortfolioLimits portfolio;
+  std::vector<Row> rows;
+  std::unordered_map<std::string, Index> index;
+  const PortfolioAggregator *pnl_source = nullptr;
+  std::atomic<bool> killed_{false};
+  long long gross_contracts_ = 0;
+  long long notional_cents_ = 0;
+};
@@ -1,11 +1,30 @@
 #pragma once
 
 #include "protocols/feed_adapter.hpp"
+#include "protocols/kalshi/kalshi_order_book_manager.hpp"
 
 class Strategy {
 public:
   virtual ~Strategy() = default;
-  virtual void handle_feed_event(FeedEvent ev) = 0;
+
+  // `book` is the event's market with the event already applied, or nullptr
+  // if there is none. It is owned by the engine and only valid for the call.
+  virtual void handle_feed_event(const FeedEvent &ev,
+                                 const KalshiOrderBook *book) = 0;
+
+  // Called once when registered with an engine, before it starts, with the
+  // books the engine maintains.
+  virtual void attach_books(const KalshiOrderBookManager &) {}
+
+  // Called once alongside attach_books. Report acks and cancels of our own
+  // resting orders through it, on the engine thread, to have their queue
+  // position tracked in the books; the engine applies our fills itself.
+  virtual void attach_order_queue(OrderQueue) {}
+
+  // Called on the engine thread whenever its queue runs empty, and every
+  // so often while it stays empty; outside any no-allocation zone. For
+  // housekeeping that should not hold up an event.
+  virtual void on_idle() {}
 
 private:
 };
@@ -1,3 +1,6 @@
+#pragma once
+
+// A price of 0 means that side is not quoted.
 struct Quote {
   int bid;
   int ask;
@@ -0,0 +1,131 @@
+#include <gtest/gtest.h>
+
+#include "infra/book_stage.hpp"
+#include "strategy/kalshi_mm.hpp"
+#include "utils/alloc_audit.hpp"
+
+
+// Only meaningful in the -DKALSHI_ALLOC_AUDIT=ON build.
+#define REQUIRE_AUDIT_BUILD()                                                  \
+  if (!alloc_audit::kEnabled)                                                  \
+  GTEST_SKIP() << "built without KALSHI_ALLOC_AUDIT"
+
+namespace {
+
+// Past SSO length, as real tickers are, so a copy or a key built from one
+// shows up as an allocation.
+const std::string kTicker = "KXNBAPLAYOFF-26-CHI";
+
+// Keeps the compiler from eliding a new/delete pair.
+int *volatile sink;
+
+void allocate_once() {
+  sink = new int(1);
+  delete sink;
+}
+
+FeedEvent book_event(std::int64_t seq, int price, int delta) {
+  FeedEvent ev;
+  ev.exchange = Exchange::KALSHI;
+  ev.type = FeedEvent::Type::OrderbookDelta;
+  ev.cid = 1;
+  ev.ticker = kTicker;
+  ev.payload = DeltaEvent{Side::YES, price, delta, seq};
+  return ev;
+}
+
+// Runs `ev` through the same stages as the engine thread and returns the
+// allocations it made.
+struct HotPath {
+  std::vector<std::string> tickers{kTicker};
+  ASParams params{0.1, 1.5, 2.0, 60.0};
+  KalshiMM mm{tickers, params};
+  BookStage stage{tickers};
+  int quotes = 0;
+
+  HotPath() {
+    mm.attach_books(stage.books());
+    mm.set_quote_handler(
+        [this](const std::string &, const Quote &, const Quote &) {
+          ++quotes;
+        });
+    FeedEvent snap;
+    snap.exchange = Exchange::KALSHI;
+    snap.type = FeedEvent::Type::OrderbookSnapshot;
+    snap.cid = 1;
+    snap.ticker = kTicker;
+    snap.payload = SnapshotEvent{{{45, 10}, {44, 10}}, {{50, 10}}, 1};
+    run(snap);
+  }
+
+  std::uint64_t run(const FeedEvent &ev) {
+    alloc_audit::AllocationScope scope;
+    mm.handle_feed_event(ev, stage.apply(ev));
+    return scope.allocations();
+  }
+};
+
+} // namespace
+
+TEST(AllocAuditTest, CountsThreadAllocations) {
+  REQUIRE_AUDIT_BUILD();
+  alloc_audit::AllocationScope scope;
+  allocate_once();
+  EXPECT_EQ(scope.allocations(), 1u);
+  EXPECT_GE(scope.bytes(), sizeof(int));
+}
+
+TEST(AllocAuditTest, ZoneRecordsViolation) {
+  REQUIRE_AUDIT_BUILD();
+  const auto before = alloc_audit::violations().allocations;
+  {
+    KALSHI_NO_ALLOC_ZONE("test");
+    allocate_once();
+    allocate_once();
+  }
+  EXPECT_EQ(alloc_audit::violations().allocations - before, 2u);
+}
+
+TEST(AllocAuditTest, ZoneAbortsWhenAsked) {
+  REQUIRE_AUDIT_BUILD();
+  EXPECT_DEATH(
+      {
+        alloc_audit::NoAllocZone zone("fatal", alloc_audit::ZoneAction::Abort);
+        allocate_once();
+      },
+      "no-alloc zone 'fatal'");
+}
+
+// Per-event budgets for the steady-state engine path. Lower them as
+// allocations are removed; never raise them.
+TEST(AllocAuditTest, SteadyStateBudgets) {
+  REQUIRE_AUDIT_BUILD();
+  HotPath hot;
+  hot.run(book_event(2, 45, 1)); // first use of thread-local state
+
+  EXPECT_EQ(hot.run(book_event(3, 45, 2)), 0u) << "delta on a resting level";
+  EXPECT_EQ(hot.run(book_event(4, 45, -1)), 0u) << "delta shrinking a level";
+
+  FeedEvent trade;
+  trade.exchange = Exchange::KALSHI;
+  trade.type = FeedEvent::Type::Trade;
+  trade.ticker = kTicker;
+  trade.payload = TradeEvent{45, 3, Side::NO, 0};
+  EXPECT_EQ(hot.run(trade), 0u) << "trade print";
+
+  FeedEvent fill;
+  fill.exchange = Exchange::KALSHI;
+  fill.type = FeedEvent::Type::Fill;
+  fill.ticker = kTicker;
+  FillEvent f{};
+  f.trade_id = "d0f3c1a2-6b7e-4c59-9a8e-2f4b5c6d7e8f";
+  f.market_ticker = kTicker;
+  f.side = f.purchased_side = Side::YES;
+  f.action = Action::BUY;
+  f.yes_price = 45;
+  f.count = 1;
+  f.post_position = 1;
+  fill.payload = f;
+  EXPECT_EQ(hot.run(fill), 0u) << "fill";
+  EXPECT_GT(hot.quotes, 0);
+}
@@ -0,0 +1,219 @@
+#include <gtest/gtest.h>
+
+#include "infra/engine.hpp"
+#include "recorder/book_recorder.hpp"
+#include "recorder/recording_reader.hpp"
+
+#include <cstdio>
+#include <limits>
+#include <memory>
+#include <string>
+#include <unistd.h>
+
+namespace {
+
+constexpr std::int64_t kAll = std::numeric_limits<std::int64_t>::max();
+
+std::string temp_path(const char *name) {
+  return "/tmp/" + std::string(name) + "_" + std::to_string(::getpid()) +
+         ".rec";
+}
+
+void remove_recording(const std::string &path) {
+  std::remove(path.c_str());
+  std::remove((path + ".idx").c_str());
+}
+
+FeedEvent snapshot(const std::string &ticker, std::int64_t cid,
+                   std::vector<std::pair<int, int>> yes,
+                   std::vector<std::pair<int, int>> no) {
+  FeedEvent ev;
+  ev.exchange = Exchange::KALSHI;
+  ev.type = FeedEvent::Type::OrderbookSnapshot;
+  ev.cid = cid;
+  ev.ticker = ticker;
+  ev.payload = SnapshotEvent{std::move(yes), std::move(no), 1};
+  return ev;
+}
+
+FeedEvent delta(const std::string &ticker, std::int64_t cid, Side side,
+                int price, int d, std::int64_t seq) {
+  FeedEvent ev;
+  ev.exchange = Exchange::KALSHI;
+  ev.type = FeedEvent::Type::OrderbookDelta;
+  ev.cid = cid;
+  ev.ticker = ticker;
+  ev.payload = DeltaEvent{side, price, d, seq};
+  return ev;
+}
+
+BookSample row(std::int64_t ts, int yes_px, int yes_sz, int no_px,
+               int no_sz) {
+  BookSample s;
+  s.ts_ns = ts;
+  s.depth = 2;
+  s.yes[0] = {yes_px, yes_sz};
+  s.yes[1] = {yes_px - 1, yes_sz * 2};
+  s.no[0] = {no_px, no_sz};
+  return s;
+}
+
+} // namespace
+
+TEST(BookColumnsTest, RoundTripsAndStaysSmall) {
+  std::vector<BookSample> rows;
+  std::int64_t ts = 1'700'000'000'000'000'000;
+  for (int i = 0; i < 1000; ++i) {
+    ts += 1000 + (i % 7) * 250'000;
+    rows.push_back(row(ts, 40 + i % 3, 10 + i % 50, 55 - i % 2, 300));
+  }
+
+  std::vector<unsigned char> raw;
+  encode_columns(rows.data(), rows.size(), 2, raw);
+  // Four price and four size columns, plus timestamps: a few bytes a row.
+  EXPECT_LT(raw.size(), rows.size() * 16);
+
+  std::vector<BookSample> back;
+  ASSERT_TRUE(decode_columns(raw.data(), raw.size(), rows.size(), 2, 7, back));
+  ASSERT_EQ(back.size(), rows.size());
+  for (std::size_t i = 0; i < rows.size(); ++i) {
+    EXPECT_EQ(back[i].ts_ns, rows[i].ts_ns);
+    EXPECT_EQ(back[i].market, 7u);
+    for (int l = 0; l < 2; ++l) {
+      EXPECT_EQ(back[i].yes[l].price, rows[i].yes[l].price);
+      EXPECT_EQ(back[i].yes[l].size, rows[i].yes[l].size);
+      EXPECT_EQ(back[i].no[l].price, rows[i].no[l].price);
+      EXPECT_EQ(back[i].no[l].size, rows[i].no[l].size);
+    }
+  }
+  EXPECT_FALSE(
+      decode_columns(raw.data(), raw.size() - 1, rows.size(), 2, 0, back));
+}
+
+TEST(BookColumnsTest, Microprice) {
+  BookSample s = row(0, 40, 10, 55, 30); // YES 40 x 10 / 45 x 30
+  EXPECT_EQ(s.yes_ask(), 45);
+  EXPECT_DOUBLE_EQ(s.microprice(), (40.0 * 30 + 45.0 * 10) / 40);
+  s.no[0] = {};
+  EXPECT_EQ(s.microprice(), 0.0);
+}
+
+TEST(BookRecorderTest, RecordsTopOfBookChangesPerMarket) {
+  const std::string path = temp_path("book_recorder_tob");
+  BookRecorderConfig cfg;
+  cfg.path = path;
+  cfg.depth = 3;
+  cfg.rows_per_block = 2;
+  auto recorder = std::make_shared<BookRecorder>(cfg);
+  ASSERT_TRUE(recorder->open());
+  recorder->start();
+
+  Engine engine;
+  engine.add_strategy(recorder);
+  engine.dispatch(snapshot("A", 1, {{40, 10}, {39, 5}}, {{55, 20}}));
+  engine.dispatch(snapshot("B", 2, {{20, 1}}, {{70, 2}}));
+  engine.dispatch(delta("A", 1, Side::YES, 39, 5, 2)); // below the top
+  engine.dispatch(delta("A", 1, Side::YES, 40, 3, 3)); // top size
+  engine.dispatch(delta("A", 1, Side::NO, 56, 1, 4));  // new best NO
+  engine.dispatch(delta("B", 2, Side::YES, 21, 4, 2));
+  recorder->stop();
+
+  EXPECT_EQ(recorder->samples(), 5u);
+  EXPECT_EQ(recorder->drops(), 0u);
+
+  RecordingReader reader;
+  ASSERT_TRUE(reader.open(path));
+  EXPECT_EQ(reader.depth(), 3u);
+  ASSERT_EQ(reader.markets().size(), 2u);
+  EXPECT_EQ(reader.block_count(), 3u); // A: 2 + 1, B: 1 full
+
+  std::vector<BookSample> a;
+  ASSERT_TRUE(reader.read("A", 0, kAll, a));
+  ASSERT_EQ(a.size(), 3u);
+  EXPECT_EQ(a[0].yes_bid(), 40);
+  EXPECT_EQ(a[0].yes[1].price, 39);
+  EXPECT_EQ(a[0].yes[1].size, 5);
+  EXPECT_EQ(a[0].yes_ask(), 45);
+  EXPECT_EQ(a[1].yes_bid_size(), 13);
+  EXPECT_EQ(a[1].yes[1].size, 10);
+  EXPECT_EQ(a[2].yes_ask(), 44);
+  EXPECT_EQ(a[2].no[1].price, 55);
+  EXPECT_LE(a[0].ts_ns, a[1].ts_ns);
+  EXPECT_LE(a[1].ts_ns, a[2].ts_ns);
+
+  std::vector<BookSample> b;
+  ASSERT_TRUE(reader.read("B", 0, kAll, b));
+  ASSERT_EQ(b.size(), 2u);
+  EXPECT_EQ(b[1].yes_bid(), 21);
+
+  remove_recording(path);
+}
+
+TEST(BookRecorderTest, IndexSeeksWithoutDecodingOtherBlocks) {
+  const std::string path = temp_path("book_recorder_seek");
+  BookRecorderConfig cfg;
+  cfg.path = path;
+  cfg.depth = 1;
+  cfg.rows_per_block = 10;
+  auto recorder = std::make_shared<BookRecorder>(cfg);
+  ASSERT_TRUE(recorder->open());
+  recorder->start();
+
+  Engine engine;
+  engine.add_strategy(recorder);
+  engine.dispatch(snapshot("A", 1, {{40, 1}}, {{55, 1}}));
+  for (int i = 0; i < 99; ++i) // every delta moves the top size
+    engine.dispatch(delta("A", 1, Side::YES, 40, 1, i + 2));
+  recorder->stop();
+
+  RecordingReader reader;
+  ASSERT_TRUE(reader.open(path));
+  ASSERT_EQ(reader.block_count(), 10u);
+  std::vector<BookSample> all;
+  ASSERT_TRUE(reader.read("A", 0, kAll, all));
+  ASSERT_EQ(all.size(), 100u);
+
+  // A window inside the 5th block.
+  std::vector<BookSample> window;
+  std::size_t blocks_read = 0;
+  ASSERT_TRUE(reader.read("A", all[42].ts_ns, all[47].ts_ns, window,
+                          &blocks_read));
+  EXPECT_LE(blocks_read, 2u); // equal timestamps may straddle a boundary
+  ASSERT_FALSE(window.empty());
+  EXPECT_EQ(window.front().yes_bid_size(), all[42].yes_bid_size());
+  for (const auto &s : window) {
+    EXPECT_GE(s.ts_ns, all[42].ts_ns);
+    EXPECT_LT(s.ts_ns, all[47].ts_ns);
+  }
+
+  // Without the index the reader rebuilds it from the block headers.
+  std::remove((path + ".idx").c_str());
+  RecordingReader scanned;
+  ASSERT_TRUE(scanned.open(path));
+  EXPECT_EQ(scanned.block_count(), 10u);
+  std::vector<BookSample> again;
+  ASSERT_TRUE(scanned.read("A", 0, kAll, again));
+  EXPECT_EQ(again.size(), 100u);
+
+  remove_recording(path);
+}
+
+TEST(BookRecorderTest, IntervalModeThrottlesSamples) {
+  const std::string path = temp_path("book_recorder_interval");
+  BookRecorderConfig cfg;
+  cfg.path = path;
+  cfg.mode = SampleMode::Interval;
+  cfg.interval = std::chrono::hours(1);
+  auto recorder = std::make_shared<BookRecorder>(cfg);
+  ASSERT_TRUE(recorder->open());
+
+  Engine engine;
+  engine.add_strategy(recorder);
+  engine.dispatch(snapshot("A", 1, {{40, 1}}, {{55, 1}}));
+  for (int i = 0; i < 10; ++i)
+    engine.dispatch(delta("A", 1, Side::YES, 41 + i, 1, i + 2));
+  // Only the snapshot falls outside the hour.
+  EXPECT_EQ(recorder->samples(), 1u);
+
+  remove_recording(path);
+}
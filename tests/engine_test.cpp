@@ -0,0 +1,363 @@
+#include <gtest/gtest.h>
+
+#include "infra/engine.hpp"
+#include "strategy/orders/order_manager.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <optional>
+#include <thread>
+#include <vector>
+
+namespace {
+
+struct Seen {
+  std::string ticker;
+  const KalshiOrderBook *book;
+  int best_yes_bid;
+  FeedEvent::Type type;
+};
+
+class Recorder : public Strategy {
+public:
+  void handle_feed_event(const FeedEvent &ev,
+                         const KalshiOrderBook *book) override {
+    seen.push_back({ev.ticker, book,
+                    book ? book->book.best_yes_bid().first : 0, ev.type});
+  }
+  void attach_books(const KalshiOrderBookManager &b) override {
+    attached = &b;
+  }
+
+  std::vector<Seen> seen;
+  const KalshiOrderBookManager *attached = nullptr;
+};
+
+FeedEvent snapshot(const std::string &ticker, std::int64_t cid, int yes_bid,
+                   std::int64_t seq = 1) {
+  FeedEvent ev;
+  ev.exchange = Exchange::KALSHI;
+  ev.type = FeedEvent::Type::OrderbookSnapshot;
+  ev.cid = cid;
+  ev.ticker = ticker;
+  ev.payload = SnapshotEvent{{{yes_bid, 10}}, {{40, 10}}, seq};
+  return ev;
+}
+
+FeedEvent delta(const std::string &ticker, std::int64_t cid, int price,
+                int contracts, std::int64_t seq) {
+  FeedEvent ev;
+  ev.exchange = Exchange::KALSHI;
+  ev.type = FeedEvent::Type::OrderbookDelta;
+  ev.cid = cid;
+  ev.ticker = ticker;
+  ev.payload = DeltaEvent{Side::YES, price, contracts, seq};
+  return ev;
+}
+
+FeedEvent fill(const std::string &ticker, std::int64_t cid) {
+  FeedEvent ev;
+  ev.exchange = Exchange::KALSHI;
+  ev.type = FeedEvent::Type::Fill;
+  ev.cid = cid;
+  ev.ticker = ticker;
+  ev.payload = FillEvent{};
+  return ev;
+}
+
+void drain(Engine &engine) {
+  const auto deadline =
+      std::chrono::steady_clock::now() + std::chrono::seconds(5);
+  while (engine.queue_depth() > 0 &&
+         std::chrono::steady_clock::now() < deadline) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+}
+
+} // namespace
+
+TEST(EngineTest, StrategiesShareOneBookPerMarket) {
+  Engine engine;
+  auto all = std::make_shared<Recorder>();
+  auto only_a = std::make_shared<Recorder>();
+  engine.add_strategy(all);
+  engine.add_strategy(only_a, {"A"});
+  EXPECT_EQ(all->attached, &engine.books());
+  EXPECT_EQ(only_a->attached, &engine.books());
+
+  engine.dispatch(snapshot("A", 1, 45));
+  engine.dispatch(snapshot("B", 2, 30));
+
+  ASSERT_EQ(all->seen.size(), 2u);
+  ASSERT_EQ(only_a->seen.size(), 1u);
+  EXPECT_EQ(only_a->seen[0].ticker, "A");
+  EXPECT_EQ(only_a->seen[0].book, all->seen[0].book);
+  EXPECT_EQ(only_a->seen[0].book, engine.books().get_book("A"));
+  EXPECT_EQ(only_a->seen[0].best_yes_bid, 45);
+  EXPECT_EQ(all->seen[1].best_yes_bid, 30);
+}
+
+TEST(EngineTest, FillWithoutBookGetsNull) {
+  Engine engine;
+  auto r = std::make_shared<Recorder>();
+  engine.add_strategy(r);
+
+  FeedEvent ev;
+  ev.exchange = Exchange::KALSHI;
+  ev.type = FeedEvent::Type::Fill;
+  ev.ticker = "Z";
+  ev.payload = FillEvent{};
+  engine.dispatch(ev);
+  ASSERT_EQ(r->seen.size(), 1u);
+  EXPECT_EQ(r->seen[0].book, nullptr);
+}
+
+TEST(EngineTest, TracksQueuePositionOfOurOrders) {
+  static constexpr ClientOrderId kId = 0x0001000000000007;
+  // Acks the order once the book exists, the way an order manager running
+  // on the engine thread would.
+  struct Quoter : Recorder {
+    void attach_order_queue(OrderQueue q) override { queue.emplace(q); }
+    void handle_feed_event(const FeedEvent &ev,
+                           const KalshiOrderBook *book) override {
+      if (ev.type == FeedEvent::Type::OrderbookSnapshot)
+        EXPECT_TRUE(queue->on_ack(ev.ticker, kId, Side::YES, 45, 3));
+      ahead.push_back(book ? book->queue_ahead(kId) : std::nullopt);
+    }
+    std::optional<OrderQueue> queue;
+    std::vector<std::optional<int>> ahead;
+  };
+  auto q = std::make_shared<Quoter>();
+  Engine engine(q);
+  ASSERT_TRUE(q->queue);
+  EXPECT_FALSE(q->queue->on_ack("A", 1, Side::YES, 45, 1)); // no book yet
+
+  auto our_fill = [](int count) {
+    FeedEvent ev = fill("A", 1);
+    auto &f = std::get<FillEvent>(ev.payload);
+    f.count = count;
+    char id[kClientOrderIdChars];
+    format_client_order_id(kId, id);
+    f.client_order_id = std::string(id, kClientOrderIdChars);
+    return ev;
+  };
+  engine.dispatch(snapshot("A", 1, 45));
+  engine.dispatch(delta("A", 1, 45, 3, 2));  // our order lands: 13
+  engine.dispatch(delta("A", 1, 45, -9, 3)); // 4 left, 3 of them ours
+  engine.dispatch(our_fill(1));
+  engine.dispatch(our_fill(2));
+
+  ASSERT_EQ(q->ahead.size(), 5u);
+  EXPECT_EQ(q->ahead[0], 10);
+  EXPECT_EQ(q->ahead[1], 10);
+  EXPECT_EQ(q->ahead[2], 1);
+  EXPECT_EQ(q->ahead[3], 0);
+  EXPECT_EQ(q->ahead[4], std::nullopt); // filled; no longer tracked
+
+  q->queue->on_ack("A", 9, Side::YES, 45, 1);
+  q->queue->on_cancel("A", 9);
+  EXPECT_EQ(engine.books().get_book("A")->tracked_orders(), 0u);
+}
+
+TEST(EngineTest, ThreadDeliversInOrder) {
+  auto r = std::make_shared<Recorder>();
+  Engine engine(r);
+  engine.start();
+  for (int p = 1; p <= 20; ++p) {
+    engine.push(snapshot("A", 1, p, p));
+  }
+  const auto deadline =
+      std::chrono::steady_clock::now() + std::chrono::seconds(5);
+  while (engine.queue_depth() > 0 &&
+         std::chrono::steady_clock::now() < deadline) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  engine.stop();
+  ASSERT_EQ(r->seen.size(), 20u);
+  for (int p = 1; p <= 20; ++p) {
+    EXPECT_EQ(r->seen[p - 1].best_yes_bid, p);
+  }
+}
+
+TEST(EngineTest, IdleHookRunsOnceTheQueueDrains) {
+  struct Idler : Recorder {
+    void on_idle() override {
+      if (idles++ == 0)
+        seen_at_first_idle = seen.size();
+    }
+    std::atomic<int> idles{0};
+    std::size_t seen_at_first_idle = 0;
+  };
+  auto r = std::make_shared<Idler>();
+  Engine engine(r);
+  for (int p = 1; p <= 3; ++p) {
+    engine.push(snapshot("A", 1, p, p));
+  }
+  engine.start();
+  const auto deadline =
+      std::chrono::steady_clock::now() + std::chrono::seconds(5);
+  while (r->idles.load() < 2 && std::chrono::steady_clock::now() < deadline) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  engine.stop();
+  // Queued events first; then it keeps ticking while nothing arrives.
+  EXPECT_GE(r->idles.load(), 2);
+  EXPECT_EQ(r->seen_at_first_idle, 3u);
+}
+
+TEST(EngineTest, DropOldestResyncsOnlyTheLaggingMarket) {
+  EngineQueueConfig cfg;
+  cfg.capacity = 5;
+  cfg.policy = OverflowPolicy::DropOldest;
+  Engine engine(cfg);
+  auto r = std::make_shared<Recorder>();
+  engine.add_strategy(r);
+  std::vector<std::string> resynced;
+  engine.set_resync_handler(
+      [&](const std::string &t) { resynced.push_back(t); });
+
+  engine.push(snapshot("A", 1, 40));
+  engine.push(snapshot("B", 2, 30));
+  engine.push(delta("A", 1, 41, 5, 2));
+  engine.push(delta("B", 2, 31, 5, 2));
+  engine.push(delta("A", 1, 42, 5, 3));
+  // Full: A has the oldest delta, so both of A's go.
+  engine.push(delta("B", 2, 32, 5, 3));
+  ASSERT_EQ(resynced, std::vector<std::string>{"A"});
+  // A stays muted until its snapshot arrives.
+  engine.push(delta("A", 1, 43, 5, 4));
+  engine.push(snapshot("A", 1, 44, 10));
+
+  EngineQueueStats st = engine.queue_stats();
+  EXPECT_EQ(st.depth, 5u);
+  EXPECT_EQ(st.high_water, 5u);
+  EXPECT_EQ(st.dropped, 3u);
+  EXPECT_EQ(st.resyncs, 1u);
+  EXPECT_GT(st.bytes, 0u);
+
+  engine.start();
+  drain(engine);
+  engine.stop();
+  // Snapshots go first; B's deltas follow in order.
+  ASSERT_EQ(r->seen.size(), 5u);
+  EXPECT_EQ(r->seen[2].type, FeedEvent::Type::OrderbookSnapshot);
+  EXPECT_EQ(r->seen[2].best_yes_bid, 44);
+  EXPECT_EQ(r->seen[3].ticker, "B");
+  EXPECT_EQ(r->seen[4].ticker, "B");
+  EXPECT_EQ(r->seen[4].best_yes_bid, 32);
+  EXPECT_EQ(engine.queue_stats().bytes, 0u);
+}
+
+TEST(EngineTest, ConflateFoldsConsecutiveDeltasAtOneLevel) {
+  EngineQueueConfig cfg;
+  cfg.capacity = 3;
+  cfg.policy = OverflowPolicy::Conflate;
+  Engine engine(cfg);
+  auto r = std::make_shared<Recorder>();
+  engine.add_strategy(r);
+
+  engine.push(snapshot("A", 1, 40)); // YES 40 x 10
+  engine.push(delta("A", 1, 40, 5, 2));
+  engine.push(delta("A", 1, 40, -2, 3));
+  engine.push(delta("A", 1, 40, -1, 4)); // full: joins seq 3
+  EngineQueueStats st = engine.queue_stats();
+  EXPECT_EQ(st.depth, 3u);
+  EXPECT_EQ(st.conflated, 1u);
+  EXPECT_EQ(st.dropped, 0u);
+
+  engine.start();
+  drain(engine);
+  engine.stop();
+  ASSERT_EQ(r->seen.size(), 3u);
+  const KalshiOrderBook *book = engine.books().get_book("A");
+  ASSERT_NE(book, nullptr);
+  // The merged delta covers seqs 3-4 and applies without a gap.
+  EXPECT_EQ(book->last_seq, 4);
+  EXPECT_EQ(book->book.best_yes_bid().second, 12);
+}
+
+TEST(EngineTest, BlockWaitsForTheEngine) {
+  struct Gate : Strategy {
+    std::atomic<bool> open{false};
+    std::vector<FeedEvent::Type> handled;
+    void handle_feed_event(const FeedEvent &ev,
+                           const KalshiOrderBook *) override {
+      while (!open.load())
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+      handled.push_back(ev.type);
+    }
+  };
+
+  EngineQueueConfig cfg;
+  cfg.capacity = 1;
+  cfg.policy = OverflowPolicy::Block;
+  Engine engine(cfg);
+  auto gate = std::make_shared<Gate>();
+  engine.add_strategy(gate);
+  engine.start();
+
+  engine.push(snapshot("A", 1, 40)); // taken by the engine, then stuck
+  while (engine.queue_depth() > 0)
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  engine.push(delta("A", 1, 41, 5, 2)); // fills the queue
+  std::atomic<bool> pushed{false};
+  std::thread producer([&] {
+    engine.push(delta("A", 1, 42, 5, 3));
+    pushed = true;
+  });
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  EXPECT_FALSE(pushed.load());
+  EXPECT_EQ(engine.queue_stats().blocked, 1u);
+  // A fill never waits for room.
+  engine.push(fill("A", 1));
+  EXPECT_EQ(engine.queue_depth(), 2u);
+
+  gate->open = true;
+  producer.join();
+  drain(engine);
+  engine.stop();
+  EXPECT_TRUE(pushed.load());
+  EXPECT_EQ(gate->handled,
+            (std::vector<FeedEvent::Type>{FeedEvent::Type::OrderbookSnapshot,
+                                          FeedEvent::Type::Fill,
+                                          FeedEvent::Type::OrderbookDelta,
+                                          FeedEvent::Type::OrderbookDelta}));
+  EXPECT_EQ(engine.queue_stats().dropped, 0u);
+}
+
+TEST(EngineTest, FillsAndSnapshotsJumpQueuedDeltas) {
+  Engine engine;
+  auto r = std::make_shared<Recorder>();
+  engine.add_strategy(r);
+
+  engine.push(snapshot("A", 1, 40));
+  engine.push(snapshot("B", 2, 30));
+  for (int i = 0; i < 100; ++i) {
+    engine.push(delta("B", 2, 31, 1, 2 + i));
+  }
+  engine.push(delta("A", 1, 41, 5, 2));
+  engine.push(fill("B", 2));
+  // Newer than A's queued delta, which it already contains.
+  engine.push(snapshot("A", 1, 45, 3));
+
+  EngineQueueStats st = engine.queue_stats();
+  EXPECT_EQ(st.superseded, 1u);
+  EXPECT_EQ(st.lane_depth[static_cast<std::size_t>(EngineLane::Fills)], 1u);
+  EXPECT_EQ(
+      st.lane_depth[static_cast<std::size_t>(EngineLane::Snapshots)], 3u);
+  EXPECT_EQ(
+      st.lane_depth[static_cast<std::size_t>(EngineLane::MarketData)], 100u);
+
+  engine.start();
+  drain(engine);
+  engine.stop();
+  ASSERT_EQ(r->seen.size(), 104u);
+  EXPECT_EQ(r->seen[0].type, FeedEvent::Type::Fill);
+  EXPECT_EQ(r->seen[3].type, FeedEvent::Type::OrderbookSnapshot);
+  EXPECT_EQ(r->seen[3].best_yes_bid, 45);
+  const KalshiOrderBook *b = engine.books().get_book("B");
+  ASSERT_NE(b, nullptr);
+  EXPECT_EQ(b->last_seq, 101);
+  EXPECT_EQ(b->book.best_yes_bid().second, 100);
+}
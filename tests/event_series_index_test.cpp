@@ -0,0 +1,118 @@
+#include <gtest/gtest.h>
+
+#include "strategy/event_series_index.hpp"
+
+#include <vector>
+
+namespace {
+
+struct Signal {
+  std::string event;
+  SeriesSignal signal;
+  bool active;
+  SeriesTop top;
+};
+
+EventSeriesIndex make_index(std::vector<Signal> &out,
+                            SeriesThresholds t = {}) {
+  EventSeriesIndex idx(t);
+  idx.set_callback([&out](const std::string &event, SeriesSignal s,
+                          bool active, const SeriesTop &top) {
+    out.push_back({event, s, active, top});
+  });
+  return idx;
+}
+
+} // namespace
+
+TEST(EventSeriesIndex, GroupsByEventAndTracksSums) {
+  std::vector<Signal> signals;
+  auto idx = make_index(signals);
+  auto a = idx.add_market("KXNBA-26-CHI");
+  auto b = idx.add_market("KXNBA-26-BOS");
+  idx.add_market("KXNFL-26-KC");
+  EXPECT_EQ(idx.add_market("KXNBA-26-CHI"), a);
+
+  const SeriesTop *nba = idx.series("KXNBA-26");
+  ASSERT_NE(nba, nullptr);
+  EXPECT_EQ(nba->legs, 2);
+  EXPECT_EQ(nba->bid_sum, 0);
+  EXPECT_EQ(nba->ask_sum, 200);
+  EXPECT_EQ(nba->missing_asks, 2);
+
+  idx.update(a, 40, 45);
+  idx.update(b, 50, 56);
+  EXPECT_EQ(nba->bid_sum, 90);
+  EXPECT_EQ(nba->ask_sum, 101);
+  EXPECT_EQ(nba->missing_asks, 0);
+
+  // Ask pulled: that leg counts as 100 until it returns.
+  idx.update(b, 50, 0);
+  EXPECT_EQ(nba->ask_sum, 145);
+  EXPECT_EQ(nba->missing_asks, 1);
+
+  EXPECT_EQ(idx.series("KXNFL-26")->legs, 1);
+  EXPECT_EQ(idx.series("KXMLB-26"), nullptr);
+  EXPECT_TRUE(signals.empty());
+}
+
+TEST(EventSeriesIndex, FiresOnCrossingEdgesOnly) {
+  std::vector<Signal> signals;
+  auto idx = make_index(signals);
+  auto a = idx.add_market("EV-A");
+  auto b = idx.add_market("EV-B");
+
+  idx.update(a, 50, 55);
+  idx.update(b, 48, 52);
+  ASSERT_TRUE(signals.empty());
+
+  idx.update(b, 52, 53); // bids 102
+  ASSERT_EQ(signals.size(), 1u);
+  EXPECT_EQ(signals[0].event, "EV");
+  EXPECT_EQ(signals[0].signal, SeriesSignal::BidSumAbove);
+  EXPECT_TRUE(signals[0].active);
+  EXPECT_EQ(signals[0].top.bid_sum, 102);
+
+  idx.update(b, 53, 54); // still above: no new signal
+  EXPECT_EQ(signals.size(), 1u);
+
+  idx.update(b, 45, 47); // bids 95, asks 102
+  ASSERT_EQ(signals.size(), 2u);
+  EXPECT_EQ(signals[1].signal, SeriesSignal::BidSumAbove);
+  EXPECT_FALSE(signals[1].active);
+}
+
+TEST(EventSeriesIndex, AskSignalNeedsEveryLeg) {
+  std::vector<Signal> signals;
+  auto idx = make_index(signals, SeriesThresholds{100, 98});
+  auto a = idx.add_market("EV-A");
+  auto b = idx.add_market("EV-B");
+  auto c = idx.add_market("EV-C");
+
+  idx.update(a, 20, 30);
+  idx.update(b, 20, 30);
+  EXPECT_TRUE(signals.empty()); // C has no ask yet
+
+  idx.update(c, 20, 38); // asks 98: not below threshold
+  EXPECT_TRUE(signals.empty());
+
+  idx.update(c, 20, 37);
+  ASSERT_EQ(signals.size(), 1u);
+  EXPECT_EQ(signals[0].signal, SeriesSignal::AskSumBelow);
+  EXPECT_TRUE(signals[0].active);
+  EXPECT_EQ(signals[0].top.ask_sum, 97);
+
+  idx.update(c, 20, 0); // leg can no longer be bought
+  ASSERT_EQ(signals.size(), 2u);
+  EXPECT_FALSE(signals[1].active);
+}
+
+TEST(EventSeriesIndex, UnknownTickerIgnored) {
+  std::vector<Signal> signals;
+  auto idx = make_index(signals);
+  idx.add_market("EV-A");
+  idx.update("OTHER-A", 99, 99);
+  idx.update("EV-A", 101, 0);
+  EXPECT_EQ(idx.series("EV")->bid_sum, 101);
+  EXPECT_EQ(signals.size(), 1u);
+}
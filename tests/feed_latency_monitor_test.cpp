@@ -0,0 +1,139 @@
+#include <gtest/gtest.h>
+
+#include "infra/feed_latency_monitor.hpp"
+
+#include <random>
+#include <vector>
+
+namespace {
+
+constexpr std::int64_t kMs = 1'000'000;
+constexpr std::int64_t kSec = 1'000'000'000;
+constexpr std::int64_t kStart = 1'700'000'000 * kSec;
+
+// A feed whose messages are stamped in whole seconds by the exchange and
+// received on a local clock that is `offset` ahead and gains `drift_ppm`.
+struct Feed {
+  std::int64_t offset_ns = 3 * kSec;
+  double drift_ppm = 200;
+  std::int64_t path_ns = 2 * kMs;
+  std::mt19937 rng{7};
+
+  std::int64_t exchange_ts(std::int64_t t) const { return t - t % kSec; }
+  std::int64_t recv_ts(std::int64_t t, std::int64_t lag = 0) {
+    const auto jitter = std::uniform_int_distribution<std::int64_t>(
+        0, 3 * kMs)(rng);
+    return t + path_ns + jitter + lag + local_skew(t);
+  }
+  std::int64_t local_skew(std::int64_t t) const {
+    return offset_ns +
+           static_cast<std::int64_t>(static_cast<double>(t - kStart) *
+                                     drift_ppm * 1e-6);
+  }
+};
+
+} // namespace
+
+TEST(FeedLatencyMonitorTest, BucketsBoundTheirDelays) {
+  for (std::size_t b = 0; b + 1 < RollingLatency::kBuckets; ++b) {
+    const std::int64_t top = RollingLatency::bucket_ceiling_ns(b);
+    EXPECT_EQ(RollingLatency::bucket(top), b);
+    EXPECT_EQ(RollingLatency::bucket(top + 1), b + 1);
+  }
+  EXPECT_EQ(RollingLatency::bucket(-5), 0u);
+
+  RollingLatency r(kSec, 4);
+  for (int ms = 1; ms <= 100; ++ms) {
+    r.record(kStart, ms * kMs);
+  }
+  r.record(kStart + 2 * kSec, 40 * kMs);
+  const LatencyStats st = r.stats(kStart + 2 * kSec);
+  EXPECT_EQ(st.samples, 101u);
+  EXPECT_GE(st.p50_ns, 50 * kMs);
+  EXPECT_LE(st.p50_ns, 50 * kMs * 5 / 4);
+  EXPECT_LE(st.p99_ns, 100 * kMs);
+  EXPECT_EQ(st.max_ns, 100 * kMs);
+
+  // The first slot ages out of the window, then the second.
+  EXPECT_EQ(r.stats(kStart + 5 * kSec + kSec / 2).samples, 1u);
+  EXPECT_EQ(r.stats(kStart + 7 * kSec).samples, 0u);
+}
+
+TEST(FeedLatencyMonitorTest, FloorFollowsDriftingClockThroughCoarseStamps) {
+  FeedLatencyMonitor mon;
+  Feed feed;
+  std::int64_t now = 0;
+  for (std::int64_t t = kStart; t < kStart + 600 * kSec; t += 7 * kMs) {
+    now = feed.recv_ts(t);
+    mon.record(0, "M" + std::to_string(t % 5), feed.exchange_ts(t), now);
+  }
+
+  // 120 ms of drift over the run; a fixed offset would be that far off.
+  const std::int64_t truth =
+      feed.local_skew(kStart + 600 * kSec) + feed.path_ns;
+  EXPECT_NEAR(static_cast<double>(mon.floor_ns(now)),
+              static_cast<double>(truth), 10.0 * kMs);
+  EXPECT_NEAR(mon.drift_ns_per_sec(), 200'000, 30'000);
+
+  // Rounding to the second does not read as lag.
+  const LatencyStats st = mon.connection(0, now);
+  EXPECT_GT(st.samples, 0u);
+  EXPECT_LT(st.p50_ns, 50 * kMs);
+  EXPECT_EQ(mon.lag_alerts(), 0u);
+}
+
+TEST(FeedLatencyMonitorTest, FlagsOnlyTheLaggingConnection) {
+  FeedLatencyConfig cfg;
+  cfg.window = std::chrono::milliseconds(1000);
+  cfg.windows = 5;
+  FeedLatencyMonitor mon(cfg);
+  std::vector<std::pair<int, LatencyStats>> flagged;
+  mon.set_lag_handler([&](int c, const LatencyStats &st) {
+    flagged.emplace_back(c, st);
+  });
+
+  Feed feed;
+  std::int64_t now = 0;
+  int n = 0;
+  for (std::int64_t t = kStart; t < kStart + 60 * kSec; t += 7 * kMs, ++n) {
+    const int c = n % 2;
+    // Connection 1 falls 800 ms behind a third of the way in.
+    const std::int64_t lag = c == 1 && t >= kStart + 20 * kSec ? 800 * kMs : 0;
+    now = feed.recv_ts(t, lag);
+    mon.record(c, "M", feed.exchange_ts(t), now);
+  }
+
+  ASSERT_FALSE(flagged.empty());
+  for (const auto &[c, st] : flagged) {
+    EXPECT_EQ(c, 1);
+    EXPECT_GE(st.samples, cfg.min_samples);
+    // Flagged as soon as most of the window is behind, before all of it.
+    EXPECT_GT(st.p50_ns, 250 * kMs);
+    EXPECT_LT(st.p50_ns, 1000 * kMs);
+  }
+  EXPECT_EQ(mon.lag_alerts(), flagged.size());
+  EXPECT_LT(mon.connection(0, now).p50_ns, 50 * kMs);
+}
+
+TEST(FeedLatencyMonitorTest, RanksMarketsByTailDelay) {
+  FeedLatencyMonitor mon;
+  const std::vector<std::pair<std::string, std::int64_t>> markets = {
+      {"FAST", 1 * kMs}, {"SLOW", 50 * kMs}, {"MID", 10 * kMs}};
+  std::int64_t now = 0;
+  for (int i = 0; i < 200; ++i) {
+    for (const auto &[ticker, delay] : markets) {
+      const std::int64_t ts = kStart + i * 10 * kMs + 123;
+      now = ts + delay;
+      mon.record(0, ticker, ts, now);
+    }
+  }
+
+  const auto worst = mon.worst_markets(2, now);
+  ASSERT_EQ(worst.size(), 2u);
+  EXPECT_EQ(worst[0].first, "SLOW");
+  EXPECT_EQ(worst[1].first, "MID");
+  EXPECT_NEAR(static_cast<double>(worst[0].second.p50_ns), 49.0 * kMs,
+              49.0 * kMs / 4);
+  EXPECT_LT(mon.market("FAST", now).p99_ns, kMs);
+  EXPECT_EQ(mon.market("NONE", now).samples, 0u);
+}
@@ -0,0 +1,228 @@
+#include <gtest/gtest.h>
+
+#include "infra/book_stage.hpp"
+#include "strategy/kalshi_mm.hpp"
+#include "strategy/positions/fill_journal.hpp"
+#include <chrono>
+#include <cstdio>
+#include <thread>
+#include <unistd.h>
+
+static FillEvent make_fill(const std::string &trade_id,
+                           const std::string &ticker, Action action, Side side,
+                           int yes_price_cents, int count,
+                           int post_position) {
+  FillEvent f{};
+  f.trade_id = trade_id;
+  f.order_id = "O1";
+  f.market_ticker = ticker;
+  f.is_taker = true;
+  f.side = side;
+  f.purchased_side = side;
+  f.yes_price = yes_price_cents;
+  f.count = count;
+  f.action = action;
+  f.ts = 1000;
+  f.post_position = post_position;
+  return f;
+}
+
+class FillJournalTest : public ::testing::Test {
+protected:
+  void SetUp() override {
+    path = ::testing::TempDir() + "fill_journal_test_" +
+           std::to_string(::getpid()) + ".fills";
+    std::remove(path.c_str());
+  }
+  void TearDown() override { std::remove(path.c_str()); }
+
+  std::string path;
+};
+
+TEST_F(FillJournalTest, ReplayRebuildsLedgersAfterRestart) {
+  {
+    FillJournal journal({path, 64});
+    ASSERT_TRUE(journal.open());
+    journal.start();
+    EXPECT_TRUE(journal.append(
+        make_fill("T1", "KXBTC-24DEC31", Action::BUY, Side::YES, 60, 10, 10)));
+    EXPECT_TRUE(journal.append(
+        make_fill("T2", "KXBTC-24DEC31", Action::SELL, Side::YES, 70, 4, 6)));
+    journal.stop();
+    EXPECT_EQ(journal.durable(), 2u);
+  }
+
+  FillJournal journal({path, 64});
+  ASSERT_TRUE(journal.open());
+  EXPECT_EQ(journal.size(), 2u);
+
+  PositionManager pm(Exchange::KALSHI, {});
+  EXPECT_EQ(journal.replay(pm), 2u);
+
+  const auto *ledger = pm.get_ledger("KXBTC-24DEC31");
+  ASSERT_NE(ledger, nullptr);
+  auto snap = ledger->snapshot();
+  EXPECT_EQ(snap.yes_pos, 6);
+  EXPECT_EQ(snap.cash_cents, -320);
+  EXPECT_EQ(snap.realized_pnl_cents, 40);
+}
+
+TEST_F(FillJournalTest, ReplaySkipsDuplicateTradeIds) {
+  FillJournal journal({path, 64});
+  ASSERT_TRUE(journal.open());
+  auto f = make_fill("T1", "KXBTC-24DEC31", Action::BUY, Side::YES, 60, 10, 10);
+  journal.append(f);
+  journal.append(f); // redelivered after a reconnect
+
+  PositionManager pm(Exchange::KALSHI, {});
+  EXPECT_EQ(journal.replay(pm), 1u);
+  EXPECT_EQ(pm.get_ledger("KXBTC-24DEC31")->snapshot().yes_pos, 10);
+}
+
+TEST_F(FillJournalTest, ReplayKeepsEveryFillWithoutATradeId) {
+  FillJournal journal({path, 64});
+  ASSERT_TRUE(journal.open());
+  journal.append(
+      make_fill("", "KXBTC-24DEC31", Action::BUY, Side::YES, 60, 2, 2));
+  journal.append(
+      make_fill("", "KXBTC-24DEC31", Action::BUY, Side::YES, 60, 3, 5));
+
+  PositionManager pm(Exchange::KALSHI, {});
+  TradeIdFilter ids(8);
+  EXPECT_EQ(journal.replay(pm, 0, &ids), 2u);
+  EXPECT_EQ(pm.get_ledger("KXBTC-24DEC31")->snapshot().yes_pos, 5);
+  EXPECT_TRUE(ids.insert(""));
+}
+
+TEST_F(FillJournalTest, ReplayFromSkipsFillsAlreadyInCheckpoint) {
+  FillJournal journal({path, 64});
+  ASSERT_TRUE(journal.open());
+  journal.append(
+      make_fill("T1", "KXBTC-24DEC31", Action::BUY, Side::YES, 60, 10, 10));
+  journal.append(
+      make_fill("T2", "KXBTC-24DEC31", Action::BUY, Side::YES, 50, 5, 15));
+  journal.append(
+      make_fill("T1", "KXBTC-24DEC31", Action::BUY, Side::YES, 60, 10, 10));
+
+  PositionManager pm(Exchange::KALSHI, {});
+  EXPECT_EQ(journal.replay(pm, 1), 1u);
+  EXPECT_EQ(pm.get_ledger("KXBTC-24DEC31")->snapshot().yes_pos, 5);
+}
+
+TEST_F(FillJournalTest, AppendFailsWhenFull) {
+  FillJournal journal({path, 1});
+  ASSERT_TRUE(journal.open());
+  EXPECT_TRUE(journal.append(
+      make_fill("T1", "KXBTC-24DEC31", Action::BUY, Side::YES, 60, 1, 1)));
+  EXPECT_FALSE(journal.append(
+      make_fill("T2", "KXBTC-24DEC31", Action::BUY, Side::YES, 60, 1, 2)));
+}
+
+TEST_F(FillJournalTest, CompactDropsWhatTheCheckpointCovers) {
+  {
+    FillJournal journal({path, 8});
+    ASSERT_TRUE(journal.open());
+    for (int i = 1; i <= 5; ++i) {
+      ASSERT_TRUE(journal.append(make_fill("T" + std::to_string(i), "A",
+                                           Action::BUY, Side::YES, 50, 1,
+                                           i)));
+    }
+    ASSERT_TRUE(journal.compact(3));
+    EXPECT_EQ(journal.first(), 3u);
+    EXPECT_EQ(journal.size(), 5u);
+    // Room again, and numbering carries on.
+    for (int i = 6; i <= 11; ++i) {
+      ASSERT_TRUE(journal.append(make_fill("T" + std::to_string(i), "A",
+                                           Action::BUY, Side::YES, 50, 1,
+                                           i)));
+    }
+    EXPECT_FALSE(journal.append(
+        make_fill("T12", "A", Action::BUY, Side::YES, 50, 1, 12)));
+    journal.stop();
+  }
+
+  FillJournal journal({path, 8});
+  ASSERT_TRUE(journal.open());
+  EXPECT_EQ(journal.first(), 3u);
+  EXPECT_EQ(journal.size(), 11u);
+  PositionManager pm(Exchange::KALSHI, {});
+  EXPECT_EQ(journal.replay(pm, 9), 2u);
+  EXPECT_EQ(pm.get_ledger("A")->snapshot().yes_pos, 2);
+}
+
+TEST(TradeIdFilterTest, ForgetsTheOldestOnceFull) {
+  TradeIdFilter f(3);
+  EXPECT_TRUE(f.insert("a"));
+  EXPECT_TRUE(f.insert("b"));
+  EXPECT_FALSE(f.insert("a"));
+  EXPECT_TRUE(f.insert("c"));
+  EXPECT_TRUE(f.insert("d")); // evicts "a"
+  EXPECT_EQ(f.size(), 3u);
+  EXPECT_FALSE(f.insert("b"));
+  EXPECT_FALSE(f.insert("d"));
+  EXPECT_TRUE(f.insert("a"));
+  for (int i = 0; i < 1000; ++i) {
+    EXPECT_TRUE(f.insert("x" + std::to_string(i)));
+    EXPECT_FALSE(f.insert("x" + std::to_string(i)));
+  }
+}
+
+TEST_F(FillJournalTest, LiveFillsAreDedupedAndCompactedAtCheckpoints) {
+  const std::string ckpt = path + ".ckpt";
+  std::remove(ckpt.c_str());
+  std::vector<std::string> tickers{"A"};
+  ASParams params{0.1, 1.5, 2.0, 60.0};
+  KalshiMM mm(tickers, params);
+  BookStage stage(tickers);
+  mm.attach_books(stage.books());
+  auto journal = std::make_shared<FillJournal>(
+      FillJournalConfig{path, 4, std::chrono::microseconds(100)});
+  ASSERT_TRUE(journal->open());
+  journal->start();
+  mm.set_fill_journal(journal);
+  auto cp = std::make_shared<StateCheckpoint>(CheckpointConfig{ckpt, 16});
+  ASSERT_TRUE(cp->open());
+  mm.set_checkpoint(cp, std::chrono::milliseconds(0));
+  cp->start();
+
+  auto fill = [&](const std::string &id, int post) {
+    FeedEvent ev;
+    ev.exchange = Exchange::KALSHI;
+    ev.type = FeedEvent::Type::Fill;
+    ev.ticker = "A";
+    ev.payload = make_fill(id, "A", Action::BUY, Side::YES, 50, 1, post);
+    mm.handle_feed_event(ev, stage.apply(ev));
+    // The engine would idle between fills; the checkpoint and journal
+    // threads catch up meanwhile.
+    const auto deadline =
+        std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    do {
+      mm.on_idle();
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    } while (journal->size() - journal->first() >= journal->capacity() / 2 &&
+             std::chrono::steady_clock::now() < deadline);
+  };
+  fill("T1", 1);
+  fill("T1", 1); // redelivered after a reconnect
+  EXPECT_EQ(mm.positions().get_ledger("A")->yes_position(), 1);
+  EXPECT_EQ(journal->size(), 1u);
+
+  // Every idle pass checkpoints; once one is on disk and the journal is
+  // half full, the flusher compacts it, so it never fills up.
+  for (int i = 2; i <= 10; ++i) {
+    fill("T" + std::to_string(i), i);
+  }
+  EXPECT_EQ(mm.positions().get_ledger("A")->yes_position(), 10);
+  EXPECT_EQ(journal->size(), 10u);
+  EXPECT_GT(journal->first(), 0u);
+  cp->stop();
+  journal->stop();
+
+  // What restore() and replay() rebuild after a crash matches.
+  PositionManager pm(Exchange::KALSHI, {"A"});
+  KalshiOrderBookManager books;
+  ASSERT_TRUE(cp->restore(pm, books));
+  journal->replay(pm, cp->journal_records());
+  EXPECT_EQ(pm.get_ledger("A")->yes_position(), 10);
+  std::remove(ckpt.c_str());
+}
@@ -0,0 +1,126 @@
+#include <gtest/gtest.h>
+
+#include "protocols/kalshi/kalshi_commands.hpp"
+#include "utils/alloc_audit.hpp"
+
+#include <array>
+
+using nlohmann::json;
+
+namespace {
+
+// The tree the subscription manager used to build for each command.
+json subscribe_json(std::int64_t id, const std::string &channel,
+                    const json &extra, const std::vector<std::string> *t) {
+  json params = extra.is_object() ? extra : json::object();
+  params["channels"] = json::array({channel});
+  if (t)
+    params["market_tickers"] = *t;
+  return {{"id", id}, {"cmd", "subscribe"}, {"params", params}};
+}
+
+const std::vector<std::string> kAwkward = {
+    "KXNBA-26-CHI", "quote\"back\\slash", "ctl\b\f\n\r\t\x01\x1f\x7f",
+    "caf\xc3\xa9 \xe2\x82\xac", ""};
+
+} // namespace
+
+TEST(KalshiCommandsTest, StringsMatchDump) {
+  for (const auto &s : kAwkward) {
+    std::string out;
+    append_json_string(out, s);
+    EXPECT_EQ(out, json(s).dump());
+  }
+  std::string out;
+  append_json_int(out, std::int64_t{-9223372036854775807 - 1});
+  EXPECT_EQ(out, json(std::int64_t{-9223372036854775807 - 1}).dump());
+}
+
+TEST(KalshiCommandsTest, SubscriptionCommandsMatchJson) {
+  std::string out;
+  encode_subscribe(out, 7, "orderbook_delta", {}, &kAwkward);
+  EXPECT_EQ(out,
+            subscribe_json(7, "orderbook_delta", json::object(), &kAwkward)
+                .dump());
+
+  // Extra params sort around the fixed members and lose to them on a clash.
+  const json extra = {{"a", 1},
+                      {"channels", "x"},
+                      {"m", {{"nested", {1, 2}}}},
+                      {"market_tickers", "y"},
+                      {"zz", "\"q\""}};
+  encode_subscribe(out, 8, "fill", json_fragments(extra), &kAwkward);
+  EXPECT_EQ(out, subscribe_json(8, "fill", extra, &kAwkward).dump());
+  encode_subscribe(out, 9, "fill", json_fragments(extra));
+  EXPECT_EQ(out, subscribe_json(9, "fill", extra, nullptr).dump());
+  encode_subscribe(out, 10, "fill", json_fragments(json()));
+  EXPECT_EQ(out, subscribe_json(10, "fill", json(), nullptr).dump());
+
+  for (bool add : {true, false}) {
+    encode_update_subscription(out, 11, 42, add, kAwkward);
+    json j = {{"id", 11},
+              {"cmd", "update_subscription"},
+              {"params",
+               {{"sids", {42}},
+                {"market_tickers", kAwkward},
+                {"action", add ? "add_markets" : "delete_markets"}}}};
+    EXPECT_EQ(out, j.dump());
+  }
+
+  encode_unsubscribe(out, 12, 43);
+  json unsub = {
+      {"id", 12}, {"cmd", "unsubscribe"}, {"params", {{"sids", {43}}}}};
+  EXPECT_EQ(out, unsub.dump());
+}
+
+TEST(KalshiCommandsTest, OrderPayloadsMatchJson) {
+  for (Side side : {Side::YES, Side::NO}) {
+    OrderPayload o{"KXNBA-26-\"CHI\"", "00010000000000ff", side, 37, 5};
+    const char *price_key = side == Side::YES ? "yes_price" : "no_price";
+    const char *side_name = side == Side::YES ? "yes" : "no";
+
+    std::string out;
+    encode_create_order(out, o);
+    json create = {{"ticker", o.ticker},
+                   {"client_order_id", o.client_order_id},
+                   {"side", side_name},
+                   {"action", "buy"},
+                   {"type", "limit"},
+                   {"count", o.count},
+                   {price_key, o.price}};
+    EXPECT_EQ(out, create.dump());
+
+    encode_amend_order(out, o, "0001000000000100");
+    json amend = {{"ticker", o.ticker},
+                  {"client_order_id", o.client_order_id},
+                  {"updated_client_order_id", "0001000000000100"},
+                  {"side", side_name},
+                  {"action", "buy"},
+                  {"count", o.count},
+                  {price_key, o.price}};
+    EXPECT_EQ(out, amend.dump());
+  }
+
+  std::string out;
+  const std::array<std::string_view, 2> ids = {"ord-1", "ord-2"};
+  encode_batch_cancel(out, ids);
+  EXPECT_EQ(out, json({{"ids", {"ord-1", "ord-2"}}}).dump());
+}
+
+TEST(KalshiCommandsTest, ReusedBufferDoesNotAllocate) {
+  if (!alloc_audit::kEnabled)
+    GTEST_SKIP() << "built without KALSHI_ALLOC_AUDIT";
+  const std::vector<std::string> tickers = {"KXNBA-26-CHI", "KXNBA-26-BOS"};
+  OrderPayload o{"KXNBA-26-CHI", "00010000000000ff", Side::YES, 37, 5};
+  std::string out;
+  out.reserve(256);
+
+  alloc_audit::AllocationScope scope;
+  for (int i = 0; i < 100; ++i) {
+    encode_update_subscription(out, i, 3, true, tickers);
+    encode_subscribe(out, i, "orderbook_delta", {}, &tickers);
+    encode_create_order(out, o);
+    encode_amend_order(out, o, "0001000000000100");
+  }
+  EXPECT_EQ(scope.allocations(), 0u);
+}
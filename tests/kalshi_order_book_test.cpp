@@ -0,0 +1,89 @@
+#include <gtest/gtest.h>
+
+#include "protocols/kalshi/kalshi_order_book.hpp"
+
+namespace {
+
+KalshiOrderBook book_with(int yes_price, int yes_size,
+                          QueueModel model = QueueModel::Pessimistic) {
+  KalshiOrderBook kb("A");
+  kb.queue_model = model;
+  kb.apply_snapshot(SnapshotEvent{{{yes_price, yes_size}}, {{40, 5}}, 1});
+  return kb;
+}
+
+DeltaEvent delta(std::int64_t seq, int price, int contracts,
+                 Side side = Side::YES) {
+  return DeltaEvent{side, price, contracts, seq};
+}
+
+} // namespace
+
+TEST(KalshiOrderBookQueue, PessimisticWaitsForLevelToShrinkPastUs) {
+  KalshiOrderBook kb = book_with(45, 10);
+  kb.track_order(7, Side::YES, 45, 2);
+  EXPECT_EQ(kb.queue_ahead(7), 10);
+
+  kb.apply_delta(delta(2, 45, 2));  // our order lands: 12
+  kb.apply_delta(delta(3, 45, -1)); // could be from behind us
+  EXPECT_EQ(kb.queue_ahead(7), 9);
+  kb.apply_delta(delta(4, 45, 5));  // joins behind
+  kb.apply_delta(delta(5, 45, -4)); // 12 left: still could be behind
+  EXPECT_EQ(kb.queue_ahead(7), 9);
+  kb.apply_delta(delta(6, 45, -8)); // 4 left, 2 of them ours
+  EXPECT_EQ(kb.queue_ahead(7), 2);
+}
+
+TEST(KalshiOrderBookQueue, OptimisticCountsEveryDecrease) {
+  KalshiOrderBook kb = book_with(45, 10, QueueModel::Optimistic);
+  kb.track_order(7, Side::YES, 45, 2); // assumed already in the 10
+  EXPECT_EQ(kb.queue_ahead(7), 8);
+  kb.apply_delta(delta(2, 45, -3));
+  EXPECT_EQ(kb.queue_ahead(7), 5);
+  kb.apply_delta(delta(3, 45, 4));
+  EXPECT_EQ(kb.queue_ahead(7), 5);
+  kb.apply_delta(delta(4, 45, -6));
+  EXPECT_EQ(kb.queue_ahead(7), 0);
+}
+
+TEST(KalshiOrderBookQueue, OtherLevelsAndSidesUntouched) {
+  KalshiOrderBook kb = book_with(45, 10, QueueModel::Optimistic);
+  kb.apply_delta(delta(2, 44, 6));
+  kb.track_order(1, Side::YES, 45, 1);
+  kb.track_order(2, Side::NO, 40, 1);
+  kb.apply_delta(delta(3, 44, -6));
+  kb.apply_delta(delta(4, 45, -2, Side::NO));
+  EXPECT_EQ(kb.queue_ahead(1), 9);
+  EXPECT_EQ(kb.queue_ahead(2), 4);
+}
+
+TEST(KalshiOrderBookQueue, FillsCancelsAndSnapshots) {
+  KalshiOrderBook kb = book_with(45, 10);
+  kb.track_order(1, Side::YES, 45, 3);
+  kb.track_order(2, Side::YES, 45, 1);
+  EXPECT_EQ(kb.tracked_orders(), 2u);
+
+  kb.on_order_fill(1, 1);
+  EXPECT_EQ(kb.queue_ahead(1), 0);
+  kb.on_order_fill(1, 2);
+  EXPECT_FALSE(kb.queue_ahead(1).has_value());
+
+  kb.apply_snapshot(SnapshotEvent{{{45, 4}}, {{40, 5}}, 9});
+  EXPECT_EQ(kb.queue_ahead(2), 3);
+  kb.untrack_order(2);
+  EXPECT_EQ(kb.tracked_orders(), 0u);
+  EXPECT_FALSE(kb.queue_ahead(2).has_value());
+}
+
+TEST(KalshiOrderBookTrades, StatsFoldEachPrint) {
+  KalshiOrderBook kb("A");
+  EXPECT_EQ(kb.trades.vwap(), 0.0);
+  kb.trades.on_trade(TradeEvent{40, 10, Side::YES, 1});
+  kb.trades.on_trade(TradeEvent{50, 30, Side::NO, 2});
+  EXPECT_EQ(kb.trades.last_price, 50);
+  EXPECT_EQ(kb.trades.last_taker, Side::NO);
+  EXPECT_EQ(kb.trades.trades, 2);
+  EXPECT_EQ(kb.trades.volume, 40);
+  EXPECT_DOUBLE_EQ(kb.trades.vwap(), 47.5);
+  EXPECT_DOUBLE_EQ(kb.trades.taker_imbalance(), -0.5);
+}
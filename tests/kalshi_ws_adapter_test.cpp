@@ -0,0 +1,83 @@
+#include <gtest/gtest.h>
+
+#include "infra/book_stage.hpp"
+#include "protocols/kalshi/kalshi_ws_adapter.hpp"
+
+TEST(KalshiWsAdapterTest, ParsesTrade) {
+  KalshiWsAdapter a;
+  auto ev = a.parse(R"({"type":"trade","sid":11,"msg":{
+      "trade_id":"d91bc706","market_ticker":"EV-A","yes_price":36,
+      "no_price":64,"count":136,"taker_side":"no","ts":1669149841}})");
+  ASSERT_TRUE(ev.has_value());
+  EXPECT_EQ(ev->type, FeedEvent::Type::Trade);
+  EXPECT_EQ(ev->ticker, "EV-A");
+  const auto &t = std::get<TradeEvent>(ev->payload);
+  EXPECT_EQ(t.yes_price, 36);
+  EXPECT_EQ(t.count, 136);
+  EXPECT_EQ(t.taker_side, Side::NO);
+  EXPECT_EQ(t.ts, 1669149841);
+}
+
+TEST(KalshiWsAdapterTest, ParsesTicker) {
+  KalshiWsAdapter a;
+  auto ev = a.parse(R"({"type":"ticker","sid":12,"msg":{
+      "market_ticker":"EV-A","price":48,"yes_bid":45,"yes_ask":53,
+      "volume":33896,"open_interest":20422,"dollar_volume":16948,
+      "ts":1669149841}})");
+  ASSERT_TRUE(ev.has_value());
+  EXPECT_EQ(ev->type, FeedEvent::Type::Ticker);
+  const auto &t = std::get<TickerEvent>(ev->payload);
+  EXPECT_EQ(t.price, 48);
+  EXPECT_EQ(t.yes_bid, 45);
+  EXPECT_EQ(t.yes_ask, 53);
+  EXPECT_EQ(t.volume, 33896);
+  EXPECT_EQ(t.open_interest, 20422);
+}
+
+TEST(KalshiWsAdapterTest, TradeWithoutRequiredFieldsIgnored) {
+  KalshiWsAdapter a;
+  EXPECT_FALSE(
+      a.parse(R"({"type":"trade","sid":11,"msg":{"market_ticker":"A"}})"));
+}
+
+TEST(KalshiWsAdapterTest, CarriesExchangeTimestampInNanoseconds) {
+  KalshiWsAdapter a;
+  constexpr std::int64_t kSec = 1669149841;
+  auto trade = a.parse(R"({"type":"trade","sid":11,"msg":{
+      "market_ticker":"EV-A","yes_price":36,"count":1,"ts":1669149841}})");
+  ASSERT_TRUE(trade.has_value());
+  EXPECT_EQ(trade->exchange_ts_ns, kSec * 1'000'000'000);
+  EXPECT_EQ(trade->recv_ts_ns, 0);
+
+  auto delta = a.parse(R"({"type":"orderbook_delta","sid":2,"seq":3,"msg":{
+      "market_ticker":"EV-A","price":40,"delta":-5,"side":"yes",
+      "ts":"2022-11-22T20:44:01.25Z"}})");
+  ASSERT_TRUE(delta.has_value());
+  EXPECT_EQ(delta->exchange_ts_ns, kSec * 1'000'000'000 + 250'000'000);
+
+  auto ms = a.parse(R"({"type":"ticker","sid":12,"msg":{
+      "market_ticker":"EV-A","ts":1669149841500}})");
+  ASSERT_TRUE(ms.has_value());
+  EXPECT_EQ(ms->exchange_ts_ns, kSec * 1'000'000'000 + 500'000'000);
+
+  auto none = a.parse(R"({"type":"orderbook_snapshot","sid":2,"seq":1,
+      "msg":{"market_ticker":"EV-A","yes":[[40,5]]}})");
+  ASSERT_TRUE(none.has_value());
+  EXPECT_EQ(none->exchange_ts_ns, 0);
+}
+
+TEST(KalshiWsAdapterTest, BookStageKeepsTradeStatsNextToBook) {
+  KalshiWsAdapter a;
+  BookStage stage;
+  auto snap = a.parse(R"({"type":"orderbook_snapshot","sid":1,"seq":1,
+      "msg":{"market_ticker":"EV-A","yes":[[45,10]],"no":[[50,10]]}})");
+  auto trade = a.parse(R"({"type":"trade","sid":2,"msg":{
+      "market_ticker":"EV-A","yes_price":47,"count":5,"taker_side":"yes"}})");
+  ASSERT_TRUE(snap && trade);
+  stage.apply(*snap);
+  const KalshiOrderBook *kb = stage.apply(*trade);
+  ASSERT_NE(kb, nullptr);
+  EXPECT_TRUE(kb->has_snapshot); // the trade channel sid does not reset it
+  EXPECT_EQ(kb->trades.volume, 5);
+  EXPECT_EQ(kb->trades.last_price, 47);
+}
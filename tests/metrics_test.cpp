@@ -0,0 +1,105 @@
+#include <gtest/gtest.h>
+
+#include "infra/metrics.hpp"
+#include <condition_variable>
+#include <thread>
+#include <vector>
+
+static std::uint64_t counter_value(Counter c) {
+  return Metrics::instance().collect().counters[static_cast<std::size_t>(c)];
+}
+
+TEST(MetricsTest, CountersAggregateAcrossThreads) {
+  const std::uint64_t before = counter_value(Counter::WsMessages);
+
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 4; ++t) {
+    threads.emplace_back([] {
+      for (int i = 0; i < 1000; ++i) {
+        metric_inc(Counter::WsMessages);
+      }
+    });
+  }
+  for (auto &th : threads) {
+    th.join();
+  }
+
+  // Exited threads hand their shards back but keep their counts.
+  EXPECT_EQ(counter_value(Counter::WsMessages), before + 4000);
+}
+
+TEST(MetricsTest, ShardsAreReusedByLaterThreads) {
+  // Far more short-lived threads than shards; no increment may be lost.
+  for (std::size_t i = 0; i < Metrics::kMaxShards * 2; ++i) {
+    std::thread([] { metric_inc(Counter::WsReconnects); }).join();
+  }
+  std::thread([] {
+    EXPECT_NE(&metrics_shard(), nullptr);
+    metric_inc(Counter::WsReconnects);
+  }).join();
+  EXPECT_GE(counter_value(Counter::WsReconnects),
+            Metrics::kMaxShards * 2 + 1);
+}
+
+TEST(MetricsTest, GaugesKeepTheLastValueAnyThreadWrote) {
+  // Two receive threads that both raised the high water must not add up.
+  std::thread([] { metric_set(Gauge::EngineQueueHighWater, 42); }).join();
+  std::thread([] { metric_set(Gauge::EngineQueueHighWater, 40); }).join();
+  EXPECT_EQ(Metrics::instance().collect().gauges[static_cast<std::size_t>(
+                Gauge::EngineQueueHighWater)],
+            40);
+}
+
+TEST(MetricsTest, SharedOverflowShardLosesNoIncrements) {
+  // Hold every shard so the workers below all land on the overflow one.
+  std::vector<std::thread> holders;
+  std::mutex m;
+  std::condition_variable cv;
+  bool release = false;
+  std::atomic<std::size_t> held{0};
+  for (std::size_t i = 0; i < Metrics::kMaxShards; ++i) {
+    holders.emplace_back([&] {
+      metric_inc(Counter::RecorderSamples, 0);
+      ++held;
+      std::unique_lock<std::mutex> lock(m);
+      cv.wait(lock, [&] { return release; });
+    });
+  }
+  while (held.load() < Metrics::kMaxShards)
+    std::this_thread::yield();
+
+  const std::uint64_t before = counter_value(Counter::RecorderSamples);
+  std::vector<std::thread> workers;
+  for (int t = 0; t < 4; ++t) {
+    workers.emplace_back([] {
+      EXPECT_TRUE(metrics_shard().shared);
+      for (int i = 0; i < 10000; ++i)
+        metric_inc(Counter::RecorderSamples);
+    });
+  }
+  for (auto &th : workers)
+    th.join();
+  EXPECT_EQ(counter_value(Counter::RecorderSamples), before + 40000);
+
+  {
+    std::lock_guard<std::mutex> lock(m);
+    release = true;
+  }
+  cv.notify_all();
+  for (auto &th : holders)
+    th.join();
+}
+
+TEST(MetricsTest, RendersPrometheusText) {
+  metric_inc(Counter::BookGapNeedsResync, 3);
+  const std::string text = Metrics::instance().render_prometheus();
+
+  EXPECT_NE(text.find("# TYPE kalshi_book_gap_resync_total counter"),
+            std::string::npos);
+  EXPECT_NE(text.find("# TYPE kalshi_engine_queue_depth gauge"),
+            std::string::npos);
+  EXPECT_NE(text.find("kalshi_book_gap_resync_total " +
+                      std::to_string(counter_value(
+                          Counter::BookGapNeedsResync))),
+            std::string::npos);
+}
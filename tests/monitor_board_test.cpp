@@ -0,0 +1,99 @@
+#include <gtest/gtest.h>
+
+#include "infra/monitor_board.hpp"
+
+#include <atomic>
+#include <string>
+#include <thread>
+
+namespace {
+
+OrderBook make_book(std::string ticker,
+                    std::vector<std::pair<int, int>> yes,
+                    std::vector<std::pair<int, int>> no) {
+  OrderBook b(ticker);
+  b.set_snapshot(yes, no);
+  return b;
+}
+
+} // namespace
+
+TEST(MonitorBoardTest, KeepsLatestStatePerMarket) {
+  MonitorBoard board(8, 2);
+  EXPECT_EQ(board.size(), 0u);
+
+  ASSERT_TRUE(board.update_book(
+      "A", make_book("A", {{40, 10}, {39, 5}, {38, 1}}, {{55, 20}})));
+  ASSERT_TRUE(board.update_quote("A", Quote{41, 44}, Quote{56, 59}));
+  TickerSnapshotPnL pnl;
+  pnl.yes_pos = 3;
+  pnl.equity_cents = -12;
+  ASSERT_TRUE(board.update_pnl("A", pnl));
+  ASSERT_TRUE(board.update_book("B", make_book("B", {{20, 1}}, {})));
+  ASSERT_EQ(board.size(), 2u);
+
+  MarketView v{};
+  const std::uint64_t version = board.read(0, v);
+  EXPECT_EQ(version, board.version(0));
+  EXPECT_EQ(version % 2, 0u);
+  EXPECT_STREQ(v.ticker, "A");
+  EXPECT_EQ(v.depth, 2u);
+  EXPECT_EQ(v.yes[0].price, 40);
+  EXPECT_EQ(v.yes[1].size, 5);
+  EXPECT_EQ(v.yes[2].price, 0); // beyond the configured depth
+  EXPECT_EQ(v.yes_quote.bid, 41);
+  EXPECT_EQ(v.pnl.yes_pos, 3);
+
+  const nlohmann::json j = market_view_json(v);
+  EXPECT_EQ(j["ticker"], "A");
+  EXPECT_EQ(j["yes_bid"], 40);
+  EXPECT_EQ(j["yes_ask"], 45);
+  EXPECT_EQ(j["yes_ask_size"], 20);
+  EXPECT_EQ(j["depth"]["yes"].size(), 2u);
+  EXPECT_EQ(j["depth"]["no"].size(), 1u);
+  EXPECT_EQ(j["quote"]["no"]["ask"], 59);
+  EXPECT_EQ(j["pnl"]["equity_cents"], -12);
+
+  board.read(1, v);
+  const nlohmann::json b = market_view_json(v);
+  EXPECT_EQ(b["yes_ask"], 0);
+  EXPECT_FALSE(b.contains("quote"));
+  EXPECT_FALSE(b.contains("pnl"));
+
+  // Only an update moves the version.
+  const std::uint64_t before = board.version(1);
+  EXPECT_EQ(board.version(1), before);
+  board.update_quote("B", Quote{19, 22}, Quote{0, 0});
+  EXPECT_GT(board.version(1), before);
+}
+
+TEST(MonitorBoardTest, RefusesMarketsPastCapacity) {
+  MonitorBoard board(1);
+  EXPECT_TRUE(board.update_quote("A", Quote{1, 2}, Quote{3, 4}));
+  EXPECT_FALSE(board.update_quote("B", Quote{1, 2}, Quote{3, 4}));
+  EXPECT_TRUE(board.update_quote("A", Quote{5, 6}, Quote{7, 8}));
+  EXPECT_EQ(board.size(), 1u);
+}
+
+TEST(MonitorBoardTest, ReadersNeverSeeTornWrites) {
+  MonitorBoard board(1);
+  board.update_quote("A", Quote{0, 0}, Quote{0, 0});
+
+  std::atomic<bool> done{false};
+  std::atomic<int> torn{0};
+  std::thread reader([&] {
+    MarketView v{};
+    while (!done.load(std::memory_order_acquire)) {
+      board.read(0, v);
+      if (v.yes_quote.bid != v.yes_quote.ask ||
+          v.yes_quote.bid != v.no_quote.bid ||
+          v.yes_quote.bid != v.no_quote.ask)
+        torn.fetch_add(1);
+    }
+  });
+  for (int i = 1; i <= 200000; ++i)
+    board.update_quote("A", Quote{i, i}, Quote{i, i});
+  done.store(true, std::memory_order_release);
+  reader.join();
+  EXPECT_EQ(torn.load(), 0);
+}
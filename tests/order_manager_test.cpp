@@ -0,0 +1,170 @@
+#include <gtest/gtest.h>
+
+#include "strategy/orders/order_manager.hpp"
+
+#include <random>
+#include <unordered_map>
+
+TEST(OrderManagerTest, ClientIdRoundTrips) {
+  char buf[kClientOrderIdChars];
+  format_client_order_id(0x00ab'0000'0000'002full, buf);
+  const std::string_view s(buf, sizeof(buf));
+  EXPECT_EQ(s, "00ab00000000002f");
+  EXPECT_EQ(parse_client_order_id(s), 0x00ab'0000'0000'002full);
+  EXPECT_EQ(parse_client_order_id("00AB00000000002F"),
+            0x00ab'0000'0000'002full);
+  EXPECT_FALSE(parse_client_order_id("abc").has_value());
+  EXPECT_FALSE(parse_client_order_id("00ab00000000002g").has_value());
+}
+
+TEST(OrderManagerTest, FullLifecycle) {
+  OrderManager oms(8, 3);
+  const auto m = oms.add_market("A");
+  EXPECT_EQ(oms.add_market("A"), m);
+
+  auto id = oms.submit(m, Side::YES, 45, 5, 100);
+  ASSERT_TRUE(id.has_value());
+  EXPECT_EQ(*id >> 48, 3u);
+  EXPECT_EQ(oms.find(*id)->state, OrderState::PendingNew);
+  EXPECT_FALSE(oms.request_cancel(*id)); // nothing to cancel yet
+
+  EXPECT_TRUE(oms.on_ack(*id, "ex-1"));
+  EXPECT_STREQ(oms.find(*id)->exchange_id.data(), "ex-1");
+  EXPECT_FALSE(oms.on_ack(*id, "ex-1"));
+
+  EXPECT_TRUE(oms.on_fill(*id, 2));
+  EXPECT_EQ(oms.find(*id)->state, OrderState::PartiallyFilled);
+  EXPECT_TRUE(oms.request_cancel(*id));
+  EXPECT_TRUE(oms.on_cancel_reject(*id));
+  EXPECT_EQ(oms.find(*id)->state, OrderState::PartiallyFilled);
+
+  Order last;
+  EXPECT_TRUE(oms.on_fill(*id, 3, &last));
+  EXPECT_EQ(last.state, OrderState::Filled);
+  EXPECT_EQ(last.filled, 5);
+  EXPECT_EQ(oms.find(*id), nullptr);
+  EXPECT_EQ(oms.live_orders(), 0u);
+  EXPECT_FALSE(oms.on_fill(*id, 1));
+}
+
+TEST(OrderManagerTest, CancelRejectAndEarlyFill) {
+  OrderManager oms(8);
+  const auto m = oms.add_market("A");
+
+  auto a = *oms.submit(m, Side::NO, 40, 2, 0);
+  oms.on_ack(a, "x");
+  Order last;
+  EXPECT_TRUE(oms.request_cancel(a));
+  EXPECT_TRUE(oms.on_cancel(a, &last));
+  EXPECT_EQ(last.state, OrderState::Cancelled);
+  EXPECT_EQ(oms.find(a), nullptr);
+
+  auto b = *oms.submit(m, Side::NO, 40, 2, 0);
+  EXPECT_TRUE(oms.on_reject(b, &last));
+  EXPECT_EQ(last.state, OrderState::Rejected);
+
+  // The fill arrives before the ack.
+  auto c = *oms.submit(m, Side::YES, 50, 3, 0);
+  FillEvent f{};
+  f.count = 1;
+  char buf[kClientOrderIdChars];
+  format_client_order_id(c, buf);
+  f.client_order_id = std::string(buf, sizeof(buf));
+  EXPECT_TRUE(oms.on_fill(f));
+  EXPECT_EQ(oms.find(c)->state, OrderState::PartiallyFilled);
+  f.client_order_id.reset();
+  EXPECT_FALSE(oms.on_fill(f));
+}
+
+TEST(OrderManagerTest, AckAfterFillStoresExchangeId) {
+  OrderManager oms(8);
+  const auto m = oms.add_market("A");
+
+  auto a = *oms.submit(m, Side::YES, 50, 3, 0);
+  EXPECT_TRUE(oms.on_fill(a, 1));
+  EXPECT_TRUE(oms.on_ack(a, "ex-a"));
+  EXPECT_EQ(oms.find(a)->state, OrderState::PartiallyFilled);
+  EXPECT_STREQ(oms.find(a)->exchange_id.data(), "ex-a");
+  EXPECT_FALSE(oms.on_ack(a, "ex-a"));
+
+  // Cancelled on the strength of the fill, then acked.
+  auto b = *oms.submit(m, Side::NO, 40, 3, 0);
+  EXPECT_TRUE(oms.on_fill(b, 2));
+  EXPECT_TRUE(oms.request_cancel(b));
+  EXPECT_TRUE(oms.on_ack(b, "ex-b"));
+  EXPECT_EQ(oms.find(b)->state, OrderState::PendingCancel);
+  EXPECT_STREQ(oms.find(b)->exchange_id.data(), "ex-b");
+
+}
+
+TEST(OrderManagerTest, CompleteFillBeforeAckKeepsTheOrderForTheAck) {
+  OrderManager oms(8);
+  const auto m = oms.add_market("A");
+  auto c = *oms.submit(m, Side::NO, 40, 2, 0);
+  EXPECT_TRUE(oms.on_fill(c, 2));
+  ASSERT_NE(oms.find(c), nullptr);
+  EXPECT_EQ(oms.find(c)->state, OrderState::Filled);
+  EXPECT_FALSE(oms.on_fill(c, 1));
+  EXPECT_FALSE(oms.on_cancel(c));
+
+  Order last;
+  EXPECT_TRUE(oms.on_ack(c, "ex-c", &last));
+  EXPECT_EQ(last.state, OrderState::Filled);
+  EXPECT_EQ(last.filled, 2);
+  EXPECT_STREQ(last.exchange_id.data(), "ex-c");
+  EXPECT_EQ(oms.find(c), nullptr);
+  EXPECT_EQ(oms.live_orders(), 0u);
+  EXPECT_FALSE(oms.on_ack(c, "ex-c"));
+
+  // Acked first, the fill retires it at once.
+  auto d = *oms.submit(m, Side::NO, 40, 1, 0);
+  EXPECT_TRUE(oms.on_ack(d, "ex-d"));
+  EXPECT_TRUE(oms.on_fill(d, 1));
+  EXPECT_EQ(oms.find(d), nullptr);
+}
+
+TEST(OrderManagerTest, RefusesPastCapacity) {
+  OrderManager oms(4);
+  for (int i = 0; i < 4; ++i) {
+    EXPECT_TRUE(oms.submit(0, Side::YES, 50, 1, 0).has_value());
+  }
+  EXPECT_FALSE(oms.submit(0, Side::YES, 50, 1, 0).has_value());
+}
+
+TEST(OrderManagerTest, ChurnMatchesReference) {
+  OrderManager oms(64);
+  std::unordered_map<ClientOrderId, int> ref; // id -> remaining
+  std::vector<ClientOrderId> ids;
+  std::mt19937 rng(7);
+
+  for (int step = 0; step < 20'000; ++step) {
+    const bool add = ids.empty() || (ids.size() < 64 && rng() % 2 == 0);
+    if (add) {
+      auto id = oms.submit(0, Side::YES, 50, 1 + rng() % 3, step);
+      ASSERT_TRUE(id.has_value());
+      ASSERT_TRUE(oms.on_ack(*id, "x"));
+      ref[*id] = oms.find(*id)->count;
+      ids.push_back(*id);
+      continue;
+    }
+    const std::size_t k = rng() % ids.size();
+    const ClientOrderId id = ids[k];
+    if (rng() % 2 == 0) {
+      ASSERT_TRUE(oms.on_fill(id, 1));
+      if (--ref[id] > 0)
+        continue;
+    } else {
+      ASSERT_TRUE(oms.on_cancel(id));
+    }
+    ref.erase(id);
+    ids[k] = ids.back();
+    ids.pop_back();
+
+    ASSERT_EQ(oms.live_orders(), ref.size());
+    for (const auto &[live_id, remaining] : ref) {
+      const Order *o = oms.find(live_id);
+      ASSERT_NE(o, nullptr);
+      ASSERT_EQ(o->count - o->filled, remaining);
+    }
+  }
+}
@@ -0,0 +1,122 @@
+#include <gtest/gtest.h>
+
+#include "protocols/kalshi/kalshi_tickers.hpp"
+#include "strategy/positions/position_manager.hpp"
+#include "strategy/risk_gate.hpp"
+
+namespace {
+
+FillEvent fill(const std::string &ticker, Action action, Side side,
+               int yes_price, int count, int post_position) {
+  FillEvent f{};
+  f.trade_id = "T";
+  f.order_id = "O";
+  f.market_ticker = ticker;
+  f.side = side;
+  f.purchased_side = side;
+  f.action = action;
+  f.yes_price = yes_price;
+  f.count = count;
+  f.post_position = post_position;
+  return f;
+}
+
+// The O(markets) scan the aggregator replaces.
+PortfolioTotals scan(const PositionManager &pm) {
+  PortfolioTotals t;
+  pm.for_each_ledger([&](const TickerPositionLedger &l) {
+    const auto s = l.snapshot();
+    t.cash_cents += s.cash_cents;
+    t.realized_pnl_cents += s.realized_pnl_cents;
+    t.unrealized_pnl_cents += s.unrealized_pnl_cents;
+    t.equity_cents += s.equity_cents;
+    t.gross_contracts += std::abs(s.yes_pos) + std::abs(s.no_pos);
+    t.net_contracts += s.yes_pos - s.no_pos;
+  });
+  return t;
+}
+
+} // namespace
+
+TEST(PortfolioAggregatorTest, EventTickerIsPrefixBeforeLastDash) {
+  EXPECT_EQ(event_ticker("KXNBAPLAYOFF-26-CHI"), "KXNBAPLAYOFF-26");
+  EXPECT_EQ(event_ticker("INXD-24JAN15-B4800"), "INXD-24JAN15");
+  EXPECT_EQ(event_ticker("NODASH"), "NODASH");
+}
+
+TEST(PortfolioAggregatorTest, RunningTotalsMatchFullScan) {
+  PositionManager pm(Exchange::KALSHI, {"EVA-26-X", "EVA-26-Y", "EVB-26-Z"});
+
+  pm.on_fill(fill("EVA-26-X", Action::BUY, Side::YES, 40, 10, 10));
+  pm.set_marks("EVA-26-X", 45, 55);
+  pm.on_fill(fill("EVA-26-Y", Action::BUY, Side::NO, 70, 4, -4));
+  pm.set_marks("EVA-26-Y", 65, 35);
+  pm.on_fill(fill("EVB-26-Z", Action::BUY, Side::YES, 20, 5, 5));
+  pm.on_fill(fill("EVA-26-X", Action::SELL, Side::YES, 50, 6, 4));
+  pm.set_marks("EVA-26-X", 48, 52);
+  pm.set_marks("EVB-26-Z", 10, 90);
+
+  const PortfolioTotals expect = scan(pm);
+  const PortfolioTotals &got = pm.portfolio().totals();
+  EXPECT_EQ(got.cash_cents, expect.cash_cents);
+  EXPECT_EQ(got.realized_pnl_cents, expect.realized_pnl_cents);
+  EXPECT_EQ(got.unrealized_pnl_cents, expect.unrealized_pnl_cents);
+  EXPECT_EQ(got.equity_cents, expect.equity_cents);
+  EXPECT_EQ(got.gross_contracts, expect.gross_contracts);
+  EXPECT_EQ(got.net_contracts, expect.net_contracts);
+  EXPECT_EQ(got.gross_contracts, 4 + 4 + 5);
+  EXPECT_EQ(got.net_contracts, 4 - 4 + 5);
+  EXPECT_EQ(got.pnl_cents,
+            expect.realized_pnl_cents + expect.unrealized_pnl_cents);
+}
+
+TEST(PortfolioAggregatorTest, ExposureIsGroupedByEvent) {
+  PositionManager pm(Exchange::KALSHI, {"EVA-26-X", "EVA-26-Y", "EVB-26-Z"});
+  pm.on_fill(fill("EVA-26-X", Action::BUY, Side::YES, 40, 10, 10));
+  pm.on_fill(fill("EVA-26-Y", Action::BUY, Side::NO, 70, 4, -4));
+  pm.on_fill(fill("EVB-26-Z", Action::BUY, Side::YES, 20, 5, 5));
+
+  // Unmarked positions count at cost.
+  EXPECT_EQ(pm.portfolio().event_exposure_cents("EVA-26"), 400 + 4 * 30);
+  EXPECT_EQ(pm.portfolio().event_exposure_cents("EVB-26"), 100);
+
+  // Marked positions count at the mark.
+  pm.set_marks("EVA-26-X", 50, 50);
+  EXPECT_EQ(pm.portfolio().event_exposure_cents("EVA-26"), 500 + 4 * 30);
+  EXPECT_EQ(pm.portfolio().event_exposure_cents("NOPE"), 0);
+
+  int events = 0;
+  pm.portfolio().for_each_event([&](const std::string &, long long) {
+    ++events;
+  });
+  EXPECT_EQ(events, 2);
+}
+
+TEST(PortfolioAggregatorTest, RestoredLedgersAreCounted) {
+  PositionManager pm(Exchange::KALSHI, {});
+  LedgerState s;
+  s.yes_pos = 3;
+  s.vwap_yes_cents = 60;
+  s.cash_cents = -180;
+  pm.restore_ledger("EVC-26-Q", s);
+  EXPECT_EQ(pm.portfolio().totals().gross_contracts, 3);
+  EXPECT_EQ(pm.portfolio().totals().open_cost_cents, 180);
+  EXPECT_EQ(pm.portfolio().totals().cash_cents, -180);
+}
+
+TEST(PortfolioAggregatorTest, RiskGateLossLimitReadsPortfolioPnl) {
+  PositionManager pm(Exchange::KALSHI, {"EVA-26-X"});
+  PortfolioLimits limits;
+  limits.max_loss_cents = 100;
+  RiskGate gate(MarketLimits{}, limits);
+  gate.set_portfolio(&pm.portfolio());
+  const auto i = gate.add_market("EVA-26-X");
+
+  pm.on_fill(fill("EVA-26-X", Action::BUY, Side::YES, 50, 10, 10));
+  pm.set_marks("EVA-26-X", 45, 55);
+  EXPECT_EQ(gate.check(i, Side::YES, 45, 1, 45, 0, false), RiskCheck::Ok);
+
+  pm.set_marks("EVA-26-X", 39, 61);
+  EXPECT_EQ(gate.check(i, Side::YES, 39, 1, 39, 0, false),
+            RiskCheck::PortfolioLoss);
+}
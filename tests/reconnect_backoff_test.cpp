@@ -0,0 +1,39 @@
+#include <gtest/gtest.h>
+
+#include "infra/reconnect_backoff.hpp"
+
+using namespace std::chrono_literals;
+
+TEST(ReconnectBackoffTest, FirstRetryIsImmediate) {
+  ReconnectBackoff b({100ms, 10000ms, 2.0, 10000ms});
+  EXPECT_EQ(b.next_delay(), 0ms);
+}
+
+TEST(ReconnectBackoffTest, DelaysStayWithinTheExponentialCap) {
+  ReconnectBackoff b({100ms, 1000ms, 2.0, 10000ms});
+  b.next_delay();
+  const std::chrono::milliseconds caps[] = {100ms, 200ms, 400ms, 800ms,
+                                            1000ms, 1000ms};
+  for (auto cap : caps) {
+    auto d = b.next_delay();
+    EXPECT_GE(d, 0ms);
+    EXPECT_LE(d, cap);
+  }
+}
+
+TEST(ReconnectBackoffTest, OnlyStableConnectionsResetTheBackoff) {
+  ReconnectBackoff b({100ms, 1000ms, 2.0, 10000ms});
+  auto t0 = std::chrono::steady_clock::now();
+  b.next_delay();
+  b.next_delay();
+
+  // Flapping: drops right after connecting keep counting up.
+  b.on_connected(t0);
+  b.on_disconnected(t0 + 1s);
+  EXPECT_EQ(b.attempts(), 2);
+
+  b.on_connected(t0);
+  b.on_disconnected(t0 + 11s);
+  EXPECT_EQ(b.attempts(), 0);
+  EXPECT_EQ(b.next_delay(), 0ms);
+}
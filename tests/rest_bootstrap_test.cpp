@@ -0,0 +1,186 @@
+#include <gtest/gtest.h>
+
+#include "infra/rest_bootstrap.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <thread>
+
+namespace {
+
+// Stands in for the trade API: canned bodies by request path, 404 for
+// anything else, and a record of how many requests overlapped.
+class StandIn : public RestTransport {
+public:
+  RestResponse get(const std::string &path) override {
+    const int now = ++in_flight;
+    int seen = max_in_flight.load();
+    while (now > seen && !max_in_flight.compare_exchange_weak(seen, now)) {
+    }
+    if (delay.count())
+      std::this_thread::sleep_for(delay);
+
+    RestResponse res;
+    {
+      std::lock_guard<std::mutex> lock(m);
+      paths.push_back(path);
+      auto it = routes.find(path);
+      if (it != routes.end())
+        res = it->second;
+      else
+        res.status = 404;
+    }
+    --in_flight;
+    return res;
+  }
+
+  void route(const std::string &path, const nlohmann::json &body,
+             int status = 200) {
+    routes[path] = RestResponse{status, body.dump(), ""};
+  }
+
+  std::map<std::string, RestResponse> routes;
+  std::vector<std::string> paths;
+  std::chrono::milliseconds delay{0};
+  std::atomic<int> in_flight{0};
+  std::atomic<int> max_in_flight{0};
+  std::mutex m;
+};
+
+const std::string kApi = "/trade-api/v2";
+
+nlohmann::json book(int yes_bid, int no_bid) {
+  return {{"orderbook", {{"yes", {{yes_bid - 1, 5}, {yes_bid, 10}}},
+                         {"no", {{no_bid, 7}}}}}};
+}
+
+RestBootstrapConfig config() {
+  RestBootstrapConfig cfg;
+  cfg.url = "http://127.0.0.1:8080/trade-api/v2";
+  cfg.connections = 4;
+  return cfg;
+}
+
+} // namespace
+
+TEST(RestBootstrapTest, DiscoversMarketsAcrossPages) {
+  StandIn api;
+  const std::string series = kApi + "/markets?series_ticker=KXS&status=open"
+                                    "&limit=1000";
+  api.route(series, {{"markets", {{{"ticker", "KXS-A"}}, {{"ticker", "M"}}}},
+                     {"cursor", "next page"}});
+  api.route(series + "&cursor=next%20page",
+            {{"markets", {{{"ticker", "KXS-B"}}}}, {"cursor", ""}});
+  api.route(kApi + "/markets?event_ticker=EV&status=open&limit=1000",
+            {{"markets", {{{"ticker", "EV-1"}}}}, {"cursor", nullptr}});
+  for (const char *t : {"M", "KXS-A", "KXS-B", "EV-1"}) {
+    api.route(kApi + "/markets/" + t + "/orderbook", book(40, 55));
+  }
+  api.route(kApi + "/portfolio/positions?count_filter=position&limit=1000",
+            {{"market_positions", nlohmann::json::array()}});
+
+  RestBootstrapConfig cfg = config();
+  cfg.series = {"KXS"};
+  cfg.events = {"EV"};
+  BootstrapResult r = RestBootstrap(cfg, api).run({"M"});
+
+  EXPECT_EQ(r.tickers,
+            (std::vector<std::string>{"M", "KXS-A", "KXS-B", "EV-1"}));
+  EXPECT_EQ(r.books.size(), 4u);
+  EXPECT_TRUE(r.positions_complete);
+  EXPECT_EQ(r.requests, 8u);
+  EXPECT_EQ(r.failures, 0u);
+}
+
+TEST(RestBootstrapTest, BoundsConcurrentRequests) {
+  StandIn api;
+  api.delay = std::chrono::milliseconds(5);
+  std::vector<std::string> tickers;
+  for (int i = 0; i < 24; ++i) {
+    tickers.push_back("T" + std::to_string(i));
+    api.route(kApi + "/markets/" + tickers.back() + "/orderbook?depth=5",
+              book(30, 60));
+  }
+
+  RestBootstrapConfig cfg = config();
+  cfg.connections = 3;
+  cfg.positions = false;
+  cfg.depth = 5;
+  BootstrapResult r = RestBootstrap(cfg, api).run(tickers);
+
+  EXPECT_EQ(r.books.size(), 24u);
+  EXPECT_LE(api.max_in_flight.load(), 3);
+  EXPECT_GT(api.max_in_flight.load(), 1);
+}
+
+TEST(RestBootstrapTest, SeedsBooksAndReconcilesPositions) {
+  StandIn api;
+  for (const char *t : {"A", "B", "C", "D"}) {
+    api.route(kApi + "/markets/" + t + "/orderbook", book(42, 50));
+  }
+  api.route(kApi + "/portfolio/positions?count_filter=position&limit=1000",
+            {{"market_positions",
+              {{{"ticker", "A"}, {"position", 3}, {"market_exposure", 120}},
+               {{"ticker", "B"},
+                {"position", -4},
+                {"market_exposure", 200},
+                {"realized_pnl", 15}}}}});
+  BootstrapResult r = RestBootstrap(config(), api).run({"A", "B", "C", "D"});
+
+  KalshiOrderBookManager books;
+  PositionManager positions(Exchange::KALSHI, {"A", "B", "C", "D"});
+  LedgerState agrees;
+  agrees.yes_pos = 3;
+  agrees.vwap_yes_cents = 41;
+  positions.restore_ledger("A", agrees);
+  LedgerState stale;
+  stale.yes_pos = 2;
+  stale.vwap_yes_cents = 30;
+  positions.restore_ledger("C", stale);
+
+  seed_books(r, books);
+  EXPECT_EQ(restore_positions(r, positions), 2u);
+
+  ASSERT_NE(books.get_book("D"), nullptr);
+  EXPECT_EQ(books.get_book("D")->book.best_yes_bid().first, 42);
+  // A already agreed, so its history is kept.
+  EXPECT_EQ(positions.get_ledger("A")->snapshot().vwap_yes_cents, 41);
+  const auto b = positions.get_ledger("B")->snapshot();
+  EXPECT_EQ(b.no_pos, 4);
+  EXPECT_EQ(b.vwap_no_cents, 50);
+  EXPECT_EQ(b.realized_pnl_cents, 15);
+  // The exchange holds nothing in C.
+  EXPECT_EQ(positions.get_ledger("C")->yes_position(), 0);
+}
+
+TEST(RestBootstrapTest, FailuresAreCountedAndLeftToTheFeed) {
+  StandIn api;
+  api.route(kApi + "/markets/A/orderbook", book(42, 50));
+  api.route(kApi + "/markets/B/orderbook", {{"error", "boom"}}, 500);
+  // No positions route: that list is incomplete.
+  BootstrapResult r = RestBootstrap(config(), api).run({"A", "B"});
+
+  ASSERT_EQ(r.books.size(), 1u);
+  EXPECT_EQ(r.books[0].ticker, "A");
+  EXPECT_FALSE(r.positions_complete);
+  EXPECT_EQ(r.failures, 2u);
+
+  PositionManager positions(Exchange::KALSHI, {"A"});
+  LedgerState held;
+  held.yes_pos = 2;
+  positions.restore_ledger("A", held);
+  EXPECT_EQ(restore_positions(r, positions), 0u);
+  EXPECT_EQ(positions.get_ledger("A")->yes_position(), 2);
+}
+
+TEST(RestBootstrapTest, SplitsUrlAndEncodesQueryValues) {
+  std::string host, prefix;
+  split_rest_url("https://api.elections.kalshi.com/trade-api/v2/", host,
+                 prefix);
+  EXPECT_EQ(host, "https://api.elections.kalshi.com");
+  EXPECT_EQ(prefix, "/trade-api/v2");
+  EXPECT_EQ(url_encode("a+b/c=d e~"), "a%2Bb%2Fc%3Dd%20e~");
+}
@@ -0,0 +1,138 @@
+#include <gtest/gtest.h>
+
+#include "infra/book_stage.hpp"
+#include "strategy/kalshi_mm.hpp"
+#include "strategy/risk_gate.hpp"
+
+namespace {
+
+MarketLimits limits() {
+  MarketLimits l;
+  l.max_position = 10;
+  l.max_notional_cents = 1'000;
+  l.max_order_size = 5;
+  l.price_band_cents = 10;
+  l.max_orders_per_sec = 2.0;
+  l.order_burst = 2.0;
+  return l;
+}
+
+constexpr std::int64_t kSec = 1'000'000'000;
+
+} // namespace
+
+TEST(RiskGateTest, PerOrderChecks) {
+  RiskGate gate(limits());
+  const auto i = gate.add_market("A");
+  EXPECT_EQ(gate.add_market("A"), i);
+  EXPECT_EQ(gate.find("A"), i);
+  EXPECT_FALSE(gate.find("B").has_value());
+
+  EXPECT_EQ(gate.check(i, Side::YES, 45, 1, 50, kSec, false), RiskCheck::Ok);
+  EXPECT_EQ(gate.check(i, Side::YES, 0, 1, 50, kSec, false),
+            RiskCheck::PriceRange);
+  EXPECT_EQ(gate.check(i, Side::YES, 100, 1, 50, kSec, false),
+            RiskCheck::PriceRange);
+  EXPECT_EQ(gate.check(i, Side::YES, 39, 1, 50, kSec, false),
+            RiskCheck::PriceBand);
+  EXPECT_EQ(gate.check(i, Side::NO, 61, 1, 50, kSec, false),
+            RiskCheck::PriceBand);
+  EXPECT_EQ(gate.check(i, Side::YES, 45, 6, 50, kSec, false),
+            RiskCheck::OrderSize);
+}
+
+TEST(RiskGateTest, PositionAndNotionalUseMirroredLedger) {
+  RiskGate gate(limits());
+  const auto i = gate.add_market("A");
+
+  gate.on_position(i, 8, 0, 8 * 45);
+  EXPECT_EQ(gate.check(i, Side::YES, 45, 2, 50, kSec, false), RiskCheck::Ok);
+  EXPECT_EQ(gate.check(i, Side::YES, 45, 3, 50, kSec, false),
+            RiskCheck::Position);
+  // Buying NO reduces net exposure.
+  EXPECT_EQ(gate.check(i, Side::NO, 50, 5, 50, kSec, false), RiskCheck::Ok);
+
+  gate.on_position(i, 0, 0, 900);
+  EXPECT_EQ(gate.check(i, Side::YES, 50, 3, 50, kSec, false),
+            RiskCheck::Notional);
+}
+
+TEST(RiskGateTest, PortfolioTotalsMoveByDifference) {
+  PortfolioLimits p;
+  p.max_gross_contracts = 12;
+  p.max_notional_cents = 100'000;
+  RiskGate gate(limits(), p);
+  const auto a = gate.add_market("A");
+  const auto b = gate.add_market("B");
+
+  gate.on_position(a, 6, 0, 300);
+  gate.on_position(b, 0, 4, 200);
+  gate.on_position(a, 6, 2, 400);
+  EXPECT_EQ(gate.gross_contracts(), 12);
+  EXPECT_EQ(gate.notional_cents(), 600);
+  EXPECT_EQ(gate.check(b, Side::NO, 50, 1, 50, kSec, false),
+            RiskCheck::PortfolioContracts);
+
+  gate.on_position(a, 0, 0, 0);
+  EXPECT_EQ(gate.gross_contracts(), 4);
+  EXPECT_EQ(gate.check(b, Side::NO, 50, 1, 50, kSec, false), RiskCheck::Ok);
+}
+
+TEST(RiskGateTest, OrderRateChargesOnlyNewOrders) {
+  RiskGate gate(limits());
+  const auto i = gate.add_market("A");
+
+  EXPECT_EQ(gate.check(i, Side::YES, 50, 1, 50, kSec, true), RiskCheck::Ok);
+  EXPECT_EQ(gate.check(i, Side::YES, 50, 1, 50, kSec, true), RiskCheck::Ok);
+  EXPECT_EQ(gate.check(i, Side::YES, 50, 1, 50, kSec, true),
+            RiskCheck::OrderRate);
+  // Re-checking a working price is free.
+  EXPECT_EQ(gate.check(i, Side::YES, 50, 1, 50, kSec, false), RiskCheck::Ok);
+  // 2/s refills one token in half a second.
+  EXPECT_EQ(gate.check(i, Side::YES, 50, 1, 50, kSec + kSec / 2, true),
+            RiskCheck::Ok);
+}
+
+TEST(RiskGateTest, KillSwitchBlocksEverything) {
+  RiskGate gate(limits());
+  const auto i = gate.add_market("A");
+  gate.kill();
+  EXPECT_TRUE(gate.killed());
+  EXPECT_EQ(gate.check(i, Side::YES, 50, 1, 50, kSec, false),
+            RiskCheck::KillSwitch);
+  gate.resume();
+  EXPECT_EQ(gate.check(i, Side::YES, 50, 1, 50, kSec, false), RiskCheck::Ok);
+}
+
+TEST(RiskGateTest, KalshiMMZeroesRejectedLegs) {
+  std::vector<std::string> tickers{"A"};
+  ASParams params{0.1, 1.5, 2.0, 60.0};
+  KalshiMM mm(tickers, params);
+  BookStage stage(tickers);
+  MarketLimits wide = limits();
+  wide.price_band_cents = 30; // the default AS spread is ~25c wide
+  auto gate = std::make_shared<RiskGate>(wide);
+  mm.set_risk_gate(gate);
+
+  std::vector<Quote> seen;
+  mm.set_quote_handler([&](const std::string &, const Quote &yes,
+                           const Quote &) { seen.push_back(yes); });
+
+  FeedEvent ev;
+  ev.exchange = Exchange::KALSHI;
+  ev.type = FeedEvent::Type::OrderbookSnapshot;
+  ev.cid = 1;
+  ev.ticker = "A";
+  ev.payload = SnapshotEvent{{{45, 10}}, {{50, 10}}, 1};
+  mm.handle_feed_event(ev, stage.apply(ev));
+  ASSERT_EQ(seen.size(), 1u);
+  EXPECT_GT(seen[0].bid, 0);
+  EXPECT_GT(seen[0].ask, 0);
+
+  gate->kill();
+  ev.payload = SnapshotEvent{{{45, 10}}, {{50, 10}}, 2};
+  mm.handle_feed_event(ev, stage.apply(ev));
+  ASSERT_EQ(seen.size(), 2u);
+  EXPECT_EQ(seen[1].bid, 0);
+  EXPECT_EQ(seen[1].ask, 0);
+}
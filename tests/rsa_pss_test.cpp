@@ -0,0 +1,109 @@
+#include "utils/rsa_pss.hpp"
+
+#include <gtest/gtest.h>
+#include <openssl/rsa.h>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+std::string encode(const std::string &s) {
+  return base64Encode(std::vector<unsigned char>(s.begin(), s.end()));
+}
+
+std::vector<unsigned char> decode(const std::string &b64) {
+  std::vector<unsigned char> out(b64.size());
+  const int n = EVP_DecodeBlock(
+      out.data(), reinterpret_cast<const unsigned char *>(b64.data()),
+      static_cast<int>(b64.size()));
+  // EVP_DecodeBlock counts padding as zero bytes.
+  std::size_t len = n < 0 ? 0 : static_cast<std::size_t>(n);
+  for (std::size_t i = b64.size(); i > 0 && b64[i - 1] == '='; --i)
+    --len;
+  out.resize(len);
+  return out;
+}
+
+bool verify(EVP_PKEY *pkey, const std::string &message,
+            const std::string &sig_b64) {
+  const std::vector<unsigned char> sig = decode(sig_b64);
+  EVP_MD_CTX *ctx = EVP_MD_CTX_new();
+  EVP_PKEY_CTX *pctx = nullptr;
+  const bool ok =
+      EVP_DigestVerifyInit(ctx, &pctx, EVP_sha256(), nullptr, pkey) == 1 &&
+      EVP_PKEY_CTX_set_rsa_padding(pctx, RSA_PKCS1_PSS_PADDING) > 0 &&
+      EVP_PKEY_CTX_set_rsa_mgf1_md(pctx, EVP_sha256()) > 0 &&
+      EVP_PKEY_CTX_set_rsa_pss_saltlen(pctx, RSA_PSS_SALTLEN_DIGEST) > 0 &&
+      EVP_DigestVerify(ctx, sig.data(), sig.size(),
+                       reinterpret_cast<const unsigned char *>(message.data()),
+                       message.size()) == 1;
+  EVP_MD_CTX_free(ctx);
+  return ok;
+}
+
+struct KeyFixture : ::testing::Test {
+  static EVP_PKEY *pkey;
+  static void SetUpTestSuite() { pkey = EVP_RSA_gen(2048); }
+  static void TearDownTestSuite() { EVP_PKEY_free(pkey); }
+};
+EVP_PKEY *KeyFixture::pkey = nullptr;
+
+} // namespace
+
+TEST(Base64, MatchesRfc4648Vectors) {
+  EXPECT_EQ(encode(""), "");
+  EXPECT_EQ(encode("f"), "Zg==");
+  EXPECT_EQ(encode("fo"), "Zm8=");
+  EXPECT_EQ(encode("foo"), "Zm9v");
+  EXPECT_EQ(encode("foob"), "Zm9vYg==");
+  EXPECT_EQ(encode("fooba"), "Zm9vYmE=");
+  EXPECT_EQ(encode("foobar"), "Zm9vYmFy");
+  EXPECT_EQ(encode("\xff\xfe\xfd"), "//79");
+}
+
+TEST(Base64, SizeMatchesOutput) {
+  for (std::size_t n = 0; n < 10; ++n) {
+    std::vector<unsigned char> data(n, 0xab);
+    EXPECT_EQ(base64Encode(data).size(), base64_encoded_size(n));
+  }
+}
+
+TEST_F(KeyFixture, SignerProducesVerifiableSignatures) {
+  ASSERT_NE(pkey, nullptr);
+  PssSigner signer(pkey);
+  ASSERT_TRUE(signer.ok());
+  EXPECT_EQ(signer.encoded_size(), 344u);
+
+  // The template context must be reusable across many messages.
+  for (int i = 0; i < 5; ++i) {
+    const std::string msg =
+        "1700000000" + std::to_string(i) + "GET/trade-api/ws/v2";
+    std::string sig;
+    ASSERT_TRUE(signer.sign(msg, sig));
+    EXPECT_EQ(sig.size(), signer.encoded_size());
+    EXPECT_TRUE(verify(pkey, msg, sig));
+    EXPECT_FALSE(verify(pkey, msg + "x", sig));
+  }
+}
+
+TEST_F(KeyFixture, CachedSignPerThread) {
+  ASSERT_NE(pkey, nullptr);
+  std::vector<std::thread> threads;
+  std::vector<int> verified(4, 0);
+  for (int t = 0; t < 4; ++t) {
+    threads.emplace_back([&, t] {
+      for (int i = 0; i < 3; ++i) {
+        const std::string msg = "thread" + std::to_string(t) + "/" +
+                                std::to_string(i);
+        std::string sig;
+        if (signPssSha256(pkey, msg, sig) && verify(pkey, msg, sig))
+          ++verified[t];
+      }
+    });
+  }
+  for (auto &th : threads)
+    th.join();
+  for (int v : verified)
+    EXPECT_EQ(v, 3);
+}
@@ -0,0 +1,68 @@
+#include <gtest/gtest.h>
+
+#include "infra/runtime_tuning.hpp"
+
+#include <cstdint>
+#include <sched.h>
+#include <thread>
+#include <vector>
+
+TEST(RuntimeTuningTest, ParsesConfig) {
+  const auto j = nlohmann::json::parse(R"({
+    "lock_memory": true,
+    "prefault_heap_mb": 2,
+    "prefault_stack_kb": 256,
+    "huge_pages": "transparent",
+    "threads": {
+      "engine": {"cpus": [2, 3], "fifo_priority": 50},
+      "reconnect": {"cpus": [0]}
+    }
+  })");
+  const RuntimeTuningConfig cfg = runtime_tuning_from_json(j);
+  EXPECT_TRUE(cfg.lock_memory);
+  EXPECT_EQ(cfg.prefault_heap_bytes, 2u << 20);
+  EXPECT_EQ(cfg.prefault_stack_bytes, 256u << 10);
+  EXPECT_EQ(cfg.huge_pages, HugePages::Transparent);
+  ASSERT_EQ(cfg.threads.size(), 2u);
+  EXPECT_EQ(cfg.threads.at("engine").cpus, (std::vector<int>{2, 3}));
+  EXPECT_EQ(cfg.threads.at("engine").fifo_priority, 50);
+  EXPECT_EQ(cfg.threads.at("reconnect").fifo_priority, 0);
+  EXPECT_EQ(runtime_tuning_from_json(nlohmann::json::object()).huge_pages,
+            HugePages::Off);
+}
+
+TEST(RuntimeTuningTest, HotAllocatorAlignsLargeBlocks) {
+  std::vector<std::uint64_t, HotAllocator<std::uint64_t>> big(
+      kHugePageSize / sizeof(std::uint64_t) + 1, 7);
+  EXPECT_EQ(reinterpret_cast<std::uintptr_t>(big.data()) % kHugePageSize, 0u);
+  EXPECT_EQ(big.back(), 7u);
+
+  std::vector<int, HotAllocator<int>> small(16, 1);
+  EXPECT_EQ(small[15], 1);
+}
+
+TEST(RuntimeTuningTest, PinsThreadToConfiguredCpu) {
+  cpu_set_t allowed;
+  CPU_ZERO(&allowed);
+  ASSERT_EQ(sched_getaffinity(0, sizeof(allowed), &allowed), 0);
+  int cpu = 0;
+  while (!CPU_ISSET(cpu, &allowed))
+    ++cpu;
+
+  RuntimeTuningConfig cfg;
+  cfg.threads["test"].cpus = {cpu};
+  cfg.prefault_stack_bytes = 64 * 1024;
+  RuntimeTuning::instance().configure(cfg);
+
+  cpu_set_t got;
+  std::thread t([&] {
+    RuntimeTuning::instance().tune_current_thread("test");
+    RuntimeTuning::instance().tune_current_thread("unknown");
+    CPU_ZERO(&got);
+    sched_getaffinity(0, sizeof(got), &got);
+  });
+  t.join();
+  EXPECT_EQ(CPU_COUNT(&got), 1);
+  EXPECT_TRUE(CPU_ISSET(cpu, &got));
+  RuntimeTuning::instance().configure(RuntimeTuningConfig{});
+}
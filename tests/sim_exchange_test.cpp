@@ -0,0 +1,217 @@
+#include <gtest/gtest.h>
+
+#include "backtest/backtest.hpp"
+#include "backtest/sim_exchange.hpp"
+#include <cstdio>
+#include <fstream>
+
+namespace {
+
+const std::string kTicker = "KXTEST-26-A";
+
+FeedEvent snapshot(std::vector<std::pair<int, int>> yes,
+                   std::vector<std::pair<int, int>> no, std::int64_t seq) {
+  FeedEvent ev;
+  ev.exchange = Exchange::KALSHI;
+  ev.type = FeedEvent::Type::OrderbookSnapshot;
+  ev.cid = 1;
+  ev.ticker = kTicker;
+  ev.payload = SnapshotEvent{std::move(yes), std::move(no), seq};
+  return ev;
+}
+
+FeedEvent delta(Side side, int price, int contracts, std::int64_t seq) {
+  FeedEvent ev;
+  ev.exchange = Exchange::KALSHI;
+  ev.type = FeedEvent::Type::OrderbookDelta;
+  ev.cid = 1;
+  ev.ticker = kTicker;
+  ev.payload = DeltaEvent{side, price, contracts, seq};
+  return ev;
+}
+
+SimConfig fast() {
+  SimConfig cfg;
+  cfg.order_latency_ns = 100;
+  cfg.cancel_latency_ns = 100;
+  return cfg;
+}
+
+} // namespace
+
+TEST(SimExchangeTest, OrderWaitsOutLatencyAndJoinsBackOfQueue) {
+  SimExchange sim(fast());
+  std::vector<FeedEvent> fills;
+  sim.on_market_data(snapshot({{40, 10}}, {{55, 5}}, 1), 0, fills);
+
+  sim.submit(kTicker, Side::YES, 40, 3, 0);
+  sim.advance(50, fills);
+  ASSERT_EQ(sim.orders(kTicker).size(), 1u);
+  EXPECT_FALSE(sim.orders(kTicker)[0].active);
+
+  sim.advance(100, fills);
+  EXPECT_TRUE(sim.orders(kTicker)[0].active);
+  EXPECT_EQ(sim.orders(kTicker)[0].queue_ahead, 10);
+  EXPECT_TRUE(fills.empty());
+}
+
+TEST(SimExchangeTest, QueueDepletionFillsOnceAheadIsGone) {
+  SimExchange sim(fast());
+  std::vector<FeedEvent> fills;
+  sim.on_market_data(snapshot({{40, 10}}, {{55, 5}}, 1), 0, fills);
+  sim.submit(kTicker, Side::YES, 40, 3, 0);
+  sim.advance(100, fills);
+
+  sim.on_market_data(delta(Side::YES, 40, -8, 2), 200, fills);
+  EXPECT_TRUE(fills.empty());
+  EXPECT_EQ(sim.orders(kTicker)[0].queue_ahead, 2);
+
+  sim.on_market_data(delta(Side::YES, 40, -2, 3), 300, fills);
+  sim.on_market_data(delta(Side::YES, 40, 5, 4), 400, fills);
+  EXPECT_TRUE(fills.empty());
+  EXPECT_EQ(sim.orders(kTicker)[0].queue_ahead, 0);
+
+  // Size joining behind us does not protect us.
+  sim.on_market_data(delta(Side::YES, 40, -2, 5), 500, fills);
+  ASSERT_EQ(fills.size(), 1u);
+  const auto &f = std::get<FillEvent>(fills[0].payload);
+  EXPECT_EQ(f.count, 2);
+  EXPECT_EQ(f.yes_price, 40);
+  EXPECT_EQ(f.action, Action::BUY);
+  EXPECT_EQ(f.purchased_side, Side::YES);
+  EXPECT_EQ(f.post_position, 2);
+  EXPECT_FALSE(f.is_taker);
+  EXPECT_EQ(sim.orders(kTicker)[0].remaining, 1);
+}
+
+TEST(SimExchangeTest, CrossingBookFillsRestingNoBid) {
+  SimExchange sim(fast());
+  std::vector<FeedEvent> fills;
+  sim.on_market_data(snapshot({{40, 10}}, {{55, 5}}, 1), 0, fills);
+  // Selling YES at 58 rests as a NO bid at 42.
+  sim.submit(kTicker, Side::NO, 42, 4, 0);
+  sim.advance(100, fills);
+  EXPECT_TRUE(fills.empty());
+
+  sim.on_market_data(delta(Side::YES, 58, 3, 2), 200, fills);
+  ASSERT_EQ(fills.size(), 1u);
+  const auto &f = std::get<FillEvent>(fills[0].payload);
+  EXPECT_EQ(f.count, 3);
+  EXPECT_EQ(f.yes_price, 58);
+  EXPECT_EQ(f.purchased_side, Side::NO);
+  EXPECT_EQ(f.post_position, -3);
+}
+
+TEST(SimExchangeTest, CrossingLevelIsSharedAcrossOrdersAndEvents) {
+  SimExchange sim(fast());
+  std::vector<FeedEvent> fills;
+  sim.on_market_data(snapshot({{40, 10}}, {{55, 5}}, 1), 0, fills);
+  sim.submit(kTicker, Side::NO, 42, 2, 0);
+  sim.submit(kTicker, Side::NO, 42, 2, 0);
+  sim.advance(100, fills);
+
+  sim.on_market_data(delta(Side::YES, 58, 3, 2), 200, fills);
+  int filled = 0;
+  for (const auto &ev : fills) {
+    filled += std::get<FillEvent>(ev.payload).count;
+  }
+  EXPECT_EQ(filled, 3);
+
+  // The book stays crossed, but the recorded size is already ours.
+  fills.clear();
+  sim.on_market_data(delta(Side::YES, 40, 1, 3), 300, fills);
+  EXPECT_TRUE(fills.empty());
+
+  // Only size that joins the level can fill the rest.
+  sim.on_market_data(delta(Side::YES, 58, 2, 4), 400, fills);
+  ASSERT_EQ(fills.size(), 1u);
+  EXPECT_EQ(std::get<FillEvent>(fills[0].payload).count, 1);
+}
+
+TEST(SimExchangeTest, QueueDepletionIsSharedInQueueOrder) {
+  SimExchange sim(fast());
+  std::vector<FeedEvent> fills;
+  sim.on_market_data(snapshot({{40, 2}}, {{55, 5}}, 1), 0, fills);
+  const auto first = sim.submit(kTicker, Side::YES, 40, 3, 0);
+  sim.advance(100, fills);
+  sim.on_market_data(delta(Side::YES, 40, 1, 2), 150, fills);
+  const auto second = sim.submit(kTicker, Side::YES, 40, 3, 150);
+  sim.advance(250, fills);
+  sim.on_market_data(delta(Side::YES, 40, 5, 3), 260, fills);
+
+  // 2 ahead of the first order, then 2 of its 3; none reach the second,
+  // which has the first order's rest and another contract ahead of it.
+  sim.on_market_data(delta(Side::YES, 40, -4, 4), 300, fills);
+  ASSERT_EQ(fills.size(), 1u);
+  EXPECT_EQ(std::get<FillEvent>(fills[0].payload).count, 2);
+  for (const auto &o : sim.orders(kTicker)) {
+    if (o.id == first)
+      EXPECT_EQ(o.remaining, 1);
+    if (o.id == second)
+      EXPECT_EQ(o.remaining, 3);
+  }
+}
+
+TEST(SimExchangeTest, MarketableOrderTakesOnArrival) {
+  SimExchange sim(fast());
+  std::vector<FeedEvent> fills;
+  sim.on_market_data(snapshot({{40, 10}}, {{55, 5}}, 1), 0, fills);
+  sim.submit(kTicker, Side::YES, 46, 8, 0);
+  sim.advance(100, fills);
+
+  ASSERT_EQ(fills.size(), 1u);
+  const auto &f = std::get<FillEvent>(fills[0].payload);
+  EXPECT_EQ(f.count, 5);
+  EXPECT_TRUE(f.is_taker);
+  ASSERT_EQ(sim.orders(kTicker).size(), 1u);
+  EXPECT_EQ(sim.orders(kTicker)[0].remaining, 3);
+}
+
+TEST(SimExchangeTest, CancelTakesEffectAfterLatency) {
+  SimExchange sim(fast());
+  std::vector<FeedEvent> fills;
+  sim.on_market_data(snapshot({{40, 1}}, {{55, 5}}, 1), 0, fills);
+  const auto id = sim.submit(kTicker, Side::YES, 40, 1, 0);
+  sim.advance(100, fills);
+
+  sim.cancel(kTicker, id, 150);
+  EXPECT_FALSE(sim.is_open(kTicker, id));
+  // Still working until the cancel lands.
+  sim.on_market_data(delta(Side::YES, 40, -1, 2), 200, fills);
+  sim.on_market_data(delta(Side::YES, 40, 1, 3), 210, fills);
+  sim.on_market_data(delta(Side::YES, 40, -1, 4), 220, fills);
+  EXPECT_EQ(fills.size(), 1u);
+  EXPECT_TRUE(sim.orders(kTicker).empty());
+}
+
+TEST(SimExchangeTest, BacktestReplaysRecordedFeed) {
+  const std::string path = ::testing::TempDir() + "sim_exchange_feed.jsonl";
+  {
+    std::ofstream out(path);
+    out << "1000\t{\"type\":\"orderbook_snapshot\",\"sid\":1,\"seq\":1,"
+           "\"msg\":{\"market_ticker\":\"" << kTicker
+        << "\",\"yes\":[[40,10]],\"no\":[[55,5]]}}\n";
+    for (int i = 0; i < 20; ++i) {
+      out << "{\"type\":\"orderbook_delta\",\"sid\":1,\"seq\":" << i + 2
+          << ",\"msg\":{\"market_ticker\":\"" << kTicker
+          << "\",\"price\":40,\"delta\":" << (i % 2 ? 1 : -1)
+          << ",\"side\":\"yes\"}}\n";
+    }
+    out << "not json\n";
+  }
+
+  const auto feed = load_recorded_feed(path);
+  ASSERT_EQ(feed.size(), 21u);
+  EXPECT_EQ(feed[0].ts_ns, 1000);
+  EXPECT_EQ(feed[1].ts_ns, 1000 + 1'000'000);
+  ASSERT_EQ(feed_tickers(feed), std::vector<std::string>{kTicker});
+
+  BacktestConfig cfg;
+  cfg.sim = fast();
+  const BacktestResult res = run_backtest(feed, feed_tickers(feed), cfg);
+  EXPECT_EQ(res.events, 21u);
+  EXPECT_GT(res.quotes, 0u);
+  EXPECT_GE(res.orders, 2u);
+  ASSERT_EQ(res.pnl.count(kTicker), 1u);
+  std::remove(path.c_str());
+}
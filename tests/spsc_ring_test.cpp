@@ -0,0 +1,47 @@
+#include <gtest/gtest.h>
+
+#include "infra/spsc_ring.hpp"
+
+#include <cstdint>
+#include <thread>
+
+TEST(SpscRingTest, RoundsCapacityAndReportsFull) {
+  SpscRing<int> ring(5);
+  EXPECT_EQ(ring.capacity(), 8u);
+  for (int i = 0; i < 8; ++i)
+    EXPECT_TRUE(ring.try_push(i));
+  EXPECT_FALSE(ring.try_push(8));
+  EXPECT_EQ(ring.size(), 8u);
+
+  int v = -1;
+  ASSERT_TRUE(ring.try_pop(v));
+  EXPECT_EQ(v, 0);
+  EXPECT_TRUE(ring.try_push(8));
+  for (int i = 1; i <= 8; ++i) {
+    ASSERT_TRUE(ring.try_pop(v));
+    EXPECT_EQ(v, i);
+  }
+  EXPECT_FALSE(ring.try_pop(v));
+}
+
+TEST(SpscRingTest, PreservesOrderAcrossThreads) {
+  constexpr std::uint64_t kItems = 1'000'000;
+  SpscRing<std::uint64_t> ring(1024);
+  std::thread producer([&] {
+    for (std::uint64_t i = 0; i < kItems; ++i) {
+      while (!ring.try_push(i))
+        std::this_thread::yield();
+    }
+  });
+
+  std::uint64_t expected = 0;
+  std::uint64_t v = 0;
+  while (expected < kItems) {
+    if (ring.try_pop(v)) {
+      ASSERT_EQ(v, expected);
+      ++expected;
+    }
+  }
+  producer.join();
+  EXPECT_EQ(ring.size(), 0u);
+}
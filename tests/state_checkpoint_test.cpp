@@ -0,0 +1,151 @@
+#include <gtest/gtest.h>
+
+#include "infra/state_checkpoint.hpp"
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <unistd.h>
+
+static FillEvent make_fill(const std::string &ticker, Action action, Side side,
+                           int yes_price_cents, int count, std::int64_t ts) {
+  FillEvent f{};
+  f.trade_id = "T1";
+  f.order_id = "O1";
+  f.market_ticker = ticker;
+  f.side = side;
+  f.purchased_side = side;
+  f.yes_price = yes_price_cents;
+  f.count = count;
+  f.action = action;
+  f.ts = ts;
+  f.post_position = count;
+  return f;
+}
+
+class StateCheckpointTest : public ::testing::Test {
+protected:
+  void SetUp() override {
+    path = ::testing::TempDir() + "state_checkpoint_test_" +
+           std::to_string(::getpid()) + ".ckpt";
+    std::remove(path.c_str());
+  }
+  void TearDown() override { std::remove(path.c_str()); }
+
+  std::string path;
+};
+
+TEST_F(StateCheckpointTest, RestoresLedgersAndBooks) {
+  std::vector<std::string> tickers = {"KXBTC-24DEC31"};
+  PositionManager pm(Exchange::KALSHI, tickers);
+  KalshiOrderBookManager books(tickers);
+
+  pm.on_fill(make_fill("KXBTC-24DEC31", Action::BUY, Side::YES, 60, 10, 1000));
+  std::string ticker = "KXBTC-24DEC31";
+  books.set_ticker_snapshot(ticker, 7, SnapshotEvent{{{40, 5}, {41, 3}},
+                                                     {{55, 8}},
+                                                     1});
+
+  {
+    StateCheckpoint cp({path, 16});
+    ASSERT_TRUE(cp.open());
+    cp.write(pm, books);
+    EXPECT_EQ(cp.epoch(), 1u);
+  }
+
+  StateCheckpoint cp({path, 16});
+  ASSERT_TRUE(cp.open());
+  PositionManager restored_pm(Exchange::KALSHI, {});
+  KalshiOrderBookManager restored_books;
+  ASSERT_TRUE(cp.restore(restored_pm, restored_books));
+
+  const auto *ledger = restored_pm.get_ledger("KXBTC-24DEC31");
+  ASSERT_NE(ledger, nullptr);
+  auto snap = ledger->snapshot();
+  EXPECT_EQ(snap.yes_pos, 10);
+  EXPECT_EQ(snap.cash_cents, -600);
+  EXPECT_EQ(snap.vwap_yes_cents, 60);
+  EXPECT_EQ(ledger->state().last_ts, 1000);
+
+  auto *kb = restored_books.get_book("KXBTC-24DEC31");
+  ASSERT_NE(kb, nullptr);
+  EXPECT_TRUE(kb->has_snapshot);
+  EXPECT_EQ(kb->cid, 0);
+  EXPECT_EQ(kb->book.best_yes_bid(), std::make_pair(41, 3));
+  EXPECT_EQ(kb->book.best_no_bid(), std::make_pair(55, 8));
+}
+
+TEST_F(StateCheckpointTest, EmptyFileHasNothingToRestore) {
+  StateCheckpoint cp({path, 16});
+  ASSERT_TRUE(cp.open());
+  PositionManager pm(Exchange::KALSHI, {});
+  KalshiOrderBookManager books;
+  EXPECT_FALSE(cp.restore(pm, books));
+}
+
+TEST_F(StateCheckpointTest, LatestEpochWins) {
+  std::vector<std::string> tickers = {"KXBTC-24DEC31"};
+  PositionManager pm(Exchange::KALSHI, tickers);
+  KalshiOrderBookManager books;
+
+  StateCheckpoint cp({path, 16});
+  ASSERT_TRUE(cp.open());
+  pm.on_fill(make_fill("KXBTC-24DEC31", Action::BUY, Side::YES, 60, 10, 1));
+  cp.write(pm, books);
+  pm.on_fill(make_fill("KXBTC-24DEC31", Action::BUY, Side::YES, 60, 5, 2));
+  cp.write(pm, books);
+  pm.on_fill(make_fill("KXBTC-24DEC31", Action::SELL, Side::YES, 70, 3, 3));
+  cp.write(pm, books);
+  EXPECT_EQ(cp.epoch(), 3u);
+
+  PositionManager restored(Exchange::KALSHI, {});
+  ASSERT_TRUE(cp.restore(restored, books));
+  EXPECT_EQ(restored.get_ledger("KXBTC-24DEC31")->snapshot().yes_pos, 12);
+}
+
+TEST_F(StateCheckpointTest, CorruptSlotFallsBackToThePreviousOne) {
+  const std::string ticker = "KXBTC-24DEC31";
+  PositionManager pm(Exchange::KALSHI, {ticker});
+  KalshiOrderBookManager books;
+  {
+    StateCheckpoint cp({path, 16});
+    ASSERT_TRUE(cp.open());
+    pm.on_fill(make_fill(ticker, Action::BUY, Side::YES, 60, 10, 1));
+    cp.write(pm, books); // epoch 1, second slot
+    pm.on_fill(make_fill(ticker, Action::BUY, Side::YES, 60, 5, 2));
+    cp.write(pm, books); // epoch 2, first slot
+  }
+
+  // The epoch bracket is intact, but part of the image never made it.
+  std::fstream f(path, std::ios::in | std::ios::out | std::ios::binary);
+  std::string bytes((std::istreambuf_iterator<char>(f)),
+                    std::istreambuf_iterator<char>());
+  const auto at = bytes.find(ticker);
+  ASSERT_NE(at, std::string::npos);
+  f.seekp(static_cast<std::streamoff>(at));
+  f.put('Z');
+  f.close();
+
+  StateCheckpoint cp({path, 16});
+  ASSERT_TRUE(cp.open());
+  PositionManager restored(Exchange::KALSHI, {});
+  ASSERT_TRUE(cp.restore(restored, books));
+  EXPECT_EQ(restored.get_ledger(ticker)->snapshot().yes_pos, 10);
+}
+
+TEST_F(StateCheckpointTest, WriterThreadReportsDurableCheckpoints) {
+  const std::string ticker = "KXBTC-24DEC31";
+  PositionManager pm(Exchange::KALSHI, {ticker});
+  KalshiOrderBookManager books;
+  pm.on_fill(make_fill(ticker, Action::BUY, Side::YES, 60, 10, 1));
+
+  StateCheckpoint cp({path, 16});
+  ASSERT_TRUE(cp.open());
+  std::atomic<std::uint64_t> durable{0};
+  cp.set_durable_handler([&](std::uint64_t n) { durable = n; });
+  cp.start();
+  EXPECT_TRUE(cp.write(pm, books, 7));
+  cp.stop();
+  EXPECT_EQ(cp.epoch(), 1u);
+  EXPECT_EQ(durable.load(), 7u);
+  EXPECT_EQ(cp.journal_records(), 7u);
+}
@@ -0,0 +1,237 @@
+#include <gtest/gtest.h>
+
+#include "infra/subscription_manager.hpp"
+
+using Clock = SubscriptionManager::Clock;
+
+static std::vector<std::string> make_tickers(int n) {
+  std::vector<std::string> out;
+  for (int i = 0; i < n; ++i) {
+    out.push_back("KXTEST-26-M" + std::to_string(i));
+  }
+  return out;
+}
+
+static std::string subscribed(std::int64_t id, std::int64_t sid) {
+  return nlohmann::json{{"id", id},
+                        {"type", "subscribed"},
+                        {"msg", {{"channel", "orderbook_delta"}, {"sid", sid}}}}
+      .dump();
+}
+
+struct Sent {
+  std::vector<nlohmann::json> msgs;
+  SubscriptionManager::Send fn() {
+    return [this](const std::string &m) {
+      msgs.push_back(nlohmann::json::parse(m));
+      return true;
+    };
+  }
+};
+
+TEST(SubscriptionManagerTest, ChunksTickersIntoBatches) {
+  SubscriptionManager sm({/*batch_size*/ 100, /*rate*/ 1000, /*burst*/ 10});
+  sm.add_markets("orderbook_delta", make_tickers(250));
+
+  Sent sent;
+  sm.pump(Clock::now(), sent.fn());
+
+  ASSERT_EQ(sent.msgs.size(), 3u);
+  EXPECT_EQ(sent.msgs[0]["cmd"], "subscribe");
+  EXPECT_EQ(sent.msgs[0]["params"]["channels"][0], "orderbook_delta");
+  EXPECT_EQ(sent.msgs[0]["params"]["market_tickers"].size(), 100u);
+  EXPECT_EQ(sent.msgs[2]["params"]["market_tickers"].size(), 50u);
+  EXPECT_EQ(sm.pending_acks(), 3u);
+}
+
+TEST(SubscriptionManagerTest, PacesCommandsToTheConfiguredRate) {
+  SubscriptionManager sm({/*batch_size*/ 10, /*rate*/ 10, /*burst*/ 2});
+  sm.add_markets("orderbook_delta", make_tickers(50));
+
+  Sent sent;
+  auto t0 = Clock::now();
+  auto next = sm.pump(t0, sent.fn());
+  EXPECT_EQ(sent.msgs.size(), 2u);
+  EXPECT_GT(next, t0);
+  EXPECT_LE(next, t0 + std::chrono::milliseconds(110));
+
+  sm.pump(t0 + std::chrono::milliseconds(100), sent.fn());
+  EXPECT_EQ(sent.msgs.size(), 3u);
+}
+
+TEST(SubscriptionManagerTest, IncrementalAddUsesExistingSid) {
+  SubscriptionManager sm({/*batch_size*/ 100, /*rate*/ 1000, /*burst*/ 10});
+  sm.add_markets("orderbook_delta", make_tickers(2));
+
+  Sent sent;
+  sm.pump(Clock::now(), sent.fn());
+  ASSERT_EQ(sent.msgs.size(), 1u);
+  const auto id = sent.msgs[0]["id"].get<std::int64_t>();
+  EXPECT_TRUE(sm.on_control_message(subscribed(id, 42)));
+  EXPECT_EQ(sm.pending_acks(), 0u);
+
+  sm.add_markets("orderbook_delta", {"KXTEST-26-NEW"});
+  sm.remove_markets("orderbook_delta", {"KXTEST-26-M0"});
+  sm.pump(Clock::now(), sent.fn());
+
+  ASSERT_EQ(sent.msgs.size(), 3u);
+  EXPECT_EQ(sent.msgs[1]["cmd"], "update_subscription");
+  EXPECT_EQ(sent.msgs[1]["params"]["sids"][0], 42);
+  EXPECT_EQ(sent.msgs[1]["params"]["action"], "add_markets");
+  EXPECT_EQ(sent.msgs[1]["params"]["market_tickers"][0], "KXTEST-26-NEW");
+  EXPECT_EQ(sent.msgs[2]["params"]["action"], "delete_markets");
+}
+
+TEST(SubscriptionManagerTest, UpdatesWaitForTheSubscribeAck) {
+  SubscriptionManager sm({/*batch_size*/ 100, /*rate*/ 1000, /*burst*/ 10});
+  sm.add_markets("orderbook_delta", {"A"});
+
+  Sent sent;
+  sm.pump(Clock::now(), sent.fn());
+  sm.add_markets("orderbook_delta", {"B"});
+  sm.pump(Clock::now(), sent.fn());
+  EXPECT_EQ(sent.msgs.size(), 1u); // no sid yet
+
+  sm.on_control_message(subscribed(sent.msgs[0]["id"], 7));
+  sm.pump(Clock::now(), sent.fn());
+  ASSERT_EQ(sent.msgs.size(), 2u);
+  EXPECT_EQ(sent.msgs[1]["params"]["sids"][0], 7);
+}
+
+TEST(SubscriptionManagerTest, ReconnectResubscribesEveryBatch) {
+  SubscriptionManager sm({/*batch_size*/ 2, /*rate*/ 1000, /*burst*/ 10});
+  sm.add_markets("orderbook_delta", make_tickers(3));
+  sm.subscribe("fill");
+
+  Sent sent;
+  sm.pump(Clock::now(), sent.fn());
+  EXPECT_EQ(sent.msgs.size(), 3u);
+
+  sm.on_connected();
+  EXPECT_EQ(sm.pending_acks(), 0u);
+  sm.pump(Clock::now(), sent.fn());
+  ASSERT_EQ(sent.msgs.size(), 6u);
+  EXPECT_EQ(sent.msgs[5]["params"]["channels"][0], "fill");
+  EXPECT_FALSE(sent.msgs[5]["params"].contains("market_tickers"));
+}
+
+TEST(SubscriptionManagerTest, IgnoresFeedMessages) {
+  SubscriptionManager sm;
+  EXPECT_FALSE(sm.on_control_message(
+      R"({"type":"orderbook_delta","sid":1,"seq":2,"msg":{}})"));
+  EXPECT_FALSE(sm.on_control_message("not json"));
+}
+
+TEST(SubscriptionManagerTest, MalformedControlFramesDoNotThrow) {
+  SubscriptionManager sm({/*batch_size*/ 100, /*rate*/ 1000, /*burst*/ 10});
+  sm.add_markets("orderbook_delta", {"KXTEST-26-M0"});
+  Sent sent;
+  sm.pump(Clock::now(), sent.fn());
+  const auto id = sent.msgs[0]["id"].get<std::int64_t>();
+
+  EXPECT_FALSE(sm.on_control_message(R"({"type":7,"id":1})"));
+  EXPECT_FALSE(sm.on_control_message(R"([1,2])"));
+  EXPECT_TRUE(sm.on_control_message(R"({"type":"ok","id":"1"})"));
+  EXPECT_EQ(sm.pending_acks(), 1u);
+
+  // A subscribe ack without a usable msg leaves the batch without a sid.
+  EXPECT_TRUE(sm.on_control_message(
+      nlohmann::json{{"id", id}, {"type", "subscribed"}}.dump()));
+  EXPECT_EQ(sm.pending_acks(), 0u);
+  sm.on_connected();
+  sm.pump(Clock::now(), sent.fn());
+  const auto resent = sent.msgs.back()["id"].get<std::int64_t>();
+  EXPECT_TRUE(sm.on_control_message(
+      nlohmann::json{{"id", resent}, {"type", "subscribed"}, {"msg", "x"}}
+          .dump()));
+  EXPECT_TRUE(sm.on_control_message(
+      nlohmann::json{
+          {"id", resent}, {"type", "subscribed"}, {"msg", {{"sid", "x"}}}}
+          .dump()));
+}
+
+TEST(SubscriptionManagerTest, ResyncReaddsOneMarket) {
+  SubscriptionManager sm({/*batch_size*/ 100, /*rate*/ 1000, /*burst*/ 10});
+  sm.add_markets("orderbook_delta", make_tickers(2));
+
+  // Nothing to do before the subscribe is out: it brings a snapshot anyway.
+  sm.resync_market("orderbook_delta", "KXTEST-26-M1");
+  Sent sent;
+  sm.pump(Clock::now(), sent.fn());
+  ASSERT_EQ(sent.msgs.size(), 1u);
+  EXPECT_TRUE(sm.on_control_message(
+      subscribed(sent.msgs[0]["id"].get<std::int64_t>(), 7)));
+
+  sm.resync_market("orderbook_delta", "KXTEST-26-M1");
+  sm.resync_market("orderbook_delta", "KXTEST-26-UNKNOWN");
+  sm.pump(Clock::now(), sent.fn());
+  ASSERT_EQ(sent.msgs.size(), 3u);
+  EXPECT_EQ(sent.msgs[1]["params"]["action"], "delete_markets");
+  EXPECT_EQ(sent.msgs[2]["params"]["action"], "add_markets");
+  EXPECT_EQ(sent.msgs[2]["params"]["sids"][0], 7);
+  EXPECT_EQ(sent.msgs[2]["params"]["market_tickers"][0], "KXTEST-26-M1");
+  EXPECT_EQ(sm.markets("orderbook_delta").size(), 2u);
+}
+
+TEST(SubscriptionManagerTest, RejectedSubscribeIsRetriedWithBackoff) {
+  SubscriptionConfig cfg{/*batch_size*/ 100, /*rate*/ 1000, /*burst*/ 10};
+  cfg.retry_initial = std::chrono::milliseconds(100);
+  SubscriptionManager sm(cfg);
+  sm.add_markets("orderbook_delta", {"A"});
+
+  Sent sent;
+  const auto t0 = Clock::now();
+  sm.pump(t0, sent.fn());
+  ASSERT_EQ(sent.msgs.size(), 1u);
+  sm.on_control_message(
+      nlohmann::json{{"id", sent.msgs[0]["id"]},
+                     {"type", "error"},
+                     {"msg", {{"code", 9}, {"msg", "busy"}}}}
+          .dump());
+  sm.add_markets("orderbook_delta", {"B"});
+
+  auto next = sm.pump(t0, sent.fn());
+  EXPECT_EQ(sent.msgs.size(), 1u);
+  EXPECT_EQ(next, t0 + std::chrono::milliseconds(100));
+
+  sm.pump(next, sent.fn());
+  ASSERT_EQ(sent.msgs.size(), 2u);
+  EXPECT_EQ(sent.msgs[1]["cmd"], "subscribe");
+  EXPECT_EQ(sent.msgs[1]["params"]["market_tickers"].size(), 2u);
+
+  // The retry is acked; nothing is left waiting on it.
+  sm.on_control_message(subscribed(sent.msgs[1]["id"], 5));
+  sm.pump(next, sent.fn());
+  EXPECT_EQ(sent.msgs.size(), 2u);
+  EXPECT_EQ(sm.pending_acks(), 0u);
+}
+
+TEST(SubscriptionManagerTest, LateAckAfterResendUnsubscribesDuplicate) {
+  SubscriptionConfig cfg{/*batch_size*/ 100, /*rate*/ 1000, /*burst*/ 10};
+  cfg.ack_timeout = std::chrono::milliseconds(50);
+  SubscriptionManager sm(cfg);
+  sm.add_markets("orderbook_delta", {"A"});
+
+  Sent sent;
+  const auto t0 = Clock::now();
+  sm.pump(t0, sent.fn());
+  sm.pump(t0 + std::chrono::milliseconds(60), sent.fn());
+  ASSERT_EQ(sent.msgs.size(), 2u); // resent
+
+  sm.on_control_message(subscribed(sent.msgs[1]["id"], 8));
+  sm.on_control_message(subscribed(sent.msgs[0]["id"], 7)); // late
+  sm.pump(t0 + std::chrono::milliseconds(60), sent.fn());
+  ASSERT_EQ(sent.msgs.size(), 3u);
+  EXPECT_EQ(sent.msgs[2]["cmd"], "unsubscribe");
+  EXPECT_EQ(sent.msgs[2]["params"]["sids"][0], 7);
+
+  // Acking the stray unsubscribe leaves the batch on sid 8.
+  sm.on_control_message(nlohmann::json{{"id", sent.msgs[2]["id"]},
+                                       {"type", "unsubscribed"},
+                                       {"sid", 7}}
+                            .dump());
+  sm.add_markets("orderbook_delta", {"B"});
+  sm.pump(t0 + std::chrono::milliseconds(60), sent.fn());
+  ASSERT_EQ(sent.msgs.size(), 4u);
+  EXPECT_EQ(sent.msgs[3]["params"]["sids"][0], 8);
+}
@@ -0,0 +1,85 @@
+#include <gtest/gtest.h>
+
+#include "backtest/sweep.hpp"
+#include <sstream>
+
+namespace {
+
+const std::string kTicker = "KXTEST-26-A";
+
+std::vector<RecordedEvent> synthetic_feed() {
+  std::vector<RecordedEvent> feed;
+  FeedEvent snap;
+  snap.exchange = Exchange::KALSHI;
+  snap.type = FeedEvent::Type::OrderbookSnapshot;
+  snap.cid = 1;
+  snap.ticker = kTicker;
+  snap.payload = SnapshotEvent{{{40, 10}, {39, 20}}, {{55, 10}, {54, 20}}, 1};
+  feed.push_back(RecordedEvent{0, snap});
+
+  // Size churns at both touches, so resting quotes get worked through.
+  std::int64_t seq = 2;
+  for (int i = 0; i < 400; ++i) {
+    FeedEvent d = snap;
+    d.type = FeedEvent::Type::OrderbookDelta;
+    const Side side = i % 4 < 2 ? Side::YES : Side::NO;
+    const int price = side == Side::YES ? 40 : 55;
+    d.payload = DeltaEvent{side, price, i % 2 ? 4 : -4, seq++};
+    feed.push_back(RecordedEvent{(i + 1) * 1'000'000LL, d});
+  }
+  return feed;
+}
+
+} // namespace
+
+TEST(SweepTest, GridExpandsToProduct) {
+  nlohmann::json j = {
+      {"as_params", {{"gamma", {0.05, 0.1, 0.2}}, {"k", {1.0, 2.0}}}}};
+  ASParams base{0.1, 1.5, 2.0, 60.0};
+  const auto grid = sweep_grid_from_json(j, base).expand();
+  ASSERT_EQ(grid.size(), 6u);
+  for (const auto &p : grid) {
+    EXPECT_EQ(p.sigma, 2.0);
+    EXPECT_EQ(p.horizon, 60.0);
+  }
+  EXPECT_EQ(grid.front().gamma, 0.05);
+  EXPECT_EQ(grid.back().k, 2.0);
+}
+
+TEST(SweepTest, ParallelRunsMatchSerialRuns) {
+  const auto feed = synthetic_feed();
+  const std::vector<std::string> tickers{kTicker};
+  BacktestConfig base;
+  base.sim.order_latency_ns = 100;
+  base.sim.cancel_latency_ns = 100;
+
+  SweepGrid g;
+  g.gamma = {0.0, 0.01, 0.1};
+  g.k = {0.5, 1.5};
+  g.sigma = {1.0};
+  g.horizon = {10.0, 60.0};
+  const auto grid = g.expand();
+
+  ThreadPool pool(4);
+  const auto results = run_sweep(feed, tickers, grid, base, pool);
+  ASSERT_EQ(results.size(), grid.size());
+
+  for (std::size_t i = 0; i < grid.size(); ++i) {
+    BacktestConfig cfg = base;
+    cfg.as_params = grid[i];
+    const BacktestResult serial = run_backtest(feed, tickers, cfg);
+    const BacktestResult &par = results[i].result;
+    EXPECT_EQ(results[i].params.gamma, grid[i].gamma);
+    EXPECT_EQ(par.fills, serial.fills);
+    EXPECT_EQ(par.orders, serial.orders);
+    EXPECT_EQ(par.pnl.at(kTicker).equity_cents,
+              serial.pnl.at(kTicker).equity_cents);
+  }
+
+  std::ostringstream csv;
+  write_sweep_csv(csv, results);
+  std::size_t lines = 0;
+  for (char c : csv.str())
+    lines += c == '\n';
+  EXPECT_EQ(lines, grid.size() + 1);
+}
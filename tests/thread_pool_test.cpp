@@ -0,0 +1,45 @@
+#include <gtest/gtest.h>
+
+#include "infra/thread_pool.hpp"
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+TEST(ThreadPoolTest, RunsEverySubmittedTask) {
+  ThreadPool pool(4);
+  std::atomic<int> ran{0};
+  for (int i = 0; i < 1000; ++i) {
+    pool.submit([&] { ran.fetch_add(1, std::memory_order_relaxed); });
+  }
+  pool.wait_idle();
+  EXPECT_EQ(ran.load(), 1000);
+
+  // Reusable after going idle.
+  pool.submit([&] { ran.fetch_add(1, std::memory_order_relaxed); });
+  pool.wait_idle();
+  EXPECT_EQ(ran.load(), 1001);
+}
+
+TEST(ThreadPoolTest, IdleWorkersStealFromBusyOnes) {
+  ThreadPool pool(2);
+  // Round-robin leaves half the short tasks on the deque of whichever
+  // worker ends up stuck on the blocking task; they only finish if the
+  // other worker steals them.
+  std::atomic<bool> release{false};
+  pool.submit([&] {
+    while (!release.load())
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  });
+  std::atomic<int> done{0};
+  for (int i = 0; i < 9; ++i) {
+    pool.submit([&] { done.fetch_add(1); });
+  }
+  const auto deadline =
+      std::chrono::steady_clock::now() + std::chrono::seconds(5);
+  while (done.load() < 9 && std::chrono::steady_clock::now() < deadline)
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  EXPECT_EQ(done.load(), 9);
+
+  release = true;
+  pool.wait_idle();
+}
@@ -0,0 +1,116 @@
+#include <gtest/gtest.h>
+
+#include "infra/ws_client.hpp"
+
+#include <optional>
+
+namespace {
+
+constexpr std::int64_t kMs = 1'000'000;
+constexpr std::int64_t kSec = 1'000'000'000;
+constexpr std::int64_t kStart = 1'700'000'000 * kSec;
+
+// Opens on start() and closes on stop(), firing the callbacks inline the way
+// ix::WebSocket fires them before start() and stop() return.
+class FakeSocket {
+public:
+  static inline std::atomic<int> starts{0};
+
+  void setUrl(const std::string &) {}
+  void disableAutomaticReconnection() {}
+  void setExtraHeaders(const ix::WebSocketHttpHeaders &) {}
+  void setOnMessageCallback(const ix::OnMessageCallback &cb) {
+    callback = cb;
+  }
+
+  void start() {
+    ++starts;
+    state = ix::ReadyState::Open;
+    fire(ix::WebSocketMessageType::Open);
+  }
+
+  void stop() {
+    if (state != ix::ReadyState::Open)
+      return;
+    state = ix::ReadyState::Closed;
+    fire(ix::WebSocketMessageType::Close);
+  }
+
+  ix::WebSocketSendInfo send(const std::string &) {
+    ix::WebSocketSendInfo info;
+    info.success = state == ix::ReadyState::Open;
+    return info;
+  }
+
+  ix::ReadyState getReadyState() const { return state; }
+
+private:
+  void fire(ix::WebSocketMessageType type) {
+    if (!callback)
+      return;
+    const std::string empty;
+    callback(std::make_unique<ix::WebSocketMessage>(
+        ix::WebSocketMessage{type, empty, 0, ix::WebSocketErrorInfo{},
+                             ix::WebSocketOpenInfo{}, ix::WebSocketCloseInfo{},
+                             false}));
+  }
+
+  ix::OnMessageCallback callback;
+  ix::ReadyState state = ix::ReadyState::Closed;
+};
+
+struct NoAdapter {
+  std::optional<FeedEvent> parse(std::string_view) { return std::nullopt; }
+};
+
+bool wait_for_starts(int n) {
+  const auto deadline =
+      std::chrono::steady_clock::now() + std::chrono::seconds(2);
+  while (FakeSocket::starts.load() < n) {
+    if (std::chrono::steady_clock::now() > deadline)
+      return false;
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  return true;
+}
+
+} // namespace
+
+TEST(WsClientTest, RecycledConnectionReconnectsOnce) {
+  FakeSocket::starts = 0;
+  ReconnectConfig rc;
+  rc.backoff.initial = std::chrono::milliseconds(1);
+  rc.backoff.max = std::chrono::milliseconds(2);
+  WsClient<NoAdapter, FakeSocket> client("ws://test", nullptr, nullptr,
+                                         nullptr, {}, rc);
+
+  FeedLatencyConfig lc;
+  lc.window = std::chrono::milliseconds(1000);
+  lc.windows = 5;
+  FeedLatencyMonitor monitor(lc);
+  monitor.set_lag_handler(
+      [&](int c, const LatencyStats &) { client.recycle_connection(c); });
+
+  client.start();
+  ASSERT_TRUE(wait_for_starts(1));
+  ASSERT_TRUE(client.is_connected());
+
+  // Connection 1 holds the clock floor while connection 0 falls 800 ms
+  // behind, until the monitor flags it.
+  const std::int64_t end = kStart + 60 * kSec;
+  int n = 0;
+  for (std::int64_t t = kStart; t < end && !monitor.lag_alerts();
+       t += 7 * kMs, ++n) {
+    const int c = n % 2;
+    const std::int64_t lag = c == 0 && t >= kStart + 20 * kSec ? 800 * kMs : 0;
+    monitor.record(c, "M", t - t % kSec, t + 2 * kMs + lag);
+  }
+  ASSERT_EQ(monitor.lag_alerts(), 1u);
+
+  ASSERT_TRUE(wait_for_starts(2));
+  // The Close our own restart causes must not schedule another one.
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  EXPECT_EQ(FakeSocket::starts.load(), 2);
+  EXPECT_TRUE(client.is_connected());
+  client.stop();
+}
@@ -0,0 +1,110 @@
+#include "alloc_audit.hpp"
+
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <execinfo.h>
+#include <sys/resource.h>
+#include <unistd.h>
+
+namespace alloc_audit {
+
+namespace {
+
+// Trivially initialised, so operator new can touch them on any thread at
+// any point of its life.
+thread_local ThreadCounts counts;
+thread_local NoAllocZone *current_zone = nullptr;
+thread_local bool reporting = false;
+
+std::atomic<std::uint64_t> zone_allocations{0};
+std::atomic<std::uint64_t> zone_faults{0};
+std::atomic<std::uint64_t> zone_blocking{0};
+
+// write(2) and backtrace_symbols_fd only: the report must not allocate.
+void write_stderr(const char *msg) {
+  std::size_t n = 0;
+  while (msg[n])
+    ++n;
+  ssize_t rc = ::write(STDERR_FILENO, msg, n);
+  (void)rc;
+}
+
+void report(const char *zone, const char *what, ZoneAction action) {
+  char line[256];
+  std::snprintf(line, sizeof(line), "[ALLOC] %s in no-alloc zone '%s'\n",
+                what, zone);
+  write_stderr(line);
+  void *frames[32];
+  const int depth = backtrace(frames, 32);
+  backtrace_symbols_fd(frames, depth, STDERR_FILENO);
+  if (action == ZoneAction::Abort)
+    std::abort();
+}
+
+void thread_usage(long &faults, long &blocks) {
+  rusage ru{};
+  getrusage(RUSAGE_THREAD, &ru);
+  faults = ru.ru_minflt + ru.ru_majflt;
+  blocks = ru.ru_nvcsw;
+}
+
+} // namespace
+
+ThreadCounts thread_counts() { return counts; }
+
+Violations violations() {
+  Violations v;
+  v.allocations = zone_allocations.load(std::memory_order_relaxed);
+  v.page_faults = zone_faults.load(std::memory_order_relaxed);
+  v.blocking = zone_blocking.load(std::memory_order_relaxed);
+  return v;
+}
+
+void on_allocation(std::size_t bytes) {
+  ++counts.allocations;
+  counts.bytes += bytes;
+  NoAllocZone *z = current_zone;
+  if (!z || reporting)
+    return;
+  zone_allocations.fetch_add(1, std::memory_order_relaxed);
+  if (z->reported && z->action == ZoneAction::Report)
+    return;
+  z->reported = true;
+  // backtrace() may allocate the first time it runs; don't recurse.
+  reporting = true;
+  char what[64];
+  std::snprintf(what, sizeof(what), "allocation of %zu bytes", bytes);
+  report(z->name, what, z->action);
+  reporting = false;
+}
+
+void on_deallocation() { ++counts.deallocations; }
+
+NoAllocZone::NoAllocZone(const char *name_, ZoneAction action_)
+    : name(name_), action(action_), outer(current_zone) {
+  current_zone = this;
+  thread_usage(faults_at_entry, blocks_at_entry);
+}
+
+NoAllocZone::~NoAllocZone() {
+  long faults = 0, blocks = 0;
+  thread_usage(faults, blocks);
+  current_zone = outer;
+  faults -= faults_at_entry;
+  blocks -= blocks_at_entry;
+  if (faults <= 0 && blocks <= 0)
+    return;
+  zone_faults.fetch_add(faults > 0 ? faults : 0, std::memory_order_relaxed);
+  zone_blocking.fetch_add(blocks > 0 ? blocks : 0, std::memory_order_relaxed);
+  if (reported && action == ZoneAction::Report)
+    return;
+  reporting = true;
+  char what[96];
+  std::snprintf(what, sizeof(what), "%ld page faults, %ld blocking waits",
+                faults, blocks);
+  report(name, what, action);
+  reporting = false;
+}
+
+} // namespace alloc_audit
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// Heap and kernel-interaction auditing for the hot path, compiled in with
+// -DKALSHI_ALLOC_AUDIT=ON. That build replaces the global operator
+// new/delete (utils/alloc_audit_hooks.cpp) to count allocations per thread,
+// and turns KALSHI_NO_ALLOC_ZONE into a scope that reports, or aborts on,
+// any allocation made inside it, with a stack trace. A zone also compares
+// the thread's rusage on entry and exit: page faults and voluntary context
+// switches (a blocking syscall) inside it are reported the same way.
+// Without the option the macros compile to nothing and the counters stay
+// zero.
+namespace alloc_audit {
+
+#ifdef KALSHI_ALLOC_AUDIT
+constexpr bool kEnabled = true;
+#else
+constexpr bool kEnabled = false;
+#endif
+
+struct ThreadCounts {
+  std::uint64_t allocations = 0;
+  std::uint64_t deallocations = 0;
+  std::uint64_t bytes = 0;
+};
+
+struct Violations {
+  std::uint64_t allocations = 0; // inside a zone
+  std::uint64_t page_faults = 0; // minor + major, inside a zone
+  std::uint64_t blocking = 0;    // voluntary context switches in a zone
+};
+
+enum class ZoneAction { Report, Abort };
+
+// Calling thread's totals since it started.
+ThreadCounts thread_counts();
+// Totals across all threads since startup.
+Violations violations();
+
+class NoAllocZone {
+public:
+  explicit NoAllocZone(const char *name,
+                       ZoneAction action = ZoneAction::Report);
+  ~NoAllocZone();
+  NoAllocZone(const NoAllocZone &) = delete;
+  NoAllocZone &operator=(const NoAllocZone &) = delete;
+
+private:
+  friend void on_allocation(std::size_t bytes);
+
+  const char *name;
+  ZoneAction action;
+  NoAllocZone *outer;
+  bool reported = false; // one trace per zone instance
+  long faults_at_entry = 0;
+  long blocks_at_entry = 0;
+};
+
+// Allocations on the calling thread while the scope is alive; for tests
+// that pin a per-event allocation budget.
+class AllocationScope {
+public:
+  AllocationScope() : start(thread_counts()) {}
+  std::uint64_t allocations() const {
+    return thread_counts().allocations - start.allocations;
+  }
+  std::uint64_t bytes() const { return thread_counts().bytes - start.bytes; }
+
+private:
+  ThreadCounts start;
+};
+
+// Called by the replaced operator new/delete.
+void on_allocation(std::size_t bytes);
+void on_deallocation();
+
+} // namespace alloc_audit
+
+#define KALSHI_ALLOC_AUDIT_CAT2(a, b) a##b
+#define KALSHI_ALLOC_AUDIT_CAT(a, b) KALSHI_ALLOC_AUDIT_CAT2(a, b)
+
+#ifdef KALSHI_ALLOC_AUDIT
+#define KALSHI_NO_ALLOC_ZONE(name)                                             \
+  ::alloc_audit::NoAllocZone KALSHI_ALLOC_AUDIT_CAT(kalshi_no_alloc_zone_,     \
+                                                    __LINE__)(name)
+#else
+#define KALSHI_NO_ALLOC_ZONE(name) ((void)0)
+#endif
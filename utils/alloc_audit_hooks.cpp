@@ -0,0 +1,75 @@
+// Global operator new/delete replacements for the allocation-audit build.
+// CMake compiles this into every executable when KALSHI_ALLOC_AUDIT is on;
+// in any other build it is empty.
+#ifdef KALSHI_ALLOC_AUDIT
+
+#include "alloc_audit.hpp"
+
+#include <cstdlib>
+#include <new>
+
+namespace {
+
+void *audited_alloc(std::size_t n) {
+  alloc_audit::on_allocation(n);
+  return std::malloc(n ? n : 1);
+}
+
+void *audited_alloc(std::size_t n, std::align_val_t al) {
+  alloc_audit::on_allocation(n);
+  const std::size_t a = static_cast<std::size_t>(al);
+  // aligned_alloc wants a size that is a multiple of the alignment.
+  return std::aligned_alloc(a, (n + a - 1) / a * a);
+}
+
+void audited_free(void *p) {
+  if (!p)
+    return;
+  alloc_audit::on_deallocation();
+  std::free(p);
+}
+
+} // namespace
+
+void *operator new(std::size_t n) {
+  if (void *p = audited_alloc(n))
+    return p;
+  throw std::bad_alloc();
+}
+
+void *operator new[](std::size_t n) { return operator new(n); }
+
+void *operator new(std::size_t n, const std::nothrow_t &) noexcept {
+  return audited_alloc(n);
+}
+
+void *operator new[](std::size_t n, const std::nothrow_t &) noexcept {
+  return audited_alloc(n);
+}
+
+void *operator new(std::size_t n, std::align_val_t al) {
+  if (void *p = audited_alloc(n, al))
+    return p;
+  throw std::bad_alloc();
+}
+
+void *operator new[](std::size_t n, std::align_val_t al) {
+  return operator new(n, al);
+}
+
+void operator delete(void *p) noexcept { audited_free(p); }
+void operator delete[](void *p) noexcept { audited_free(p); }
+void operator delete(void *p, std::size_t) noexcept { audited_free(p); }
+void operator delete[](void *p, std::size_t) noexcept { audited_free(p); }
+void operator delete(void *p, std::align_val_t) noexcept { audited_free(p); }
+void operator delete[](void *p, std::align_val_t) noexcept {
+  audited_free(p);
+}
+void operator delete(void *p, std::size_t, std::align_val_t) noexcept {
+  audited_free(p);
+}
+void operator delete[](void *p, std::size_t, std::align_val_t) noexcept {
+  audited_free(p);
+}
+
+#endif // KALSHI_ALLOC_AUDIT
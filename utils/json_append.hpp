@@ -0,0 +1,74 @@
+#pragma once
+
+#include <charconv>
+#include <concepts>
+#include <string>
+#include <string_view>
+
+// Appends JSON tokens to a caller-owned buffer, producing the same bytes as
+// nlohmann::json::dump() with default arguments: no whitespace, non-ASCII
+// passed through, control characters escaped as nlohmann does. Strings must
+// already be valid UTF-8 (dump() would throw on anything else). Nothing is
+// allocated once the buffer has grown to the size of the message.
+
+inline void append_json_string(std::string &out, std::string_view s) {
+  static constexpr char kHex[] = "0123456789abcdef";
+  out.push_back('"');
+  std::size_t run = 0; // start of the pending unescaped run
+  for (std::size_t i = 0; i < s.size(); ++i) {
+    const auto c = static_cast<unsigned char>(s[i]);
+    if (c >= 0x20 && c != '"' && c != '\\')
+      continue;
+    out.append(s.data() + run, i - run);
+    run = i + 1;
+    switch (c) {
+    case '"':
+      out.append("\\\"");
+      break;
+    case '\\':
+      out.append("\\\\");
+      break;
+    case '\b':
+      out.append("\\b");
+      break;
+    case '\f':
+      out.append("\\f");
+      break;
+    case '\n':
+      out.append("\\n");
+      break;
+    case '\r':
+      out.append("\\r");
+      break;
+    case '\t':
+      out.append("\\t");
+      break;
+    default: {
+      const char esc[] = {'\\', 'u', '0', '0', kHex[c >> 4], kHex[c & 0xf]};
+      out.append(esc, sizeof(esc));
+    }
+    }
+  }
+  out.append(s.data() + run, s.size() - run);
+  out.push_back('"');
+}
+
+template <std::integral Int> void append_json_int(std::string &out, Int v) {
+  char buf[24];
+  const auto res = std::to_chars(buf, buf + sizeof(buf), v);
+  out.append(buf, res.ptr);
+}
+
+// `strings` is any range of things convertible to std::string_view.
+template <typename Strings>
+void append_json_string_array(std::string &out, const Strings &strings) {
+  out.push_back('[');
+  bool first = true;
+  for (const auto &s : strings) {
+    if (!first)
+      out.push_back(',');
+    first = false;
+    append_json_string(out, s);
+  }
+  out.push_back(']');
+}
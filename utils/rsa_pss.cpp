@@ -1,17 +1,35 @@
 #include "rsa_pss.hpp"
 #include <iostream>
+#include <memory>
+
+std::size_t base64_encode(const unsigned char *data, std::size_t len,
+                          char *out) {
+  static constexpr char alphabet[] =
+      "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+  char *o = out;
+  std::size_t i = 0;
+  for (; i + 3 <= len; i += 3) {
+    const unsigned v = (data[i] << 16) | (data[i + 1] << 8) | data[i + 2];
+    *o++ = alphabet[(v >> 18) & 63];
+    *o++ = alphabet[(v >> 12) & 63];
+    *o++ = alphabet[(v >> 6) & 63];
+    *o++ = alphabet[v & 63];
+  }
+  if (i < len) {
+    unsigned v = data[i] << 16;
+    if (i + 1 < len)
+      v |= data[i + 1] << 8;
+    *o++ = alphabet[(v >> 18) & 63];
+    *o++ = alphabet[(v >> 12) & 63];
+    *o++ = i + 1 < len ? alphabet[(v >> 6) & 63] : '=';
+    *o++ = '=';
+  }
+  return static_cast<std::size_t>(o - out);
+}
 
 std::string base64Encode(const std::vector<unsigned char> &data) {
-  BIO *b64 = BIO_new(BIO_f_base64());
-  BIO *bmem = BIO_new(BIO_s_mem());
-  BIO_set_flags(b64, BIO_FLAGS_BASE64_NO_NL);
-  BIO_push(b64, bmem);
-  BIO_write(b64, data.data(), static_cast<int>(data.size()));
-  BIO_flush(b64);
-  BUF_MEM *bptr = nullptr;
-  BIO_get_mem_ptr(b64, &bptr);
-  std::string result(bptr->data, bptr->length);
-  BIO_free_all(b64);
+  std::string result(base64_encoded_size(data.size()), '\0');
+  base64_encode(data.data(), data.size(), result.data());
   return result;
 }
 
@@ -30,72 +48,75 @@ EVP_PKEY *loadPrivateKey(const std::string &path) {
   return pkey;
 }
 
-bool signPssSha256(EVP_PKEY *pkey, const std::string &message,
-                   std::string &sigB64) {
+PssSigner::PssSigner(EVP_PKEY *key) : pkey(key) {
   if (!pkey) {
     std::cerr << "Invalid key\n";
-    return false;
+    return;
   }
-  EVP_MD_CTX *mdctx = EVP_MD_CTX_new();
-  if (!mdctx) {
+  EVP_MD_CTX *ctx = EVP_MD_CTX_new();
+  work = EVP_MD_CTX_new();
+  if (!ctx || !work) {
     std::cerr << "EVP_MD_CTX_new failed\n";
-    return false;
+    EVP_MD_CTX_free(ctx);
+    return;
+  }
+  EVP_PKEY_CTX *pctx = nullptr;
+  if (EVP_DigestSignInit(ctx, &pctx, EVP_sha256(), nullptr, pkey) != 1 ||
+      EVP_PKEY_CTX_set_rsa_padding(pctx, RSA_PKCS1_PSS_PADDING) <= 0 ||
+      EVP_PKEY_CTX_set_rsa_mgf1_md(pctx, EVP_sha256()) <= 0 ||
+      EVP_PKEY_CTX_set_rsa_pss_saltlen(pctx, RSA_PSS_SALTLEN_DIGEST) <= 0) {
+    std::cerr << "Failed to configure RSA-PSS signing context\n";
+    ERR_print_errors_fp(stderr);
+    EVP_MD_CTX_free(ctx);
+    return;
   }
-  bool ok = false;
-  do {
-    if (EVP_DigestSignInit(mdctx, nullptr, EVP_sha256(), nullptr, pkey) != 1) {
-      std::cerr << "EVP_DigestSignInit failed\n";
-      ERR_print_errors_fp(stderr);
-      break;
-    }
-    EVP_PKEY_CTX *pctx = EVP_MD_CTX_pkey_ctx(mdctx);
-    if (!pctx) {
-      std::cerr << "EVP_MD_CTX_pkey_ctx failed\n";
-      ERR_print_errors_fp(stderr);
-      break;
-    }
-    if (EVP_PKEY_CTX_set_rsa_padding(pctx, RSA_PKCS1_PSS_PADDING) <= 0) {
-      std::cerr << "Failed to set RSA PSS padding\n";
-      ERR_print_errors_fp(stderr);
-      break;
-    }
+  proto = ctx;
+  sig.resize(static_cast<std::size_t>(EVP_PKEY_get_size(pkey)));
+}
 
-    if (EVP_PKEY_CTX_set_rsa_mgf1_md(pctx, EVP_sha256()) <= 0) {
-      std::cerr << "Failed to set MGF1 to SHA-256\n";
-      ERR_print_errors_fp(stderr);
-      break;
-    }
+PssSigner::~PssSigner() {
+  EVP_MD_CTX_free(proto);
+  EVP_MD_CTX_free(work);
+}
 
-    if (EVP_PKEY_CTX_set_rsa_pss_saltlen(pctx, RSA_PSS_SALTLEN_DIGEST) <= 0) {
-      std::cerr << "Failed to set PSS salt length\n";
-      ERR_print_errors_fp(stderr);
-      break;
-    }
+std::size_t PssSigner::sign(std::string_view message, char *out) {
+  if (!proto)
+    return 0;
+  if (EVP_MD_CTX_copy_ex(work, proto) != 1) {
+    std::cerr << "EVP_MD_CTX_copy_ex failed\n";
+    ERR_print_errors_fp(stderr);
+    return 0;
+  }
+  if (EVP_DigestSignUpdate(work, message.data(), message.size()) != 1) {
+    std::cerr << "EVP_DigestSignUpdate failed\n";
+    ERR_print_errors_fp(stderr);
+    return 0;
+  }
+  std::size_t sig_len = sig.size();
+  if (EVP_DigestSignFinal(work, sig.data(), &sig_len) != 1) {
+    std::cerr << "EVP_DigestSignFinal failed\n";
+    ERR_print_errors_fp(stderr);
+    return 0;
+  }
+  return base64_encode(sig.data(), sig_len, out);
+}
 
-    if (EVP_DigestSignUpdate(
-            mdctx, reinterpret_cast<const unsigned char *>(message.data()),
-            message.size()) != 1) {
-      std::cerr << "EVP_DigestSignUpdate failed\n";
-      ERR_print_errors_fp(stderr);
-      break;
-    }
-    size_t sigLen = 0;
-    if (EVP_DigestSignFinal(mdctx, nullptr, &sigLen) != 1) {
-      std::cerr << "EVP_DigestSignFinal (get length) failed\n";
-      ERR_print_errors_fp(stderr);
-      break;
-    }
-    std::vector<unsigned char> sig(sigLen);
-    if (EVP_DigestSignFinal(mdctx, sig.data(), &sigLen) != 1) {
-      std::cerr << "EVP_DigestSignFinal (generate) failed\n";
-      ERR_print_errors_fp(stderr);
-      break;
-    }
-    sig.resize(sigLen);
-    sigB64 = base64Encode(sig);
-    ok = true;
-  } while (false);
+bool PssSigner::sign(std::string_view message, std::string &sig_b64) {
+  sig_b64.resize(encoded_size());
+  const std::size_t n = sign(message, sig_b64.data());
+  sig_b64.resize(n);
+  return n > 0;
+}
 
-  EVP_MD_CTX_free(mdctx);
-  return ok;
+bool signPssSha256(EVP_PKEY *pkey, const std::string &message,
+                   std::string &sigB64) {
+  if (!pkey) {
+    std::cerr << "Invalid key\n";
+    return false;
+  }
+  thread_local std::unique_ptr<PssSigner> signer;
+  if (!signer || signer->key() != pkey) {
+    signer = std::make_unique<PssSigner>(pkey);
+  }
+  return signer->ok() && signer->sign(message, sigB64);
 }
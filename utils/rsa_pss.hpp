@@ -1,4 +1,8 @@
+#pragma once
+
+#include <cstddef>
 #include <string>
+#include <string_view>
 #include <vector>
 
 #include <openssl/bio.h>
@@ -7,7 +11,49 @@
 #include <openssl/evp.h>
 #include <openssl/pem.h>
 
+// Padded standard-alphabet base64, no newlines.
+constexpr std::size_t base64_encoded_size(std::size_t n) {
+  return (n + 2) / 3 * 4;
+}
+// Writes base64_encoded_size(len) chars to `out` (no terminator) and
+// returns that count. Never allocates.
+std::size_t base64_encode(const unsigned char *data, std::size_t len,
+                          char *out);
+
 std::string base64Encode(const std::vector<unsigned char> &data);
 EVP_PKEY *loadPrivateKey(const std::string &path);
+
+// Uses a per-thread PssSigner for `pkey`, so repeat calls skip the context
+// setup.
 bool signPssSha256(EVP_PKEY *pkey, const std::string &message,
                    std::string &sigB64);
+
+// RSA-PSS / SHA-256 / MGF1-SHA-256 / digest-length salt, as Kalshi expects.
+// Digest, padding, MGF1 and salt length are configured once on a template
+// context; each signature starts from a copy of it and encodes into a
+// caller buffer. One signer per thread: sign() reuses internal state.
+class PssSigner {
+public:
+  // `pkey` is not owned and must outlive the signer.
+  explicit PssSigner(EVP_PKEY *pkey);
+  ~PssSigner();
+  PssSigner(const PssSigner &) = delete;
+  PssSigner &operator=(const PssSigner &) = delete;
+
+  bool ok() const { return proto != nullptr; }
+  EVP_PKEY *key() const { return pkey; }
+
+  // Base64 length of every signature from this key.
+  std::size_t encoded_size() const { return base64_encoded_size(sig.size()); }
+
+  // Writes the base64 signature to `out`, which must hold encoded_size()
+  // chars, and returns its length; 0 on failure.
+  std::size_t sign(std::string_view message, char *out);
+  bool sign(std::string_view message, std::string &sig_b64);
+
+private:
+  EVP_PKEY *pkey;
+  EVP_MD_CTX *proto = nullptr; // configured, never updated
+  EVP_MD_CTX *work = nullptr;
+  std::vector<unsigned char> sig;
+};